@@ -37,6 +37,16 @@ FIRM_API double gs_matrix_get(const gs_matrix_t *m, unsigned row, unsigned col);
  */
 FIRM_API double gs_matrix_gauss_seidel(const gs_matrix_t *m, double *x);
 
+/**
+ * Performs one step of the Gauss-Seidel algorithm for the system m*x = b
+ * @p m         The iteration matrix
+ * @p x         The iteration vector
+ * @p b         The right hand side
+ * @returns     the sum of the absolute changes in x
+ */
+FIRM_API double gs_matrix_gauss_seidel_rhs(const gs_matrix_t *m, double *x,
+                                           const double *b);
+
 FIRM_API unsigned gs_matrix_get_n_entries(const gs_matrix_t *m);
 
 /**
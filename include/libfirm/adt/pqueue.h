@@ -28,6 +28,12 @@
 /** priority queue */
 typedef struct pqueue_t pqueue_t;
 
+/**
+ * A handle to an element of a priority queue. It stays valid until the
+ * element is removed from the queue.
+ */
+typedef size_t pqueue_handle_t;
+
 /**
  * Creates a new priority queue.
  * @return A priority queue of initial length 0.
@@ -48,6 +54,49 @@ FIRM_API void del_pqueue(pqueue_t *q);
  */
 FIRM_API void pqueue_put(pqueue_t *q, void *data, int priority);
 
+/**
+ * Inserts a new element into a priority queue.
+ * @param q         The priority queue the element should be inserted to.
+ * @param data      The actual data which should be stored in the queue.
+ * @param priority  The priority for the data.
+ * @return A handle to the new element.
+ */
+FIRM_API pqueue_handle_t pqueue_insert(pqueue_t *q, void *data,
+                                       double priority);
+
+/**
+ * Changes the priority of an element in a priority queue, which may be
+ * higher or lower than the old one.
+ * @param q         The priority queue.
+ * @param handle    The handle of the element.
+ * @param priority  The new priority for the element.
+ */
+FIRM_API void pqueue_set_priority(pqueue_t *q, pqueue_handle_t handle,
+                                  double priority);
+
+/**
+ * Returns the priority of an element in a priority queue.
+ * @param q         The priority queue.
+ * @param handle    The handle of the element.
+ */
+FIRM_API double pqueue_get_priority(pqueue_t const *q, pqueue_handle_t handle);
+
+/**
+ * Removes an element from a priority queue.
+ * @param q         The priority queue.
+ * @param handle    The handle of the element.
+ * @return The data of the element.
+ */
+FIRM_API void *pqueue_remove(pqueue_t *q, pqueue_handle_t handle);
+
+/**
+ * Returns the first element, i.e. that one with the highest priority, without
+ * removing it from the queue.
+ * @param q   The priority queue.
+ * @return The first element of the queue. Asserts if queue is empty.
+ */
+FIRM_API void *pqueue_front(pqueue_t const *q);
+
 /**
  * Returns and removes the first element, i.e. that one with the highest priority, from the queue.
  * @param q   The priority queue.
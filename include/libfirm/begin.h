@@ -34,6 +34,22 @@
 	#define  FIRM_API extern
 #endif
 
+/**
+ * @def FIRM_THREAD_LOCAL
+ * Storage class specifier for global state which every thread gets its own
+ * copy of. This is only active when libFirm (and its user) is compiled with
+ * FIRM_THREADS defined.
+ */
+#ifdef FIRM_THREADS
+	#ifdef _MSC_VER
+		#define FIRM_THREAD_LOCAL __declspec(thread)
+	#else
+		#define FIRM_THREAD_LOCAL __thread
+	#endif
+#else
+	#define FIRM_THREAD_LOCAL
+#endif
+
 #endif
 
 /* mark declarations as C function (note that we always need this,
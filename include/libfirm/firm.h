@@ -40,6 +40,18 @@
  *   and further functionality needed in a compiler.  Finally there is more
  *   generic functionality to support implementations using firm.
  *   (Code generation, further optimizations).
+ *
+ *  By default libFirm is single threaded. When libFirm and its user are
+ *  compiled with FIRM_THREADS defined (and linked with the platform thread
+ *  library), the identifier and target value tables, the node and graph
+ *  numbering, the program's graph and type lists, the graph visited counters
+ *  and current_ir_graph may be used from several threads, so that the graphs
+ *  of different, already existing entities can be constructed concurrently.
+ *  Other types and entities must still be created from one thread at a time.
+ *  A pass manager can run graph passes on several graphs at once, see
+ *  ir_pass_manager_set_n_threads() for the passes that allow this. All other
+ *  passes and the backend keep per-run state in static variables and must be
+ *  run from one thread at a time.
  */
 
 /** @defgroup irana Analyses */
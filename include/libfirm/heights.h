@@ -63,6 +63,15 @@ FIRM_API unsigned heights_recompute_block(ir_heights_t *h, ir_node *block);
  */
 FIRM_API ir_heights_t *heights_new(ir_graph *irg);
 
+/**
+ * Makes heights_reachable_in_block() answer queries from a transitive
+ * reachability bit matrix which is built for each block on the first query in
+ * it. Only use this if the data dependencies inside the queried blocks do not
+ * change or heights_recompute_block() is called after changing them.
+ * @param h The heights object.
+ */
+FIRM_API void heights_enable_reachability_index(ir_heights_t *h);
+
 /**
  * Frees a heights object.
  * @param h The heights object.
@@ -517,8 +517,9 @@ FIRM_API ir_node *new_ASM(ir_node *mem, int arity, ir_node *in[],
 
 /**
  * Global variable holding the graph which is currently constructed.
+ * With FIRM_THREADS every thread has its own current_ir_graph.
  */
-FIRM_API ir_graph *current_ir_graph;
+FIRM_API FIRM_THREAD_LOCAL ir_graph *current_ir_graph;
 
 /**
  * Returns graph which is currently constructed
@@ -667,6 +668,32 @@ FIRM_API void keep_alive(ir_node *ka);
 /** Puts the graph into state "phase_high" */
 FIRM_API void irg_finalize_cons(ir_graph *irg);
 
+/**
+ * Starts the construction of many nodes in @p irg at once.
+ *
+ * Storage for @p n_nodes further nodes is reserved up front. Until
+ * irg_commit_bulk_cons() the new nodes are neither entered into the value
+ * table for CSE nor into the out edges; the node constructors only run the
+ * local optimizations that do not need the value table. No other
+ * optimization may be run on the graph during a bulk construction.
+ *
+ * @param irg      the graph
+ * @param n_nodes  an estimate of the number of nodes that will be created
+ */
+FIRM_API void irg_begin_bulk_cons(ir_graph *irg, size_t n_nodes);
+
+/**
+ * Ends a bulk construction started by irg_begin_bulk_cons().
+ *
+ * The nodes created since then are entered into the value table in the order
+ * of their creation, and nodes found to be common subexpressions are
+ * exchanged with their earlier equivalent. Nodes whose operands were
+ * exchanged are optimized again. All references to exchanged nodes, also
+ * from nodes and values created before the bulk, are redirected. Out edges
+ * are rebuilt if they were active before.
+ */
+FIRM_API void irg_commit_bulk_cons(ir_graph *irg);
+
 /**
  * If firm is built in debug mode, verify that a newly created node is fine.
  * The normal node constructors already call this function, you only need to
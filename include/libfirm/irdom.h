@@ -185,6 +185,27 @@ FIRM_API void compute_doms(ir_graph *irg);
  */
 FIRM_API void compute_postdoms(ir_graph *irg);
 
+/**
+ * Updates the dominance and post dominance relation after the control flow
+ * edge from block @p from to block @p to was added.
+ *
+ * Only the relations that are consistent are updated. Usually only the part
+ * of the dominator trees below the deepest common dominator of @p from and
+ * @p to is recomputed, which does not need outs information. If blocks become
+ * reachable or unreachable, if one of the blocks was created after the trees
+ * were computed, or if the post dominators of endless loops are involved,
+ * everything is recomputed like compute_doms() and compute_postdoms() do.
+ * The dominance frontiers are freed.
+ */
+FIRM_API void dom_insert_edge(ir_node *from, ir_node *to);
+
+/**
+ * Updates the dominance and post dominance relation after the control flow
+ * edge from block @p from to block @p to was removed.
+ * Works like dom_insert_edge().
+ */
+FIRM_API void dom_delete_edge(ir_node *from, ir_node *to);
+
 /**
  * Compute the dominance frontiers for a given graph.
  * The information is freed automatically when dominance info is freed.
@@ -77,7 +77,7 @@
  * - n_loc           An int giving the number of local variables in this
  *                   procedure.  This is needed for ir construction.
  *
- * - value_table     This hash table (pset) is used for global value numbering
+ * - value_table     This hash table is used for global value numbering
  *                   for optimizing use in iropt.c.
  *
  * - visited         A int used as flag to traverse the ir_graph.
@@ -397,6 +397,15 @@ typedef enum ir_graph_properties_t {
 	IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE        = 1U << 11,
 	/** graph contains as many returns as possible */
 	IR_GRAPH_PROPERTY_MANY_RETURNS                   = 1U << 12,
+	/** the cached results of get_alias_relation() are up to date */
+	IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_CACHE         = 1U << 13,
+	/** the parameter summaries of the graph entity are up to date, see
+	 * get_method_param_access() and get_method_param_weight() */
+	IR_GRAPH_PROPERTY_CONSISTENT_PARAM_SUMMARY       = 1U << 14,
+	/** block execution frequencies are estimated, see get_block_execfreq() */
+	IR_GRAPH_PROPERTY_CONSISTENT_EXECFREQ            = 1U << 15,
+	/** the cached liveness check of the graph is up to date */
+	IR_GRAPH_PROPERTY_CONSISTENT_LIVENESS            = 1U << 16,
 
 	/**
 	 * List of all graph properties that are only affected by control flow
@@ -409,7 +418,9 @@ typedef enum ir_graph_properties_t {
 		| IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO
 		| IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
 		| IR_GRAPH_PROPERTY_CONSISTENT_POSTDOMINANCE
-		| IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE_FRONTIERS,
+		| IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE_FRONTIERS
+		| IR_GRAPH_PROPERTY_CONSISTENT_EXECFREQ
+		| IR_GRAPH_PROPERTY_CONSISTENT_LIVENESS,
 
 	/**
 	 * List of all graph properties.
@@ -421,7 +432,9 @@ typedef enum ir_graph_properties_t {
 		| IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
 		| IR_GRAPH_PROPERTY_CONSISTENT_OUTS
 		| IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE
-		| IR_GRAPH_PROPERTY_MANY_RETURNS,
+		| IR_GRAPH_PROPERTY_MANY_RETURNS
+		| IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_CACHE
+		| IR_GRAPH_PROPERTY_CONSISTENT_PARAM_SUMMARY,
 
 } ir_graph_properties_t;
 ENUM_BITSET(ir_graph_properties_t)
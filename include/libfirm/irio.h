@@ -5,7 +5,7 @@
 
 /**
  * @file
- * @brief   Input/Output textual representation of firm.
+ * @brief   Input/Output textual and binary representation of firm.
  * @author  Moritz Kroll
  */
 #ifndef FIRM_IR_IRIO_H
@@ -38,15 +38,55 @@ FIRM_API int ir_export(const char *filename);
  */
 FIRM_API void ir_export_file(FILE *output);
 
+/**
+ * Exports the whole irp to the given file in a compact binary form.
+ * The binary form contains the same information as the textual one but is
+ * smaller and faster to read. ir_import() maps it into memory.
+ *
+ * @param filename  the name of the resulting file
+ * @return  0 if no errors occured, other values in case of errors
+ */
+FIRM_API int ir_export_binary(const char *filename);
+
+/**
+ * same as ir_export_binary but writes to a FILE*
+ * @note As with any FILE* errors are indicated by ferror(output)
+ */
+FIRM_API void ir_export_binary_file(FILE *output);
+
 /**
  * Imports the data stored in the given file.
  * Imports any type graphs and ir graphs contained in the file.
+ * The file may be in textual or binary form.
  *
  * @param filename  the name of the file
  * @returns 0 if no errors occured, other values in case of errors
  */
 FIRM_API int ir_import(const char *filename);
 
+/**
+ * Imports the data stored in the given file like ir_import(), but defers
+ * building the ir graphs of a binary file: Types and entities are created
+ * immediately, the graph of a method entity is built by
+ * ir_load_entity_irg(). Until then get_entity_irg() returns NULL for the
+ * entity and the graph is not part of the program's graph list. Exporting
+ * the program builds all of them.
+ *
+ * @param filename  the name of the file
+ * @returns 0 if no errors occured, other values in case of errors
+ */
+FIRM_API int ir_import_lazy(const char *filename);
+
+/**
+ * Returns the ir graph of a method entity, building it first if its import
+ * was deferred by ir_import_lazy(). Building adds the graph to the
+ * program's graph list, so do not call this while iterating over it.
+ *
+ * @param entity  the method entity
+ * @returns the graph of the entity, NULL if it has none
+ */
+FIRM_API ir_graph *ir_load_entity_irg(ir_entity *entity);
+
 /**
  * same as ir_import but imports from a FILE*
  */
@@ -99,6 +99,21 @@ FIRM_API ir_mode *new_float_mode(const char *name,
  */
 FIRM_API ir_mode *new_non_arithmetic_mode(const char *name, unsigned bit_size);
 
+/**
+ * Creates a new vector mode. Values of the mode consist of @p n_lanes values
+ * of @p element_mode, arithmetic operations work on each element separately.
+ *
+ * @param name          the name of the mode to be created
+ * @param element_mode  mode of the elements, an integer or float mode
+ * @param n_lanes       number of elements
+ *
+ * The element with index 0 is stored at the lowest address. Arithmetic of
+ * vector modes is irma_none. Vector values cannot be method parameters or
+ * results; pass them in memory instead.
+ */
+FIRM_API ir_mode *new_vector_mode(const char *name, ir_mode *element_mode,
+                                  unsigned n_lanes);
+
 /** Returns the ident* of the mode */
 FIRM_API ident *get_mode_ident(const ir_mode *mode);
 
@@ -276,6 +291,15 @@ FIRM_API int mode_is_num(const ir_mode *mode);
  */
 FIRM_API int mode_is_data(const ir_mode *mode);
 
+/** Returns 1 if @p mode is a vector mode, 0 otherwise */
+FIRM_API int mode_is_vector(const ir_mode *mode);
+
+/** Returns the mode of the elements of the vector mode @p mode. */
+FIRM_API ir_mode *get_mode_vector_element_mode(const ir_mode *mode);
+
+/** Returns the number of elements of the vector mode @p mode. */
+FIRM_API unsigned get_mode_vector_n_lanes(const ir_mode *mode);
+
 /**
  * Returns true if a value of mode @p sm can be converted to mode @p lm without
  * loss.
@@ -10,7 +10,10 @@
 #ifndef FIRM_IROPTIMIZE_H
 #define FIRM_IROPTIMIZE_H
 
+#include <stdio.h>
+
 #include "firm_types.h"
+#include "irgraph.h"
 #include "begin.h"
 
 /**
@@ -130,6 +133,42 @@ FIRM_API void opt_if_conv(ir_graph *irg);
  */
 FIRM_API void opt_if_conv_cb(ir_graph *irg, arch_allow_ifconv_func callback);
 
+/**
+ * This function is called to evaluate the cost of a vector operation on the
+ * current architecture. The operation replaces @p node and its isomorphic
+ * neighbours, one in each lane of @p mode.
+ *
+ * @param node  A Load, Store or arithmetic node of the element mode of
+ *              @p mode.
+ * @param mode  The vector mode.
+ * @return      The cost of the vector operation, where one scalar operation
+ *              costs 1, or a negative value if the architecture has no such
+ *              vector operation.
+ */
+typedef int (*arch_vector_cost_func)(ir_node const *node, ir_mode *mode);
+
+/**
+ * Packs isomorphic scalar operations on adjacent memory into vector
+ * operations (superword level parallelism).
+ *
+ * Groups of Stores to adjacent addresses in a block are replaced by a vector
+ * Store, if their values are computed by isomorphic operations from Loads of
+ * adjacent addresses or constants. The cost function of the target decides
+ * which vector operations are available and profitable. Unrolled loops are
+ * vectorized by running this after loop unrolling.
+ *
+ * @param irg  The graph.
+ */
+FIRM_API void opt_slp(ir_graph *irg);
+
+/**
+ * Performs SLP vectorization on a graph - callback version.
+ *
+ * @param irg        The graph.
+ * @param cost_func  The cost function, NULL disables vectorization.
+ */
+FIRM_API void opt_slp_cb(ir_graph *irg, arch_vector_cost_func cost_func);
+
 /**
  * Tries to reduce dependencies for memory nodes where possible by parallelizing
  * them and synchronizing with Sync nodes
@@ -403,16 +442,43 @@ typedef void (*opt_ptr)(ir_graph *irg);
  * Heuristic inliner. Calculates a benefice value for every call and inlines
  * those calls with a value higher than the threshold.
  *
+ * Graphs are processed bottom-up in the callgraph, so a callee is finished,
+ * including @p after_inline_opt, before it is inlined into its callers.
+ *
  * @param maxsize             Do not inline any calls if a method has more than
  *                            maxsize firm nodes.  It may reach this limit by
  *                            inlining.
  * @param inline_threshold    inlining threshold
  * @param after_inline_opt    optimizations performed immediately after inlining
- *                            some calls
+ *                            some calls into a graph
  */
 FIRM_API void inline_functions(unsigned maxsize, int inline_threshold,
                                opt_ptr after_inline_opt);
 
+/**
+ * Heuristic inliner like inline_functions(), which optimizes independent
+ * graphs in parallel.
+ *
+ * The graphs are grouped into levels of the callgraph, a graph is one level
+ * above its highest callee. The calls of the graphs of a level are inlined
+ * one graph after the other, then @p after_inline_opt runs concurrently on
+ * all graphs of the level that got calls inlined. It must therefore only
+ * consist of passes that may run in parallel, see
+ * ir_pass_manager_set_n_threads(). Without FIRM_THREADS (see firm.h) the
+ * graphs are optimized one after the other.
+ *
+ * @param maxsize             Do not inline any calls if a method has more than
+ *                            maxsize firm nodes.  It may reach this limit by
+ *                            inlining.
+ * @param inline_threshold    inlining threshold
+ * @param after_inline_opt    optimizations performed immediately after inlining
+ *                            some calls into a graph
+ * @param n_threads           the maximum number of threads optimizing graphs
+ */
+FIRM_API void inline_functions_parallel(unsigned maxsize, int inline_threshold,
+                                        opt_ptr after_inline_opt,
+                                        unsigned n_threads);
+
 /**
  * Combines congruent blocks into one.
  *
@@ -439,6 +505,50 @@ FIRM_API void do_loop_unrolling(ir_graph *irg);
  */
 FIRM_API void do_loop_peeling(ir_graph *irg);
 
+/**
+ * Perform loop vectorization on a given graph.
+ * Innermost tail controlled counting loops with a constant number of
+ * iterations, which only access the array elements indexed by their
+ * induction variable, execute several iterations at once with vector
+ * operations. The cost function of the target decides which vector operations
+ * are available and profitable. Run loop inversion first to turn head
+ * controlled loops into tail controlled ones.
+ *
+ * @param irg  The graph.
+ */
+FIRM_API void do_loop_vectorization(ir_graph *irg);
+
+/**
+ * Perform loop vectorization on a given graph - callback version.
+ *
+ * @param irg        The graph.
+ * @param cost_func  The cost function, NULL disables vectorization.
+ */
+FIRM_API void do_loop_vectorization_cb(ir_graph *irg,
+                                       arch_vector_cost_func cost_func);
+
+/**
+ * Moves loop invariant computations in front of their loops.
+ *
+ * Besides pure computations, Loads are hoisted when no Store or Call in the
+ * loop may alias them and they either cannot trap or are executed in every
+ * iteration of the loop.
+ */
+FIRM_API void do_loop_invariant_motion(ir_graph *irg);
+
+/**
+ * Perform loop unswitching on a given graph.
+ *
+ * Loops containing a conditional jump with a loop invariant condition are
+ * duplicated, the condition is evaluated once in front of both versions.
+ *
+ * @param irg            the graph
+ * @param max_loop_size  maximum number of nodes of an unswitched loop
+ * @param max_growth     maximum growth of the graph in percent
+ */
+FIRM_API void do_loop_unswitching(ir_graph *irg, unsigned max_loop_size,
+                                  unsigned max_growth);
+
 /**
  * Removes all entities which are unused.
  *
@@ -519,6 +629,108 @@ FIRM_API ir_entity *create_compilerlib_entity(char const *name, ir_type *mt);
 
 /** @} */
 
+/**
+ * @ingroup iroptimize
+ * @defgroup irpass  Pass Manager
+ *
+ * A pass manager runs a pipeline of graph and program passes. Consecutive
+ * graph passes are run one graph after the other, so each graph goes through
+ * all of them while its analysis results are still valid.
+ *
+ * Analyses are cached as graph properties: Before a pass runs, the manager
+ * assures the properties the pass requires and afterwards keeps only those
+ * the pass preserved. A pass may still assure and confirm properties itself,
+ * the manager never keeps more than the pass left valid.
+ *
+ * For each pass the manager accumulates the time spent in the pass and in
+ * assuring its required analyses, the number of analyses it had to compute
+ * and the memory allocated on the graph obstacks. If statistic events are
+ * enabled, they are also reported for each run in the context "pass".
+ * @{
+ */
+
+/** A pass manager. */
+typedef struct ir_pass_manager_t ir_pass_manager_t;
+
+/** A pass transforming a single graph. */
+typedef void (*ir_graph_pass_func)(ir_graph *irg);
+
+/** A pass transforming the whole program. */
+typedef void (*ir_prog_pass_func)(void);
+
+/**
+ * Creates a new, empty pass manager.
+ *
+ * @param name  the name of the pipeline, used in statistics
+ */
+FIRM_API ir_pass_manager_t *new_ir_pass_manager(char const *name);
+
+/** Frees a pass manager. */
+FIRM_API void free_ir_pass_manager(ir_pass_manager_t *mgr);
+
+/**
+ * Appends a graph pass to the pipeline of a pass manager.
+ *
+ * @param mgr        the pass manager
+ * @param name       the name of the pass, used in statistics
+ * @param func       the pass
+ * @param required   the properties assured before the pass runs
+ * @param preserved  the properties still valid after the pass, use
+ *                   IR_GRAPH_PROPERTIES_ALL to keep everything the pass
+ *                   itself confirmed
+ */
+FIRM_API void ir_pass_manager_add_graph_pass(ir_pass_manager_t *mgr,
+                                             char const *name,
+                                             ir_graph_pass_func func,
+                                             ir_graph_properties_t required,
+                                             ir_graph_properties_t preserved);
+
+/**
+ * Appends a program pass to the pipeline of a pass manager. Its required and
+ * preserved properties apply to all graphs of the program.
+ *
+ * @see ir_pass_manager_add_graph_pass()
+ */
+FIRM_API void ir_pass_manager_add_prog_pass(ir_pass_manager_t *mgr,
+                                            char const *name,
+                                            ir_prog_pass_func func,
+                                            ir_graph_properties_t required,
+                                            ir_graph_properties_t preserved);
+
+/**
+ * Sets the number of threads running graph passes of a pass manager, the
+ * default is 1.
+ *
+ * With more than one thread, each group of consecutive graph passes runs on
+ * several graphs concurrently, every graph still runs through the whole group
+ * in one thread. The passes of the group must then only touch their own
+ * graph; passes that also modify types, entities or other graphs must be
+ * added as program passes. Of the passes in libFirm, optimize_graph_df(),
+ * optimize_cf(), remove_unreachable_code(), remove_bads(), place_code(),
+ * conv_opt(), opt_bool(), opt_jumpthreading(), optimize_reassociation(),
+ * opt_osr(), opt_parallelize_mem(), opt_frame_irg(), dead_node_elimination()
+ * and irg_verify() may run this way; combo(), optimize_load_store(),
+ * scalar_replacement_opt() and opt_if_conv() change global state and may not.
+ * No statistic events are reported for parallel runs.
+ *
+ * Without FIRM_THREADS (see firm.h) the setting is ignored and all passes
+ * run in the calling thread.
+ */
+FIRM_API void ir_pass_manager_set_n_threads(ir_pass_manager_t *mgr,
+                                            unsigned n_threads);
+
+/** Runs the pipeline of a pass manager on all graphs of the program. */
+FIRM_API void ir_pass_manager_run(ir_pass_manager_t *mgr);
+
+/** Prints the accumulated statistics of all passes to @p out. */
+FIRM_API void ir_pass_manager_print_stats(ir_pass_manager_t const *mgr,
+                                          FILE *out);
+
+/** Resets the accumulated statistics of all passes. */
+FIRM_API void ir_pass_manager_reset_stats(ir_pass_manager_t *mgr);
+
+/** @} */
+
 #include "end.h"
 
 #endif
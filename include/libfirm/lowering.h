@@ -132,6 +132,26 @@ typedef int lower_mux_callback(ir_node* mux);
  */
 FIRM_API void lower_mux(ir_graph *irg, lower_mux_callback *cb_func);
 
+/**
+ * Used as callback by lower_vector(). The return value indicates whether the
+ * target supports the operation of a node on a vector mode.
+ *
+ * @param node  A node with a vector mode, or a Load or Store of a vector.
+ * @return      A non-zero value indicates that the node may be kept.
+ */
+typedef int lower_vector_callback(ir_node *node);
+
+/**
+ * Replaces operations on vector modes by operations on their elements. If the
+ * callback rejects one node of a vector mode, all values of this mode are
+ * lowered, so vectors never need to be assembled from scalar values.
+ *
+ * @param irg      The graph to lower vector operations in.
+ * @param cb_func  The callback function deciding which operations the target
+ *                 supports. Can be NULL, to lower all vector operations.
+ */
+FIRM_API void lower_vector(ir_graph *irg, lower_vector_callback *cb_func);
+
 /**
  * An intrinsic mapper function.
  *
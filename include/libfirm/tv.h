@@ -159,6 +159,23 @@ FIRM_API ir_tarval *new_tarval_from_bytes(unsigned char const *buf,
 FIRM_API ir_tarval *new_tarval_nan(ir_mode *mode, int signaling,
                                    ir_tarval const *payload);
 
+/**
+ * Construct a new vector tarval from the tarvals of its lanes.
+ *
+ * @param mode   vector mode for the resulting tarval
+ * @param lanes  get_mode_vector_n_lanes(mode) tarvals of the element mode of
+ *               @p mode, lane 0 first
+ * @return A newly created (or cached) tarval, tarval_bad if one of the lanes
+ *         is tarval_bad.
+ */
+FIRM_API ir_tarval *new_tarval_from_lanes(ir_mode *mode,
+                                          ir_tarval *const *lanes);
+
+/**
+ * Returns the tarval of lane @p lane of the vector tarval @p tv.
+ */
+FIRM_API ir_tarval *get_tarval_lane(ir_tarval const *tv, unsigned lane);
+
 /**
  * Write tarval to a sequence of bytes. The value is written in a
  * "little endian" fashion which means the less significant bytes come first.
@@ -45,6 +45,10 @@ typedef struct {
 
 /**
  * Sets vrp data on the graph irg
+ * The ranges and known bits are computed one strongly connected component of
+ * the data dependencies at a time, so only values in cycles are visited more
+ * than once. Phis in cycles are widened and narrowed afterwards. If the
+ * constant bits analysis ran before, its results are used as well.
  * @param irg graph on which to set vrp data
  */
 FIRM_API void set_vrp_data(ir_graph *irg);
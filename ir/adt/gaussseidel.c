@@ -157,12 +157,12 @@ double gs_matrix_get(const gs_matrix_t *m, unsigned row, unsigned col)
 
 /* NOTE: You can slice out miss_rate and weights.
  * This does ONE step of gauss_seidel. Termination must be checked outside!
- * This solves m*x=0. You must add stuff for m*x=b. See wikipedia german and english article. Should be simple.
- * param a is the number of rows in the matrix that should be considered.
+ * This solves m*x=b, b may be NULL to solve m*x=0.
+ * See wikipedia german and english article.
  *
  * Note that the diagonal element is stored separately in this matrix implementation.
  * */
-double gs_matrix_gauss_seidel(const gs_matrix_t *m, double *x)
+static double gauss_seidel(const gs_matrix_t *m, double *x, const double *b)
 {
 	double res = 0.0;
 	unsigned n = m->c_rows;
@@ -171,7 +171,7 @@ double gs_matrix_gauss_seidel(const gs_matrix_t *m, double *x)
 		row_col_t *row  = &m->rows[r];
 		col_val_t *cols = row->cols;
 
-		double sum = 0.0;
+		double sum = b != NULL ? -b[r] : 0.0;
 		for (unsigned c = 0; c < row->n_cols; ++c) {
 			unsigned col_idx = cols[c].col_idx;
 			sum += cols[c].v * x[col_idx];
@@ -187,6 +187,17 @@ double gs_matrix_gauss_seidel(const gs_matrix_t *m, double *x)
 	return res;
 }
 
+double gs_matrix_gauss_seidel(const gs_matrix_t *m, double *x)
+{
+	return gauss_seidel(m, x, NULL);
+}
+
+double gs_matrix_gauss_seidel_rhs(const gs_matrix_t *m, double *x,
+                                  const double *b)
+{
+	return gauss_seidel(m, x, b);
+}
+
 void gs_matrix_dump(const gs_matrix_t *m, FILE *out)
 {
 	unsigned size  = m->c_rows;
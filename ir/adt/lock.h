@@ -0,0 +1,65 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2016 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Minimal mutual exclusion for libFirm's global tables.
+ *
+ * Without FIRM_THREADS all operations compile to nothing, so the
+ * single-threaded library pays no price. With FIRM_THREADS the lock is a
+ * pthread mutex (or an SRW lock on Windows) that can be initialized
+ * statically with FIRM_LOCK_INIT.
+ */
+#ifndef FIRM_ADT_LOCK_H
+#define FIRM_ADT_LOCK_H
+
+#ifdef FIRM_THREADS
+#ifdef _WIN32
+#include <windows.h>
+
+typedef SRWLOCK firm_lock_t;
+#define FIRM_LOCK_INIT SRWLOCK_INIT
+
+static inline void firm_lock(firm_lock_t *lock)
+{
+	AcquireSRWLockExclusive(lock);
+}
+
+static inline void firm_unlock(firm_lock_t *lock)
+{
+	ReleaseSRWLockExclusive(lock);
+}
+#else
+#include <pthread.h>
+
+typedef pthread_mutex_t firm_lock_t;
+#define FIRM_LOCK_INIT PTHREAD_MUTEX_INITIALIZER
+
+static inline void firm_lock(firm_lock_t *lock)
+{
+	pthread_mutex_lock(lock);
+}
+
+static inline void firm_unlock(firm_lock_t *lock)
+{
+	pthread_mutex_unlock(lock);
+}
+#endif
+#else
+typedef char firm_lock_t;
+#define FIRM_LOCK_INIT 0
+
+static inline void firm_lock(firm_lock_t *lock)
+{
+	(void)lock;
+}
+
+static inline void firm_unlock(firm_lock_t *lock)
+{
+	(void)lock;
+}
+#endif
+
+#endif
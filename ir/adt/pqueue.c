@@ -7,118 +7,246 @@
  * @file
  * Implements a heap.
  *
- * Implementation note: It might seem strange that we start indexing at 0
- * but use 2*i and 2*i+1 to find the left and right sucessor of an index.
- * The trick is that for index 0 the left successor is 0 again, and the
- * right successor is 1 in this scheme. For the right successor 1 everything
- * works like usual. We simply took care in the algorithms that they still
- * work with the left child of 0 being 0 again. This was possible without
- * any extra ifs or arithmetic.
- * Thus we can save the wastage of 1 array position you can see in other
- * implementations or the ugly (i+1)*2 - 1 and (i+1)*2 for calculating the
- * left and right child. (At the expense that stuff easily breaks when you make
- * changes and don't think that the left child of 0 is 0 :-/)
+ * Implementation note: The heap is 4-ary, the children of position i are at
+ * 4*i+1 to 4*i+4. This halves the height of the heap compared to a binary
+ * one and the children of a node share a cache line. Sifting moves a hole
+ * instead of swapping elements, so every element is written once per level.
+ *
+ * Elements which were inserted with a handle additionally record their heap
+ * position in a slot indexed by the handle, so handles stay valid while the
+ * element moves in the heap.
  *
  * @author  Christian Wuerdig, Matthias Braun
  * @brief   Priority Queue implementation based on the heap data structure
  */
 #include "pqueue.h"
 
+#include <stdint.h>
+
 #include "array.h"
 #include "panic.h"
+#include "util.h"
+
+#define PQUEUE_ARITY     4
+#define PQUEUE_NO_HANDLE SIZE_MAX
 
 typedef struct pqueue_el_t {
-	void *data;
-	int   priority;
+	double          priority;
+	void           *data;
+	pqueue_handle_t handle;  /**< PQUEUE_NO_HANDLE if there is none */
 } pqueue_el_t;
 
 struct pqueue_t {
-	pqueue_el_t *elems;
+	pqueue_el_t *elems;       /**< the heap */
+	size_t      *positions;   /**< heap position of each handle, for unused
+	                               handles the next unused one */
+	size_t       free_handle; /**< first unused handle */
 };
 
+static inline void pqueue_place(pqueue_t *q, size_t pos, pqueue_el_t el)
+{
+	q->elems[pos] = el;
+	if (el.handle != PQUEUE_NO_HANDLE)
+		q->positions[el.handle] = pos;
+}
+
 /**
- * Enforces the heap characteristics if the queue
- * starting from element at position @p pos.
+ * Moves the hole at position @p pos up until @p el can be placed in it.
  */
-static void pqueue_heapify(pqueue_t *q, size_t pos)
+static void pqueue_sift_up(pqueue_t *q, size_t pos, pqueue_el_t el)
 {
-	size_t len = ARR_LEN(q->elems);
-	while (pos * 2 < len) {
-		size_t exchange = pos;
-		if (q->elems[exchange].priority < q->elems[pos * 2].priority)
-			exchange = pos * 2;
-
-		if ((pos * 2 + 1) < len
-		    && q->elems[exchange].priority < q->elems[pos * 2 + 1].priority)
-			exchange = pos * 2 + 1;
-
-		if (exchange == pos)
+	while (pos > 0) {
+		size_t parent = (pos - 1) / PQUEUE_ARITY;
+		if (!(el.priority > q->elems[parent].priority))
 			break;
+		pqueue_place(q, pos, q->elems[parent]);
+		pos = parent;
+	}
+	pqueue_place(q, pos, el);
+}
 
-		pqueue_el_t tmp    = q->elems[pos];
-		q->elems[pos]      = q->elems[exchange];
-		q->elems[exchange] = tmp;
+/**
+ * Returns the position of the child with the highest priority among the
+ * children starting at @p first.
+ */
+static inline size_t pqueue_best_child(pqueue_el_t const *elems, size_t first,
+                                       size_t len)
+{
+	if (first + PQUEUE_ARITY <= len) {
+		/* Select by arithmetic instead of branches, the comparisons of
+		 * random priorities are unpredictable. */
+		double p0 = elems[first    ].priority;
+		double p1 = elems[first + 1].priority;
+		double p2 = elems[first + 2].priority;
+		double p3 = elems[first + 3].priority;
+		size_t i0 = first     + (p1 > p0);
+		size_t i1 = first + 2 + (p3 > p2);
+		double m0 = p1 > p0 ? p1 : p0;
+		double m1 = p3 > p2 ? p3 : p2;
+		return i0 + (i1 - i0) * (m1 > m0);
+	}
 
-		pos = exchange;
+	size_t best = first;
+	for (size_t c = first + 1; c < len; ++c) {
+		if (elems[c].priority > elems[best].priority)
+			best = c;
 	}
+	return best;
 }
 
 /**
- * Sifts up a newly inserted element at position @p pos.
+ * Moves the hole at position @p pos down until @p el can be placed in it.
  */
-static void pqueue_sift_up(pqueue_t *q, size_t pos)
+static void pqueue_sift_down(pqueue_t *q, size_t pos, pqueue_el_t el)
 {
-	while (q->elems[pos].priority > q->elems[pos / 2].priority) {
-		pqueue_el_t tmp   = q->elems[pos];
-		q->elems[pos]     = q->elems[pos / 2];
-		q->elems[pos / 2] = tmp;
+	pqueue_el_t *elems = q->elems;
+	size_t       len   = ARR_LEN(elems);
+	for (size_t first; (first = pos * PQUEUE_ARITY + 1) < len;) {
+		size_t best = pqueue_best_child(elems, first, len);
+		if (!(elems[best].priority > el.priority))
+			break;
+		pqueue_place(q, pos, elems[best]);
+		pos = best;
+	}
+	pqueue_place(q, pos, el);
+}
 
-		pos /= 2;
+/**
+ * Moves the hole at position @p pos down to a leaf and fills it with @p el.
+ * An element taken from the end of the heap usually belongs near the bottom
+ * again, so this saves comparing it on every level on the way down.
+ */
+static void pqueue_sift_down_to_leaf(pqueue_t *q, size_t pos, pqueue_el_t el)
+{
+	pqueue_el_t *elems = q->elems;
+	size_t       len   = ARR_LEN(elems);
+	for (size_t first; (first = pos * PQUEUE_ARITY + 1) < len;) {
+		size_t best = pqueue_best_child(elems, first, len);
+		pqueue_place(q, pos, elems[best]);
+		pos = best;
 	}
+	pqueue_sift_up(q, pos, el);
+}
+
+/**
+ * Puts @p el into the hole at position @p pos.
+ */
+static void pqueue_fill(pqueue_t *q, size_t pos, pqueue_el_t el)
+{
+	if (pos > 0 && el.priority > q->elems[(pos - 1) / PQUEUE_ARITY].priority)
+		pqueue_sift_up(q, pos, el);
+	else
+		pqueue_sift_down(q, pos, el);
 }
 
 pqueue_t *new_pqueue(void)
 {
 	pqueue_t *res = XMALLOC(pqueue_t);
-	res->elems = NEW_ARR_F(pqueue_el_t, 0);
+	res->elems       = NEW_ARR_F(pqueue_el_t, 0);
+	res->positions   = NEW_ARR_F(size_t, 0);
+	res->free_handle = PQUEUE_NO_HANDLE;
 	return res;
 }
 
 void del_pqueue(pqueue_t *q)
 {
+	DEL_ARR_F(q->positions);
 	DEL_ARR_F(q->elems);
 	free(q);
 }
 
+static void pqueue_push(pqueue_t *q, pqueue_el_t el)
+{
+	size_t pos = ARR_LEN(q->elems);
+	ARR_APP1(pqueue_el_t, q->elems, el);
+	pqueue_sift_up(q, pos, el);
+}
+
 void pqueue_put(pqueue_t *q, void *data, int priority)
 {
 	pqueue_el_t el = {
-		.data = data,
-		.priority = priority
+		.priority = priority,
+		.data     = data,
+		.handle   = PQUEUE_NO_HANDLE,
 	};
-	ARR_APP1(pqueue_el_t, q->elems, el);
+	pqueue_push(q, el);
+}
+
+pqueue_handle_t pqueue_insert(pqueue_t *q, void *data, double priority)
+{
+	pqueue_handle_t handle = q->free_handle;
+	if (handle != PQUEUE_NO_HANDLE) {
+		q->free_handle = q->positions[handle];
+	} else {
+		handle = ARR_LEN(q->positions);
+		ARR_APP1(size_t, q->positions, 0);
+	}
 
-	pqueue_sift_up(q, ARR_LEN(q->elems) - 1);
+	pqueue_el_t el = {
+		.priority = priority,
+		.data     = data,
+		.handle   = handle,
+	};
+	pqueue_push(q, el);
+	return handle;
+}
+
+void pqueue_set_priority(pqueue_t *q, pqueue_handle_t handle, double priority)
+{
+	size_t      pos = q->positions[handle];
+	pqueue_el_t el  = q->elems[pos];
+	assert(el.handle == handle);
+	el.priority = priority;
+	pqueue_fill(q, pos, el);
+}
+
+double pqueue_get_priority(pqueue_t const *q, pqueue_handle_t handle)
+{
+	size_t pos = q->positions[handle];
+	assert(q->elems[pos].handle == handle);
+	return q->elems[pos].priority;
+}
+
+/**
+ * Removes the element at heap position @p pos and returns its data.
+ */
+static void *pqueue_remove_at(pqueue_t *q, size_t pos)
+{
+	pqueue_el_t el   = q->elems[pos];
+	size_t      len  = ARR_LEN(q->elems) - 1;
+	pqueue_el_t last = q->elems[len];
+	ARR_SHRINKLEN(q->elems, len);
+	if (pos == 0 && len > 0)
+		pqueue_sift_down_to_leaf(q, 0, last);
+	else if (pos != len)
+		pqueue_fill(q, pos, last);
+
+	if (el.handle != PQUEUE_NO_HANDLE) {
+		q->positions[el.handle] = q->free_handle;
+		q->free_handle          = el.handle;
+	}
+	return el.data;
+}
+
+void *pqueue_remove(pqueue_t *q, pqueue_handle_t handle)
+{
+	size_t pos = q->positions[handle];
+	assert(q->elems[pos].handle == handle);
+	return pqueue_remove_at(q, pos);
+}
+
+void *pqueue_front(pqueue_t const *q)
+{
+	if (ARR_LEN(q->elems) == 0)
+		panic("attempt to retrieve element from empty priority queue");
+	return q->elems[0].data;
 }
 
 void *pqueue_pop_front(pqueue_t *q)
 {
-	switch (ARR_LEN(q->elems)) {
-	case 0:
+	if (ARR_LEN(q->elems) == 0)
 		panic("attempt to retrieve element from empty priority queue");
-	case 1:
-		ARR_SHRINKLEN(q->elems, 0);
-		return q->elems[0].data;
-	default: {
-		void   *data = q->elems[0].data;
-		size_t len   = ARR_LEN(q->elems) - 1;
-
-		q->elems[0] = q->elems[len];
-		ARR_SHRINKLEN(q->elems, len);
-		pqueue_heapify(q, 0);
-		return data;
-	}
-	}
+	return pqueue_remove_at(q, 0);
 }
 
 size_t pqueue_length(pqueue_t const *q)
@@ -0,0 +1,81 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2016 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Bulk operations on large raw bitsets.
+ *
+ * The kernels process two elements at a time as one 64-bit word. Without
+ * hardware support a popcount is a library call per element, so on x86 a
+ * variant using the popcnt instruction is selected at runtime if the cpu
+ * has it when the library is initialized. Otherwise, and before
+ * ir_init_library(), a branch-free bit counting fallback is used.
+ */
+#include "raw_bitset.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RBITSET_HAVE_POPCNT
+#endif
+
+typedef unsigned (rbitset_count_func)(const unsigned *bitset, size_t n_elems);
+
+static inline uint64_t load64(const unsigned *p)
+{
+	uint64_t res;
+	memcpy(&res, p, sizeof(res));
+	return res;
+}
+
+static inline unsigned popcount64_swar(uint64_t x)
+{
+	x -= (x >> 1) & 0x5555555555555555ULL;
+	x  = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+	x  = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+	return (x * 0x0101010101010101ULL) >> 56;
+}
+
+#define RBITSET_COUNT_BODY(count64) \
+	do { \
+		unsigned res = 0; \
+		size_t   i   = 0; \
+		for (; i + 2 <= n_elems; i += 2) \
+			res += count64(load64(&bitset[i])); \
+		if (i < n_elems) \
+			res += count64(bitset[i]); \
+		return res; \
+	} while (0)
+
+static unsigned count_generic(const unsigned *bitset, size_t n_elems)
+{
+	RBITSET_COUNT_BODY(popcount64_swar);
+}
+
+#ifdef RBITSET_HAVE_POPCNT
+__attribute__((target("popcnt")))
+static unsigned count_popcnt(const unsigned *bitset, size_t n_elems)
+{
+	RBITSET_COUNT_BODY(__builtin_popcountll);
+}
+#endif
+
+/** The kernel, only changed by init_rbitset() before any thread starts. */
+static rbitset_count_func *count_func = count_generic;
+
+void init_rbitset(void)
+{
+#ifdef RBITSET_HAVE_POPCNT
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("popcnt"))
+		count_func = count_popcnt;
+#endif
+}
+
+unsigned rbitset_popcount_bulk_(const unsigned *bitset, size_t n_elems)
+{
+	return count_func(bitset, n_elems);
+}
@@ -201,6 +201,18 @@ static inline bool rbitset_is_set(const unsigned *bitset, size_t pos)
 	return (BITSET_ELEM(bitset, pos) & (1u << (pos % BITS_PER_ELEM))) != 0;
 }
 
+/**
+ * Bitsets with at least this many elements are counted by the out of line
+ * bulk kernels, which select an implementation depending on the cpu.
+ */
+#define RBITSET_BULK_ELEMS 8
+
+/* internal helpers: bulk kernels for large bitsets, see raw_bitset.c */
+unsigned rbitset_popcount_bulk_(const unsigned *bitset, size_t n_elems);
+
+/** Selects the bulk kernels for the cpu, called by ir_init_library(). */
+void init_rbitset(void);
+
 /**
  * Calculate the number of set bits (number of elements).
  *
@@ -209,8 +221,12 @@ static inline bool rbitset_is_set(const unsigned *bitset, size_t pos)
  */
 static inline unsigned rbitset_popcount(const unsigned *bitset, size_t size)
 {
+	size_t n = BITSET_SIZE_ELEMS(size);
+	if (n >= RBITSET_BULK_ELEMS)
+		return rbitset_popcount_bulk_(bitset, n);
+
 	unsigned res = 0;
-	for (size_t i = 0, n = BITSET_SIZE_ELEMS(size); i < n; ++i) {
+	for (size_t i = 0; i < n; ++i) {
 		res += popcount(bitset[i]);
 	}
 	return res;
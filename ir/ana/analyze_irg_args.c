@@ -13,6 +13,7 @@
 #include "array.h"
 #include "cgana.h"
 #include "entity_t.h"
+#include "irgraph_t.h"
 #include "irmode_t.h"
 #include "irnode_t.h"
 #include "irouts_t.h"
@@ -20,15 +21,113 @@
 #include "util.h"
 #include <stdlib.h>
 
+/**
+ * Drops the parameter access of a method and of all methods whose parameter
+ * access was computed from it.
+ *
+ * @param ent  The entity that represent this method.
+ */
+static void drop_param_access(ir_entity *ent)
+{
+	method_ent_attr *attr = &ent->attr.mtd_attr;
+	if (attr->param_access) {
+		DEL_ARR_F(attr->param_access);
+		attr->param_access = NULL;
+	}
+
+	ir_entity **callees = attr->param_access_callees;
+	if (callees) {
+		attr->param_access_callees = NULL;
+		for (size_t i = ARR_LEN(callees); i-- > 0; ) {
+			ir_entity **callers = callees[i]->attr.mtd_attr.param_access_callers;
+			if (!callers)
+				continue;
+			for (size_t j = ARR_LEN(callers); j-- > 0; ) {
+				if (callers[j] == ent) {
+					callers[j] = callers[ARR_LEN(callers) - 1];
+					ARR_SHRINKLEN(callers, ARR_LEN(callers) - 1);
+					break;
+				}
+			}
+		}
+		DEL_ARR_F(callees);
+	}
+
+	/* detach the list first, cyclic call chains lead back here */
+	ir_entity **callers = attr->param_access_callers;
+	if (callers) {
+		attr->param_access_callers = NULL;
+		for (size_t i = ARR_LEN(callers); i-- > 0; )
+			drop_param_access(callers[i]);
+		DEL_ARR_F(callers);
+	}
+}
+
+/**
+ * Remembers that the parameter access of @p caller was computed from the one
+ * of @p callee.
+ */
+static void add_param_access_dep(ir_entity *caller, ir_entity *callee)
+{
+	if (caller == callee)
+		return;
+
+	ir_entity **callees = caller->attr.mtd_attr.param_access_callees;
+	if (callees) {
+		for (size_t i = ARR_LEN(callees); i-- > 0; ) {
+			if (callees[i] == callee)
+				return;
+		}
+	} else {
+		callees = NEW_ARR_F(ir_entity*, 0);
+	}
+	ARR_APP1(ir_entity*, callees, callee);
+	caller->attr.mtd_attr.param_access_callees = callees;
+
+	ir_entity **callers = callee->attr.mtd_attr.param_access_callers;
+	if (!callers)
+		callers = NEW_ARR_F(ir_entity*, 0);
+	ARR_APP1(ir_entity*, callers, caller);
+	callee->attr.mtd_attr.param_access_callers = callers;
+}
+
+void free_param_summary(ir_entity *ent)
+{
+	drop_param_access(ent);
+	if (ent->attr.mtd_attr.param_weight) {
+		DEL_ARR_F(ent->attr.mtd_attr.param_weight);
+		ent->attr.mtd_attr.param_weight = NULL;
+	}
+}
+
+/**
+ * Drops the parameter summaries of a method if its graph changed since they
+ * were computed.
+ *
+ * @param ent  The entity that represent this method.
+ */
+static void check_param_summary(ir_entity *ent)
+{
+	ir_graph *irg = get_entity_irg(ent);
+	if (irg == NULL
+	    || irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_PARAM_SUMMARY))
+		return;
+
+	free_param_summary(ent);
+	add_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_PARAM_SUMMARY);
+}
+
 /**
  * Walk recursive the successors of a graph argument
  * with mode reference and mark if it will be read,
  * written or stored.
  *
+ * @param ent   The entity of the analyzed method.
  * @param arg   The graph argument with mode reference,
  *             that must be checked.
  */
-static ptr_access_kind analyze_arg(ir_node *arg, ptr_access_kind bits)
+static ptr_access_kind analyze_arg(ir_entity *ent, ir_node *arg,
+                                   ptr_access_kind bits)
 {
 	/* We must visit a node once to avoid endless recursion.*/
 	mark_irn_visited(arg);
@@ -63,6 +162,7 @@ static ptr_access_kind analyze_arg(ir_node *arg, ptr_access_kind bits)
 						if (get_Call_param(succ, p) == arg) {
 							/* an arg can be used more than once ! */
 							bits |= get_method_param_access(callee, p);
+							add_param_access_dep(ent, callee);
 						}
 					}
 				} else if (is_Member(ptr) && get_irp_callee_info_state() == irg_callee_info_consistent) {
@@ -83,6 +183,7 @@ static ptr_access_kind analyze_arg(ir_node *arg, ptr_access_kind bits)
 							if (get_Call_param(succ, p) == arg) {
 								/* an arg can be used more than once ! */
 								bits |= get_method_param_access(meth_ent, p);
+								add_param_access_dep(ent, meth_ent);
 							}
 						}
 					}
@@ -138,7 +239,7 @@ static ptr_access_kind analyze_arg(ir_node *arg, ptr_access_kind bits)
 			continue;
 
 		/* follow further the address calculation */
-		bits = analyze_arg(succ, bits);
+		bits = analyze_arg(ent, succ, bits);
 	}
 	return bits;
 }
@@ -175,6 +276,7 @@ static void analyze_ent_args(ir_entity *ent)
 	}
 
 	assure_irg_outs(irg);
+	inc_irg_visited(irg);
 	ir_node *irg_args = get_irg_args(irg);
 
 	/* A array to save the information for each argument with
@@ -192,7 +294,7 @@ static void analyze_ent_args(ir_entity *ent)
 		unsigned proj_nr  = get_Proj_num(arg);
 
 		if (mode_is_reference(arg_mode))
-			rw_info[proj_nr] |= analyze_arg(arg, rw_info[proj_nr]);
+			rw_info[proj_nr] |= analyze_arg(ent, arg, rw_info[proj_nr]);
 	}
 
 	/* copy the temporary info */
@@ -208,6 +310,7 @@ void analyze_irg_args(ir_graph *irg)
 	if (entity == NULL)
 		return;
 
+	check_param_summary(entity);
 	if (!entity->attr.mtd_attr.param_access)
 		analyze_ent_args(entity);
 }
@@ -219,6 +322,7 @@ ptr_access_kind get_method_param_access(ir_entity *ent, size_t pos)
 	assert(is_method_variadic(mtp) || pos < get_method_n_params(mtp));
 #endif
 
+	check_param_summary(ent);
 	if (ent->attr.mtd_attr.param_access) {
 		if (pos < ARR_LEN(ent->attr.mtd_attr.param_access))
 			return ent->attr.mtd_attr.param_access[pos];
@@ -368,6 +472,7 @@ static void analyze_method_params_weight(ir_entity *ent)
 
 	/* Call algorithm that computes the out edges */
 	assure_irg_outs(irg);
+	inc_irg_visited(irg);
 
 	ir_node *irg_args = get_irg_args(irg);
 	foreach_irn_out_r(irg_args, i, arg) {
@@ -378,6 +483,7 @@ static void analyze_method_params_weight(ir_entity *ent)
 
 unsigned get_method_param_weight(ir_entity *ent, size_t pos)
 {
+	check_param_summary(ent);
 	if (!ent->attr.mtd_attr.param_weight)
 		analyze_method_params_weight(ent);
 
@@ -394,11 +500,11 @@ void analyze_irg_args_weight(ir_graph *irg)
 		return;
 
 	assert(is_method_entity(entity));
+	check_param_summary(entity);
 	if (entity->attr.mtd_attr.param_weight != NULL)
 		return;
 
 	ir_reserve_resources(irg, IR_RESOURCE_IRN_VISITED);
-	inc_irg_visited(irg);
 	analyze_method_params_weight(entity);
 	ir_free_resources(irg, IR_RESOURCE_IRN_VISITED);
 }
@@ -107,7 +107,7 @@
  * A - B = A + -B = (Amin (-B)min, Amax + (-B)max) = (Amin - Bmax, Amax - Bmin)
  */
 
-DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+DEBUG_ONLY(static FIRM_THREAD_LOCAL firm_dbg_module_t *dbg;)
 
 static bool is_undefined(bitinfo const *const b)
 {
@@ -204,7 +204,9 @@ static bitinfo *get_bitinfo_recursive(ir_node const *const irn)
 	return b;
 }
 
-static bitinfo *(*get_bitinfo_func)(ir_node const*) = &get_bitinfo_null;
+/** Per thread, as it follows the analysis of the graph the thread works on. */
+static FIRM_THREAD_LOCAL bitinfo *(*get_bitinfo_func)(ir_node const*)
+	= &get_bitinfo_null;
 
 bitinfo *get_bitinfo(ir_node const *const irn)
 {
@@ -29,7 +29,9 @@
 
 #include "dfs_t.h"
 #include "gaussjordan.h"
+#include "gaussseidel.h"
 #include "hashptr.h"
+#include "irdom.h"
 #include "iredges_t.h"
 #include "irgraph_t.h"
 #include "irgwalk.h"
@@ -53,6 +55,13 @@
 
 #define MAX_INT_FREQ 1000000
 
+/** Graphs with more blocks than this use a sparse solver. */
+#define SPARSE_SOLVER_THRESHOLD 512
+/** Relative change at which the sparse solver considers itself converged. */
+#define SPARSE_EPSILON          1e-9
+/** Give up (and use the loop weight fallback) after this many sweeps. */
+#define SPARSE_MAX_ITERATIONS   10000
+
 static hook_entry_t hook;
 
 typedef struct {
@@ -390,22 +399,17 @@ static double mat_dot_vec_entry(square_matrix *mat, double *vec, int row)
 	return acc;
 }
 
-void ir_estimate_execfreq(ir_graph *irg)
+/**
+ * Computes the execution frequencies with a dense linear equation system.
+ * Blocks that are not the target of a backedge are eliminated by simple
+ * substitution; the remaining system is solved with a QR decomposition.
+ * This needs O(n^2) memory and O(n^3) time in the number of blocks.
+ *
+ * @return false if no valid frequencies could be computed
+ */
+static bool estimate_execfreq_dense(ir_graph *irg, dfs_t const *dfs,
+                                    double inv_loop_weight)
 {
-	double loop_weight = 10.0;
-
-	assure_irg_properties(irg,
-		IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
-		| IR_GRAPH_PROPERTY_NO_BADS
-		| IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO
-		| IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE);
-
-	/* compute a DFS.
-	 * using a toposort on the CFG (without back edges) will propagate
-	 * the values better for the gauss/seidel iteration.
-	 * => they can "flow" from start to end. */
-	dfs_t *const dfs = dfs_new(irg);
-
 	unsigned       size   = dfs_get_n_nodes(dfs);
 	square_matrix *in_fac = mat_create(size);
 	for (unsigned r = 0; r < size; r++) {
@@ -414,32 +418,10 @@ void ir_estimate_execfreq(ir_graph *irg)
 		}
 	}
 
-
 	ir_node *const start_block = get_irg_start_block(irg);
 	ir_node *const end_block   = get_irg_end_block(irg);
 	const int      end_idx     = size - dfs_get_post_num(dfs, end_block) - 1;
 
-	ir_reserve_resources(irg, IR_RESOURCE_BLOCK_VISITED
-	                          | IR_RESOURCE_IRN_VISITED
-	                          | IR_RESOURCE_IRN_LINK);
-	inc_irg_block_visited(irg);
-
-	/* mark all blocks reachable from end_block as (block)visited
-	 * (so we can detect places like endless-loops/noreturn calls which
-	 *  do not reach the End block) */
-	block_walk_no_keeps(end_block);
-	/* mark all kept blocks as (node)visited */
-	inc_irg_visited(irg);
-	const ir_node *end          = get_irg_end(irg);
-	int const      n_keepalives = get_End_n_keepalives(end);
-	for (int k = n_keepalives - 1; k >= 0; --k) {
-		ir_node *keep = get_End_keepalive(end, k);
-		if (is_Block(keep)) {
-			mark_irn_visited(keep);
-		}
-	}
-
-	double const inv_loop_weight = 1.0 / loop_weight;
 	/* lgs_to_mat[i] is the index of the block represented by the
 	 * i-th row/column in the LGS matrix. */
 	int *lgs_to_mat = NEW_ARR_F(int, 0);
@@ -480,6 +462,8 @@ void ir_estimate_execfreq(ir_graph *irg)
 
 	/* add artifical edges from "kept blocks without a path to end"
 	 * to end */
+	const ir_node *end          = get_irg_end(irg);
+	int const      n_keepalives = get_End_n_keepalives(end);
 	for (unsigned k = n_keepalives; k-- > 0; ) {
 		ir_node *keep = get_End_keepalive(end, k);
 		if (!is_Block(keep) || has_path_to_end(keep))
@@ -582,6 +566,374 @@ void ir_estimate_execfreq(ir_graph *irg)
 	}
 
 	DEL_ARR_F(freqs);
+	DEL_ARR_F(lgs_to_mat);
+	DEL_ARR_F(mat_to_lgs);
+	free(in_fac);
+	free(lgs_matrix);
+	DEL_ARR_F(lgs_x);
+	return valid_freq;
+}
+
+/**
+ * Adds val to the entry (row, col) of the sparse matrix m.
+ */
+static void gs_matrix_add(gs_matrix_t *m, unsigned row, unsigned col,
+                          double val)
+{
+	gs_matrix_set(m, row, col, gs_matrix_get(m, row, col) + val);
+}
+
+/**
+ * Computes the execution frequencies with a sparse Gauss-Seidel iteration.
+ * This is used for irreducible graphs, where estimate_execfreq_loops() is
+ * not applicable. Unlike estimate_execfreq_dense() the start block is not connected to the
+ * end block, but gets a fixed frequency of 1.0 as right hand side. This
+ * makes the system regular, so every loop converges independently instead of
+ * the whole graph being rescaled one sweep at a time. Rows are numbered in
+ * reverse postorder, so frequencies flow from the start to the end block in
+ * a single sweep. Each sweep needs O(n + e) time and the matrix O(n + e)
+ * memory.
+ *
+ * @return false if no valid frequencies could be computed
+ */
+static bool estimate_execfreq_sparse(ir_graph *irg, dfs_t const *dfs,
+                                     double inv_loop_weight)
+{
+	unsigned     const size   = dfs_get_n_nodes(dfs);
+	gs_matrix_t *const matrix = gs_new_matrix(size, 4);
+	double      *const rhs    = NEW_ARR_FZ(double, size);
+
+	ir_node *const start_block = get_irg_start_block(irg);
+	ir_node *const end_block   = get_irg_end_block(irg);
+	unsigned const end_idx     = size - dfs_get_post_num(dfs, end_block) - 1;
+
+	/* x[b] = sum of (cf_probability * x[pred]) is -x[b] + sum(...) = 0. */
+	for (unsigned idx = 0; idx < size; ++idx) {
+		ir_node const *const bb = dfs_get_post_num_node(dfs, size-idx-1);
+		gs_matrix_set(matrix, idx, idx, -1.0);
+		if (bb == start_block) {
+			rhs[idx] = -1.0;
+			continue;
+		}
+
+		for (int i = get_Block_n_cfgpreds(bb) - 1; i >= 0; --i) {
+			ir_node *const pred = get_Block_cfgpred_block(bb, i);
+			if (pred == NULL)
+				continue;
+			unsigned const pred_idx       = size - dfs_get_post_num(dfs, pred) - 1;
+			double   const cf_probability = get_cf_probability(bb, i, inv_loop_weight);
+			gs_matrix_add(matrix, idx, pred_idx, cf_probability);
+		}
+	}
+
+	/* add artifical edges from "kept blocks without a path to end"
+	 * to end */
+	const ir_node *end          = get_irg_end(irg);
+	int const      n_keepalives = get_End_n_keepalives(end);
+	for (unsigned k = n_keepalives; k-- > 0; ) {
+		ir_node *keep = get_End_keepalive(end, k);
+		if (!is_Block(keep) || has_path_to_end(keep))
+			continue;
+
+		double   sum      = get_sum_succ_factors(keep, inv_loop_weight);
+		unsigned keep_idx = size - dfs_get_post_num(dfs, keep) - 1;
+		gs_matrix_add(matrix, end_idx, keep_idx, KEEP_FAC/sum);
+	}
+
+	double *const x = NEW_ARR_FZ(double, size);
+	bool converged = false;
+	for (unsigned iter = 0; iter < SPARSE_MAX_ITERATIONS; ++iter) {
+		double const change = gs_matrix_gauss_seidel_rhs(matrix, x, rhs);
+		double       norm   = 0.0;
+		for (unsigned idx = 0; idx < size; ++idx) {
+			norm += fabs(x[idx]);
+		}
+		if (isinf(norm) || isnan(norm))
+			break;
+		if (change <= SPARSE_EPSILON * norm) {
+			converged = true;
+			break;
+		}
+	}
+	gs_delete_matrix(matrix);
+	DEL_ARR_F(rhs);
+
+	/* normalize, so that the end block has frequency 1.0 */
+	double const end_freq   = x[end_idx];
+	double const norm       = end_freq != 0.0 ? 1.0 / end_freq : 1.0;
+	bool         valid_freq = converged;
+	for (unsigned idx = 0; valid_freq && idx < size; ++idx) {
+		double const freq = x[idx] * norm;
+		/* Check for inf, nan and negative values. */
+		if (isinf(freq) || !(freq >= 0)) {
+			valid_freq = false;
+			break;
+		}
+		set_block_execfreq(dfs_get_post_num_node(dfs, size - idx - 1), freq);
+	}
+
+	DEL_ARR_F(x);
+	return valid_freq;
+}
+
+static int cmp_unsigned(const void *a, const void *b)
+{
+	unsigned const ua = *(const unsigned*)a;
+	unsigned const ub = *(const unsigned*)b;
+	return ua < ub ? -1 : ua > ub;
+}
+
+/**
+ * Determines the loop headers, i.e. the targets of backedges.
+ * In reverse postorder an edge is a backedge iff it does not lead to a block
+ * with a greater number. The graph is reducible iff the targets of all
+ * backedges dominate their sources.
+ *
+ * @return a flexible array telling for every reverse postorder number
+ *         whether the block is a loop header, or NULL if the graph is
+ *         irreducible
+ */
+static bool *find_loop_headers(dfs_t const *dfs)
+{
+	unsigned const size      = dfs_get_n_nodes(dfs);
+	bool    *const is_header = NEW_ARR_FZ(bool, size);
+	for (unsigned idx = 0; idx < size; ++idx) {
+		ir_node *const bb = dfs_get_post_num_node(dfs, size - idx - 1);
+		for (int i = get_Block_n_cfgpreds(bb); i-- > 0; ) {
+			ir_node *const pred = get_Block_cfgpred_block(bb, i);
+			if (pred == NULL)
+				continue;
+			unsigned const pred_idx = size - dfs_get_post_num(dfs, pred) - 1;
+			if (pred_idx < idx)
+				continue;
+			if (!block_dominates(bb, pred)) {
+				DEL_ARR_F(is_header);
+				return NULL;
+			}
+			is_header[idx] = true;
+		}
+	}
+	return is_header;
+}
+
+/**
+ * Computes the execution frequencies of a reducible graph by propagating
+ * them along the loop structure (Wu and Larus: Static branch frequency and
+ * program profile analysis). Loops are handled innermost first: the header
+ * gets frequency 1 and the body is evaluated in reverse postorder to
+ * determine the cyclic probability, i.e. the probability to return to the
+ * header through one of its backedges. A header then executes
+ * 1/(1 - cyclic probability) times per entry, which turns the whole graph
+ * into an acyclic propagation.
+ *
+ * This gives the same result as estimate_execfreq_dense() and needs
+ * O(n * loop depth) time.
+ *
+ * @return false if no valid frequencies could be computed
+ */
+static bool estimate_execfreq_loops(ir_graph *irg, dfs_t const *dfs,
+                                    bool const *is_header,
+                                    double inv_loop_weight)
+{
+	unsigned const size        = dfs_get_n_nodes(dfs);
+	ir_node *const start_block = get_irg_start_block(irg);
+	unsigned const start_idx   = size - dfs_get_post_num(dfs, start_block) - 1;
+	ir_node *const end_block   = get_irg_end_block(irg);
+	unsigned const end_idx     = size - dfs_get_post_num(dfs, end_block) - 1;
+
+	double   *const cyclic = NEW_ARR_FZ(double, size);
+	double   *const freq   = NEW_ARR_FZ(double, size);
+	unsigned *const mark   = NEW_ARR_FZ(unsigned, size);
+	unsigned       *body   = NEW_ARR_F(unsigned, 0);
+	unsigned       *stack  = NEW_ARR_F(unsigned, 0);
+
+	/* Inner loop headers come after their outer loop header in reverse
+	 * postorder, so walking backwards handles inner loops first. */
+	for (unsigned h = size; h-- > 0; ) {
+		if (!is_header[h])
+			continue;
+		ir_node *const header = dfs_get_post_num_node(dfs, size - h - 1);
+
+		/* collect the natural loop by walking backwards from the backedge
+		 * sources until the header is reached */
+		ARR_SHRINKLEN(body, 0);
+		mark[h] = h + 1;
+		for (int i = get_Block_n_cfgpreds(header); i-- > 0; ) {
+			ir_node *const pred = get_Block_cfgpred_block(header, i);
+			if (pred == NULL)
+				continue;
+			unsigned const pred_idx = size - dfs_get_post_num(dfs, pred) - 1;
+			if (pred_idx >= h && mark[pred_idx] != h + 1) {
+				mark[pred_idx] = h + 1;
+				ARR_APP1(unsigned, stack, pred_idx);
+			}
+		}
+		while (ARR_LEN(stack) > 0) {
+			unsigned const idx = stack[ARR_LEN(stack) - 1];
+			ARR_SHRINKLEN(stack, ARR_LEN(stack) - 1);
+			ARR_APP1(unsigned, body, idx);
+
+			ir_node *const bb = dfs_get_post_num_node(dfs, size - idx - 1);
+			for (int i = get_Block_n_cfgpreds(bb); i-- > 0; ) {
+				ir_node *const pred = get_Block_cfgpred_block(bb, i);
+				if (pred == NULL)
+					continue;
+				unsigned const pred_idx = size - dfs_get_post_num(dfs, pred) - 1;
+				if (mark[pred_idx] != h + 1) {
+					mark[pred_idx] = h + 1;
+					ARR_APP1(unsigned, stack, pred_idx);
+				}
+			}
+		}
+		qsort(body, ARR_LEN(body), sizeof(*body), cmp_unsigned);
+
+		/* propagate a frequency of 1 from the header through the body */
+		freq[h] = 1.0;
+		for (size_t b = 0, n = ARR_LEN(body); b < n; ++b) {
+			unsigned const idx = body[b];
+			ir_node *const bb  = dfs_get_post_num_node(dfs, size - idx - 1);
+			double         sum = 0.0;
+			for (int i = get_Block_n_cfgpreds(bb); i-- > 0; ) {
+				ir_node *const pred = get_Block_cfgpred_block(bb, i);
+				if (pred == NULL)
+					continue;
+				unsigned const pred_idx = size - dfs_get_post_num(dfs, pred) - 1;
+				if (pred_idx >= idx || mark[pred_idx] != h + 1)
+					continue;
+				sum += freq[pred_idx] * get_cf_probability(bb, i, inv_loop_weight);
+			}
+			freq[idx] = is_header[idx] ? sum / (1.0 - cyclic[idx]) : sum;
+		}
+
+		double back_prob = 0.0;
+		for (int i = get_Block_n_cfgpreds(header); i-- > 0; ) {
+			ir_node *const pred = get_Block_cfgpred_block(header, i);
+			if (pred == NULL)
+				continue;
+			unsigned const pred_idx = size - dfs_get_post_num(dfs, pred) - 1;
+			if (pred_idx >= h)
+				back_prob += freq[pred_idx] * get_cf_probability(header, i, inv_loop_weight);
+		}
+		/* endless loops only leave through the artificial keep edge */
+		cyclic[h] = MIN(back_prob, 1.0 - EPSILON);
+	}
+
+	/* now the whole graph is acyclic */
+	for (unsigned idx = 0; idx < size; ++idx) {
+		if (idx == end_idx)
+			continue;
+		ir_node *const bb  = dfs_get_post_num_node(dfs, size - idx - 1);
+		double         sum = idx == start_idx ? 1.0 : 0.0;
+		for (int i = get_Block_n_cfgpreds(bb); i-- > 0; ) {
+			ir_node *const pred = get_Block_cfgpred_block(bb, i);
+			if (pred == NULL)
+				continue;
+			unsigned const pred_idx = size - dfs_get_post_num(dfs, pred) - 1;
+			if (pred_idx >= idx)
+				continue;
+			sum += freq[pred_idx] * get_cf_probability(bb, i, inv_loop_weight);
+		}
+		freq[idx] = is_header[idx] ? sum / (1.0 - cyclic[idx]) : sum;
+	}
+
+	/* handle end block, including the artifical edges from "kept blocks
+	 * without a path to end" */
+	double end_freq = 0.0;
+	for (int i = get_Block_n_cfgpreds(end_block); i-- > 0; ) {
+		ir_node *const pred = get_Block_cfgpred_block(end_block, i);
+		if (pred == NULL)
+			continue;
+		unsigned const pred_idx = size - dfs_get_post_num(dfs, pred) - 1;
+		end_freq += freq[pred_idx] * get_cf_probability(end_block, i, inv_loop_weight);
+	}
+	const ir_node *end          = get_irg_end(irg);
+	int const      n_keepalives = get_End_n_keepalives(end);
+	for (unsigned k = n_keepalives; k-- > 0; ) {
+		ir_node *keep = get_End_keepalive(end, k);
+		if (!is_Block(keep) || has_path_to_end(keep))
+			continue;
+
+		double   sum      = get_sum_succ_factors(keep, inv_loop_weight);
+		unsigned keep_idx = size - dfs_get_post_num(dfs, keep) - 1;
+		end_freq += freq[keep_idx] * KEEP_FAC/sum;
+	}
+	freq[end_idx] = end_freq;
+
+	/* normalize, so that the end block has frequency 1.0 */
+	double const norm       = end_freq != 0.0 ? 1.0 / end_freq : 1.0;
+	bool         valid_freq = true;
+	for (unsigned idx = 0; idx < size; ++idx) {
+		double const f = freq[idx] * norm;
+		/* Check for inf, nan and negative values. */
+		if (isinf(f) || !(f >= 0)) {
+			valid_freq = false;
+			break;
+		}
+		set_block_execfreq(dfs_get_post_num_node(dfs, size - idx - 1), f);
+	}
+
+	DEL_ARR_F(stack);
+	DEL_ARR_F(body);
+	DEL_ARR_F(mark);
+	DEL_ARR_F(freq);
+	DEL_ARR_F(cyclic);
+	return valid_freq;
+}
+
+void ir_estimate_execfreq(ir_graph *irg)
+{
+	double loop_weight = 10.0;
+
+	assure_irg_properties(irg,
+		IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
+		| IR_GRAPH_PROPERTY_NO_BADS
+		| IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO
+		| IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE);
+
+	/* compute a DFS.
+	 * using a toposort on the CFG (without back edges) will propagate
+	 * the values better for the gauss/seidel iteration.
+	 * => they can "flow" from start to end. */
+	dfs_t *const dfs = dfs_new(irg);
+
+	unsigned size = dfs_get_n_nodes(dfs);
+	if (size > SPARSE_SOLVER_THRESHOLD)
+		assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+
+	ir_reserve_resources(irg, IR_RESOURCE_BLOCK_VISITED
+	                          | IR_RESOURCE_IRN_VISITED
+	                          | IR_RESOURCE_IRN_LINK);
+	inc_irg_block_visited(irg);
+
+	/* mark all blocks reachable from end_block as (block)visited
+	 * (so we can detect places like endless-loops/noreturn calls which
+	 *  do not reach the End block) */
+	block_walk_no_keeps(get_irg_end_block(irg));
+	/* mark all kept blocks as (node)visited */
+	inc_irg_visited(irg);
+	const ir_node *end          = get_irg_end(irg);
+	int const      n_keepalives = get_End_n_keepalives(end);
+	for (int k = n_keepalives - 1; k >= 0; --k) {
+		ir_node *keep = get_End_keepalive(end, k);
+		if (is_Block(keep)) {
+			mark_irn_visited(keep);
+		}
+	}
+
+	double const inv_loop_weight = 1.0 / loop_weight;
+	bool         valid_freq;
+	if (size > SPARSE_SOLVER_THRESHOLD) {
+		bool *const is_header = find_loop_headers(dfs);
+		if (is_header != NULL) {
+			valid_freq = estimate_execfreq_loops(irg, dfs, is_header,
+			                                     inv_loop_weight);
+			DEL_ARR_F(is_header);
+		} else {
+			valid_freq = estimate_execfreq_sparse(irg, dfs, inv_loop_weight);
+		}
+	} else {
+		valid_freq = estimate_execfreq_dense(irg, dfs, inv_loop_weight);
+	}
 
 	/* Fallback solution: Use loop weight. */
 	if (!valid_freq) {
@@ -619,9 +971,5 @@ void ir_estimate_execfreq(ir_graph *irg)
 	                       | IR_RESOURCE_IRN_LINK);
 
 	dfs_free(dfs);
-	DEL_ARR_F(lgs_to_mat);
-	DEL_ARR_F(mat_to_lgs);
-	free(in_fac);
-	free(lgs_matrix);
-	DEL_ARR_F(lgs_x);
+	add_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_EXECFREQ);
 }
@@ -16,16 +16,37 @@
 #include "irgwalk.h"
 #include "irnodemap.h"
 #include "list.h"
+#include "pmap.h"
+#include "raw_bitset.h"
 #include "util.h"
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+/** Blocks with more nodes than this get no reachability index. */
+#define REACH_INDEX_MAX_NODES 4096
+/** Number of searches in a block before its reachability index is built. */
+#define REACH_INDEX_MIN_QUERIES 4
+
+/**
+ * Transitive reachability inside a block. The nodes are numbered in
+ * postorder, so a node can only reach nodes with a smaller number and row i
+ * of the (lower triangular) bit matrix only needs i+1 bits.
+ */
+typedef struct {
+	unsigned        n_queries; /**< searches since the last build attempt */
+	unsigned        n_nodes;
+	const ir_node **nodes;   /**< the nodes by their number, NULL if not built */
+	pmap           *numbers; /**< node -> number + 1 */
+	unsigned      **rows;    /**< the nodes reachable from each node */
+} reach_index_t;
+
 struct ir_heights_t {
 	ir_nodemap      data;
 	unsigned        visited;
 	hook_entry_t   *dump_handle;
 	struct obstack  obst;
+	pmap           *reach;   /**< block -> reach_index_t, NULL if disabled */
 };
 
 typedef struct {
@@ -99,6 +120,123 @@ static bool search(ir_heights_t *h, const ir_node *curr, const ir_node *tgt)
 	return false;
 }
 
+static void free_reach_index(reach_index_t *index)
+{
+	if (index->n_nodes > 0)
+		free(index->rows[0]);
+	if (index->numbers != NULL)
+		pmap_destroy(index->numbers);
+	free(index->nodes);
+	free(index->rows);
+	free(index);
+}
+
+static unsigned get_reach_number(const reach_index_t *index,
+                                 const ir_node *irn)
+{
+	/* numbers are stored off by one to tell them apart from missing nodes */
+	return PTR_TO_INT(pmap_get(void, index->numbers, irn)) - 1;
+}
+
+/**
+ * Numbers @p irn and its operands inside the block @p bl in postorder.
+ */
+static void number_node(reach_index_t *index, ir_node *irn, const ir_node *bl)
+{
+	if (pmap_contains(index->numbers, irn))
+		return;
+
+	if (!is_Phi(irn)) {
+		foreach_irn_in(irn, i, op) {
+			if (!is_Block(op) && get_nodes_block(op) == bl)
+				number_node(index, op, bl);
+		}
+	}
+
+	unsigned const number = index->n_nodes++;
+	index->nodes[number] = irn;
+	pmap_insert(index->numbers, irn, INT_TO_PTR(number + 1));
+}
+
+/**
+ * Builds the reachability index of a block. The nodes are numbered by pointer
+ * and not by node index as the backend transformation reuses node indices
+ * while the old nodes are still alive.
+ */
+static void build_reach_index(reach_index_t *index, const ir_node *bl)
+{
+	unsigned n_nodes = 0;
+	foreach_out_edge(bl, edge) {
+		if (++n_nodes > REACH_INDEX_MAX_NODES)
+			return;
+	}
+
+	index->nodes   = XMALLOCN(const ir_node*, n_nodes);
+	index->numbers = pmap_create_ex(n_nodes);
+	foreach_out_edge(bl, edge) {
+		number_node(index, get_edge_src_irn(edge), bl);
+	}
+	assert(index->n_nodes == n_nodes);
+
+	/* all rows live in a single allocation */
+	size_t n_words = 0;
+	for (unsigned i = 0; i < n_nodes; ++i)
+		n_words += BITSET_SIZE_ELEMS(i + 1);
+	unsigned *words = XMALLOCNZ(unsigned, n_words);
+
+	/* operands are numbered before their users, so their rows are complete */
+	index->rows = XMALLOCN(unsigned*, n_nodes);
+	for (unsigned i = 0; i < n_nodes; ++i) {
+		unsigned *row = words;
+		words += BITSET_SIZE_ELEMS(i + 1);
+		index->rows[i] = row;
+		rbitset_set(row, i);
+
+		const ir_node *irn = index->nodes[i];
+		if (is_Phi(irn))
+			continue;
+		foreach_irn_in(irn, j, op) {
+			if (is_Block(op) || get_nodes_block(op) != bl)
+				continue;
+			unsigned const op_number = get_reach_number(index, op);
+			rbitset_or(row, index->rows[op_number], op_number + 1);
+		}
+	}
+}
+
+/**
+ * Answers a reachability query from the index of the block.
+ * @return -1 if the index cannot answer the query.
+ */
+static int reachable_indexed(ir_heights_t *h, const ir_node *n,
+                             const ir_node *m)
+{
+	ir_node       *bl    = get_nodes_block(n);
+	reach_index_t *index = pmap_get(reach_index_t, h->reach, bl);
+	if (index == NULL) {
+		index = XMALLOCZ(reach_index_t);
+		pmap_insert(h->reach, bl, index);
+	}
+	if (index->nodes == NULL) {
+		/* building costs about as much as a few searches */
+		if (++index->n_queries < REACH_INDEX_MIN_QUERIES)
+			return -1;
+		index->n_queries = 0;
+		build_reach_index(index, bl);
+		if (index->nodes == NULL)
+			return -1;
+	}
+
+	/* nodes created after the index was built are not numbered */
+	unsigned const n_number = get_reach_number(index, n);
+	unsigned const m_number = get_reach_number(index, m);
+	if (n_number == (unsigned)-1 || m_number == (unsigned)-1)
+		return -1;
+
+	return m_number <= n_number
+	    && rbitset_is_set(index->rows[n_number], m_number);
+}
+
 int heights_reachable_in_block(ir_heights_t *h, const ir_node *n,
                                const ir_node *m)
 {
@@ -109,6 +247,12 @@ int heights_reachable_in_block(ir_heights_t *h, const ir_node *n,
 	assert(get_nodes_block(n) == get_nodes_block(m));
 	assert(hn != NULL && hm != NULL);
 
+	if (h->reach != NULL) {
+		int const indexed = reachable_indexed(h, n, m);
+		if (indexed >= 0)
+			return indexed;
+	}
+
 	if (hn->height <= hm->height) {
 		h->visited++;
 		res = search(h, n, m);
@@ -186,7 +330,14 @@ unsigned heights_recompute_block(ir_heights_t *h, ir_node *block)
 		memset(ih, 0, sizeof(*ih));
 	}
 
-	h->visited = 0;
+	if (h->reach != NULL) {
+		reach_index_t *index = pmap_get(reach_index_t, h->reach, block);
+		if (index != NULL) {
+			free_reach_index(index);
+			pmap_insert(h->reach, block, NULL);
+		}
+	}
+
 	return compute_heights_in_block(block, h);
 }
 
@@ -203,8 +354,21 @@ ir_heights_t *heights_new(ir_graph *irg)
 	return res;
 }
 
+void heights_enable_reachability_index(ir_heights_t *h)
+{
+	if (h->reach == NULL)
+		h->reach = pmap_create();
+}
+
 void heights_free(ir_heights_t *h)
 {
+	if (h->reach != NULL) {
+		foreach_pmap(h->reach, entry) {
+			if (entry->value != NULL)
+				free_reach_index((reach_index_t*)entry->value);
+		}
+		pmap_destroy(h->reach);
+	}
 	dump_remove_node_info_callback(h->dump_handle);
 	obstack_free(&h->obst, NULL);
 	ir_nodemap_destroy(&h->data);
@@ -21,17 +21,20 @@
 #include "irprog_t.h"
 #include "pmap.h"
 
+/* The state of a construction is per thread, so that graphs may be analysed
+ * concurrently. */
+
 /** The outermost graph the scc is computed for */
-static ir_graph *outermost_ir_graph;
+static FIRM_THREAD_LOCAL ir_graph *outermost_ir_graph;
 /** Current cfloop construction is working on. */
-static ir_loop *current_loop;
+static FIRM_THREAD_LOCAL ir_loop *current_loop;
 /** Counts the number of allocated cfloop nodes.
  * Each cfloop node gets a unique number.
  * @todo What for? ev. remove.
  */
-static int loop_node_cnt = 0;
+static FIRM_THREAD_LOCAL int loop_node_cnt = 0;
 /** Counter to generate depth first numbering of visited nodes. */
-static int current_dfn = 1;
+static FIRM_THREAD_LOCAL int current_dfn = 1;
 
 /**********************************************************************/
 /* Node attributes needed for the construction.                      **/
@@ -121,9 +124,9 @@ static inline int get_irn_dfn(ir_node *n)
 /**********************************************************************/
 
 /** An IR-node stack */
-static ir_node **stack = NULL;
+static FIRM_THREAD_LOCAL ir_node **stack = NULL;
 /** The top (index) of the IR-node stack */
-static size_t    tos = 0;
+static FIRM_THREAD_LOCAL size_t    tos = 0;
 
 /**
  * Initializes the IR-node stack
@@ -572,7 +575,8 @@ static void reset_backedges(ir_node *n)
 static void loop_reset_node(ir_node *n, void *env)
 {
 	(void)env;
-	set_irn_loop(n, NULL);
+	if (is_Block(n))
+		set_irn_loop(n, NULL);
 	reset_backedges(n);
 }
 
@@ -16,6 +16,7 @@
 #include "iredges_t.h"
 #include "irgraph_t.h"
 #include "irgwalk.h"
+#include "irlivechk.h"
 #include "irnode_t.h"
 #include "irouts_t.h"
 #include "util.h"
@@ -497,9 +498,20 @@ static void count_and_init_blocks_dom(ir_node *block, void *env)
 	set_Block_dom_depth(block, -1);
 }
 
+/**
+ * Drops the cached liveness check, which identifies blocks by their dominator
+ * tree pre order numbers.
+ */
+static void dom_tree_renumbered(ir_graph *irg)
+{
+	free_irg_lv_chk(irg);
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LIVENESS);
+}
+
 void compute_doms(ir_graph *irg)
 {
 	assert(!irg_is_constrained(irg, IR_GRAPH_CONSTRAINT_CONSTRUCTION));
+	dom_tree_renumbered(irg);
 
 	/* We need the out data structure. */
 	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS
@@ -642,6 +654,7 @@ void compute_postdoms(ir_graph *irg)
 	ir_free_resources(irg, IR_RESOURCE_BLOCK_VISITED);
 	assert(used <= n_blocks);
 	n_blocks = used;
+	irg->postdom_keepalive = false;
 
 	for (int i = n_blocks; i-- > 1; ) {  /* Don't iterate the root, it's done. */
 		tmp_dom_info *w = &tdi_list[i];
@@ -649,6 +662,8 @@ void compute_postdoms(ir_graph *irg)
 		/* Step 2 */
 		ir_node  *block       = w->block;
 		bool      unreachable = w->unreachable;
+		if (unreachable)
+			irg->postdom_keepalive = true;
 		foreach_irn_out(block, j, succ) {
 			if (get_irn_mode(succ) != mode_X || is_Bad(succ))
 				continue;
@@ -708,3 +723,522 @@ void compute_postdoms(ir_graph *irg)
 	postdom_tree_walk(get_irg_end_block(irg), assign_tree_postdom_pre_order,
 	                  assign_tree_postdom_pre_order_max, &tree_pre_order);
 }
+
+/*
+ * Incremental updates
+ *
+ * Inserting or deleting the flow graph edge (from, to) only changes the
+ * immediate dominators of blocks below the nearest common dominator of from
+ * and to, see Ramalingam and Reps, "An Incremental Algorithm for Maintaining
+ * the Dominator Tree of a Reducible Flowgraph" and Georgiadis et al., "An
+ * Experimental Study of Dynamic Dominators". So we rebuild just this subtree
+ * with the algorithm above. Paths entering the subtree pass its root, so the
+ * edges between its blocks suffice, and these are found via the block
+ * predecessors. Thus no outs are needed.
+ */
+
+static inline ir_dom_info *get_tree_info(ir_node *block, bool post)
+{
+	return post ? get_pdom_info(block) : get_dom_info(block);
+}
+
+static ir_node *tree_common_dominator(ir_node *a, ir_node *b, bool post)
+{
+	ir_dom_info *ai = get_tree_info(a, post);
+	ir_dom_info *bi = get_tree_info(b, post);
+	while (ai->dom_depth > bi->dom_depth) {
+		a  = ai->idom;
+		ai = get_tree_info(a, post);
+	}
+	while (bi->dom_depth > ai->dom_depth) {
+		b  = bi->idom;
+		bi = get_tree_info(b, post);
+	}
+	while (a != b) {
+		a  = ai->idom;
+		ai = get_tree_info(a, post);
+		b  = bi->idom;
+		bi = get_tree_info(b, post);
+	}
+	return a;
+}
+
+/** Returns the index of @p block in the subtree @p blocks or -1. */
+static int get_subtree_index(ir_node *block, ir_node *const *blocks,
+                             bool post)
+{
+	int idx = get_tree_info(block, post)->pre_num;
+	if (idx < 0 || (size_t)idx >= ARR_LEN(blocks) || blocks[idx] != block)
+		return -1;
+	return idx;
+}
+
+typedef struct subtree_edge_t {
+	unsigned src;
+	unsigned dst;
+} subtree_edge_t;
+
+static void add_subtree_edge(subtree_edge_t **edges, int pred, unsigned block,
+                             bool post)
+{
+	if (pred < 0)
+		return;
+	subtree_edge_t edge = { (unsigned)pred, block };
+	if (post) {
+		edge.src = block;
+		edge.dst = (unsigned)pred;
+	}
+	ARR_APP1(subtree_edge_t, *edges, edge);
+}
+
+/**
+ * Recomputes the (post) dominator tree below @p root.
+ *
+ * If blocks of the subtree are no longer reachable from the root, they are
+ * removed from the tree and appended to @p unreachable. Without
+ * @p unreachable the caller has to recompute the whole tree then.
+ *
+ * @return the number of blocks in the subtree or -1 if it failed
+ */
+static int rebuild_dom_subtree(ir_graph *irg, ir_node *root, bool post,
+                               ir_node ***unreachable)
+{
+	/* collect the subtree, the pre_num is its index here */
+	ir_node **blocks = NEW_ARR_F(ir_node*, 1);
+	blocks[0] = root;
+	for (size_t i = 0; i < ARR_LEN(blocks); ++i) {
+		ir_dom_info *info = get_tree_info(blocks[i], post);
+		info->pre_num = i;
+		for (ir_node *c = info->first; c != NULL;
+		     c = get_tree_info(c, post)->next)
+			ARR_APP1(ir_node*, blocks, c);
+	}
+	unsigned const n = ARR_LEN(blocks);
+
+	/* collect the flow graph edges between blocks of the subtree */
+	ir_node        *end_block = get_irg_end_block(irg);
+	subtree_edge_t *edges     = NEW_ARR_F(subtree_edge_t, 0);
+	for (unsigned i = 0; i < n; ++i) {
+		ir_node *block = blocks[i];
+		for (int j = 0, arity = get_Block_n_cfgpreds(block); j < arity; ++j) {
+			ir_node *pred = get_Block_cfgpred_block(block, j);
+			if (pred != NULL)
+				add_subtree_edge(&edges, get_subtree_index(pred, blocks, post),
+				                 i, post);
+		}
+		/* keep-alive edges, the post dominator tree root is never rebuilt */
+		if (!post && block == end_block) {
+			foreach_irn_in(get_irg_end(irg), j, pred) {
+				if (is_Block(pred))
+					add_subtree_edge(&edges,
+					                 get_subtree_index(pred, blocks, post), i,
+					                 post);
+			}
+		}
+	}
+	size_t const n_edges = ARR_LEN(edges);
+
+	struct obstack obst;
+	obstack_init(&obst);
+	unsigned *succ_start = OALLOCNZ(&obst, unsigned, n + 1);
+	unsigned *pred_start = OALLOCNZ(&obst, unsigned, n + 1);
+	unsigned *succs      = OALLOCN(&obst, unsigned, n_edges);
+	unsigned *preds      = OALLOCN(&obst, unsigned, n_edges);
+	for (size_t e = 0; e < n_edges; ++e) {
+		++succ_start[edges[e].src + 1];
+		++pred_start[edges[e].dst + 1];
+	}
+	for (unsigned i = 0; i < n; ++i) {
+		succ_start[i + 1] += succ_start[i];
+		pred_start[i + 1] += pred_start[i];
+	}
+	unsigned *succ_pos = OALLOCN(&obst, unsigned, n);
+	unsigned *pred_pos = OALLOCN(&obst, unsigned, n);
+	MEMCPY(succ_pos, succ_start, n);
+	MEMCPY(pred_pos, pred_start, n);
+	for (size_t e = 0; e < n_edges; ++e) {
+		succs[succ_pos[edges[e].src]++] = edges[e].dst;
+		preds[pred_pos[edges[e].dst]++] = edges[e].src;
+	}
+	DEL_ARR_F(edges);
+
+	/* depth first search from the root, succ_pos is the next successor */
+	int          *dfs_num  = OALLOCN(&obst, int, n);
+	unsigned     *vertex   = OALLOCN(&obst, unsigned, n);
+	unsigned     *stack    = OALLOCN(&obst, unsigned, n);
+	tmp_dom_info *tdi_list = OALLOCN(&obst, tmp_dom_info, n);
+	for (unsigned i = 0; i < n; ++i) {
+		dfs_num[i]  = -1;
+		succ_pos[i] = succ_start[i];
+	}
+	unsigned used = 0;
+	unsigned sp   = 0;
+	for (unsigned v = 0;;) {
+		tmp_dom_info *tdi = &tdi_list[used];
+		tdi->block       = blocks[v];
+		tdi->semi        = tdi;
+		tdi->parent      = sp > 0 ? &tdi_list[dfs_num[stack[sp - 1]]] : NULL;
+		tdi->label       = tdi;
+		tdi->ancestor    = NULL;
+		tdi->dom         = NULL;
+		tdi->bucket      = NULL;
+		tdi->unreachable = 0;
+		dfs_num[v]       = used;
+		vertex[used++]   = v;
+		stack[sp++]      = v;
+
+		/* find the next unvisited block */
+		for (;;) {
+			unsigned top = stack[sp - 1];
+			if (succ_pos[top] < succ_start[top + 1]) {
+				v = succs[succ_pos[top]++];
+				if (dfs_num[v] < 0)
+					break;
+			} else if (--sp == 0) {
+				goto dfs_done;
+			}
+		}
+	}
+dfs_done:
+	if (used < n) {
+		/* Blocks becoming unreachable also change the dominators of their
+		 * successors outside the subtree. */
+		if (unreachable == NULL) {
+			obstack_free(&obst, NULL);
+			DEL_ARR_F(blocks);
+			return -1;
+		}
+		for (unsigned i = 0; i < n; ++i) {
+			if (dfs_num[i] >= 0)
+				continue;
+			ir_dom_info *info = get_tree_info(blocks[i], post);
+			info->idom      = NULL;
+			info->next      = NULL;
+			info->first     = NULL;
+			info->pre_num   = -1;
+			info->dom_depth = -1;
+			ARR_APP1(ir_node*, *unreachable, blocks[i]);
+		}
+	}
+	if (!post)
+		dom_tree_renumbered(irg);
+
+	for (unsigned i = used; i-- > 1; ) {
+		tmp_dom_info *w = &tdi_list[i];
+		unsigned      v = vertex[i];
+
+		/* Step 2 */
+		for (unsigned p = pred_start[v]; p < pred_start[v + 1]; ++p) {
+			int pred_num = dfs_num[preds[p]];
+			if (pred_num < 0)
+				continue;    /* unreachable */
+			const tmp_dom_info *u = dom_eval(&tdi_list[pred_num]);
+			if (u->semi < w->semi)
+				w->semi = u->semi;
+		}
+
+		w->bucket = w->semi->bucket;
+		w->semi->bucket = w;
+
+		dom_link(w->parent, w);
+
+		/* Step 3 */
+		while (w->parent->bucket) {
+			tmp_dom_info *v = w->parent->bucket;
+			w->parent->bucket = v->bucket;
+			v->bucket         = NULL;
+
+			tmp_dom_info *u = dom_eval(v);
+			if (u->semi < v->semi)
+				v->dom = u;
+			else
+				v->dom = w->parent;
+		}
+	}
+
+	/* replace the subtree */
+	for (unsigned i = 0; i < n; ++i)
+		get_tree_info(blocks[i], post)->first = NULL;
+	for (unsigned i = 1; i < used; ++i) {
+		tmp_dom_info *w = &tdi_list[i];
+		if (w->dom != w->semi)
+			w->dom = w->dom->dom;
+		ir_node *idom = w->dom->block;
+		if (post)
+			set_Block_ipostdom(w->block, idom);
+		else
+			set_Block_idom(w->block, idom);
+		get_tree_info(w->block, post)->dom_depth
+			= get_tree_info(idom, post)->dom_depth + 1;
+	}
+
+	/* Renumber the subtree. It got no new blocks, so the numbers of the old
+	 * subtree suffice. */
+	ir_node **tree_stack = OALLOCN(&obst, ir_node*, used);
+	ir_node **child      = OALLOCN(&obst, ir_node*, used);
+	ir_dom_info *root_info = get_tree_info(root, post);
+	unsigned     num       = root_info->tree_pre_num + 1;
+	tree_stack[0] = root;
+	child[0]      = root_info->first;
+	sp            = 1;
+	while (sp > 0) {
+		ir_node *c = child[sp - 1];
+		if (c != NULL) {
+			ir_dom_info *info = get_tree_info(c, post);
+			child[sp - 1]     = info->next;
+			info->tree_pre_num = num++;
+			tree_stack[sp]    = c;
+			child[sp++]       = info->first;
+		} else {
+			get_tree_info(tree_stack[--sp], post)->max_subtree_pre_num
+				= num - 1;
+		}
+	}
+
+	obstack_free(&obst, NULL);
+	DEL_ARR_F(blocks);
+	return n;
+}
+
+static void update_dom_tree(ir_graph *irg, ir_node *from, ir_node *to,
+                            bool insert, bool post)
+{
+	if (!irg_has_properties(irg, post
+	        ? IR_GRAPH_PROPERTY_CONSISTENT_POSTDOMINANCE
+	        : IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE))
+		return;
+
+	/* Which keep-alive edges to endless loops are used depends on the whole
+	 * graph, so there is no local update for them. */
+	if (post && irg->postdom_keepalive)
+		goto recompute;
+
+	/* the post dominator tree is built on the reverse flow graph */
+	if (post) {
+		ir_node *tmp = from;
+		from = to;
+		to   = tmp;
+	}
+
+	ir_dom_info *from_info = get_tree_info(from, post);
+	ir_dom_info *to_info   = get_tree_info(to, post);
+	/* the depth is -1 for unreachable blocks and 0 for blocks created after
+	 * the tree was computed */
+	if (from_info->dom_depth == 0 || to_info->dom_depth == 0)
+		goto recompute;
+	if (from_info->dom_depth < 0)
+		return; /* edges of unreachable blocks do not matter */
+	if (to_info->dom_depth > 0) {
+		ir_node *root = tree_common_dominator(from, to, post);
+		if (root == to || (insert && root == to_info->idom))
+			return;
+		if (rebuild_dom_subtree(irg, root, post, NULL) >= 0)
+			return;
+	} else if (!insert) {
+		return;
+	}
+
+	/* blocks became reachable or unreachable, recompute everything */
+recompute:
+	if (post)
+		compute_postdoms(irg);
+	else
+		compute_doms(irg);
+}
+
+void dom_insert_edge(ir_node *from, ir_node *to)
+{
+	ir_graph *irg = get_irn_irg(from);
+	update_dom_tree(irg, from, to, true, false);
+	update_dom_tree(irg, from, to, true, true);
+	ir_free_dominance_frontiers(irg);
+}
+
+void dom_delete_edge(ir_node *from, ir_node *to)
+{
+	ir_graph *irg = get_irn_irg(from);
+	if (irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE)) {
+		dom_edge_t const edge = { from, to };
+		dom_remove_edges(irg, &edge, 1, NULL);
+	}
+	update_dom_tree(irg, from, to, false, true);
+	ir_free_dominance_frontiers(irg);
+}
+
+/** Returns true if @p a dominates @p b in the current dominator tree. */
+static bool tree_dominates(ir_node *a, ir_node *b)
+{
+	ir_dom_info const *ai = get_dom_info(a);
+	unsigned    const  bn = get_dom_info(b)->tree_pre_num;
+	return ai->tree_pre_num <= bn && bn <= ai->max_subtree_pre_num;
+}
+
+/**
+ * Classifies the reachable predecessors of @p block, including the keep-alive
+ * edges of the End block.
+ *
+ * @param has_idom     set if the immediate dominator is among them
+ * @param has_outside  set if one of them is not dominated by @p block
+ */
+static void classify_preds(ir_graph *irg, ir_node *block, bool *has_idom,
+                           bool *has_outside)
+{
+	ir_node *const idom = get_dom_info(block)->idom;
+	*has_idom    = false;
+	*has_outside = false;
+	for (int i = 0, arity = get_Block_n_cfgpreds(block); i < arity; ++i) {
+		ir_node *const pred = get_Block_cfgpred_block(block, i);
+		if (pred == NULL || get_dom_info(pred)->dom_depth <= 0)
+			continue;
+		*has_idom    |= pred == idom;
+		*has_outside |= !tree_dominates(block, pred);
+	}
+	if (block == get_irg_end_block(irg)) {
+		foreach_irn_in(get_irg_end(irg), i, pred) {
+			if (!is_Block(pred) || get_dom_info(pred)->dom_depth <= 0)
+				continue;
+			*has_idom    |= pred == idom;
+			*has_outside |= !tree_dominates(block, pred);
+		}
+	}
+}
+
+/**
+ * Removes the dominator subtree of @p root, which became unreachable, from
+ * the tree and appends its blocks to @p unreachable.
+ */
+static unsigned remove_dom_subtree(ir_node *root, ir_node ***unreachable)
+{
+	ir_dom_info *const parent = get_dom_info(get_dom_info(root)->idom);
+	for (ir_node **p = &parent->first; *p != NULL; p = &get_dom_info(*p)->next) {
+		if (*p == root) {
+			*p = get_dom_info(root)->next;
+			break;
+		}
+	}
+
+	size_t const first = ARR_LEN(*unreachable);
+	ARR_APP1(ir_node*, *unreachable, root);
+	for (size_t i = first; i < ARR_LEN(*unreachable); ++i) {
+		ir_dom_info *const info = get_dom_info((*unreachable)[i]);
+		for (ir_node *c = info->first; c != NULL; c = get_dom_info(c)->next)
+			ARR_APP1(ir_node*, *unreachable, c);
+	}
+	for (size_t i = first, n = ARR_LEN(*unreachable); i < n; ++i) {
+		ir_dom_info *const info = get_dom_info((*unreachable)[i]);
+		info->idom      = NULL;
+		info->next      = NULL;
+		info->first     = NULL;
+		info->pre_num   = -1;
+		info->dom_depth = -1;
+	}
+	return ARR_LEN(*unreachable) - first;
+}
+
+static void collect_unreachable_block(ir_node *block, void *data)
+{
+	ir_node ***unreachable = (ir_node***)data;
+	if (get_dom_info(block)->dom_depth < 0)
+		ARR_APP1(ir_node*, *unreachable, block);
+}
+
+unsigned dom_remove_edges(ir_graph *irg, dom_edge_t const *edges,
+                          size_t n_edges, ir_node ***unreachable)
+{
+	/* Without a caller interested in unreachable blocks, everything is
+	 * recomputed when some become unreachable, so no out edges are needed. */
+	ir_node **own_unreachable = NULL;
+	if (unreachable == NULL) {
+		own_unreachable = NEW_ARR_F(ir_node*, 0);
+		unreachable     = &own_unreachable;
+	} else {
+		assert(edges_activated_kind(irg, EDGE_KIND_BLOCK));
+	}
+
+	/* An edge without source stands for a block, which lost a predecessor
+	 * that became unreachable. */
+	dom_edge_t *worklist = NEW_ARR_F(dom_edge_t, n_edges);
+	MEMCPY(worklist, edges, n_edges);
+	unsigned cost = 0;
+	while (ARR_LEN(worklist) > 0) {
+		dom_edge_t const edge = worklist[ARR_LEN(worklist) - 1];
+		ARR_SHRINKLEN(worklist, ARR_LEN(worklist) - 1);
+
+		/* the depth is -1 for unreachable blocks and 0 for blocks created
+		 * after the tree was computed */
+		ir_node     *const to      = edge.to;
+		ir_dom_info *const to_info = get_dom_info(to);
+		if (to_info->dom_depth == 0)
+			goto recompute;
+		if (to_info->dom_depth < 0 || to_info->idom == NULL)
+			continue;
+
+		/* If the immediate dominator still is a predecessor, no dominators
+		 * change: A block gaining a dominator d implies that a lost path
+		 * avoided d and passed the target of the edge. So the target gains
+		 * d, too, which contradicts the path from its unchanged immediate
+		 * dominator. */
+		bool has_idom;
+		bool has_outside;
+		classify_preds(irg, to, &has_idom, &has_outside);
+		++cost;
+		if (has_idom)
+			continue;
+
+		size_t const n_unreachable = ARR_LEN(*unreachable);
+		if (!has_outside) {
+			/* Only entered from its own subtree, so all of it is dead. */
+			dom_tree_renumbered(irg);
+			cost += remove_dom_subtree(to, unreachable);
+		} else {
+			ir_node *root;
+			if (edge.from != NULL && get_dom_info(edge.from)->dom_depth > 0) {
+				root = tree_common_dominator(edge.from, to, false);
+				if (root == to)
+					continue;
+			} else {
+				/* The source may have become unreachable by an earlier
+				 * update, then the edge is not among its successors
+				 * anymore. */
+				root = to_info->idom;
+			}
+			cost += rebuild_dom_subtree(irg, root, false, unreachable);
+		}
+		if (own_unreachable != NULL && ARR_LEN(own_unreachable) > 0)
+			goto recompute;
+
+		for (size_t i = n_unreachable, n = ARR_LEN(*unreachable); i < n; ++i) {
+			ir_node *const block = (*unreachable)[i];
+			foreach_block_succ(block, succ_edge) {
+				dom_edge_t const succ = { NULL, get_edge_src_irn(succ_edge) };
+				ARR_APP1(dom_edge_t, worklist, succ);
+			}
+			/* keep-alive edges lead to the End block */
+			foreach_irn_in(get_irg_end(irg), j, pred) {
+				if (pred == block) {
+					dom_edge_t const succ = { NULL, get_irg_end_block(irg) };
+					ARR_APP1(dom_edge_t, worklist, succ);
+					break;
+				}
+			}
+		}
+	}
+	DEL_ARR_F(worklist);
+	if (own_unreachable != NULL)
+		DEL_ARR_F(own_unreachable);
+
+	add_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+	ir_free_dominance_frontiers(irg);
+	return cost;
+
+recompute:
+	DEL_ARR_F(worklist);
+	compute_doms(irg);
+	if (own_unreachable != NULL)
+		DEL_ARR_F(own_unreachable);
+	else
+		irg_block_walk_graph(irg, collect_unreachable_block, NULL,
+		                     unreachable);
+	ir_free_dominance_frontiers(irg);
+	return cost;
+}
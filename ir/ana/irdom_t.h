@@ -59,6 +59,28 @@ unsigned get_Block_pdom_max_subtree_pre_num(const ir_node *bl);
 
 void ir_free_dominance_frontiers(ir_graph *irg);
 
+/** A control flow edge between two blocks. */
+typedef struct dom_edge_t {
+	ir_node *from;
+	ir_node *to;
+} dom_edge_t;
+
+/**
+ * Updates the dominator tree after the control flow edges @p edges were
+ * removed from the graph. Edges whose target keeps its immediate dominator as
+ * predecessor are skipped, otherwise the subtree below the nearest common
+ * dominator is recomputed. The post dominator tree is not updated. Blocks
+ * which become unreachable get the dominator depth -1 and are appended to
+ * @p unreachable, this needs consistent block out edges. If @p unreachable
+ * is NULL, the whole tree is recomputed instead once blocks become
+ * unreachable. The same happens for edges to blocks created after the tree
+ * was computed, then all unreachable blocks are appended.
+ *
+ * @return the number of blocks visited
+ */
+unsigned dom_remove_edges(ir_graph *irg, dom_edge_t const *edges,
+                          size_t n_edges, ir_node ***unreachable);
+
 /**
  * Iterate over all nodes which are immediately dominated by a given
  * node.
@@ -424,3 +424,26 @@ end:
 
 	return res;
 }
+
+void assure_irg_lv_chk(ir_graph *irg)
+{
+	free_irg_lv_chk(irg);
+	/* the depth first search follows the block out edges */
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
+	irg->lv_chk = lv_chk_new(irg);
+	add_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LIVENESS);
+}
+
+void free_irg_lv_chk(ir_graph *irg)
+{
+	if (irg->lv_chk != NULL) {
+		lv_chk_free(irg->lv_chk);
+		irg->lv_chk = NULL;
+	}
+}
+
+lv_chk_t *get_irg_lv_chk(ir_graph const *irg)
+{
+	assert(irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LIVENESS));
+	return irg->lv_chk;
+}
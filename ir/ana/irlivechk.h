@@ -61,6 +61,21 @@ extern lv_chk_t *lv_chk_new(ir_graph *irg);
  */
 extern void lv_chk_free(lv_chk_t *lv);
 
+/**
+ * Makes sure the liveness check cached in the graph is up to date. As it only
+ * depends on the control flow, it survives all other changes of the graph.
+ */
+void assure_irg_lv_chk(ir_graph *irg);
+
+/** Frees the liveness check cached in the graph. */
+void free_irg_lv_chk(ir_graph *irg);
+
+/**
+ * Returns the liveness check cached in the graph. Queries additionally need
+ * consistent dominance and out edges.
+ */
+lv_chk_t *get_irg_lv_chk(ir_graph const *irg);
+
 
 /**
  * Return liveness information for a node concerning a block.
@@ -107,7 +107,8 @@ static inline unsigned _get_loop_depth(const ir_loop *loop)
 /* Uses temporary information to get the loop */
 static inline ir_loop *_get_irn_loop(const ir_node *n)
 {
-	return n->loop;
+	assert(is_Block(n));
+	return n->attr.block.loop;
 }
 
 #endif
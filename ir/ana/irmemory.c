@@ -22,12 +22,16 @@
 #include "irouts_t.h"
 #include "irprintf.h"
 #include "irprog_t.h"
+#include "lock.h"
 #include "panic.h"
+#include "statev_t.h"
 #include "type_t.h"
 #include "typerep.h"
 #include "util.h"
+#include "xmalloc.h"
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 
 /** The debug handle. */
 DEBUG_ONLY(static firm_dbg_module_t *dbg = NULL;)
@@ -61,11 +65,15 @@ void set_irg_memory_disambiguator_options(ir_graph *irg,
                                           ir_disambiguator_options options)
 {
 	irg->mem_disambig_opt = options & ~aa_opt_inherited;
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_CACHE);
 }
 
 void set_irp_memory_disambiguator_options(ir_disambiguator_options options)
 {
 	global_mem_disamgig_opt = options;
+	foreach_irp_irg(i, irg) {
+		clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_CACHE);
+	}
 }
 
 ir_storage_class_class_t get_base_sc(ir_storage_class_class_t x)
@@ -294,55 +302,90 @@ follow_ptr:
 	}
 }
 
-static ir_alias_relation _get_alias_relation(const ir_node *addr1, const ir_type *const objt1, unsigned size1,
-                                             const ir_node *addr2, const ir_type *const objt2, unsigned size2)
+/** A cached alias query and its result. */
+typedef struct alias_query_t {
+	const ir_node    *addr1;
+	const ir_type    *type1;
+	const ir_node    *addr2;
+	const ir_type    *type2;
+	unsigned          size1;
+	unsigned          size2;
+	ir_alias_relation rel;
+	bool              known; /**< rel was computed */
+} alias_query_t;
+
+static unsigned hash_alias_query(const alias_query_t *query)
 {
-	if (addr1 == addr2)
-		return ir_sure_alias;
-	ir_graph *const irg     = get_irn_irg(addr1);
-	unsigned  const options = get_irg_memory_disambiguator_options(irg);
-	if (options & aa_opt_always_alias)
-		return ir_may_alias;
-	/* The Armageddon switch */
-	if (options & aa_opt_no_alias)
-		return ir_no_alias;
-
-	/* do the addresses have constants offsets from the same base?
-	 *  Note: sub X, C is normalized to add X, -C */
-
-	/*
-	 * Currently, only expressions with at most one symbolic
-	 * offset can be handled.  To extend this, change
-	 * sym_offset to be a set, and compare the sets.
-	 */
-	address_info const info1   = get_address_info(addr1);
-	address_info const info2   = get_address_info(addr2);
-	long               offset1 = info1.offset;
-	long               offset2 = info2.offset;
-	addr1 = info1.base;
-	addr2 = info2.base;
-
-	/* same base address -> compare offsets if possible.
-	 * FIXME: type long is not sufficient for this task ... */
-	if (addr1 == addr2 && info1.sym_offset == info2.sym_offset && info1.has_const_offset && info2.has_const_offset) {
-		unsigned long first_offset;
-		unsigned long last_offset;
-		unsigned first_size;
+	/* node indices are dense, so they give better low bits than pointers */
+	unsigned hash = hash_combine(hash_ptr(query->type1) ^ query->size1,
+	                             hash_ptr(query->type2) ^ query->size2);
+	hash = hash_combine(hash, get_irn_idx(query->addr1));
+	return hash_combine(hash, get_irn_idx(query->addr2));
+}
 
-		if (offset1 <= offset2) {
-			first_offset = offset1;
-			last_offset = offset2;
-			first_size = size1;
-		} else {
-			first_offset = offset2;
-			last_offset = offset1;
-			first_size = size2;
-		}
+static bool alias_queries_equal(const alias_query_t *q1,
+                                const alias_query_t *q2)
+{
+	return q1->addr1 == q2->addr1 && q1->addr2 == q2->addr2
+	    && q1->type1 == q2->type1 && q1->type2 == q2->type2
+	    && q1->size1 == q2->size1 && q1->size2 == q2->size2;
+}
 
-		return first_offset + first_size <= last_offset
-		     ? ir_no_alias : ir_sure_alias;
-	}
+#define HashSet                   ir_alias_cache
+#define HashSetEntry              alias_cache_entry_t
+#define ValueType                 alias_query_t
+#define ADDITIONAL_DATA           unsigned n_hits; unsigned n_misses;
+#include "hashset.h"
+#undef ADDITIONAL_DATA
+
+typedef struct ir_alias_cache ir_alias_cache;
+
+#define KeyType                   const alias_query_t*
+#define ConstKeyType              const alias_query_t*
+#define GetKey(entry)             (&(entry))
+#define InitData(self,entry,key)  (entry) = *(key)
+#define Hash(self,key)            hash_alias_query(key)
+#define KeysEqual(self,key1,key2) alias_queries_equal(key1, key2)
+#define SetRangeEmpty(ptr,size)   memset(ptr, 0, (size) * sizeof((ptr)[0]))
+#define EntrySetEmpty(entry)      (entry).data.addr1 = NULL
+#define EntrySetDeleted(entry)    (entry).data.addr1 = (ir_node*)-1
+#define EntryIsEmpty(entry)       ((entry).data.addr1 == NULL)
+#define EntryIsDeleted(entry)     ((entry).data.addr1 == (ir_node*)-1)
+#define ADDITIONAL_INIT           self->n_hits = 0; self->n_misses = 0;
+
+#define hashset_init            alias_cache_init
+#define hashset_destroy         alias_cache_destroy
+#define hashset_insert          alias_cache_insert
+
+static void alias_cache_init(ir_alias_cache *self);
+static void alias_cache_destroy(ir_alias_cache *self);
+static alias_query_t *alias_cache_insert(ir_alias_cache *self,
+                                         const alias_query_t *query);
+
+#include "hashset.c.h"
+
+void free_alias_cache(ir_graph *irg)
+{
+	ir_alias_cache *cache = irg->alias_cache;
+	if (cache == NULL)
+		return;
+	stat_ev_ull("alias_cache_hits", cache->n_hits);
+	stat_ev_ull("alias_cache_misses", cache->n_misses);
+	alias_cache_destroy(cache);
+	free(cache);
+	irg->alias_cache = NULL;
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_CACHE);
+}
 
+/**
+ * Determines the alias relation of two addresses which are not just constant
+ * offsets from the same base.
+ */
+static ir_alias_relation get_base_alias_relation(
+		const ir_node *addr1, long offset1, const ir_type *const objt1,
+		unsigned size1, const ir_node *addr2, long offset2,
+		const ir_type *const objt2, unsigned size2, unsigned options)
+{
 	/* skip Sels/Members */
 	ir_entity     *ent1  = NULL;
 	ir_entity     *ent2  = NULL;
@@ -474,6 +517,81 @@ leave_type_based_alias:;
 	return ir_may_alias;
 }
 
+static ir_alias_relation _get_alias_relation(const ir_node *addr1, const ir_type *const objt1, unsigned size1,
+                                             const ir_node *addr2, const ir_type *const objt2, unsigned size2)
+{
+	if (addr1 == addr2)
+		return ir_sure_alias;
+	ir_graph *const irg     = get_irn_irg(addr1);
+	unsigned  const options = get_irg_memory_disambiguator_options(irg);
+	if (options & aa_opt_always_alias)
+		return ir_may_alias;
+	/* The Armageddon switch */
+	if (options & aa_opt_no_alias)
+		return ir_no_alias;
+
+	/* do the addresses have constants offsets from the same base?
+	 *  Note: sub X, C is normalized to add X, -C */
+
+	/*
+	 * Currently, only expressions with at most one symbolic
+	 * offset can be handled.  To extend this, change
+	 * sym_offset to be a set, and compare the sets.
+	 */
+	address_info const info1   = get_address_info(addr1);
+	address_info const info2   = get_address_info(addr2);
+	long               offset1 = info1.offset;
+	long               offset2 = info2.offset;
+
+	/* same base address -> compare offsets if possible.
+	 * FIXME: type long is not sufficient for this task ... */
+	if (info1.base == info2.base && info1.sym_offset == info2.sym_offset && info1.has_const_offset && info2.has_const_offset) {
+		unsigned long first_offset;
+		unsigned long last_offset;
+		unsigned first_size;
+
+		if (offset1 <= offset2) {
+			first_offset = offset1;
+			last_offset = offset2;
+			first_size = size1;
+		} else {
+			first_offset = offset2;
+			last_offset = offset1;
+			first_size = size2;
+		}
+
+		return first_offset + first_size <= last_offset
+		     ? ir_no_alias : ir_sure_alias;
+	}
+
+	/* The remaining analysis is more expensive, so its results are cached.
+	 * The cache is keyed by the address nodes, so it is only valid as long
+	 * as the graph is unchanged. */
+	if (!irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_CACHE)) {
+		free_alias_cache(irg);
+		irg->alias_cache = XMALLOC(ir_alias_cache);
+		alias_cache_init(irg->alias_cache);
+		add_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_CACHE);
+	}
+
+	ir_alias_cache *const cache = irg->alias_cache;
+	alias_query_t const   query = {
+		addr1, objt1, addr2, objt2, size1, size2, ir_may_alias, false
+	};
+	alias_query_t *const entry = alias_cache_insert(cache, &query);
+	if (entry->known) {
+		++cache->n_hits;
+		return entry->rel;
+	}
+	++cache->n_misses;
+
+	entry->rel   = get_base_alias_relation(info1.base, offset1, objt1, size1,
+	                                       info2.base, offset2, objt2, size2,
+	                                       options);
+	entry->known = true;
+	return entry->rel;
+}
+
 ir_alias_relation get_alias_relation(const ir_node *const addr1, const ir_type *const type1, unsigned size1,
                                      const ir_node *const addr2, const ir_type *const type2, unsigned size2)
 {
@@ -662,8 +780,9 @@ static void analyse_irg_entity_usage(ir_graph *irg)
 		set_entity_usage(entity, (ir_entity_usage) flags);
 	}
 
-	/* now computed */
+	/* now computed, cached alias relations may depend on the old state */
 	add_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE);
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_CACHE);
 }
 
 void assure_irg_entity_usage_computed(ir_graph *irg)
@@ -835,6 +954,7 @@ static void analyse_irp_globals_entity_usage(void)
 	foreach_irp_irg(i, irg) {
 		assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS | IR_GRAPH_PROPERTY_NO_TUPLES);
 		irg_walk_graph(irg, NULL, check_global_address, NULL);
+		clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_CACHE);
 	}
 
 #ifdef DEBUG_libfirm
@@ -854,9 +974,14 @@ ir_entity_usage_computed_state get_irp_globals_entity_usage_state(void)
 	return irp->globals_entity_usage_state;
 }
 
+/** Graph passes running in several threads all invalidate the state. */
+static firm_lock_t entity_usage_lock = FIRM_LOCK_INIT;
+
 void set_irp_globals_entity_usage_state(ir_entity_usage_computed_state state)
 {
+	firm_lock(&entity_usage_lock);
 	irp->globals_entity_usage_state = state;
+	firm_unlock(&entity_usage_lock);
 }
 
 void assure_irp_globals_entity_usage_computed(void)
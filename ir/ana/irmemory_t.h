@@ -22,6 +22,11 @@ void firm_init_memory_disambiguator(void);
 
 bool is_partly_volatile(ir_node *ptr);
 
+/**
+ * Frees the cached alias relations of a graph.
+ */
+void free_alias_cache(ir_graph *irg);
+
 /**
  * Classify storage locations.
  * Except ir_sc_pointer they are all disjoint.
@@ -208,94 +208,80 @@ void irg_out_block_walk(ir_node *node, irg_walk_func *pre, irg_walk_func *post,
 	}
 }
 
-/*--------------------------------------------------------------------*/
-/** Building and Removing the out data structure                     **/
-/**                                                                  **/
-/** The outs of a graph are allocated in a single, large array.      **/
-/** This allows to allocate and deallocate the memory for the outs   **/
-/** on demand.  The large array is separated into many small ones    **/
-/** for each node.  Only a single field to reference the out array   **/
-/** is stored in each node and a field referencing the large out     **/
-/** array in irgraph.  The 0 field of each out array contains the    **/
-/** size of this array.  This saves memory in the irnodes themselves.**/
-/** The construction does two passes over the graph.  The first pass **/
-/** counts the overall number of outs and the outs of each node.  It **/
-/** stores the outs of each node in the out reference of the node.   **/
-/** Then the large array is allocated.  The second iteration chops   **/
-/** the large array into smaller parts, sets the out edges and       **/
-/** recounts the out edges.                                          **/
-/*--------------------------------------------------------------------*/
-
-
-/** Returns the amount of out edges for not yet visited successors. */
-static void count_outs_node(ir_node *n)
+/*
+ * The out edges of a graph live in a single array, which holds the
+ * ir_def_use_edges of all nodes one after another.  A walk from the End node
+ * counts the outs of each node and records the reached nodes.  A linear sweep
+ * over the recorded nodes then chops the array into the per node parts and a
+ * second one fills in the edges.
+ */
+
+typedef struct outs_env_t {
+	ir_node **nodes;    /**< the reached nodes in the order they were reached */
+	size_t    n_nodes;
+	size_t    n_users;  /**< the nodes before this one are users */
+	size_t    n_edges;  /**< the total number of out edges */
+} outs_env_t;
+
+static void count_outs_node(ir_node *n, outs_env_t *env)
 {
 	if (irn_visited_else_mark(n))
 		return;
 
-	/* initialize our counter */
+	env->nodes[env->n_nodes++] = n;
 	n->o.n_outs = 0;
 
-	int start = is_Block(n) ? 0 : -1;
-	for (int i = start, irn_arity = get_irn_arity(n); i < irn_arity; ++i) {
+	int start     = is_Block(n) ? 0 : -1;
+	int irn_arity = get_irn_arity(n);
+	for (int i = start; i < irn_arity; ++i) {
 		ir_node *def = get_irn_n(n, i);
-		count_outs_node(def);
+		count_outs_node(def, env);
 		++def->o.n_outs;
 	}
+	env->n_edges += irn_arity - start;
 }
 
-
-/** Returns the amount of out edges for not yet visited successors.
- *  This version handles some special nodes like irg_frame, irg_args etc. */
-static void count_outs(ir_graph *irg)
+/** Counts the outs of all nodes, including unused anchors like irg_frame. */
+static void count_outs(ir_graph *irg, outs_env_t *env)
 {
 	inc_irg_visited(irg);
-	count_outs_node(get_irg_end(irg));
+	count_outs_node(get_irg_end(irg), env);
+	/* the anchors are no users, their operands do not get outs for them */
+	env->n_users = env->n_nodes;
 	foreach_irn_in(get_irg_anchor(irg), i, n) {
 		if (irn_visited_else_mark(n))
 			continue;
+		env->nodes[env->n_nodes++] = n;
 		n->o.n_outs = 0;
 	}
 }
 
-static void set_out_edges_node(ir_node *node, struct obstack *obst)
-{
-	if (irn_visited_else_mark(node))
-		return;
-
-	/* Allocate my array */
-	unsigned n_outs = node->o.n_outs;
-	node->o.out          = OALLOCF(obst, ir_def_use_edges, edges, n_outs);
-	node->o.out->n_edges = 0;
-
-	/* add def->use edges from my predecessors to me */
-	int start = is_Block(node) ? 0 : -1;
-	for (int i = start, irn_arity = get_irn_arity(node); i < irn_arity; ++i) {
-		ir_node *def = get_irn_n(node, i);
-
-		/* recurse, ensures that out array of pred is already allocated */
-		set_out_edges_node(def, obst);
-
-		/* Remember this Def-Use edge */
-		unsigned pos = def->o.out->n_edges++;
-		def->o.out->edges[pos].use = node;
-		def->o.out->edges[pos].pos = i;
-	}
-}
-
-static void set_out_edges(ir_graph *irg)
+static void set_out_edges(ir_graph *irg, const outs_env_t *env)
 {
 	struct obstack *obst = &irg->out_obst;
 	obstack_init(obst);
 	irg->out_obst_allocated = true;
 
-	inc_irg_visited(irg);
-	set_out_edges_node(get_irg_end(irg), obst);
-	foreach_irn_in(get_irg_anchor(irg), i, n) {
-		if (irn_visited_else_mark(n))
-			continue;
-		n->o.out          = OALLOCF(obst, ir_def_use_edges, edges, 0);
-		n->o.out->n_edges = 0;
+	size_t const size = env->n_nodes * sizeof(ir_def_use_edges)
+	                  + env->n_edges * sizeof(ir_def_use_edge);
+	char *mem = (char*)obstack_alloc(obst, size);
+	for (size_t i = 0; i < env->n_nodes; ++i) {
+		ir_node *node   = env->nodes[i];
+		unsigned n_outs = node->o.n_outs;
+		node->o.out          = (ir_def_use_edges*)mem;
+		node->o.out->n_edges = 0;
+		mem += sizeof(ir_def_use_edges) + n_outs * sizeof(ir_def_use_edge);
+	}
+
+	for (size_t i = 0; i < env->n_users; ++i) {
+		ir_node *node  = env->nodes[i];
+		int      start = is_Block(node) ? 0 : -1;
+		for (int j = start, arity = get_irn_arity(node); j < arity; ++j) {
+			ir_def_use_edges *out = get_irn_n(node, j)->o.out;
+			unsigned          pos = out->n_edges++;
+			out->edges[pos].use = node;
+			out->edges[pos].pos = j;
+		}
 	}
 }
 
@@ -303,13 +289,13 @@ void compute_irg_outs(ir_graph *irg)
 {
 	free_irg_outs(irg);
 
-	/* This first iteration counts the overall number of out edges and the
-	   number of out edges for each node. */
-	count_outs(irg);
-
-	/* The second iteration splits the irg->outs array into smaller arrays
-	   for each node and writes the back edges into this array. */
-	set_out_edges(irg);
+	outs_env_t env;
+	env.nodes   = XMALLOCN(ir_node*, get_irg_last_idx(irg));
+	env.n_nodes = 0;
+	env.n_edges = 0;
+	count_outs(irg, &env);
+	set_out_edges(irg, &env);
+	free(env.nodes);
 
 	add_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
 }
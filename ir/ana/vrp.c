@@ -10,7 +10,9 @@
  */
 #include "vrp.h"
 
+#include "array.h"
 #include "bitset.h"
+#include "constbits.h"
 #include "debug.h"
 #include "iredges_t.h"
 #include "irgopt.h"
@@ -19,36 +21,73 @@
 #include "irhooks.h"
 #include "irnodemap.h"
 #include "iroptimize.h"
-#include "irouts_t.h"
 #include "irprintf.h"
+#include "lock.h"
 #include "pdeq.h"
 #include "tv.h"
 
-DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+DEBUG_ONLY(static FIRM_THREAD_LOCAL firm_dbg_module_t *dbg;)
+
+/** Number of changes of a Phi before its range is widened. */
+#define VRP_WIDEN_AFTER 1
+/** Number of times a range may shrink again after widening. */
+#define VRP_NARROW_LIMIT 2
+
+/** Per node state. The attribute is first so the node map can hand it out. */
+typedef struct vrp_node_t {
+	vrp_attr attr;
+	unsigned n_changes; /**< number of changes so far */
+	unsigned n_narrows; /**< number of range reductions so far */
+	unsigned dfs_num;   /**< preorder number in the SCC search, 0 if unseen */
+	unsigned low;       /**< smallest dfs_num reachable from the node */
+	unsigned scc;       /**< number of the SCC of the node, 0 if open */
+	bool     on_stack;  /**< the node is on the SCC stack */
+	bool     self_use;  /**< the node is computed from itself */
+	bool     widened;   /**< the range was widened */
+} vrp_node_t;
+
+/** A node whose operands are being searched for SCCs. */
+typedef struct vrp_frame_t {
+	ir_node    *node;
+	vrp_node_t *vn;
+	int         pos;  /**< next operand to search */
+} vrp_frame_t;
 
 typedef struct vrp_env_t {
-	deq_t        workqueue;
-	bitset_t    *visited;
-	ir_vrp_info *info;
+	deq_t         worklist;
+	bitset_t     *in_worklist;
+	ir_vrp_info  *info;
+	vrp_frame_t  *frames;   /**< search path of the SCC search */
+	ir_node     **stack;    /**< nodes of SCCs which are not complete yet */
+	unsigned      n_dfs;    /**< last dfs_num handed out */
+	unsigned      n_sccs;   /**< number of completed SCCs */
+	unsigned      n_visits;
 } vrp_env_t;
 
-static vrp_attr *vrp_get_or_set_info(ir_vrp_info *info, const ir_node *node)
+/** A value range, the lattice element of the analysis. */
+typedef struct vrp_range_t {
+	enum range_types type;
+	ir_tarval       *bottom;
+	ir_tarval       *top;
+} vrp_range_t;
+
+static vrp_node_t *vrp_get_or_set_node(ir_vrp_info *info, const ir_node *node)
 {
-	vrp_attr *attr = ir_nodemap_get(vrp_attr, &info->infos, node);
-	if (attr == NULL) {
+	vrp_node_t *vn = ir_nodemap_get(vrp_node_t, &info->infos, node);
+	if (vn == NULL) {
 		ir_mode *mode = get_irn_mode(node);
 		assert(mode_is_int(mode));
 
-		attr = OALLOCZ(&info->obst, vrp_attr);
-		attr->range_type   = VRP_UNDEFINED;
-		attr->bits_set     = get_mode_null(mode);
-		attr->bits_not_set = get_mode_all_one(mode);
-		attr->range_bottom = tarval_bad;
-		attr->range_top    = tarval_bad;
+		vn = OALLOCZ(&info->obst, vrp_node_t);
+		vn->attr.range_type   = VRP_UNDEFINED;
+		vn->attr.bits_set     = get_mode_null(mode);
+		vn->attr.bits_not_set = get_mode_all_one(mode);
+		vn->attr.range_bottom = tarval_bad;
+		vn->attr.range_top    = tarval_bad;
 
-		ir_nodemap_insert(&info->infos, node, attr);
+		ir_nodemap_insert(&info->infos, node, vn);
 	}
-	return attr;
+	return vn;
 }
 
 vrp_attr *vrp_get_info(const ir_node *node)
@@ -59,424 +98,672 @@ vrp_attr *vrp_get_info(const ir_node *node)
 	return ir_nodemap_get(vrp_attr, &irg->vrp.infos, node);
 }
 
-static int vrp_update_node(ir_vrp_info *info, ir_node *node)
+static ir_tarval *tv_min(ir_tarval *a, ir_tarval *b)
 {
-	ir_tarval       *new_bits_set      = get_tarval_bad();
-	ir_tarval       *new_bits_not_set  = get_tarval_bad();
-	ir_tarval       *new_range_bottom  = get_tarval_bad();
-	ir_tarval       *new_range_top     = get_tarval_bad();
-	enum range_types new_range_type    = VRP_UNDEFINED;
-	bool             something_changed = false;
-	if (!mode_is_int(get_irn_mode(node))) {
-		return 0; /* we don't optimize for non-int-nodes*/
-	}
-
-	vrp_attr *vrp = vrp_get_or_set_info(info, node);
-
-	/* TODO: Check if all predecessors have valid VRP information*/
+	return tarval_cmp(a, b) == ir_relation_greater ? b : a;
+}
 
-	switch (get_irn_opcode(node)) {
-	case iro_Const: {
-		ir_tarval *tv = get_Const_tarval(node);
-		new_bits_set = tv;
-		new_bits_not_set = tv;
-		new_range_bottom = tv;
-		new_range_top = tv;
-		new_range_type = VRP_RANGE;
-		break;
-	}
-	case iro_And: {
-		const vrp_attr *vrp_left, *vrp_right;
-		const ir_node *left, *right;
+static ir_tarval *tv_max(ir_tarval *a, ir_tarval *b)
+{
+	return tarval_cmp(a, b) == ir_relation_less ? b : a;
+}
 
-		left = get_And_left(node);
-		right = get_And_right(node);
-		vrp_left = vrp_get_or_set_info(info, left);
-		vrp_right = vrp_get_or_set_info(info, right);
-		new_bits_set = tarval_and(vrp_left->bits_set, vrp_right->bits_set);
-		new_bits_not_set = tarval_and(vrp_left->bits_not_set, vrp_right->bits_not_set);
+static vrp_range_t range_make(enum range_types type, ir_tarval *bottom,
+                              ir_tarval *top)
+{
+	vrp_range_t range = { type, bottom, top };
+	return range;
+}
 
-		break;
-	}
+static vrp_range_t range_varying(void)
+{
+	return range_make(VRP_VARYING, tarval_bad, tarval_bad);
+}
 
-	case iro_Add: {
-		const vrp_attr *vrp_left  = vrp_get_or_set_info(info, get_Add_left(node));
-		const vrp_attr *vrp_right = vrp_get_or_set_info(info, get_Add_right(node));
+/**
+ * Creates the range [bottom, top] for bounds known to be ordered, which is
+ * varying if it covers the whole mode or a bound overflowed.
+ */
+static vrp_range_t range_ordered(ir_tarval *bottom, ir_tarval *top)
+{
+	if (bottom == tarval_bad || top == tarval_bad)
+		return range_varying();
+	ir_mode *mode = get_tarval_mode(bottom);
+	if (bottom == get_mode_min(mode) && top == get_mode_max(mode))
+		return range_varying();
+	return range_make(VRP_RANGE, bottom, top);
+}
 
-		if (vrp_left->range_type == VRP_UNDEFINED
-		 || vrp_right->range_type == VRP_UNDEFINED
-		 || vrp_left->range_type == VRP_VARYING
-		 || vrp_right->range_type == VRP_VARYING) {
-			return 0;
-		}
+/**
+ * Creates the range [bottom, top], which is empty and thus undefined if
+ * bottom > top and varying if it covers the whole mode.
+ */
+static vrp_range_t range_interval(ir_tarval *bottom, ir_tarval *top)
+{
+	if (bottom != tarval_bad && top != tarval_bad
+	    && tarval_cmp(bottom, top) == ir_relation_greater)
+		return range_make(VRP_UNDEFINED, tarval_bad, tarval_bad);
+	return range_ordered(bottom, top);
+}
 
-		if (vrp_left->range_type == VRP_RANGE
-		 && vrp_right->range_type == VRP_RANGE) {
-			int old_wrap_on_overflow = tarval_get_wrap_on_overflow();
-			tarval_set_wrap_on_overflow(false);
-			ir_tarval *new_top
-				= tarval_add(vrp_left->range_top, vrp_right->range_top);
-			ir_tarval *new_bottom
-				= tarval_add(vrp_left->range_bottom, vrp_right->range_bottom);
-			tarval_set_wrap_on_overflow(old_wrap_on_overflow);
-
-			if (new_top != tarval_bad && new_bottom != tarval_bad) {
-				new_range_bottom = new_bottom;
-				new_range_top    = new_top;
-				new_range_type   = VRP_RANGE;
-			} else {
-				/* TODO Implement overflow handling*/
-				new_range_type = VRP_UNDEFINED;
-			}
-		}
-		break;
-	}
+static bool range_equal(const vrp_range_t *a, const vrp_range_t *b)
+{
+	return a->type == b->type && a->bottom == b->bottom && a->top == b->top;
+}
 
-	case iro_Sub: {
-		ir_node *left  = get_Sub_left(node);
-		ir_node *right = get_Sub_right(node);
+/** Returns the smallest range containing both @p a and @p b. */
+static vrp_range_t range_join(vrp_range_t a, vrp_range_t b)
+{
+	if (a.type == VRP_UNDEFINED)
+		return b;
+	if (b.type == VRP_UNDEFINED || range_equal(&a, &b))
+		return a;
+	if (a.type == VRP_RANGE && b.type == VRP_RANGE)
+		return range_ordered(tv_min(a.bottom, b.bottom),
+		                     tv_max(a.top, b.top));
+	return range_varying();
+}
 
-		if (!mode_is_int(get_irn_mode(left)))
-			return 0;
+/**
+ * Widens the range @p next of a node whose range was @p prev before: bounds
+ * which still move are dropped to the limits of the mode.
+ */
+static vrp_range_t range_widen(vrp_range_t prev, vrp_range_t next, ir_mode *mode)
+{
+	if (prev.type != VRP_RANGE || next.type != VRP_RANGE)
+		return next;
+	/* next contains prev, so moving bounds are the ones not equal */
+	ir_tarval *bottom = next.bottom != prev.bottom ? get_mode_min(mode)
+	                                               : next.bottom;
+	ir_tarval *top    = next.top != prev.top ? get_mode_max(mode) : next.top;
+	return range_ordered(bottom, top);
+}
 
-		const vrp_attr *vrp_left  = vrp_get_or_set_info(info, left);
-		const vrp_attr *vrp_right = vrp_get_or_set_info(info, right);
+/**
+ * Restricts @p range to the values possible with the known bits @p min (the
+ * bits which are set) and @p max (the bits which may be set). The bits bound
+ * the value from below and above unless the sign is unknown.
+ */
+static vrp_range_t range_restrict_bits(vrp_range_t range, ir_tarval *min,
+                                       ir_tarval *max, ir_mode *mode)
+{
+	if (range.type == VRP_UNDEFINED
+	    || (range.type == VRP_RANGE && range.bottom == range.top)
+	    || (tarval_is_null(min) && max == get_mode_all_one(mode)))
+		return range;
+	if (mode_is_signed(mode)
+	    && tarval_is_negative(min) != tarval_is_negative(max))
+		return range;
+	vrp_range_t bits = range_interval(min, max);
+	if (bits.type != VRP_RANGE)
+		return range;
+	if (range.type != VRP_RANGE)
+		return bits;
+	return range_interval(tv_max(range.bottom, min), tv_min(range.top, max));
+}
 
-		if (vrp_left->range_type == VRP_UNDEFINED
-		 || vrp_right->range_type == VRP_UNDEFINED
-		 || vrp_left->range_type == VRP_VARYING
-		 || vrp_right->range_type == VRP_VARYING) {
-			return 0;
-		}
+/**
+ * Returns the intersection of @p a and @p b if it is a range and @p a
+ * otherwise.
+ */
+static vrp_range_t range_meet(vrp_range_t a, vrp_range_t b)
+{
+	if (b.type != VRP_RANGE || a.type == VRP_UNDEFINED
+	    || a.type == VRP_ANTIRANGE)
+		return a;
+	if (a.type == VRP_VARYING)
+		return b;
+	vrp_range_t res = range_interval(tv_max(a.bottom, b.bottom),
+	                                 tv_min(a.top, b.top));
+	return res.type == VRP_RANGE ? res : a;
+}
 
-		if (vrp_left->range_type == VRP_RANGE
-		 && vrp_right->range_type == VRP_RANGE) {
-			int old_wrap_on_overflow = tarval_get_wrap_on_overflow();
-			tarval_set_wrap_on_overflow(false);
-			ir_tarval *new_top = tarval_sub(vrp_left->range_top, vrp_right->range_bottom);
-			ir_tarval *new_bottom = tarval_sub(vrp_left->range_bottom, vrp_right->range_top);
-			tarval_set_wrap_on_overflow(old_wrap_on_overflow);
-
-			if (new_top != tarval_bad && new_bottom != tarval_bad) {
-				new_range_bottom = new_bottom;
-				new_range_top = new_top;
-				new_range_type = VRP_RANGE;
-			} else {
-				/* TODO Implement overflow handling*/
-				new_range_type = VRP_UNDEFINED;
-			}
-		}
-		break;
+static vrp_range_t range_add_sub(vrp_range_t l, vrp_range_t r, bool sub)
+{
+	if (l.type == VRP_UNDEFINED || r.type == VRP_UNDEFINED)
+		return range_make(VRP_UNDEFINED, tarval_bad, tarval_bad);
+	if (l.type != VRP_RANGE || r.type != VRP_RANGE)
+		return range_varying();
+
+	int old_wrap_on_overflow = tarval_get_wrap_on_overflow();
+	tarval_set_wrap_on_overflow(false);
+	ir_tarval *bottom;
+	ir_tarval *top;
+	if (sub) {
+		bottom = tarval_sub(l.bottom, r.top);
+		top    = tarval_sub(l.top, r.bottom);
+	} else {
+		bottom = tarval_add(l.bottom, r.bottom);
+		top    = tarval_add(l.top, r.top);
 	}
+	tarval_set_wrap_on_overflow(old_wrap_on_overflow);
+	/* without an overflow the bounds stay ordered */
+	return range_ordered(bottom, top);
+}
 
-	case iro_Or: {
-		const vrp_attr *vrp_left, *vrp_right;
-
-		vrp_left = vrp_get_or_set_info(info, get_Or_left(node));
-		vrp_right = vrp_get_or_set_info(info, get_Or_right(node));
-
-		new_bits_set = tarval_or(vrp_left->bits_set, vrp_right->bits_set);
-		new_bits_not_set = tarval_or(vrp_left->bits_not_set, vrp_right->bits_not_set);
+static vrp_range_t range_conv(vrp_range_t op, ir_mode *mode)
+{
+	if (op.type != VRP_RANGE)
+		return op.type == VRP_UNDEFINED ? op : range_varying();
+
+	/* both bounds must survive the conversion and stay ordered, otherwise
+	 * the range wraps around */
+	ir_mode   *op_mode = get_tarval_mode(op.bottom);
+	ir_tarval *bottom  = tarval_convert_to(op.bottom, mode);
+	ir_tarval *top     = tarval_convert_to(op.top, mode);
+	if (tarval_convert_to(bottom, op_mode) != op.bottom
+	    || tarval_convert_to(top, op_mode) != op.top
+	    || tarval_cmp(bottom, top) == ir_relation_greater)
+		return range_varying();
+	return range_ordered(bottom, top);
+}
 
-		break;
+static vrp_range_t range_confirm(vrp_range_t op, ir_relation relation,
+                                 vrp_range_t bound, ir_mode *mode)
+{
+	if (op.type == VRP_UNDEFINED || bound.type == VRP_UNDEFINED)
+		return op;
+
+	if (relation == ir_relation_less_greater) {
+		if (op.type == VRP_VARYING && bound.type == VRP_RANGE
+		    && bound.bottom == bound.top)
+			return range_make(VRP_ANTIRANGE, bound.bottom, bound.top);
+		return op;
 	}
-
-	case iro_Shl: {
-		const vrp_attr *vrp_left;
-		const ir_node *right = get_Shl_right(node);
-		vrp_left = vrp_get_or_set_info(info, get_Shl_left(node));
-
-		/* We can only compute this if the right value is a constant*/
-		if (is_Const(right)) {
-			new_bits_set = tarval_shl(vrp_left->bits_set, get_Const_tarval(right));
-			new_bits_not_set = tarval_shl(vrp_left->bits_not_set, get_Const_tarval(right));
-		}
+	if (op.type == VRP_ANTIRANGE || bound.type != VRP_RANGE)
+		return op;
+
+	ir_tarval *bottom = op.type == VRP_RANGE ? op.bottom : get_mode_min(mode);
+	ir_tarval *top    = op.type == VRP_RANGE ? op.top    : get_mode_max(mode);
+	ir_tarval *one    = get_mode_one(mode);
+	switch (relation) {
+	case ir_relation_equal:
+		bottom = tv_max(bottom, bound.bottom);
+		top    = tv_min(top, bound.top);
+		break;
+	case ir_relation_less:
+		if (bound.top == get_mode_min(mode))
+			return op;
+		top = tv_min(top, tarval_sub(bound.top, one));
+		break;
+	case ir_relation_less_equal:
+		top = tv_min(top, bound.top);
 		break;
+	case ir_relation_greater:
+		if (bound.bottom == get_mode_max(mode))
+			return op;
+		bottom = tv_max(bottom, tarval_add(bound.bottom, one));
+		break;
+	case ir_relation_greater_equal:
+		bottom = tv_max(bottom, bound.bottom);
+		break;
+	default:
+		return op;
 	}
+	vrp_range_t res = range_interval(bottom, top);
+	/* an empty range means the Confirm is unreachable */
+	return res.type == VRP_UNDEFINED ? op : res;
+}
 
-	case iro_Shr: {
-		const vrp_attr *vrp_left;
-		const ir_node *right = get_Shr_right(node);
-
-		vrp_left = vrp_get_or_set_info(info, get_Shr_left(node));
+/** Returns whether control flow can reach the block through input @p pos. */
+static bool cfgpred_reachable(const ir_node *block, int pos)
+{
+	const bitinfo *b = try_get_bitinfo(get_Block_cfgpred(block, pos));
+	return b == NULL || b->z != tarval_b_false;
+}
 
-		/* We can only compute this if the right value is a constant*/
-		if (is_Const(right)) {
-			new_bits_set = tarval_shr(vrp_left->bits_set, get_Const_tarval(right));
-			new_bits_not_set = tarval_shr(vrp_left->bits_not_set, get_Const_tarval(right));
-		}
-		break;
+/** Returns whether the value of @p node is computed from operand @p pred. */
+static bool vrp_uses_operand(const ir_node *node, const ir_node *pred)
+{
+	switch (get_irn_opcode(node)) {
+	case iro_Add:
+	case iro_And:
+	case iro_Confirm:
+	case iro_Conv:
+	case iro_Eor:
+	case iro_Id:
+	case iro_Not:
+	case iro_Or:
+	case iro_Phi:
+	case iro_Shl:
+	case iro_Shr:
+	case iro_Shrs:
+	case iro_Sub:
+		return mode_is_int(get_irn_mode(pred));
+	default:
+		return false;
 	}
+}
 
-	case iro_Shrs: {
-		const vrp_attr *vrp_left;
-		const ir_node *right = get_Shrs_right(node);
+/**
+ * Returns the bits set in both @p a and @p b. Most known bits are all or
+ * nothing, which needs no tarval operation.
+ */
+static ir_tarval *bits_and(ir_tarval *a, ir_tarval *b, ir_mode *mode)
+{
+	if (a == b || a == get_mode_null(mode) || b == get_mode_all_one(mode))
+		return a;
+	if (b == get_mode_null(mode) || a == get_mode_all_one(mode))
+		return b;
+	return tarval_and(a, b);
+}
 
-		vrp_left = vrp_get_or_set_info(info, get_Shrs_left(node));
+/** Returns the bits set in @p a or @p b, see bits_and(). */
+static ir_tarval *bits_or(ir_tarval *a, ir_tarval *b, ir_mode *mode)
+{
+	if (a == b || a == get_mode_all_one(mode) || b == get_mode_null(mode))
+		return a;
+	if (b == get_mode_all_one(mode) || a == get_mode_null(mode))
+		return b;
+	return tarval_or(a, b);
+}
 
-		/* We can only compute this if the right value is a constant*/
-		if (is_Const(right)) {
-			new_bits_set = tarval_shrs(vrp_left->bits_set, get_Const_tarval(right));
-			new_bits_not_set = tarval_shrs(vrp_left->bits_not_set, get_Const_tarval(right));
-		}
-		break;
-	}
+static const vrp_attr *vrp_attr_of(ir_vrp_info *info, const ir_node *node)
+{
+	return &vrp_get_or_set_node(info, node)->attr;
+}
 
-	case iro_Eor: {
-		const vrp_attr *vrp_left, *vrp_right;
+static vrp_range_t range_of_attr(const vrp_attr *attr)
+{
+	return range_make(attr->range_type, attr->range_bottom, attr->range_top);
+}
 
-		vrp_left = vrp_get_or_set_info(info, get_Eor_left(node));
-		vrp_right = vrp_get_or_set_info(info, get_Eor_right(node));
+static bool attr_defined(const vrp_attr *attr)
+{
+	return attr->range_type != VRP_UNDEFINED;
+}
 
-		new_bits_set = tarval_or(tarval_and(vrp_left->bits_set, tarval_not(vrp_right->bits_not_set)),
-		                         tarval_and(tarval_not(vrp_left->bits_not_set), vrp_right->bits_set));
+static vrp_range_t range_of(ir_vrp_info *info, const ir_node *node)
+{
+	return range_of_attr(vrp_attr_of(info, node));
+}
 
-		new_bits_not_set = tarval_not(tarval_or(tarval_and(vrp_left->bits_set,vrp_right->bits_set),
-		                                        tarval_and(tarval_not(vrp_left->bits_not_set),
-		                                                   tarval_not(vrp_right->bits_not_set))));
+/**
+ * Computes the range and the known bits of @p node from those of its
+ * operands in one go, so each operand is looked up once: @p set receives
+ * the bits which are set, @p not_set the bits which may be set.
+ */
+static vrp_range_t vrp_transfer(ir_vrp_info *info, const ir_node *node,
+                                ir_tarval **set, ir_tarval **not_set)
+{
+	ir_mode *mode = get_irn_mode(node);
+	*set     = get_mode_null(mode);
+	*not_set = get_mode_all_one(mode);
 
-		break;
+	switch (get_irn_opcode(node)) {
+	case iro_Const: {
+		ir_tarval *tv = get_Const_tarval(node);
+		*set     = tv;
+		*not_set = tv;
+		return range_make(VRP_RANGE, tv, tv);
 	}
 
-	case iro_Id: {
-		const vrp_attr *vrp_pred = vrp_get_or_set_info(info, get_Id_pred(node));
-		new_bits_set = vrp_pred->bits_set;
-		new_bits_not_set = vrp_pred->bits_not_set;
-		new_range_top = vrp_pred->range_top;
-		new_range_bottom = vrp_pred->range_bottom;
-		new_range_type = vrp_pred->range_type;
-		break;
+	case iro_Add:
+		return range_add_sub(range_of(info, get_Add_left(node)),
+		                     range_of(info, get_Add_right(node)), false);
+
+	case iro_Sub: {
+		const ir_node *left = get_Sub_left(node);
+		if (!mode_is_int(get_irn_mode(left)))
+			return range_varying();
+		return range_add_sub(range_of(info, left),
+		                     range_of(info, get_Sub_right(node)), true);
 	}
 
-	case iro_Not: {
-		const vrp_attr *vrp_pred = vrp_get_or_set_info(info, get_Not_op(node));
-		new_bits_set = tarval_not(vrp_pred->bits_not_set);
-		new_bits_not_set = tarval_not(vrp_pred->bits_set);
-		break;
+	case iro_Id: {
+		const vrp_attr *op = vrp_attr_of(info, get_Id_pred(node));
+		*set     = op->bits_set;
+		*not_set = op->bits_not_set;
+		return range_of_attr(op);
 	}
 
 	case iro_Conv: {
-		const ir_node *pred = get_Conv_op(node);
-		ir_mode *old_mode = get_irn_mode(pred);
-		const vrp_attr *vrp_pred;
-
-		ir_mode *new_mode;
-
-		if (!mode_is_int(old_mode))
-			return 0;
-
-		vrp_pred = vrp_get_or_set_info(info, pred);
-		new_mode = get_irn_mode(node);
-
-		/* The second and is needed if target type is smaller*/
-		new_bits_not_set = tarval_convert_to(get_mode_all_one(old_mode), new_mode);
-		new_bits_not_set = tarval_and(new_bits_not_set, tarval_convert_to(vrp_pred->bits_not_set, new_mode));
-		new_bits_set = tarval_and(new_bits_not_set,
-		                          tarval_convert_to(vrp_pred->bits_set, new_mode));
-
-		/* Matze: TODO, BUGGY, tarval_cmp never returns ir_relation_less_equal */
-		if (tarval_cmp(vrp_pred->range_top, get_mode_max(new_mode)) == ir_relation_less_equal) {
-			vrp->range_top = vrp_pred->range_top;
-		}
-
-		/* Matze: TODO, BUGGY, tarval_cmp never returns ir_relation_greater_equal */
-		if (tarval_cmp(vrp_pred->range_bottom, get_mode_min(new_mode)) == ir_relation_greater_equal) {
-			vrp->range_bottom = vrp_pred->range_bottom;
-		}
-		break;
+		const ir_node *op      = get_Conv_op(node);
+		ir_mode       *op_mode = get_irn_mode(op);
+		if (!mode_is_int(op_mode))
+			return range_varying();
+		/* extending the sign bit keeps it unknown if it was */
+		const vrp_attr *a = vrp_attr_of(info, op);
+		*set     = tarval_convert_to(a->bits_set, mode);
+		*not_set = tarval_convert_to(a->bits_not_set, mode);
+		return range_conv(range_of_attr(a), mode);
 	}
 
 	case iro_Confirm: {
-		const ir_relation relation = get_Confirm_relation(node);
-		const ir_node    *bound    = get_Confirm_bound(node);
-
-
-		if (relation == ir_relation_less_greater) {
-			/** @todo: Handle non-Const bounds */
-			if (is_Const(bound)) {
-				new_range_type = VRP_ANTIRANGE;
-				new_range_top = get_Const_tarval(bound);
-				new_range_bottom = get_Const_tarval(bound);
-			}
-		} else if (relation == ir_relation_less_equal) {
-			if (is_Const(bound)) {
-				new_range_type = VRP_RANGE;
-				new_range_top = get_Const_tarval(bound);
-				new_range_bottom = get_mode_min(get_irn_mode(node));
-			}
-		}
-		break;
+		const ir_node  *bound = get_Confirm_bound(node);
+		const vrp_attr *op    = vrp_attr_of(info, get_Confirm_value(node));
+		*set     = op->bits_set;
+		*not_set = op->bits_not_set;
+		if (get_irn_mode(bound) != mode)
+			return range_of_attr(op);
+		return range_confirm(range_of_attr(op), get_Confirm_relation(node),
+		                     range_of(info, bound), mode);
 	}
 
 	case iro_Phi: {
-		/* combine all ranges*/
-		const ir_node *pred = get_Phi_pred(node,0);
-		const vrp_attr *vrp_pred = vrp_get_or_set_info(info, pred);
-		new_range_top    = vrp_pred->range_top;
-		new_range_bottom = vrp_pred->range_bottom;
-		new_range_type   = vrp_pred->range_type;
-		new_bits_set     = vrp_pred->bits_set;
-		new_bits_not_set = vrp_pred->bits_not_set;
-
-		for (int i = 1, num = get_Phi_n_preds(node); i < num; i++) {
-			pred = get_Phi_pred(node, i);
-			vrp_pred = vrp_get_or_set_info(info, pred);
-			if (new_range_type == VRP_RANGE && vrp_pred->range_type == VRP_RANGE) {
-				ir_relation relation = tarval_cmp(new_range_top, vrp_pred->range_top);
-				if (relation == ir_relation_less) {
-					new_range_top = vrp_pred->range_top;
-				}
-				relation = tarval_cmp(new_range_bottom, vrp_pred->range_bottom);
-				if (relation == ir_relation_greater) {
-					new_range_bottom = vrp_pred->range_bottom;
-				}
+		/* only values flowing in over reachable control flow count */
+		const ir_node *block   = get_nodes_block(node);
+		vrp_range_t    res     = range_make(VRP_UNDEFINED, tarval_bad,
+		                                    tarval_bad);
+		bool           defined = false;
+		foreach_irn_in(node, i, pred) {
+			if (!cfgpred_reachable(block, i))
+				continue;
+			const vrp_attr *a = vrp_attr_of(info, pred);
+			if (!attr_defined(a))
+				continue;
+			res = range_join(res, range_of_attr(a));
+			if (defined) {
+				*set     = bits_and(*set, a->bits_set, mode);
+				*not_set = bits_or(*not_set, a->bits_not_set, mode);
 			} else {
-				new_range_type = VRP_VARYING;
+				*set     = a->bits_set;
+				*not_set = a->bits_not_set;
+				defined  = true;
 			}
-			new_bits_set = tarval_and(new_bits_set, vrp_pred->bits_set);
-			new_bits_not_set = tarval_or(new_bits_not_set,
-			                             vrp_pred->bits_not_set);
 		}
-
-		break;
+		return res;
 	}
-	default:
-		/* unhandled, therefore never updated */
-		break;
-	}
-
-
-
-	/* TODO: Check, if there can be information derived from any of these:
-	is_Abs(node) is_Address(node) is_Alloc(node) is_Anchor(node) is_Borrow(node)
-	is_Bound(node) is_Break(node) is_Builtin(node) is_Call(node)
-	is_Carry(node) is_Cmp(node) is_Cond(node)
-	is_CopyB(node) is_Div(node) is_Dummy(node)
-	is_End(node) is_Free(node)
-	is_IJmp(node) is_Jmp(node) is_Load(node) is_Minus(node) is_Member(node)
-	is_Mod(node) is_Mul(node) is_Mulh(node) is_Mux(node) is_NoMem(node)
-	is_Offset(node) is_Pin(node) is_Proj(node)
-	is_Raise(node) is_Return(node) is_Sel(node) is_Start(node) is_Store(node)
-	is_Sync(node) is_Tuple(node) is_TypeConst(node)
-	*/
 
-	/* @todo: At this place, we check if the mode of the variable changed. A
-	 * better place for this might be in the convopt.c file
-	 */
+	/* the known bits are all we have for the bitwise operations */
+	case iro_And: {
+		const vrp_attr *l = vrp_attr_of(info, get_And_left(node));
+		const vrp_attr *r = vrp_attr_of(info, get_And_right(node));
+		if (!attr_defined(l) || !attr_defined(r))
+			break;
+		*set     = bits_and(l->bits_set, r->bits_set, mode);
+		*not_set = bits_and(l->bits_not_set, r->bits_not_set, mode);
+		return range_varying();
+	}
 
-	if (new_bits_set != tarval_bad && get_tarval_mode(new_bits_set) != get_tarval_mode(vrp->bits_set)) {
-		vrp->bits_set = tarval_convert_to(vrp->bits_set, get_irn_mode(node));
+	case iro_Or: {
+		const vrp_attr *l = vrp_attr_of(info, get_Or_left(node));
+		const vrp_attr *r = vrp_attr_of(info, get_Or_right(node));
+		if (!attr_defined(l) || !attr_defined(r))
+			break;
+		*set     = bits_or(l->bits_set, r->bits_set, mode);
+		*not_set = bits_or(l->bits_not_set, r->bits_not_set, mode);
+		return range_varying();
 	}
-	if (new_bits_not_set != tarval_bad && get_tarval_mode(new_bits_not_set) != get_tarval_mode(vrp->bits_not_set)) {
-		vrp->bits_not_set = tarval_convert_to(vrp->bits_not_set, get_irn_mode(node));
+
+	case iro_Eor: {
+		const vrp_attr *l = vrp_attr_of(info, get_Eor_left(node));
+		const vrp_attr *r = vrp_attr_of(info, get_Eor_right(node));
+		if (!attr_defined(l) || !attr_defined(r))
+			break;
+		/* a bit is known if it is known in both operands */
+		ir_tarval *known = tarval_and(
+			tarval_or(l->bits_set, tarval_not(l->bits_not_set)),
+			tarval_or(r->bits_set, tarval_not(r->bits_not_set)));
+		ir_tarval *value = tarval_eor(l->bits_set, r->bits_set);
+		*set     = tarval_and(value, known);
+		*not_set = tarval_or(value, tarval_not(known));
+		return range_varying();
 	}
 
-	if (vrp->range_type != VRP_UNDEFINED && new_range_type != VRP_UNDEFINED && get_tarval_mode(new_range_top) != get_tarval_mode(vrp->range_top)) {
-		/* @todo: We might be able to preserve this range information if it
-		 * fits in */
-		vrp->range_type = VRP_VARYING;
+	case iro_Not: {
+		const vrp_attr *op = vrp_attr_of(info, get_Not_op(node));
+		if (!attr_defined(op))
+			break;
+		*set     = tarval_not(op->bits_not_set);
+		*not_set = tarval_not(op->bits_set);
+		return range_varying();
 	}
 
-	/* Merge the newly calculated values with those that might already exist*/
-	if (new_bits_set != tarval_bad) {
-		new_bits_set = tarval_or(new_bits_set, vrp->bits_set);
-		if (new_bits_set != vrp->bits_set) {
-			something_changed = true;
-			vrp->bits_set     = new_bits_set;
+	case iro_Shl:
+	case iro_Shr:
+	case iro_Shrs: {
+		const ir_node  *right = get_binop_right(node);
+		const vrp_attr *l     = vrp_attr_of(info, get_binop_left(node));
+		if (!attr_defined(l) || (mode_is_int(get_irn_mode(right))
+		                         && !attr_defined(vrp_attr_of(info, right))))
+			break;
+		/* we can only compute this if the shift amount is a constant */
+		if (!is_Const(right))
+			return range_varying();
+		ir_tarval *amount = get_Const_tarval(right);
+		if (is_Shl(node)) {
+			*set     = tarval_shl(l->bits_set, amount);
+			*not_set = tarval_shl(l->bits_not_set, amount);
+		} else if (is_Shr(node)) {
+			*set     = tarval_shr(l->bits_set, amount);
+			*not_set = tarval_shr(l->bits_not_set, amount);
+		} else {
+			*set     = tarval_shrs(l->bits_set, amount);
+			*not_set = tarval_shrs(l->bits_not_set, amount);
 		}
+		return range_varying();
 	}
-	if (new_bits_not_set != tarval_bad) {
-		new_bits_not_set = tarval_and(new_bits_not_set, vrp->bits_not_set);
 
-		if (new_bits_not_set != vrp->bits_not_set) {
-			something_changed = true;
-			vrp->bits_not_set = new_bits_not_set;
-		}
+	default:
+		/* unhandled, the known bits are all we have */
+		return range_varying();
 	}
+	/* an undefined operand of a bitwise operation */
+	return range_make(VRP_UNDEFINED, tarval_bad, tarval_bad);
+}
 
-	if (vrp->range_type == VRP_UNDEFINED &&
-	    new_range_type != VRP_UNDEFINED) {
-		something_changed = true;
-		vrp->range_type = new_range_type;
-		vrp->range_bottom = new_range_bottom;
-		vrp->range_top = new_range_top;
-
-	} else if (vrp->range_type == VRP_RANGE) {
-		if (new_range_type == VRP_RANGE) {
-			if (tarval_cmp(vrp->range_bottom, new_range_bottom) == ir_relation_less) {
-				something_changed = true;
-				vrp->range_bottom = new_range_bottom;
-			}
-			if (tarval_cmp(vrp->range_top, new_range_top) == ir_relation_greater) {
-				something_changed = true;
-				vrp->range_top    = new_range_top;
+/**
+ * Updates the range of @p node. While widening, ranges only grow, so the
+ * analysis terminates. The narrowing afterwards only shrinks them a limited
+ * number of times, which recovers the bounds lost by widening.
+ * @return true if it changed
+ */
+static bool vrp_update_node(vrp_env_t *env, const ir_node *node,
+                            vrp_node_t *vn, bool narrow)
+{
+	ir_vrp_info *info = env->info;
+	if (narrow && vn->n_narrows >= VRP_NARROW_LIMIT)
+		return false;
+	++env->n_visits;
+
+	ir_mode     *mode = get_irn_mode(node);
+	vrp_attr    *attr = &vn->attr;
+	vrp_range_t  prev = range_make(attr->range_type, attr->range_bottom,
+	                               attr->range_top);
+
+	/* the known bits only grow less precise, like the ranges before the
+	 * narrowing, and need no widening as there are only finitely many */
+	ir_tarval  *bits_set;
+	ir_tarval  *bits_not;
+	vrp_range_t next = vrp_transfer(info, node, &bits_set, &bits_not);
+	if (narrow || next.type == VRP_UNDEFINED) {
+		bits_set = attr->bits_set;
+		bits_not = attr->bits_not_set;
+	} else {
+		if (prev.type != VRP_UNDEFINED) {
+			bits_set = bits_and(bits_set, attr->bits_set, mode);
+			bits_not = bits_or(bits_not, attr->bits_not_set, mode);
+		}
+		/* the constant bits analysis may know more if it ran before */
+		const bitinfo *b = try_get_bitinfo(node);
+		if (b != NULL) {
+			ir_tarval *set     = tarval_or(bits_set, b->o);
+			ir_tarval *not_set = tarval_and(bits_not, b->z);
+			if (tarval_is_null(tarval_andnot(set, not_set))) {
+				bits_set = set;
+				bits_not = not_set;
 			}
 		}
+	}
 
-		if (new_range_type == VRP_ANTIRANGE) {
-			/* if they are overlapping, cut the range.*/
-			/* TODO: Maybe we can preserve more information here*/
-			if (tarval_cmp(vrp->range_bottom, new_range_top) == ir_relation_greater &&
-			    tarval_cmp(vrp->range_bottom, new_range_bottom) == ir_relation_greater) {
-				something_changed = true;
-				vrp->range_bottom = new_range_top;
-
-			} else if (tarval_cmp(vrp->range_top, new_range_bottom) == ir_relation_greater &&
-			           tarval_cmp(vrp->range_top, new_range_top) == ir_relation_less) {
-				something_changed = true;
-				vrp->range_top    = new_range_bottom;
-			}
+	next = range_restrict_bits(next, bits_set, bits_not, mode);
+	if (narrow) {
+		next = range_meet(prev, next);
+	} else {
+		next = range_join(prev, next);
+		if (is_Phi(node) && vn->n_changes >= VRP_WIDEN_AFTER) {
+			next        = range_widen(prev, next, mode);
+			vn->widened = true;
+		}
+	}
+	if (range_equal(&prev, &next) && bits_set == attr->bits_set
+	    && bits_not == attr->bits_not_set)
+		return false;
+
+	DB((dbg, LEVEL_3, "%+F: range %d [%T, %T]\n", node, (int)next.type,
+	    next.bottom, next.top));
+	if (narrow)
+		++vn->n_narrows;
+	else
+		++vn->n_changes;
+	attr->range_type   = next.type;
+	attr->range_bottom = next.bottom;
+	attr->range_top    = next.top;
+	attr->bits_set     = bits_set;
+	attr->bits_not_set = bits_not;
+	return true;
+}
 
-			/* We can not handle the case where the anti range is in the*/
-			/* range*/
+static void vrp_enqueue(vrp_env_t *env, ir_node *node)
+{
+	unsigned idx = get_irn_idx(node);
+	if (bitset_is_set(env->in_worklist, idx))
+		return;
+	bitset_set(env->in_worklist, idx);
+	deq_push_pointer_right(&env->worklist, node);
+}
 
+/** Propagates along the def-use edges of changed values inside an SCC. */
+static void vrp_propagate(vrp_env_t *env, unsigned scc, bool narrow)
+{
+	while (!deq_empty(&env->worklist)) {
+		ir_node    *node = deq_pop_pointer_left(ir_node, &env->worklist);
+		vrp_node_t *vn   = vrp_get_or_set_node(env->info, node);
+		bitset_clear(env->in_worklist, get_irn_idx(node));
+		if (!vrp_update_node(env, node, vn, narrow))
+			continue;
+		foreach_out_edge(node, edge) {
+			ir_node *succ = get_edge_src_irn(edge);
+			if (is_Block(succ) || !mode_is_int(get_irn_mode(succ)))
+				continue;
+			vrp_node_t *vn = vrp_get_or_set_node(env->info, succ);
+			if (vn->scc == scc)
+				vrp_enqueue(env, succ);
 		}
-	} else if (vrp->range_type == VRP_ANTIRANGE) {
-		if (new_range_type == VRP_ANTIRANGE) {
-			if (tarval_cmp(vrp->range_bottom, new_range_bottom) == ir_relation_greater) {
-				something_changed = true;
-				vrp->range_bottom = new_range_bottom;
-			}
-			if (tarval_cmp(vrp->range_top, new_range_top) == ir_relation_less) {
-				something_changed = true;
-				vrp->range_top    = new_range_top;
-			}
-		}
+	}
+}
 
-		if (new_range_type == VRP_RANGE) {
-			if (tarval_cmp(vrp->range_bottom, new_range_top) == ir_relation_greater) {
-				something_changed = true;
-				vrp->range_bottom = new_range_top;
-			}
-			if (tarval_cmp(vrp->range_top, new_range_bottom) == ir_relation_less) {
-				something_changed = true;
-				vrp->range_top    = new_range_bottom;
-			}
-		}
+/**
+ * Computes the ranges of the SCC @p members, the first of which has the state
+ * @p root_vn. All operands outside of the SCC are final already, so only a
+ * cyclic SCC needs more than one visit per node.
+ */
+static void vrp_solve_scc(vrp_env_t *env, vrp_node_t *root_vn,
+                          ir_node **members, size_t n_members)
+{
+	unsigned scc = ++env->n_sccs;
+	if (n_members == 1 && !root_vn->self_use) {
+		root_vn->on_stack = false;
+		root_vn->scc      = scc;
+		vrp_update_node(env, members[0], root_vn, false);
+		return;
 	}
 
-	assert(tarval_is_null(tarval_and(vrp->bits_set, tarval_not(vrp->bits_not_set))));
-	return something_changed;
+	for (size_t i = 0; i < n_members; ++i) {
+		vrp_node_t *vn = vrp_get_or_set_node(env->info, members[i]);
+		vn->on_stack = false;
+		vn->scc      = scc;
+	}
+	/* the stack holds the members in preorder of the search, so visit them
+	 * in reverse to have most operands computed before their users */
+	for (size_t i = n_members; i-- > 0;)
+		vrp_enqueue(env, members[i]);
+	vrp_propagate(env, scc, false);
+
+	/* narrow starting at the widened Phis */
+	for (size_t i = 0; i < n_members; ++i) {
+		vrp_node_t *vn = vrp_get_or_set_node(env->info, members[i]);
+		if (vn->widened)
+			vrp_enqueue(env, members[i]);
+	}
+	vrp_propagate(env, scc, true);
 }
 
-static void vrp_first_pass(ir_node *n, void *e)
+static void vrp_push_frame(vrp_env_t *env, ir_node *node, vrp_node_t *vn)
 {
-	if (is_Block(n))
-		return;
+	vn->dfs_num  = ++env->n_dfs;
+	vn->low      = vn->dfs_num;
+	vn->on_stack = true;
+	ARR_APP1(ir_node*, env->stack, node);
 
-	vrp_env_t *env = (vrp_env_t*) e;
-	bitset_set(env->visited, get_irn_idx(n));
+	vrp_frame_t frame = { node, vn, 0 };
+	ARR_APP1(vrp_frame_t, env->frames, frame);
+}
 
-	vrp_update_node(env->info, n);
+/**
+ * Searches the SCCs of the operands of @p root with Tarjan's algorithm and
+ * solves each one as soon as it is complete, which is after all SCCs it
+ * depends on.
+ */
+static void vrp_visit(vrp_env_t *env, ir_node *root, vrp_node_t *root_vn)
+{
+	vrp_push_frame(env, root, root_vn);
+	while (ARR_LEN(env->frames) > 0) {
+		vrp_frame_t *frame = &env->frames[ARR_LEN(env->frames) - 1];
+		ir_node     *node  = frame->node;
+		vrp_node_t  *vn    = frame->vn;
+		if (frame->pos < get_irn_arity(node)) {
+			ir_node *pred = get_irn_n(node, frame->pos++);
+			if (!vrp_uses_operand(node, pred))
+				continue;
+			vrp_node_t *pvn = vrp_get_or_set_node(env->info, pred);
+			if (pvn == vn)
+				vn->self_use = true;
+			else if (pvn->dfs_num == 0)
+				vrp_push_frame(env, pred, pvn);
+			else if (pvn->on_stack && pvn->dfs_num < vn->low)
+				vn->low = pvn->dfs_num;
+			continue;
+		}
 
-	foreach_irn_out_r(n, i, succ) {
-		if (bitset_is_set(env->visited, get_irn_idx(succ))) {
-			/* we found a loop*/
-			deq_push_pointer_right(&env->workqueue, succ);
+		ARR_SHRINKLEN(env->frames, ARR_LEN(env->frames) - 1);
+		if (ARR_LEN(env->frames) > 0) {
+			vrp_node_t *pvn = env->frames[ARR_LEN(env->frames) - 1].vn;
+			if (vn->low < pvn->low)
+				pvn->low = vn->low;
 		}
+		if (vn->low != vn->dfs_num)
+			continue;
+
+		size_t first = ARR_LEN(env->stack);
+		while (env->stack[--first] != node) {}
+		vrp_solve_scc(env, vn, &env->stack[first],
+		              ARR_LEN(env->stack) - first);
+		ARR_SHRINKLEN(env->stack, first);
 	}
 }
 
+/** Returns whether the SCCs of all operands of @p node are solved. */
+static bool vrp_operands_solved(ir_vrp_info *info, const ir_node *node)
+{
+	foreach_irn_in(node, i, pred) {
+		if (vrp_uses_operand(node, pred)
+		    && (pred == node || vrp_get_or_set_node(info, pred)->scc == 0))
+			return false;
+	}
+	return true;
+}
+
+static void vrp_visit_node(ir_node *node, void *data)
+{
+	vrp_env_t *env = (vrp_env_t*)data;
+	if (is_Block(node) || !mode_is_int(get_irn_mode(node)))
+		return;
+	vrp_node_t *vn = vrp_get_or_set_node(env->info, node);
+	if (vn->dfs_num != 0)
+		return;
+	/* the walk visits operands first, so outside of loops the node is an
+	 * SCC on its own and needs no search */
+	if (vrp_operands_solved(env->info, node)) {
+		vn->dfs_num = ++env->n_dfs;
+		vn->scc     = ++env->n_sccs;
+		vrp_update_node(env, node, vn, false);
+		return;
+	}
+	vrp_visit(env, node, vn);
+}
+
 static void dump_vrp_info(void *ctx, FILE *F, const ir_node *node)
 {
 	(void)ctx;
@@ -497,6 +784,7 @@ static void dump_vrp_info(void *ctx, FILE *F, const ir_node *node)
 }
 
 static hook_entry_t dump_hook;
+static firm_lock_t  dump_hook_lock = FIRM_LOCK_INIT;
 
 void set_vrp_data(ir_graph *irg)
 {
@@ -505,36 +793,34 @@ void set_vrp_data(ir_graph *irg)
 
 	FIRM_DBG_REGISTER(dbg, "ir.ana.vrp");
 
-	assure_irg_outs(irg); /* ensure that out edges are consistent*/
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
 	ir_nodemap_init(&irg->vrp.infos, irg);
 	obstack_init(&irg->vrp.obst);
-	ir_vrp_info *info = &irg->vrp;
 
+	firm_lock(&dump_hook_lock);
 	if (dump_hook.hook._hook_node_info == NULL) {
 		dump_hook.hook._hook_node_info = dump_vrp_info;
 		register_hook(hook_node_info, &dump_hook);
 	}
-
-	vrp_env_t *env = OALLOCZ(&irg->vrp.obst, vrp_env_t);
-	env->info      = info;
-	deq_init(&env->workqueue);
-
-	env->visited = bitset_malloc(get_irg_last_idx(irg));
-	irg_walk_graph(irg, NULL, vrp_first_pass, env);
-	free(env->visited);
-
-	/* while there are entries in the worklist, continue*/
-	while (!deq_empty(&env->workqueue)) {
-		ir_node *node = deq_pop_pointer_left(ir_node, &env->workqueue);
-
-		if (vrp_update_node(info, node)) {
-			/* if something changed, add successors to worklist*/
-			foreach_irn_out_r(node, i, succ) {
-				deq_push_pointer_right(&env->workqueue, succ);
-			}
-		}
-	}
-	deq_free(&env->workqueue);
+	firm_unlock(&dump_hook_lock);
+
+	vrp_env_t env;
+	env.info        = &irg->vrp;
+	env.frames      = NEW_ARR_F(vrp_frame_t, 0);
+	env.stack       = NEW_ARR_F(ir_node*, 0);
+	env.n_dfs       = 0;
+	env.n_sccs      = 0;
+	env.n_visits    = 0;
+	env.in_worklist = bitset_malloc(get_irg_last_idx(irg));
+	deq_init(&env.worklist);
+	/* operands come first in the walk, which keeps the search paths short */
+	irg_walk_graph(irg, NULL, vrp_visit_node, &env);
+	DB((dbg, LEVEL_1, "%+F: %u node visits\n", irg, env.n_visits));
+
+	deq_free(&env.worklist);
+	free(env.in_worklist);
+	DEL_ARR_F(env.stack);
+	DEL_ARR_F(env.frames);
 }
 
 void free_vrp_data(ir_graph *irg)
@@ -24,6 +24,7 @@
 #include "isas.h"
 #include "lower_builtins.h"
 #include "lower_calls.h"
+#include "lowering.h"
 #include "panic.h"
 #include "target_t.h"
 
@@ -123,6 +124,11 @@ static void TEMPLATE_finish(void)
 
 static void TEMPLATE_lower_for_target(void)
 {
+	foreach_irp_irg(i, irg) {
+		lower_vector(irg, NULL);
+		be_after_transform(irg, "lower-vector");
+	}
+
 	lower_builtins(0, NULL, NULL);
 	be_after_irp_transform("lower-builtins");
 
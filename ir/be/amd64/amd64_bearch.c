@@ -32,6 +32,7 @@
 #include "irgopt.h"
 #include "irgwalk.h"
 #include "iropt_t.h"
+#include "iroptimize.h"
 #include "irtools.h"
 #include "isas.h"
 #include "lower_alloc.h"
@@ -49,6 +50,9 @@ pmap *amd64_constants;
 
 ir_mode *amd64_mode_xmm;
 
+bool amd64_use_avx;
+bool amd64_use_avx2;
+
 static ir_node *create_push(ir_node *node, ir_node *schedpoint, ir_node *sp,
                             ir_node *mem, ir_entity *ent, x86_insn_size_t size)
 {
@@ -398,6 +402,11 @@ static void amd64_collect_frame_entity_nodes(ir_node *node, void *data)
 		if (attr->base.size == X86_SIZE_80) {
 			size     = 12;
 			po2align = 2;
+		} else if (attr->base.size == X86_SIZE_256) {
+			/* ymm registers are spilled with vmovdqu, which needs no
+			 * alignment beyond the one of the stack */
+			size     = 32;
+			po2align = AMD64_PO2_STACK_ALIGNMENT;
 		} else {
 			size     = x86_bytes_from_size(attr->base.size);
 			po2align = log2_floor(size);
@@ -702,37 +711,122 @@ static const ir_settings_arch_dep_t amd64_arch_dep = {
 	.max_bits_for_mulh    = 32,
 };
 
-static void amd64_lower_for_target(void)
+/**
+ * Returns true if SSE2 has a single instruction for the operation @p opcode
+ * on the vector mode @p mode. 256bit vectors need AVX for float and AVX2 for
+ * integer elements.
+ */
+static bool amd64_has_vector_op(unsigned const opcode, ir_mode *const mode)
+{
+	ir_mode *const element_mode = get_mode_vector_element_mode(mode);
+	unsigned const element_size = get_mode_size_bits(element_mode);
+	bool     const is_float     = mode_is_float(element_mode);
+	if (is_float && element_size != 32 && element_size != 64)
+		return false;
+
+	switch (get_mode_size_bits(mode)) {
+	case 128:
+		break;
+	case 256:
+		if (!amd64_use_avx2 && (!is_float || !amd64_use_avx))
+			return false;
+		break;
+	default:
+		return false;
+	}
+
+	switch (opcode) {
+	case iro_Add:
+	case iro_And:
+	case iro_Const:
+	case iro_Eor:
+	case iro_Load:
+	case iro_Minus:
+	case iro_Not:
+	case iro_Or:
+	case iro_Phi:
+	case iro_Store:
+	case iro_Sub:
+	case iro_Unknown:
+		return true;
+	case iro_Mul:
+		/* SSE2 only has a packed 16bit integer multiplication */
+		return is_float || element_size == 16;
+	default:
+		return false;
+	}
+}
+
+/**
+ * Decides which vector operations are kept for the backend.
+ */
+static int amd64_lower_vector_callback(ir_node *const node)
+{
+	ir_mode *mode;
+	switch (get_irn_opcode(node)) {
+	case iro_Load:  mode = get_Load_mode(node);                 break;
+	case iro_Store: mode = get_irn_mode(get_Store_value(node)); break;
+	case iro_Proj:  return is_Load(get_Proj_pred(node));
+	default:        mode = get_irn_mode(node);                  break;
+	}
+	return amd64_has_vector_op(get_irn_opcode(node), mode);
+}
+
+static int amd64_vector_cost(ir_node const *const node, ir_mode *const mode)
+{
+	return amd64_has_vector_op(get_irn_opcode(node), mode) ? 1 : -1;
+}
+
+static void amd64_lower_vector(ir_graph *irg)
+{
+	lower_vector(irg, amd64_lower_vector_callback);
+	be_after_transform(irg, "lower-vector");
+}
+
+static void amd64_lower_arch_dep(void)
 {
 	ir_arch_lower(&amd64_arch_dep);
 	be_after_irp_transform("lower_arch-dep");
+}
 
+static void amd64_lower_calls(void)
+{
 	/* lower compound param handling */
 	lower_calls_with_compounds(LF_RETURN_HIDDEN, NULL);
 	be_after_irp_transform("lower-calls");
+}
 
-	foreach_irp_irg(i, irg) {
-		lower_switch(irg, 4, 256, mode_Iu);
-		be_after_transform(irg, "lower-switch");
-	}
+static void amd64_lower_switch(ir_graph *irg)
+{
+	lower_switch(irg, 4, 256, mode_Iu);
+	be_after_transform(irg, "lower-switch");
+}
 
-	foreach_irp_irg(i, irg) {
-		/* lower for mode_b stuff */
-		ir_lower_mode_b(irg, mode_Lu);
-		be_after_transform(irg, "lower-modeb");
-		lower_alloc(irg, AMD64_PO2_STACK_ALIGNMENT);
-		be_after_transform(irg, "lower-alloc");
-	}
+static void amd64_lower_mode_b(ir_graph *irg)
+{
+	/* lower for mode_b stuff */
+	ir_lower_mode_b(irg, mode_Lu);
+	be_after_transform(irg, "lower-modeb");
+}
 
-	foreach_irp_irg(i, irg) {
-		/* Turn all small CopyBs into loads/stores, and turn all bigger
-		 * CopyBs into memcpy calls, because we cannot handle CopyB nodes
-		 * during code generation yet.
-		 * TODO:  Adapt this once custom CopyB handling is implemented. */
-		lower_CopyB(irg, 64, 65, true);
-		be_after_transform(irg, "lower-copyb");
-	}
+static void amd64_lower_alloc(ir_graph *irg)
+{
+	lower_alloc(irg, AMD64_PO2_STACK_ALIGNMENT);
+	be_after_transform(irg, "lower-alloc");
+}
+
+static void amd64_lower_CopyB(ir_graph *irg)
+{
+	/* Turn all small CopyBs into loads/stores, and turn all bigger
+	 * CopyBs into memcpy calls, because we cannot handle CopyB nodes
+	 * during code generation yet.
+	 * TODO:  Adapt this once custom CopyB handling is implemented. */
+	lower_CopyB(irg, 64, 65, true);
+	be_after_transform(irg, "lower-copyb");
+}
 
+static void amd64_lower_builtins(void)
+{
 	ir_builtin_kind supported[6];
 	size_t  s = 0;
 	supported[s++] = ir_bk_ffs;
@@ -747,6 +841,32 @@ static void amd64_lower_for_target(void)
 	be_after_irp_transform("lower-builtins");
 }
 
+static void amd64_lower_for_target(void)
+{
+	/* The lowerings confirm what they keep valid themselves. */
+	ir_graph_properties_t const none = IR_GRAPH_PROPERTIES_NONE;
+	ir_graph_properties_t const all  = IR_GRAPH_PROPERTIES_ALL;
+	ir_pass_manager_t *const mgr = new_ir_pass_manager("amd64-lower");
+	ir_pass_manager_add_graph_pass(mgr, "lower-vector", amd64_lower_vector,
+	                               none, all);
+	ir_pass_manager_add_prog_pass(mgr, "lower-arch-dep", amd64_lower_arch_dep,
+	                              none, all);
+	ir_pass_manager_add_prog_pass(mgr, "lower-calls", amd64_lower_calls,
+	                              none, all);
+	ir_pass_manager_add_graph_pass(mgr, "lower-switch", amd64_lower_switch,
+	                               none, all);
+	ir_pass_manager_add_graph_pass(mgr, "lower-modeb", amd64_lower_mode_b,
+	                               none, all);
+	ir_pass_manager_add_graph_pass(mgr, "lower-alloc", amd64_lower_alloc,
+	                               none, all);
+	ir_pass_manager_add_graph_pass(mgr, "lower-copyb", amd64_lower_CopyB,
+	                               none, all);
+	ir_pass_manager_add_prog_pass(mgr, "lower-builtins", amd64_lower_builtins,
+	                              none, all);
+	ir_pass_manager_run(mgr);
+	free_ir_pass_manager(mgr);
+}
+
 static int amd64_is_valid_clobber(const char *clobber)
 {
 	return x86_parse_clobber(amd64_additional_clobber_names, clobber) != NULL;
@@ -773,6 +893,7 @@ static void amd64_init(void)
 	ir_target.experimental = "the amd64 backend is experimental and unfinished (consider the ia32 backend)";
 	ir_target.fast_unaligned_memaccess = true;
 	ir_target.float_int_overflow       = ir_overflow_indefinite;
+	ir_target.vector_cost              = amd64_vector_cost;
 }
 
 static unsigned amd64_get_op_estimated_cost(const ir_node *node)
@@ -808,6 +929,8 @@ void be_init_arch_amd64(void)
 
 	static const lc_opt_table_entry_t options[] = {
 		LC_OPT_ENT_BOOL("no-red-zone", "gcc compatibility",                &amd64_use_red_zone),
+		LC_OPT_ENT_BOOL("avx",         "use AVX for 256bit float vectors", &amd64_use_avx),
+		LC_OPT_ENT_BOOL("avx2",        "use AVX2 for all 256bit vectors",  &amd64_use_avx2),
 		LC_OPT_LAST
 	};
 	lc_opt_entry_t *be_grp    = lc_opt_get_grp(firm_opt_get_root(), "be");
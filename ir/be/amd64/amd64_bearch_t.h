@@ -17,6 +17,7 @@
 typedef struct amd64_irg_data_t {
 	bool omit_fp;
 	bool has_returns_twice_call;
+	bool uses_ymm; /**< xmm registers hold 256bit values */
 } amd64_irg_data_t;
 
 extern pmap *amd64_constants; /**< A map of entities that store const tarvals */
@@ -24,6 +25,8 @@ extern pmap *amd64_constants; /**< A map of entities that store const tarvals */
 extern ir_mode *amd64_mode_xmm;
 
 extern bool amd64_use_red_zone;
+extern bool amd64_use_avx;
+extern bool amd64_use_avx2;
 
 #define AMD64_REGISTER_SIZE   8
 /** power of two stack alignment on calls */
@@ -31,6 +31,7 @@
 #include <inttypes.h>
 
 static bool omit_fp;
+static bool uses_ymm;
 static int  frame_type_size;
 static int  callframe_offset;
 
@@ -43,6 +44,7 @@ static char get_gp_size_suffix(x86_insn_size_t const size)
 	case X86_SIZE_64: return 'q';
 	case X86_SIZE_80:
 	case X86_SIZE_128:
+	case X86_SIZE_256:
 		break;
 	}
 	panic("invalid insn mode");
@@ -62,6 +64,7 @@ static char get_xmm_size_suffix(x86_insn_size_t const size)
 	case X86_SIZE_8:
 	case X86_SIZE_16:
 	case X86_SIZE_80:
+	case X86_SIZE_256:
 		break;
 	}
 	panic("invalid insn mode");
@@ -72,6 +75,27 @@ static void amd64_emit_xmm_size_suffix(x86_insn_size_t const size)
 	be_emit_char(get_xmm_size_suffix(size));
 }
 
+/** Suffix of packed integer SSE instructions for the element size. */
+static char get_packed_size_suffix(x86_insn_size_t const size)
+{
+	switch (size) {
+	case X86_SIZE_8:  return 'b';
+	case X86_SIZE_16: return 'w';
+	case X86_SIZE_32: return 'd';
+	case X86_SIZE_64: return 'q';
+	case X86_SIZE_80:
+	case X86_SIZE_128:
+	case X86_SIZE_256:
+		break;
+	}
+	panic("invalid insn mode");
+}
+
+static void amd64_emit_packed_size_suffix(x86_insn_size_t const size)
+{
+	be_emit_char(get_packed_size_suffix(size));
+}
+
 static char get_x87_size_suffix(x86_insn_size_t const size)
 {
 	switch (size) {
@@ -81,6 +105,7 @@ static char get_x87_size_suffix(x86_insn_size_t const size)
 	case X86_SIZE_8:
 	case X86_SIZE_16:
 	case X86_SIZE_128:
+	case X86_SIZE_256:
 		break;
 	}
 	panic("Invalid insn mode");
@@ -187,6 +212,7 @@ static const char *get_register_name_mode(const arch_register_t *reg,
 	case X86_SIZE_64:
 	case X86_SIZE_80:
 	case X86_SIZE_128: return reg->name;
+	case X86_SIZE_256: break;
 	}
 	panic("invalid mode");
 }
@@ -202,7 +228,12 @@ static void emit_register_mode(const arch_register_t *reg,
                                x86_insn_size_t size)
 {
 	if (reg->cls == &amd64_reg_classes[CLASS_amd64_xmm]) {
-		emit_register(reg);
+		if (size == X86_SIZE_256) {
+			/* the ymm registers extend the xmm registers */
+			be_emit_irprintf("%%ymm%u", reg->index);
+		} else {
+			emit_register(reg);
+		}
 	} else {
 		emit_register_sized(reg, size);
 	}
@@ -214,6 +245,7 @@ typedef enum amd64_emit_mod_t {
 	EMIT_FORCE_32      = 1U << 2,
 	EMIT_CONV_DEST     = 1U << 3,
 	EMIT_INDIRECT_STAR = 1U << 4,
+	EMIT_YMM           = 1U << 5,
 } amd64_emit_mod_t;
 ENUM_BITSET(amd64_emit_mod_t)
 
@@ -341,6 +373,7 @@ void amd64_emitf(ir_node const *const node, char const *fmt, ...)
 			case '3': mod |= EMIT_FORCE_32;      break;
 			case '#': mod |= EMIT_CONV_DEST;     break;
 			case '*': mod |= EMIT_INDIRECT_STAR; break;
+			case 'Y': mod |= EMIT_YMM;           break;
 			default:
 				goto end_of_mods;
 			}
@@ -457,6 +490,8 @@ end_of_mods:
 emit_R:
 				if (mod & EMIT_IGNORE_MODE) {
 					emit_register(reg);
+				} else if (mod & EMIT_YMM) {
+					emit_register_mode(reg, X86_SIZE_256);
 				} else if (mod & EMIT_FORCE_32) {
 					emit_register_mode(reg, X86_SIZE_32);
 				} else if (mod & EMIT_CONV_DEST) {
@@ -477,6 +512,9 @@ emit_R:
 				if (*fmt == 'X') {
 					++fmt;
 					amd64_emit_xmm_size_suffix(attr->size);
+				} else if (*fmt == 'P') {
+					++fmt;
+					amd64_emit_packed_size_suffix(attr->size);
 				} else {
 					amd64_emit_insn_size_suffix(attr->size);
 				}
@@ -676,6 +714,7 @@ static void emit_amd64_mov_gp(const ir_node *node)
 	case X86_SIZE_64: amd64_emitf(node, "movq %AM, %^D0");   return;
 	case X86_SIZE_80:
 	case X86_SIZE_128:
+	case X86_SIZE_256:
 		break;
 	}
 	panic("invalid insn mode");
@@ -696,7 +735,11 @@ static void emit_be_Copy(const ir_node *irn)
 	if (cls == &amd64_reg_classes[CLASS_amd64_gp]) {
 		amd64_emitf(irn, "mov %^S0, %^D0");
 	} else if (cls == &amd64_reg_classes[CLASS_amd64_xmm]) {
-		amd64_emitf(irn, "movapd %^S0, %^D0");
+		if (uses_ymm) {
+			amd64_emitf(irn, "vmovaps %YS0, %YD0");
+		} else {
+			amd64_emitf(irn, "movapd %^S0, %^D0");
+		}
 	} else if (cls == &amd64_reg_classes[CLASS_amd64_x87]) {
 		/* nothing to do */
 	} else {
@@ -715,9 +758,15 @@ static void emit_be_Perm(const ir_node *node)
 	if (cls == &amd64_reg_classes[CLASS_amd64_gp]) {
 		amd64_emitf(node, "xchg %^R, %^R", reg0, reg1);
 	} else if (cls == &amd64_reg_classes[CLASS_amd64_xmm]) {
-		amd64_emitf(node, "pxor %^R, %^R", reg0, reg1);
-		amd64_emitf(node, "pxor %^R, %^R", reg1, reg0);
-		amd64_emitf(node, "pxor %^R, %^R", reg0, reg1);
+		if (uses_ymm) {
+			amd64_emitf(node, "vxorps %YR, %YR, %YR", reg0, reg1, reg1);
+			amd64_emitf(node, "vxorps %YR, %YR, %YR", reg1, reg0, reg0);
+			amd64_emitf(node, "vxorps %YR, %YR, %YR", reg0, reg1, reg1);
+		} else {
+			amd64_emitf(node, "pxor %^R, %^R", reg0, reg1);
+			amd64_emitf(node, "pxor %^R, %^R", reg1, reg0);
+			amd64_emitf(node, "pxor %^R, %^R", reg0, reg1);
+		}
 	} else {
 		panic("unexpected register class in be_Perm (%+F)", node);
 	}
@@ -782,6 +831,11 @@ static void amd64_gen_block(ir_node *block)
 
 	be_dwarf_location(get_irn_dbg_info(block));
 	sched_foreach(block, node) {
+		/* avoid the penalty for switching from AVX to SSE code in the
+		 * callee or caller */
+		if (uses_ymm && (is_amd64_call(node) || is_amd64_ret(node)))
+			amd64_emitf(node, "vzeroupper");
+
 		be_emit_node(node);
 
 		if (omit_fp) {
@@ -810,7 +864,8 @@ void amd64_emit_function(ir_graph *irg)
 	be_emit_init_cf_links(blk_sched);
 
 	amd64_irg_data_t const *const irg_data = amd64_get_irg_data(irg);
-	omit_fp = irg_data->omit_fp;
+	omit_fp  = irg_data->omit_fp;
+	uses_ymm = irg_data->uses_ymm;
 
 	if (omit_fp) {
 		ir_type *frame_type = get_irg_frame_type(irg);
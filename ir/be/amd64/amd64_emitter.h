@@ -27,6 +27,7 @@
  * %u   unsigned int            unsigned int
  *
  * x starts at 0
+ * A Y in front of D, R or S names the 256bit ymm register of an xmm register.
  */
 void amd64_emitf(ir_node const *node, char const *fmt, ...);
 
@@ -215,6 +215,16 @@ my $binopx_commutative = {
 	emit      => "{name}%MX %AM",
 };
 
+my $vbinop = {
+	irn_flags => [ "rematerializable" ],
+	in_reqs   => [ "xmm", "xmm" ],
+	out_reqs  => [ "xmm" ],
+	ins       => [ "left", "right" ],
+	outs      => [ "res" ],
+	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_NONE;",
+	attr      => "x86_insn_size_t size",
+};
+
 my $cvtop2x = {
 	state     => "exc_pinned",
 	in_reqs   => "...",
@@ -617,6 +627,105 @@ xorp_0 => {
 
 xorp => { template => $binopx_commutative },
 
+# Packed SSE2 operations, the size attribute is the size of the elements
+
+addp => { template => $binopx_commutative },
+
+mulp => { template => $binopx_commutative },
+
+subp => {
+	template => $binopx,
+	emit     => "subp%MX %AM",
+},
+
+padd => {
+	template => $binopx_commutative,
+	emit     => "padd%MP %AM",
+},
+
+psub => {
+	template => $binopx,
+	emit     => "psub%MP %AM",
+},
+
+pmullw => {
+	template => $binopx_commutative,
+	emit     => "pmullw %AM",
+},
+
+pand => {
+	template => $binopx_commutative,
+	emit     => "pand %AM",
+},
+
+por => {
+	template => $binopx_commutative,
+	emit     => "por %AM",
+},
+
+pxor => {
+	template => $binopx_commutative,
+	emit     => "pxor %AM",
+},
+
+# AVX operations on 256bit vectors, the size attribute is the size of the
+# elements
+
+vaddp => {
+	template => $vbinop,
+	emit     => "vaddp%MX %YS1, %YS0, %YD0",
+},
+
+vmulp => {
+	template => $vbinop,
+	emit     => "vmulp%MX %YS1, %YS0, %YD0",
+},
+
+vsubp => {
+	template => $vbinop,
+	emit     => "vsubp%MX %YS1, %YS0, %YD0",
+},
+
+vandps => {
+	template => $vbinop,
+	emit     => "vandps %YS1, %YS0, %YD0",
+},
+
+vorps => {
+	template => $vbinop,
+	emit     => "vorps %YS1, %YS0, %YD0",
+},
+
+vxorps => {
+	template => $vbinop,
+	emit     => "vxorps %YS1, %YS0, %YD0",
+},
+
+vxorps_0 => {
+	op_flags  => [ "constlike" ],
+	irn_flags => [ "rematerializable" ],
+	out_reqs  => [ "xmm" ],
+	outs      => [ "res" ],
+	fixed     => "amd64_op_mode_t op_mode = AMD64_OP_NONE;\n"
+	            ."x86_insn_size_t size    = X86_SIZE_256;\n",
+	emit      => "vxorps %YD0, %YD0, %YD0",
+},
+
+vpadd => {
+	template => $vbinop,
+	emit     => "vpadd%MP %YS1, %YS0, %YD0",
+},
+
+vpsub => {
+	template => $vbinop,
+	emit     => "vpsub%MP %YS1, %YS0, %YD0",
+},
+
+vpmullw => {
+	template => $vbinop,
+	emit     => "vpmullw %YS1, %YS0, %YD0",
+},
+
 movd_xmm_gp => {
 	state     => "exc_pinned",
 	ins       => [ "operand" ],
@@ -683,6 +792,22 @@ movdqu_store => {
 	emit      => "movdqu %^S0, %A",
 },
 
+vmovdqu => {
+	template => $movopx,
+	fixed    => "x86_insn_size_t size = X86_SIZE_256;\n",
+},
+
+vmovdqu_store => {
+	op_flags  => [ "uses_memory" ],
+	state     => "exc_pinned",
+	in_reqs   => "...",
+	out_reqs  => [ "mem" ],
+	outs      => [ "M" ],
+	attr_type => "amd64_binop_addr_attr_t",
+	attr      => "const amd64_binop_addr_attr_t *attr_init",
+	emit      => "vmovdqu %YS0, %A",
+},
+
 l_punpckldq => {
 	ins       => [ "arg0", "arg1" ],
 	outs      => [ "res" ],
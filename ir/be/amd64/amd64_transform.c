@@ -25,6 +25,7 @@
 #include "ircons.h"
 #include "iredges_t.h"
 #include "irgmod.h"
+#include "irgwalk.h"
 #include "irgraph_t.h"
 #include "irmode_t.h"
 #include "irnode_t.h"
@@ -357,6 +358,12 @@ void init_lconst_addr(x86_addr_t *addr, ir_entity *entity)
 	};
 }
 
+/** Returns true if values of mode @p mode fill a whole ymm register. */
+static bool is_ymm_mode(ir_mode *const mode)
+{
+	return mode_is_vector(mode) && get_mode_size_bits(mode) == 256;
+}
+
 static ir_node *create_float_const(dbg_info *dbgi, ir_node *block,
                                    ir_tarval *tv)
 {
@@ -372,7 +379,10 @@ static ir_node *create_float_const(dbg_info *dbgi, ir_node *block,
 	ir_node *load;
 	unsigned pn_res;
 	x86_insn_size_t size = x86_size_from_mode(tv_mode);
-	if (size == X86_SIZE_128) {
+	if (size == X86_SIZE_256) {
+		load = new_bd_amd64_vmovdqu(dbgi, block, ARRAY_SIZE(in), in, mem_reqs, AMD64_OP_ADDR, addr);
+		pn_res = pn_amd64_vmovdqu_res;
+	} else if (size == X86_SIZE_128) {
 		load = new_bd_amd64_movdqa(dbgi, block, ARRAY_SIZE(in), in, mem_reqs, AMD64_OP_ADDR, addr);
 		pn_res = pn_amd64_movdqa_res;
 	} else {
@@ -451,6 +461,8 @@ static ir_node *gen_Const(ir_node *const node)
 		if (mode == x86_mode_E) {
 			return gen_x87_Const(dbgi, block, tv);
 		} else if (tarval_is_null(tv)) {
+			if (is_ymm_mode(mode))
+				return new_bd_amd64_vxorps_0(dbgi, block);
 			return new_bd_amd64_xorp_0(dbgi, block, X86_SIZE_64);
 		}
 		return create_float_const(dbgi, block, tv);
@@ -918,6 +930,76 @@ static ir_node *gen_binop_xmm(ir_node *node, ir_node *op0, ir_node *op1,
 	return be_new_Proj(new_node, pn_amd64_subs_res);
 }
 
+typedef ir_node *(*construct_vbinop_func)(dbg_info *dbgi, ir_node *block,
+                                          ir_node *left, ir_node *right,
+                                          x86_insn_size_t size);
+
+/**
+ * Creates a packed SSE operation, the size attribute is the size of the
+ * elements. Memory operands are not matched, as they would have to be
+ * aligned. 256bit vectors use the AVX operation @p make_vnode instead.
+ */
+static ir_node *create_binop_vector(dbg_info *const dbgi,
+                                    ir_node *const new_block,
+                                    ir_mode *const mode,
+                                    ir_node *const new_op0,
+                                    ir_node *const new_op1,
+                                    construct_binop_func const make_node,
+                                    construct_vbinop_func const make_vnode)
+{
+	ir_mode *const element_mode = get_mode_vector_element_mode(mode);
+	if (is_ymm_mode(mode)) {
+		/* AVX has a separate destination operand, so there are no register
+		 * constraints. */
+		return make_vnode(dbgi, new_block, new_op0, new_op1,
+		                  x86_size_from_mode(element_mode));
+	}
+
+	ir_node *const in[] = { new_op0, new_op1 };
+	amd64_binop_addr_attr_t const attr = {
+		.base = {
+			.base = {
+				.op_mode = AMD64_OP_REG_REG,
+				.size    = x86_size_from_mode(element_mode),
+			},
+			.addr = {
+				.base_input = 0,
+				.variant    = X86_ADDR_REG,
+			},
+		},
+		.u.reg_input = 1,
+	};
+	ir_node *const new_node = make_node(dbgi, new_block, ARRAY_SIZE(in), in,
+	                                    amd64_xmm_xmm_reqs, &attr);
+	/* Without a way to swap the inputs the finishing phase needs room for a
+	 * copy, if input 0 cannot get the output register. */
+	bool const commutative = arch_get_irn_flags(new_node)
+	                       & amd64_arch_irn_flag_commutative_binop;
+	arch_set_irn_register_req_out(new_node, 0, commutative
+		? &amd64_requirement_xmm_same_0
+		: &amd64_requirement_xmm_same_0_not_1);
+	return be_new_Proj(new_node, pn_amd64_padd_res);
+}
+
+static ir_node *gen_binop_vector(ir_node *const node, ir_node *const op0,
+                                 ir_node *const op1,
+                                 construct_binop_func const make_node,
+                                 construct_vbinop_func const make_vnode)
+{
+	dbg_info *const dbgi      = get_irn_dbg_info(node);
+	ir_node  *const new_block = be_transform_nodes_block(node);
+	ir_node  *const new_op0   = be_transform_node(op0);
+	ir_node  *const new_op1   = be_transform_node(op1);
+	ir_mode  *const mode      = get_irn_mode(node);
+	return create_binop_vector(dbgi, new_block, mode, new_op0, new_op1,
+	                           make_node, make_vnode);
+}
+
+static bool is_float_vector(ir_mode *const mode)
+{
+	return mode_is_float(get_mode_vector_element_mode(mode));
+}
+
 typedef ir_node *(*construct_x87_binop_func)(
 		dbg_info *dbgi, ir_node *block, ir_node *op0, ir_node *op1);
 
@@ -1016,7 +1098,13 @@ static ir_node *gen_Add(ir_node *const node)
 	ir_mode *const mode  = get_irn_mode(node);
 	ir_node *const block = get_nodes_block(node);
 
-	if (mode_is_float(mode)) {
+	if (mode_is_vector(mode)) {
+		if (is_float_vector(mode))
+			return gen_binop_vector(node, op1, op2, new_bd_amd64_addp,
+			                        new_bd_amd64_vaddp);
+		return gen_binop_vector(node, op1, op2, new_bd_amd64_padd,
+		                        new_bd_amd64_vpadd);
+	} else if (mode_is_float(mode)) {
 		if (mode == x86_mode_E)
 			return gen_binop_x87(node, op1, op2, new_bd_amd64_fadd);
 		return gen_binop_am(node, op1, op2, new_bd_amd64_adds,
@@ -1056,7 +1144,13 @@ static ir_node *gen_Sub(ir_node *const node)
 	ir_node *const op2  = get_Sub_right(node);
 	ir_mode *const mode = get_irn_mode(node);
 
-	if (mode_is_float(mode)) {
+	if (mode_is_vector(mode)) {
+		if (is_float_vector(mode))
+			return gen_binop_vector(node, op1, op2, new_bd_amd64_subp,
+			                        new_bd_amd64_vsubp);
+		return gen_binop_vector(node, op1, op2, new_bd_amd64_psub,
+		                        new_bd_amd64_vpsub);
+	} else if (mode_is_float(mode)) {
 		if (mode == x86_mode_E)
 			return gen_binop_x87(node, op1, op2, new_bd_amd64_fsub);
 		return gen_binop_am(node, op1, op2, new_bd_amd64_subs,
@@ -1079,6 +1173,9 @@ static ir_node *gen_And(ir_node *const node)
 {
 	ir_node *const op1 = get_And_left(node);
 	ir_node *const op2 = get_And_right(node);
+	if (mode_is_vector(get_irn_mode(node)))
+		return gen_binop_vector(node, op1, op2, new_bd_amd64_pand,
+		                        new_bd_amd64_vandps);
 
 	/* Is it a zero extension? */
 	if (is_Const(op2)) {
@@ -1109,6 +1206,9 @@ static ir_node *gen_Eor(ir_node *const node)
 {
 	ir_node *const op1 = get_Eor_left(node);
 	ir_node *const op2 = get_Eor_right(node);
+	if (mode_is_vector(get_irn_mode(node)))
+		return gen_binop_vector(node, op1, op2, new_bd_amd64_pxor,
+		                        new_bd_amd64_vxorps);
 	return gen_binop_am(node, op1, op2, new_bd_amd64_xor, pn_amd64_xor_res,
 	                    match_immediate | match_am | match_mode_neutral
 	                    | match_commutative);
@@ -1118,6 +1218,9 @@ static ir_node *gen_Or(ir_node *const node)
 {
 	ir_node *const op1 = get_Or_left(node);
 	ir_node *const op2 = get_Or_right(node);
+	if (mode_is_vector(get_irn_mode(node)))
+		return gen_binop_vector(node, op1, op2, new_bd_amd64_por,
+		                        new_bd_amd64_vorps);
 	return gen_binop_am(node, op1, op2, new_bd_amd64_or, pn_amd64_or_res,
 	                    match_immediate | match_am | match_mode_neutral
 	                    | match_commutative);
@@ -1129,7 +1232,14 @@ static ir_node *gen_Mul(ir_node *const node)
 	ir_node *const op2  = get_Mul_right(node);
 	ir_mode *const mode = get_irn_mode(node);
 
-	if (get_mode_size_bits(mode) < 16) {
+	if (mode_is_vector(mode)) {
+		/* only 16bit integer elements have a packed multiplication */
+		if (is_float_vector(mode))
+			return gen_binop_vector(node, op1, op2, new_bd_amd64_mulp,
+			                        new_bd_amd64_vmulp);
+		return gen_binop_vector(node, op1, op2, new_bd_amd64_pmullw,
+		                        new_bd_amd64_vpmullw);
+	} else if (get_mode_size_bits(mode) < 16) {
 		/* imulb only supports rax - reg form */
 		ir_node *new_node
 			= gen_binop_rax(node, op1, op2, new_bd_amd64_imul_1op,
@@ -1448,11 +1558,41 @@ static ir_node *gen_float_neg(ir_node *const node)
 	return be_new_Proj(xor, pn_amd64_xorp_res);
 }
 
+/**
+ * Negates the lanes of a vector. Floats get their sign bits flipped, integers
+ * are subtracted from zero.
+ */
+static ir_node *gen_vector_neg(ir_node *const node)
+{
+	dbg_info *const dbgi      = get_irn_dbg_info(node);
+	ir_node  *const new_block = be_transform_nodes_block(node);
+	ir_node  *const new_op    = be_transform_node(get_Minus_op(node));
+	ir_mode  *const mode      = get_irn_mode(node);
+	if (is_float_vector(mode)) {
+		ir_mode    *const element_mode = get_mode_vector_element_mode(mode);
+		unsigned    const n_lanes      = get_mode_vector_n_lanes(mode);
+		ir_tarval **const lanes        = ALLOCAN(ir_tarval*, n_lanes);
+		for (unsigned i = 0; i < n_lanes; ++i)
+			lanes[i] = create_sign_tv(element_mode);
+		ir_tarval *const tv   = new_tarval_from_lanes(mode, lanes);
+		ir_node   *const mask = create_float_const(dbgi, new_block, tv);
+		return create_binop_vector(dbgi, new_block, mode, new_op, mask,
+		                           new_bd_amd64_xorp, new_bd_amd64_vxorps);
+	}
+	ir_node *const zero = is_ymm_mode(mode)
+		? new_bd_amd64_vxorps_0(dbgi, new_block)
+		: new_bd_amd64_xorp_0(dbgi, new_block, X86_SIZE_64);
+	return create_binop_vector(dbgi, new_block, mode, zero, new_op,
+	                           new_bd_amd64_psub, new_bd_amd64_vpsub);
+}
+
 static ir_node *gen_Minus(ir_node *const node)
 {
 	ir_mode *mode = get_irn_mode(node);
 
-	if (mode_is_float(mode)) {
+	if (mode_is_vector(mode)) {
+		return gen_vector_neg(node);
+	} else if (mode_is_float(mode)) {
 		if (mode == x86_mode_E) {
 			dbg_info *dbgi   = get_irn_dbg_info(node);
 			ir_node  *block  = be_transform_node(get_nodes_block(node));
@@ -1468,6 +1608,16 @@ static ir_node *gen_Minus(ir_node *const node)
 
 static ir_node *gen_Not(ir_node *const node)
 {
+	ir_mode *const mode = get_irn_mode(node);
+	if (mode_is_vector(mode)) {
+		dbg_info *const dbgi      = get_irn_dbg_info(node);
+		ir_node  *const new_block = be_transform_nodes_block(node);
+		ir_node  *const new_op    = be_transform_node(get_Not_op(node));
+		ir_tarval *const all_one  = get_mode_all_one(mode);
+		ir_node  *const mask      = create_float_const(dbgi, new_block, all_one);
+		return create_binop_vector(dbgi, new_block, mode, new_op, mask,
+		                           new_bd_amd64_pxor, new_bd_amd64_vxorps);
+	}
 	return gen_unop(node, n_Not_op, &new_bd_amd64_not, pn_amd64_not_res);
 }
 
@@ -1755,7 +1905,13 @@ static ir_node *make_store_for_mode(ir_mode *const mode, dbg_info *const dbgi, i
 {
 	construct_binop_func               cons;
 	arch_register_req_t const **const *reqs;
-	if (!mode_is_float(mode)) {
+	if (is_ymm_mode(mode)) {
+		cons = &new_bd_amd64_vmovdqu_store;
+		reqs = xmm_am_reqs;
+	} else if (mode_is_vector(mode)) {
+		cons = &new_bd_amd64_movdqu_store;
+		reqs = xmm_am_reqs;
+	} else if (!mode_is_float(mode)) {
 		cons = &new_bd_amd64_mov_store;
 		reqs = gp_am_reqs;
 	} else if (mode == x86_mode_E) {
@@ -2131,6 +2287,8 @@ static ir_node *gen_Phi(ir_node *const node)
 		req = mode == x86_mode_E
 		    ? &amd64_class_reg_req_x87
 		    : &amd64_class_reg_req_xmm;
+	} else if (mode_is_vector(mode)) {
+		req = &amd64_class_reg_req_xmm;
 	} else {
 		req = arch_memory_req;
 	}
@@ -2595,6 +2753,11 @@ ir_node *amd64_new_spill(ir_node *const value, ir_node *const after)
 		size = X86_SIZE_80;
 		cons = &new_bd_amd64_fst;
 		reqs = x87_reg_mem_reqs;
+	} else if (amd64_get_irg_data(get_irn_irg(after))->uses_ymm) {
+		/* the value may fill the whole ymm register */
+		size = X86_SIZE_256;
+		cons = new_bd_amd64_vmovdqu_store;
+		reqs = xmm_reg_mem_reqs;
 	} else {
 		size = X86_SIZE_128;
 		/* TODO: currently our stack alignment is messed up so we can't use
@@ -2629,13 +2792,14 @@ ir_node *amd64_new_spill(ir_node *const value, ir_node *const after)
 	return store;
 }
 
-static ir_node *create_sse_spill(dbg_info *const dbgi, ir_node *const block,
-                                 int const arity, ir_node *const *const in,
-                                 arch_register_req_t const **const in_reqs,
-                                 x86_insn_size_t const size, amd64_op_mode_t const op_mode,
-                                 x86_addr_t const addr)
+static ir_node *create_movdqu(dbg_info *const dbgi, ir_node *const block,
+                              int const arity, ir_node *const *const in,
+                              arch_register_req_t const **const in_reqs,
+                              x86_insn_size_t const size, amd64_op_mode_t const op_mode,
+                              x86_addr_t const addr)
 {
-	(void)size; /* TODO */
+	if (size == X86_SIZE_256)
+		return new_bd_amd64_vmovdqu(dbgi, block, arity, in, in_reqs, op_mode, addr);
 	return new_bd_amd64_movdqu(dbgi, block, arity, in, in_reqs, op_mode, addr);
 }
 
@@ -2665,9 +2829,13 @@ ir_node *amd64_new_reload(ir_node *value, ir_node *spill, ir_node *before)
 		size   = X86_SIZE_80;
 		cons   = &new_bd_amd64_fld;
 		pn_res = pn_amd64_fld_res;
+	} else if (amd64_get_irg_data(irg)->uses_ymm) {
+		size   = X86_SIZE_256;
+		cons   = &create_movdqu;
+		pn_res = pn_amd64_vmovdqu_res;
 	} else {
 		size   = X86_SIZE_128;
-		cons   = &create_sse_spill;
+		cons   = &create_movdqu;
 		pn_res = pn_amd64_movdqu_res;
 	}
 	ir_node *const load = cons(NULL, block, ARRAY_SIZE(in), in, reg_mem_reqs,
@@ -2702,6 +2870,7 @@ static ir_node *gen_Load(ir_node *const node)
 	assert((size_t)arity <= ARRAY_SIZE(in));
 
 	create_mov_func   const cons      =
+		mode_is_vector(mode)                                  ? &create_movdqu :
 		mode_is_float(mode)                                   ?
 			(mode == x86_mode_E ? new_bd_amd64_fld : &new_bd_amd64_movs_xmm) :
 		get_mode_size_bits(mode) < 64 && mode_is_signed(mode) ? &new_bd_amd64_movs     :
@@ -2717,7 +2886,7 @@ static ir_node *gen_Unknown(ir_node *const node)
 {
 	ir_node *const block = be_transform_nodes_block(node);
 	ir_mode *const mode  = get_irn_mode(node);
-	if (mode_is_float(mode)) {
+	if (mode_is_float(mode) || mode_is_vector(mode)) {
 		return be_new_Unknown(block, &amd64_class_reg_req_xmm);
 	} else if (be_mode_needs_gp_reg(mode)) {
 		return be_new_Unknown(block, &amd64_class_reg_req_gp);
@@ -2774,6 +2943,20 @@ static ir_node *gen_Proj_Load(ir_node *const node)
 			return be_new_Proj(new_load, pn_amd64_fld_M);
 		}
 		break;
+	case iro_amd64_movdqu:
+		if (pn == pn_Load_res) {
+			return be_new_Proj(new_load, pn_amd64_movdqu_res);
+		} else if (pn == pn_Load_M) {
+			return be_new_Proj(new_load, pn_amd64_movdqu_M);
+		}
+		break;
+	case iro_amd64_vmovdqu:
+		if (pn == pn_Load_res) {
+			return be_new_Proj(new_load, pn_amd64_vmovdqu_res);
+		} else if (pn == pn_Load_M) {
+			return be_new_Proj(new_load, pn_amd64_vmovdqu_M);
+		}
+		break;
 	case iro_amd64_add:
 	case iro_amd64_and:
 	case iro_amd64_cmp:
@@ -3252,6 +3435,13 @@ static void amd64_register_transformers(void)
 	be_set_upper_bits_clean_function(op_Shrs, NULL);
 }
 
+static void find_ymm_value(ir_node *const node, void *const data)
+{
+	bool *const uses_ymm = (bool*)data;
+	if (is_ymm_mode(get_irn_mode(node)))
+		*uses_ymm = true;
+}
+
 void amd64_transform_graph(ir_graph *irg)
 {
 	assure_irg_properties(irg, IR_GRAPH_PROPERTY_NO_TUPLES
@@ -3272,7 +3462,14 @@ void amd64_transform_graph(ir_graph *irg)
 	be_add_parameter_entity_stores(irg);
 	x86_create_parameter_loads(irg, current_cconv);
 
+	if (amd64_use_avx || amd64_use_avx2) {
+		bool uses_ymm = false;
+		irg_walk_graph(irg, find_ymm_value, NULL, &uses_ymm);
+		amd64_get_irg_data(irg)->uses_ymm = uses_ymm;
+	}
+
 	heights = heights_new(irg);
+	heights_enable_reachability_index(heights);
 	x86_calculate_non_address_mode_nodes(irg);
 	be_transform_graph(irg, NULL);
 	x86_free_non_address_mode_nodes();
@@ -221,6 +221,11 @@ static const ir_settings_arch_dep_t arm_arch_dep = {
 
 static void arm_lower_for_target(void)
 {
+	foreach_irp_irg(i, irg) {
+		lower_vector(irg, NULL);
+		be_after_transform(irg, "lower-vector");
+	}
+
 	ir_arch_lower(&arm_arch_dep);
 	be_after_irp_transform("lower-arch-dep");
 
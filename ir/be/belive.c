@@ -12,12 +12,14 @@
 /* statev is expensive here, only enable when needed */
 #define DISABLE_STATEV
 
+#include "bitset.h"
 #include "debug.h"
 #include "iredges_t.h"
 #include "irgwalk.h"
 #include "irprintf.h"
 #include "irdump_t.h"
 #include "irnodeset.h"
+#include "util.h"
 
 #include "statev_t.h"
 #include "be_t.h"
@@ -58,13 +60,17 @@ static unsigned _be_liveness_bsearch(be_lv_info_t const *const arr, ir_node cons
 	return res;
 }
 
-be_lv_info_node_t *be_lv_get(const be_lv_t *li, const ir_node *bl,
-                             const ir_node *irn)
+be_lv_state_t be_lv_get(const be_lv_t *li, const ir_node *bl,
+                        const ir_node *irn)
 {
 	stat_ev_tim_push();
-	be_lv_info_t      *irn_live = ir_nodehashmap_get(be_lv_info_t, &li->map, bl);
-	be_lv_info_node_t *res      = NULL;
-	if (irn_live != NULL) {
+	be_lv_info_t *irn_live = ir_nodehashmap_get(be_lv_info_t, &li->map, bl);
+	be_lv_state_t res      = be_lv_state_none;
+	if (irn_live == NULL) {
+		/* nothing is live here */
+	} else if (irn_live->n_idx != 0) {
+		res = be_lv_dense_get(irn_live, get_irn_idx(irn));
+	} else {
 		/* Get the position of the index in the array. */
 		unsigned pos = _be_liveness_bsearch(irn_live, irn);
 
@@ -73,15 +79,60 @@ be_lv_info_node_t *be_lv_get(const be_lv_t *li, const ir_node *bl,
 
 		/* Check, if the irn is in deed in the array. */
 		if (rec->node == irn)
-			res = rec;
+			res = rec->flags;
 	}
 	stat_ev_tim_pop("be_lv_get");
 
 	return res;
 }
 
-static be_lv_info_node_t *be_lv_get_or_set(be_lv_t *li, ir_node *bl,
-                                           ir_node *irn)
+static unsigned dense_n_elems(unsigned n_idx)
+{
+	return (n_idx + BE_LV_STATES_PER_ELEM - 1) / BE_LV_STATES_PER_ELEM;
+}
+
+/**
+ * Makes the states of a dense set cover node index @p idx.
+ */
+static void dense_cover(be_lv_t *li, be_lv_info_t *irn_live, unsigned idx)
+{
+	unsigned const n_idx = irn_live->n_idx;
+	if (idx < n_idx)
+		return;
+
+	unsigned const last_idx  = get_irg_last_idx(li->irg);
+	unsigned const new_idx   = MAX(MAX(idx + 1, last_idx), 2 * n_idx);
+	unsigned const n_elems   = dense_n_elems(n_idx);
+	unsigned const new_elems = dense_n_elems(new_idx);
+	unsigned      *states    = OALLOCNZ(&li->obst, unsigned, new_elems);
+	MEMCPY(states, irn_live->states, n_elems);
+	irn_live->states = states;
+	irn_live->n_idx  = new_elems * BE_LV_STATES_PER_ELEM;
+}
+
+/**
+ * Converts a sparse liveness set to a dense one.
+ */
+static void make_dense(be_lv_t *li, be_lv_info_t *irn_live)
+{
+	assert(irn_live->n_idx == 0);
+	irn_live->states = NULL;
+	dense_cover(li, irn_live, get_irg_last_idx(li->irg) - 1);
+	for (unsigned i = 0, n = irn_live->n_members; i < n; ++i) {
+		be_lv_info_node_t const *const member = &irn_live->nodes[i];
+		unsigned const idx   = get_irn_idx(member->node);
+		unsigned const shift = idx % BE_LV_STATES_PER_ELEM * BE_LV_STATE_BITS;
+		irn_live->states[idx / BE_LV_STATES_PER_ELEM] |= member->flags << shift;
+	}
+	irn_live->n_members = 0;
+}
+
+/**
+ * Adds @p state to the liveness state of @p irn in block @p bl.
+ * @return the state before
+ */
+static be_lv_state_t be_lv_add(be_lv_t *li, ir_node *bl, ir_node *irn,
+                               be_lv_state_t state)
 {
 	assert(get_irn_mode(irn) != mode_T);
 
@@ -92,20 +143,35 @@ static be_lv_info_node_t *be_lv_get_or_set(be_lv_t *li, ir_node *bl,
 		ir_nodehashmap_insert(&li->map, bl, irn_live);
 	}
 
-	/* Get the position of the index in the array. */
-	unsigned pos = _be_liveness_bsearch(irn_live, irn);
+	if (irn_live->n_idx == 0) {
+		/* Get the position of the index in the array. */
+		unsigned pos = _be_liveness_bsearch(irn_live, irn);
 
-	/* Get the record in question. */
-	be_lv_info_node_t *res = &irn_live->nodes[pos];
+		/* Get the record in question. */
+		be_lv_info_node_t *res = &irn_live->nodes[pos];
+
+		/* Check, if the irn is in deed in the array. */
+		if (res->node == irn) {
+			be_lv_state_t const before = res->flags;
+			res->flags |= state;
+			return before;
+		}
 
-	/* Check, if the irn is in deed in the array. */
-	if (res->node != irn) {
 		unsigned n_members = irn_live->n_members;
 		unsigned n_size    = irn_live->n_size;
 		if (n_members + 1 >= n_size) {
+			/* Switch to the dense form, if it does not take more memory
+			 * than the doubled array. */
+			unsigned const new_size = 2 * n_size;
+			size_t   const n_idx    = get_irg_last_idx(li->irg);
+			if ((size_t)new_size * sizeof(*irn_live->nodes) * 8
+			    >= n_idx * BE_LV_STATE_BITS) {
+				make_dense(li, irn_live);
+				goto dense;
+			}
+
 			/* double the array size. */
-			unsigned      const new_size = 2 * n_size;
-			be_lv_info_t *const nw       = OALLOCF(&li->obst, be_lv_info_t, nodes, new_size);
+			be_lv_info_t *const nw = OALLOCF(&li->obst, be_lv_info_t, nodes, new_size);
 			memcpy(nw, irn_live, sizeof(*irn_live) + n_size * sizeof(*irn_live->nodes));
 			memset(&nw->nodes[n_size], 0, (new_size - n_size) * sizeof(*irn_live->nodes));
 			nw->n_size = new_size;
@@ -120,10 +186,50 @@ static be_lv_info_node_t *be_lv_get_or_set(be_lv_t *li, ir_node *bl,
 		++irn_live->n_members;
 		res        = &irn_live->nodes[pos];
 		res->node  = irn;
-		res->flags = 0;
+		res->flags = state;
+		return be_lv_state_none;
 	}
 
-	return res;
+dense:;
+	unsigned const idx = get_irn_idx(irn);
+	dense_cover(li, irn_live, idx);
+	be_lv_state_t const before = be_lv_dense_get(irn_live, idx);
+	unsigned      const shift  = idx % BE_LV_STATES_PER_ELEM * BE_LV_STATE_BITS;
+	irn_live->states[idx / BE_LV_STATES_PER_ELEM] |= state << shift;
+	return before;
+}
+
+static void dense_clear(be_lv_info_t *const irn_live, unsigned const idx)
+{
+	if (idx >= irn_live->n_idx)
+		return;
+	unsigned const shift = idx % BE_LV_STATES_PER_ELEM * BE_LV_STATE_BITS;
+	irn_live->states[idx / BE_LV_STATES_PER_ELEM]
+		&= ~(((1u << BE_LV_STATE_BITS) - 1) << shift);
+}
+
+/**
+ * Removes all nodes whose index is in @p removed from a liveness set.
+ */
+static void lv_remove_nodes_from_set(be_lv_info_t *const irn_live,
+                                     bitset_t const *const removed)
+{
+	if (irn_live->n_idx != 0) {
+		bitset_foreach(removed, idx) {
+			dense_clear(irn_live, idx);
+		}
+		return;
+	}
+
+	unsigned const n = irn_live->n_members;
+	unsigned       k = 0;
+	for (unsigned i = 0; i < n; ++i) {
+		be_lv_info_node_t const member = irn_live->nodes[i];
+		if (!bitset_is_set(removed, get_irn_idx(member.node)))
+			irn_live->nodes[k++] = member;
+	}
+	memset(&irn_live->nodes[k], 0, (n - k) * sizeof(*irn_live->nodes));
+	irn_live->n_members = k;
 }
 
 typedef struct lv_remove_walker_t {
@@ -141,8 +247,13 @@ static void lv_remove_irn_walker(ir_node *const bl, void *const data)
 	if (irn_live == NULL)
 		return;
 
+	ir_node const *const irn = w->irn;
+	if (irn_live->n_idx != 0) {
+		dense_clear(irn_live, get_irn_idx(irn));
+		return;
+	}
+
 	unsigned           const n   = irn_live->n_members;
-	ir_node     const *const irn = w->irn;
 	unsigned           const pos = _be_liveness_bsearch(irn_live, irn);
 	be_lv_info_node_t *const res = &irn_live->nodes[pos];
 	if (res->node != irn)
@@ -174,13 +285,10 @@ static struct {
  */
 static void live_end_at_block(ir_node *const block, be_lv_state_t const state)
 {
-	be_lv_info_node_t *const n      = be_lv_get_or_set(re.lv, block, re.def);
-	be_lv_state_t      const before = n->flags;
-
 	assert(state == be_lv_state_end || state == (be_lv_state_end | be_lv_state_out));
 	DBG((dbg, LEVEL_2, "marking %+F live %s at %+F\n", re.def,
 	     state & be_lv_state_out ? "end+out" : "end", block));
-	n->flags |= state;
+	be_lv_state_t const before = be_lv_add(re.lv, block, re.def, state);
 
 	/* There is no need to recurse further, if we where here before (i.e., any
 	 * live state bits were set before). */
@@ -192,7 +300,7 @@ static void live_end_at_block(ir_node *const block, be_lv_state_t const state)
 		return;
 
 	DBG((dbg, LEVEL_2, "marking %+F live in at %+F\n", re.def, block));
-	n->flags |= be_lv_state_in;
+	be_lv_add(re.lv, block, re.def, be_lv_state_in);
 
 	for (unsigned i = get_Block_n_cfgpreds(block); i-- > 0;) {
 		ir_node *const pred_block = get_Block_cfgpred_block(block, i);
@@ -235,9 +343,8 @@ static void liveness_for_node(ir_node *irn)
 		} else if (def_block != use_block) {
 			/* Else, the value is live in at this block. Mark it and call live
 			 * out on the predecessors. */
-			be_lv_info_node_t *const n = be_lv_get_or_set(re.lv, use_block, irn);
 			DBG((dbg, LEVEL_2, "marking %+F live in at %+F\n", irn, use_block));
-			n->flags |= be_lv_state_in;
+			be_lv_add(re.lv, use_block, irn, be_lv_state_in);
 
 			for (unsigned i = get_Block_n_cfgpreds(use_block); i-- > 0; ) {
 				ir_node *pred_block = get_Block_cfgpred_block(use_block, i);
@@ -355,6 +462,29 @@ void be_liveness_update(be_lv_t *lv, ir_node *irn)
 	be_liveness_introduce(lv, irn);
 }
 
+void be_liveness_update_nodes(be_lv_t *lv, ir_nodeset_t const *nodes)
+{
+	assert(lv->sets_valid);
+
+	bitset_t *const removed = bitset_malloc(get_irg_last_idx(lv->irg));
+	foreach_ir_nodeset(nodes, irn, iter) {
+		bitset_set(removed, get_irn_idx(irn));
+	}
+
+	ir_nodehashmap_iterator_t iter;
+	ir_nodehashmap_entry_t    entry;
+	foreach_ir_nodehashmap(&lv->map, entry, iter) {
+		lv_remove_nodes_from_set((be_lv_info_t*)entry.data, removed);
+	}
+	free(removed);
+
+	re.lv = lv;
+	foreach_ir_nodeset(nodes, irn, iter) {
+		if (is_liveness_node(irn))
+			liveness_for_node(irn);
+	}
+}
+
 void be_liveness_transfer(const arch_register_class_t *cls,
                           ir_node *node, ir_nodeset_t *nodeset)
 {
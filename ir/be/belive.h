@@ -63,6 +63,13 @@ void be_liveness_invalidate_chk(be_lv_t *lv);
  */
 void be_liveness_update(be_lv_t *lv, ir_node *irn);
 
+/**
+ * Update the liveness information for a set of nodes. This has the same
+ * effect as calling be_liveness_update() for each of them, but removes the
+ * old information of all nodes in a single sweep over the liveness sets.
+ */
+void be_liveness_update_nodes(be_lv_t *lv, ir_nodeset_t const *nodes);
+
 /**
  * Remove a node from the liveness information.
  */
@@ -143,20 +150,41 @@ struct be_lv_info_node_t {
 	be_lv_state_t flags;
 };
 
+/**
+ * The liveness set of a block. Small sets are arrays of nodes sorted by
+ * address. Once such an array would take more memory than storing the state
+ * for every node index of the graph, the set switches to the dense form with
+ * BE_LV_STATE_BITS per node index.
+ */
 struct be_lv_info_t {
-	unsigned          n_members;
-	unsigned          n_size;
-	be_lv_info_node_t nodes[];
+	unsigned           n_members; /**< number of nodes in a sparse set */
+	unsigned           n_size;    /**< capacity of a sparse set */
+	unsigned           n_idx;     /**< node indices covered by a dense set,
+	                                   0 for a sparse set */
+	unsigned          *states;    /**< states of a dense set */
+	be_lv_info_node_t  nodes[];   /**< members of a sparse set */
 };
 
-be_lv_info_node_t *be_lv_get(const be_lv_t *li, const ir_node *block,
-                             const ir_node *irn);
+#define BE_LV_STATE_BITS     4
+#define BE_LV_STATES_PER_ELEM (sizeof(unsigned) * 8 / BE_LV_STATE_BITS)
+
+static inline be_lv_state_t be_lv_dense_get(be_lv_info_t const *const info,
+                                            unsigned const idx)
+{
+	if (idx >= info->n_idx)
+		return be_lv_state_none;
+	unsigned const shift = idx % BE_LV_STATES_PER_ELEM * BE_LV_STATE_BITS;
+	return (be_lv_state_t)(info->states[idx / BE_LV_STATES_PER_ELEM] >> shift
+	                       & ((1u << BE_LV_STATE_BITS) - 1));
+}
+
+be_lv_state_t be_lv_get(const be_lv_t *li, const ir_node *block,
+                        const ir_node *irn);
 
 static inline be_lv_state_t be_get_live_state(be_lv_t const *const li, ir_node const *const block, ir_node const *const irn)
 {
 	if (li->sets_valid) {
-		be_lv_info_node_t *info = be_lv_get(li, block, irn);
-		return info ? info->flags : be_lv_state_none;
+		return be_lv_get(li, block, irn);
 	} else {
 		return lv_chk_bl_xxx(li->lvc, block, irn);
 	}
@@ -201,6 +229,7 @@ static inline bool be_is_live_end(const be_lv_t *li, const ir_node *block,
 typedef struct lv_iterator_t
 {
 	be_lv_info_t *info;
+	ir_graph     *irg;
 	size_t        i;
 } lv_iterator_t;
 
@@ -209,37 +238,60 @@ static inline lv_iterator_t be_lv_iteration_begin(const be_lv_t *lv,
 {
 	assert(lv->sets_valid);
 	lv_iterator_t res;
-	res.info  = ir_nodehashmap_get(be_lv_info_t, &lv->map, block);
-	res.i     = res.info ? res.info->n_members : 0;
+	res.info = ir_nodehashmap_get(be_lv_info_t, &lv->map, block);
+	res.irg  = lv->irg;
+	res.i    = res.info == NULL     ? 0
+	         : res.info->n_idx != 0 ? res.info->n_idx
+	         : res.info->n_members;
 	return res;
 }
 
-static inline ir_node *be_lv_iteration_next(lv_iterator_t *iterator,
-                                            be_lv_state_t flags)
+/**
+ * Returns the next node in the liveness set, whose state has some of the
+ * bits in @p flags set.
+ */
+static inline ir_node *be_lv_iteration_raw_next(lv_iterator_t *iterator,
+                                                be_lv_state_t flags)
 {
+	be_lv_info_t const *const info = iterator->info;
+	if (info != NULL && info->n_idx != 0) {
+		while (iterator->i != 0) {
+			unsigned const idx = --iterator->i;
+			/* skip over elements without any live nodes */
+			if (idx % BE_LV_STATES_PER_ELEM == BE_LV_STATES_PER_ELEM - 1
+			    && info->states[idx / BE_LV_STATES_PER_ELEM] == 0) {
+				iterator->i -= BE_LV_STATES_PER_ELEM - 1;
+				continue;
+			}
+			if (be_lv_dense_get(info, idx) & flags)
+				return get_idx_irn(iterator->irg, idx);
+		}
+		return NULL;
+	}
+
 	while (iterator->i != 0) {
-		be_lv_info_node_t const *const node = &iterator->info->nodes[--iterator->i];
-		assert(get_irn_mode(node->node) != mode_T);
+		be_lv_info_node_t const *const node = &info->nodes[--iterator->i];
 		if (node->flags & flags)
 			return node->node;
 	}
 	return NULL;
 }
 
+static inline ir_node *be_lv_iteration_next(lv_iterator_t *iterator,
+                                            be_lv_state_t flags)
+{
+	ir_node *const node = be_lv_iteration_raw_next(iterator, flags);
+	assert(node == NULL || get_irn_mode(node) != mode_T);
+	return node;
+}
+
 static inline ir_node *be_lv_iteration_cls_next(lv_iterator_t *iterator,
                                                 be_lv_state_t flags,
                                                 const arch_register_class_t *cls)
 {
-	while (iterator->i != 0) {
-		be_lv_info_node_t const *const lnode = &iterator->info->nodes[--iterator->i];
-		assert(get_irn_mode(lnode->node) != mode_T);
-		if (!(lnode->flags & flags))
-			continue;
-
-		ir_node *const node = lnode->node;
-		if (!arch_irn_consider_in_reg_alloc(cls, node))
-			continue;
-		return node;
+	for (ir_node *node; (node = be_lv_iteration_next(iterator, flags)) != NULL;) {
+		if (arch_irn_consider_in_reg_alloc(cls, node))
+			return node;
 	}
 	return NULL;
 }
@@ -16,6 +16,7 @@
 #include "bearch.h"
 #include "bechordal_t.h"
 #include "beirg.h"
+#include "belive.h"
 #include "bemodule.h"
 #include "benode.h"
 #include "besched.h"
@@ -536,10 +537,42 @@ static void determine_spill_costs(spill_env_t *env, spill_info_t *spillinfo)
 	DB((dbg, LEVEL_1, "spill %+F after definition\n", to_spill));
 }
 
+/**
+ * Updates the liveness of all values touched by spilling: The spilled values,
+ * all nodes created since node index @p first_new_idx and their operands.
+ */
+static void update_liveness(spill_env_t *env, unsigned first_new_idx)
+{
+	ir_graph    *const irg = env->irg;
+	ir_nodeset_t       touched;
+	ir_nodeset_init(&touched);
+
+	for (spill_info_t *si = env->spills; si != NULL; si = si->next)
+		ir_nodeset_insert(&touched, si->to_spill);
+	for (spill_info_t *si = env->mem_phis; si != NULL; si = si->next_mem_phi)
+		ir_nodeset_insert(&touched, si->to_spill);
+
+	for (unsigned idx = first_new_idx, n = get_irg_last_idx(irg); idx < n;
+	     ++idx) {
+		ir_node *const node = get_idx_irn(irg, idx);
+		if (node == NULL || is_Deleted(node) || is_Block(node))
+			continue;
+		ir_nodeset_insert(&touched, node);
+		foreach_irn_in(node, i, op) {
+			ir_nodeset_insert(&touched, op);
+		}
+	}
+
+	be_liveness_update_nodes(be_get_irg_liveness(irg), &touched);
+	ir_nodeset_destroy(&touched);
+}
+
 void be_insert_spills_reloads(spill_env_t *env)
 {
 	be_timer_push(T_RA_SPILL_APPLY);
 
+	unsigned const first_new_idx = get_irg_last_idx(env->irg);
+
 	/* create all phi-ms first, this is needed so, that phis, hanging on
 	   spilled phis work correctly */
 	for (spill_info_t *info = env->mem_phis; info != NULL;
@@ -669,9 +702,10 @@ void be_insert_spills_reloads(spill_env_t *env)
 	stat_ev_dbl("spill_remats", env->remat_count);
 	stat_ev_dbl("spill_spilled_phis", env->spilled_phi_count);
 
-	/* Matze: In theory be_ssa_construction should take care of the liveness...
-	 * try to disable this again in the future */
-	be_invalidate_live_sets(env->irg);
+	/* Update the liveness of the touched values instead of recomputing it
+	 * for the whole graph. */
+	if (be_get_irg_liveness(env->irg)->sets_valid)
+		update_liveness(env, first_new_idx);
 
 	be_remove_dead_nodes_from_schedule(env->irg);
 
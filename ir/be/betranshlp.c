@@ -27,6 +27,7 @@
 #include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irhooks.h"
+#include "irmemory_t.h"
 #include "irnode_t.h"
 #include "irnodemap.h"
 #include "irop_t.h"
@@ -336,6 +337,7 @@ void be_transform_graph(ir_graph *irg, arch_pretrans_nodes *func)
 	irg->last_node_idx = 0;
 
 	free_vrp_data(irg);
+	free_alias_cache(irg);
 
 	/* create new value table for CSE */
 	new_identities(irg);
@@ -109,8 +109,9 @@ ir_node *insert_Perm_before(ir_graph *irg, const arch_register_class_t *cls,
 //---------------------------------------------------------------------------
 
 typedef struct remove_dead_nodes_env_t_ {
-	bitset_t *reachable;
-	be_lv_t  *lv;
+	bitset_t     *reachable;
+	be_lv_t      *lv;
+	ir_nodeset_t  operands; /**< live operands of removed nodes */
 } remove_dead_nodes_env_t;
 
 /**
@@ -134,8 +135,14 @@ static void remove_dead_nodes_walker(ir_node *block, void *data)
 		if (bitset_is_set(env->reachable, get_irn_idx(node)))
 			continue;
 
-		if (env->lv->sets_valid)
+		if (env->lv->sets_valid) {
 			be_liveness_remove(env->lv, node);
+			/* the operands may be live shorter now */
+			foreach_irn_in(node, i, op) {
+				if (bitset_is_set(env->reachable, get_irn_idx(op)))
+					ir_nodeset_insert(&env->operands, op);
+			}
+		}
 		sched_remove(node);
 
 		/* kill projs */
@@ -163,7 +170,11 @@ void be_remove_dead_nodes_from_schedule(ir_graph *irg)
 	irg_walk_graph(irg, mark_dead_nodes_walker, NULL, &env);
 
 	/* walk schedule and remove non-marked nodes */
+	ir_nodeset_init(&env.operands);
 	irg_block_walk_graph(irg, remove_dead_nodes_walker, NULL, &env);
+	if (ir_nodeset_size(&env.operands) > 0)
+		be_liveness_update_nodes(env.lv, &env.operands);
+	ir_nodeset_destroy(&env.operands);
 }
 
 void be_keep_if_unused(ir_node *node)
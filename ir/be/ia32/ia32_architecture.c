@@ -894,6 +894,7 @@ void ia32_setup_cg_config(void)
 	c->use_incdec           = !flags(opt_arch, arch_netburst | arch_nocona | arch_core2 | arch_geode) || opt_size;
 	c->use_softfloat        = (fpu_arch & IA32_FPU_SOFTFLOAT) != 0;
 	c->use_sse2             = (fpu_arch & IA32_FPU_SSE2) != 0 && flags(arch, arch_feature_sse2);
+	c->use_packed_sse2      = !c->use_softfloat && flags(arch, arch_feature_sse2);
 	c->use_ffreep           = flags(opt_arch, arch_athlon_plus);
 	c->use_femms            = flags(opt_arch, arch_athlon_plus) && flags(arch, arch_feature_3DNow);
 	c->use_fucomi           = flags(arch, arch_feature_p6_insn);
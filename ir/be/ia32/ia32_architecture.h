@@ -27,6 +27,8 @@ typedef struct {
 	bool use_softfloat:1;
 	/** use sse2 instructions (instead of x87) */
 	bool use_sse2:1;
+	/** use packed sse2 instructions for vector modes */
+	bool use_packed_sse2:1;
 	/** use ffreep instead of fpop */
 	bool use_ffreep:1;
 	/** use femms to pop all float registers */
@@ -1344,6 +1344,63 @@ static int ia32_is_mux_allowed(ir_node const *const sel,
 	return true;
 }
 
+/**
+ * Returns true if SSE2 has a single instruction for the operation @p opcode
+ * on the vector mode @p mode.
+ */
+static bool ia32_has_vector_op(unsigned const opcode, ir_mode *const mode)
+{
+	if (!ia32_cg_config.use_packed_sse2 || get_mode_size_bits(mode) != 128)
+		return false;
+
+	ir_mode *const element_mode = get_mode_vector_element_mode(mode);
+	unsigned const element_size = get_mode_size_bits(element_mode);
+	bool     const is_float     = mode_is_float(element_mode);
+	if (is_float && element_size != 32 && element_size != 64)
+		return false;
+
+	switch (opcode) {
+	case iro_Add:
+	case iro_And:
+	case iro_Const:
+	case iro_Eor:
+	case iro_Load:
+	case iro_Minus:
+	case iro_Not:
+	case iro_Or:
+	case iro_Phi:
+	case iro_Store:
+	case iro_Sub:
+	case iro_Unknown:
+		return true;
+	case iro_Mul:
+		/* SSE2 only has a packed 16bit integer multiplication */
+		return is_float || element_size == 16;
+	default:
+		return false;
+	}
+}
+
+/**
+ * Decides which vector operations are kept for the backend.
+ */
+static int ia32_lower_vector_callback(ir_node *const node)
+{
+	ir_mode *mode;
+	switch (get_irn_opcode(node)) {
+	case iro_Load:  mode = get_Load_mode(node);                 break;
+	case iro_Store: mode = get_irn_mode(get_Store_value(node)); break;
+	case iro_Proj:  return is_Load(get_Proj_pred(node));
+	default:        mode = get_irn_mode(node);                  break;
+	}
+	return ia32_has_vector_op(get_irn_opcode(node), mode);
+}
+
+static int ia32_vector_cost(ir_node const *const node, ir_mode *const mode)
+{
+	return ia32_has_vector_op(get_irn_opcode(node), mode) ? 1 : -1;
+}
+
 /**
  * Initializes the backend ISA.
  */
@@ -1365,6 +1422,7 @@ static void ia32_init(void)
 	ir_target.fast_unaligned_memaccess = true;
 	ir_target.allow_ifconv             = ia32_is_mux_allowed;
 	ir_target.float_int_overflow       = ir_overflow_indefinite;
+	ir_target.vector_cost              = ia32_vector_cost;
 	ir_platform_set_va_list_type_pointer();
 
 	if (!ia32_cg_config.use_sse2 && !ia32_cg_config.use_softfloat) {
@@ -1576,6 +1634,11 @@ static const ir_settings_arch_dep_t ia32_arch_dep = {
 
 static void ia32_lower_for_target(void)
 {
+	foreach_irp_irg(i, irg) {
+		lower_vector(irg, ia32_lower_vector_callback);
+		be_after_transform(irg, "lower-vector");
+	}
+
 	ir_arch_lower(&ia32_arch_dep);
 	be_after_irp_transform("lower-arch-dep");
 
@@ -27,6 +27,7 @@ static const unsigned ignore_regs[] = {
 	REG_ESP,
 	REG_GP_NOREG,
 	REG_FP_NOREG,
+	REG_XMM_NOREG,
 };
 
 static const arch_register_t* const default_param_regs[] = {};
@@ -156,6 +156,10 @@ static const char *get_register_name_size(arch_register_t const *const reg,
                                           x86_insn_size_t const size,
                                           bool use_8bit_high)
 {
+	/* the size only selects a subregister of general purpose registers */
+	if (reg->cls != &ia32_reg_classes[CLASS_ia32_gp])
+		return reg->name;
+
 	switch (size) {
 	case X86_SIZE_8:
 		return use_8bit_high ? get_register_name_8bit_high(reg)
@@ -165,6 +169,7 @@ static const char *get_register_name_size(arch_register_t const *const reg,
 	case X86_SIZE_64:
 	case X86_SIZE_80:
 	case X86_SIZE_128:
+	case X86_SIZE_256:
 		break;
 	}
 	panic("Unexpected size");
@@ -202,6 +207,7 @@ static void ia32_emit_mode_suffix(x86_insn_size_t const size)
 	case X86_SIZE_64: be_emit_cstring("ll"); return;
 	case X86_SIZE_80:
 	case X86_SIZE_128:
+	case X86_SIZE_256:
 		break;
 	}
 	panic("Unexpected mode size");
@@ -223,6 +229,7 @@ static void ia32_emit_x87_mode_suffix(ir_node const *const node)
 	case X86_SIZE_128: be_emit_char('t'); return;
 	case X86_SIZE_8:
 	case X86_SIZE_16:
+	case X86_SIZE_256:
 		break;
 	}
 	panic("Unexpected size");
@@ -241,6 +248,7 @@ static void ia32_emit_x87_mode_suffix_int(ir_node const *const node)
 	case X86_SIZE_8:
 	case X86_SIZE_80:
 	case X86_SIZE_128:
+	case X86_SIZE_256:
 		break;
 	}
 	panic("Unexpected size");
@@ -255,6 +263,7 @@ static char get_xmm_mode_suffix(x86_insn_size_t const size)
 	case X86_SIZE_16:
 	case X86_SIZE_80:
 	case X86_SIZE_128:
+	case X86_SIZE_256:
 		break;
 	}
 	panic("invalid XMM mode");
@@ -266,6 +275,28 @@ static void ia32_emit_xmm_mode_suffix(ir_node const *const node)
 	be_emit_char(get_xmm_mode_suffix(attr->size));
 }
 
+/** Suffix of packed integer SSE instructions for the element size. */
+static char get_packed_mode_suffix(x86_insn_size_t const size)
+{
+	switch (size) {
+	case X86_SIZE_8:  return 'b';
+	case X86_SIZE_16: return 'w';
+	case X86_SIZE_32: return 'd';
+	case X86_SIZE_64: return 'q';
+	case X86_SIZE_80:
+	case X86_SIZE_128:
+	case X86_SIZE_256:
+		break;
+	}
+	panic("invalid packed mode");
+}
+
+static void ia32_emit_packed_mode_suffix(ir_node const *const node)
+{
+	ia32_attr_t const *const attr = get_ia32_attr_const(node);
+	be_emit_char(get_packed_mode_suffix(attr->size));
+}
+
 void x86_emit_condition_code(x86_condition_code_t cc)
 {
 	switch (cc) {
@@ -459,6 +490,8 @@ destination_operand:
 						be_emit_char('r');
 				} else if (*fmt == 'X') {
 					ia32_emit_xmm_mode_suffix(node);
+				} else if (*fmt == 'E') {
+					ia32_emit_packed_mode_suffix(node);
 				} else if (*fmt == '0') {
 					be_emit_char('%');
 					be_emit_string(get_ia32_x87_attr_const(node)->x87.reg->name);
@@ -950,7 +983,11 @@ static void Copy_emitter(const ir_node *node, const ir_node *op)
 	if (in->cls == &ia32_reg_classes[CLASS_ia32_fp])
 		return;
 
-	ia32_emitf(node, "movl %#R, %#R", in, out);
+	if (in->cls == &ia32_reg_classes[CLASS_ia32_xmm]) {
+		ia32_emitf(node, "movapd %#R, %#R", in, out);
+	} else {
+		ia32_emitf(node, "movl %#R, %#R", in, out);
+	}
 }
 
 static void emit_be_Copy(const ir_node *node)
@@ -27,6 +27,7 @@
  * %B   <node>                  operands for binary operation
  * %Dx  <node>                  destination register x
  * %E   ir_entity const*        emit entity name
+ * %FE  <node>                  packed integer SSE element suffix
  * %Fx  <node>                  x87 register x
  * %FM  <node>                  x87 mode suffix
  * %FX  <node>                  SSE mode suffix
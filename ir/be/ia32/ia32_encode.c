@@ -255,6 +255,7 @@ static void enc_imm(ia32_immediate_attr_t const *const attr,
 	case X86_SIZE_64:
 	case X86_SIZE_80:
 	case X86_SIZE_128:
+	case X86_SIZE_256:
 		break;
 	}
 	panic("Invalid size");
@@ -1125,6 +1126,7 @@ static void enc_fild(const ir_node *node)
 
 	case X86_SIZE_8:
 	case X86_SIZE_128:
+	case X86_SIZE_256:
 	case X86_SIZE_80:
 		break;
 	}
@@ -1149,6 +1151,7 @@ enc:
 	case X86_SIZE_8:
 	case X86_SIZE_80:
 	case X86_SIZE_128:
+	case X86_SIZE_256:
 		break;
 	}
 	panic("invalid mode size");
@@ -1164,6 +1167,7 @@ static void enc_fisttp(ir_node const *const node)
 	case X86_SIZE_8:
 	case X86_SIZE_80:
 	case X86_SIZE_128:
+	case X86_SIZE_256:
 		panic("unexpected mode size");
 	}
 	enc_mod_am(1, node);
@@ -1191,6 +1195,7 @@ static void enc_fld(const ir_node *node)
 	case X86_SIZE_8:
 	case X86_SIZE_16:
 	case X86_SIZE_128:
+	case X86_SIZE_256:
 		break;
 	}
 	panic("unexpected mode size");
@@ -1220,6 +1225,7 @@ enc:
 	case X86_SIZE_8:
 	case X86_SIZE_16:
 	case X86_SIZE_128:
+	case X86_SIZE_256:
 		break;
 	}
 	panic("unexpected mode size");
@@ -380,6 +380,32 @@ my $xbinop_commutative = {
 	emit      => "{name}%FX %B",
 };
 
+# Packed SSE operations have no address mode, as memory operands would have to
+# be aligned. The size attribute is the size of the elements.
+my $xpacked = {
+	irn_flags => [ "rematerializable" ],
+	state     => "exc_pinned",
+	in_reqs   => [ "gp", "gp", "mem", "xmm", "xmm" ],
+	out_reqs  => [ "in_r3 !in_r4", "flags", "mem" ],
+	ins       => [ "base", "index", "mem", "left", "right" ],
+	outs      => [ "res", "flags", "M" ],
+	mode      => "first",
+	attr      => "x86_insn_size_t size",
+	emit      => "{name} %B",
+};
+
+my $xpacked_commutative = {
+	irn_flags => [ "rematerializable" ],
+	state     => "exc_pinned",
+	in_reqs   => [ "gp", "gp", "mem", "xmm", "xmm" ],
+	out_reqs  => [ "in_r3 in_r4", "flags", "mem" ],
+	ins       => [ "base", "index", "mem", "left", "right" ],
+	outs      => [ "res", "flags", "M" ],
+	mode      => "first",
+	attr      => "x86_insn_size_t size",
+	emit      => "{name} %B",
+};
+
 my $xconv_i2f = {
 	state    => "exc_pinned",
 	in_reqs  => [ "gp", "gp", "mem", "gp" ],
@@ -1457,6 +1483,56 @@ Divs => {
 	mode     => "mode_T"
 },
 
+Addp => {
+	template => $xpacked_commutative,
+	emit     => "addp%FX %B",
+	latency  => 4,
+},
+
+Subp => {
+	template => $xpacked,
+	emit     => "subp%FX %B",
+	latency  => 4,
+},
+
+Mulp => {
+	template => $xpacked_commutative,
+	emit     => "mulp%FX %B",
+	latency  => 4,
+},
+
+Padd => {
+	template => $xpacked_commutative,
+	emit     => "padd%FE %B",
+	latency  => 1,
+},
+
+Psub => {
+	template => $xpacked,
+	emit     => "psub%FE %B",
+	latency  => 1,
+},
+
+Pmullw => {
+	template => $xpacked_commutative,
+	latency  => 3,
+},
+
+Pand => {
+	template => $xpacked_commutative,
+	latency  => 1,
+},
+
+Por => {
+	template => $xpacked_commutative,
+	latency  => 1,
+},
+
+Pxor => {
+	template => $xpacked_commutative,
+	latency  => 1,
+},
+
 Ucomis => {
 	irn_flags => [ "modify_flags", "rematerializable" ],
 	state     => "exc_pinned",
@@ -1914,11 +1990,11 @@ xxLoad => {
 	op_flags  => [ "uses_memory", "fragile" ],
 	state     => "exc_pinned",
 	in_reqs   => [ "gp", "gp", "mem" ],
-	out_reqs  => [ "xmm", "mem", "exec", "exec" ],
+	out_reqs  => [ "xmm", "none", "mem", "exec", "exec" ],
 	attr      => "x86_insn_size_t size",
-	emit      => "movdqu %D0, %AM",
+	emit      => "movdqu %AM, %D0",
 	ins       => [ "base", "index", "mem" ],
-	outs      => [ "res", "M", "X_regular", "X_except" ],
+	outs      => [ "res", "unused", "M", "X_regular", "X_except" ],
 	latency   => 1,
 },
 
@@ -272,7 +272,7 @@ static ir_node *try_create_Immediate(const ir_node *node, char const constraint)
 static ir_entity *create_float_const_entity(ir_tarval *tv, ident *name)
 {
 	ir_mode *mode = get_tarval_mode(tv);
-	if (!ia32_cg_config.use_sse2) {
+	if (!ia32_cg_config.use_sse2 && mode_is_float(mode)) {
 		/* try to reduce the mode to produce smaller sized entities */
 		ir_mode *const modes[] = { mode_F, mode_D, NULL };
 		for (ir_mode *const *i = modes;; ++i) {
@@ -315,6 +315,29 @@ static void set_am_const_entity(ir_node *node, ir_entity *entity)
 	attr->addr.variant = lconst_variant;
 }
 
+/**
+ * Creates a vector constant. Zero and all ones are produced in a register,
+ * everything else is loaded from a constant entity.
+ */
+static ir_node *create_vector_const(dbg_info *const dbgi, ir_node *const block,
+                                    ir_tarval *const tv)
+{
+	if (tarval_is_null(tv))
+		return new_bd_ia32_xPzero(dbgi, block, X86_SIZE_128);
+	if (tarval_is_all_one(tv))
+		return new_bd_ia32_xAllOnes(dbgi, block, X86_SIZE_128);
+
+	ir_entity *const ent  = create_float_const_entity(tv, NULL);
+	ir_node   *const base = get_global_base(get_irn_irg(block));
+	ir_node   *const load = new_bd_ia32_xxLoad(dbgi, block, base, noreg_GP,
+	                                           nomem, X86_SIZE_128);
+	set_irn_pinned(load, false);
+	set_ia32_op_type(load, ia32_AddrModeS);
+	set_am_const_entity(load, ent);
+	arch_add_irn_flags(load, arch_irn_flag_rematerializable);
+	return be_new_Proj(load, pn_ia32_xxLoad_res);
+}
+
 /**
  * Transforms a Const.
  */
@@ -326,7 +349,9 @@ static ir_node *gen_Const(ir_node *node)
 	ir_tarval      *const tv    = get_Const_tarval(node);
 	x86_insn_size_t const size  = x86_size_from_mode(mode);
 
-	if (mode_is_float(mode)) {
+	if (mode_is_vector(mode)) {
+		return create_vector_const(dbgi, block, tv);
+	} else if (mode_is_float(mode)) {
 		ir_graph *const irg = get_irn_irg(node);
 		ir_node        *res;
 		if (ia32_cg_config.use_sse2) {
@@ -540,7 +565,9 @@ static ir_node *gen_Unknown(ir_node *node)
 {
 	ir_node *const block = be_transform_nodes_block(node);
 	ir_mode *const mode  = get_irn_mode(node);
-	if (mode_is_float(mode)) {
+	if (mode_is_vector(mode)) {
+		return be_new_Unknown(block, &ia32_class_reg_req_xmm);
+	} else if (mode_is_float(mode)) {
 		if (ia32_cg_config.use_sse2) {
 			return be_new_Unknown(block, &ia32_class_reg_req_xmm);
 		} else {
@@ -1066,6 +1093,46 @@ static ir_node *gen_binop(ir_node *node, ir_node *op1, ir_node *op2,
 	return new_node;
 }
 
+static bool is_float_vector(ir_mode *const mode)
+{
+	return mode_is_float(get_mode_vector_element_mode(mode));
+}
+
+/**
+ * Creates a packed SSE operation, the size attribute is the size of the
+ * elements. Memory operands are not matched, as they would have to be
+ * aligned.
+ */
+static ir_node *create_binop_vector(dbg_info *const dbgi, ir_node *const block,
+                                    ir_mode *const mode,
+                                    ir_node *const new_op1,
+                                    ir_node *const new_op2,
+                                    construct_binop_func *const func)
+{
+	ir_mode        *const element_mode = get_mode_vector_element_mode(mode);
+	x86_insn_size_t const size         = x86_size_from_mode(element_mode);
+	ir_node        *const res          = func(dbgi, block, noreg_GP, noreg_GP,
+	                                          nomem, new_op1, new_op2, size);
+	/* allow the finishing phase to swap the operands of commutative ones */
+	arch_register_req_t const *const req
+		= arch_get_irn_register_req_out(res, pn_ia32_res);
+	if (req->should_be_same == (1U << n_ia32_binary_left | 1U << n_ia32_binary_right))
+		set_ia32_commutative(res);
+	return res;
+}
+
+static ir_node *gen_binop_vector(ir_node *const node, ir_node *const op1,
+                                 ir_node *const op2,
+                                 construct_binop_func *const func)
+{
+	dbg_info *const dbgi    = get_irn_dbg_info(node);
+	ir_node  *const block   = be_transform_nodes_block(node);
+	ir_node  *const new_op1 = be_transform_node(op1);
+	ir_node  *const new_op2 = be_transform_node(op2);
+	ir_mode  *const mode    = get_irn_mode(node);
+	return create_binop_vector(dbgi, block, mode, new_op1, new_op2, func);
+}
+
 /**
  * Generic names for the inputs of an ia32 binary op.
  */
@@ -1437,7 +1504,10 @@ static ir_node *gen_Add(ir_node *node)
 	if (shift64)
 		return shift64;
 
-	if (mode_is_float(mode)) {
+	if (mode_is_vector(mode)) {
+		return gen_binop_vector(node, op1, op2, is_float_vector(mode)
+		                        ? new_bd_ia32_Addp : new_bd_ia32_Padd);
+	} else if (mode_is_float(mode)) {
 		if (ia32_cg_config.use_sse2)
 			return gen_binop(node, op1, op2, new_bd_ia32_Adds,
 			                 match_commutative | match_am);
@@ -1508,7 +1578,11 @@ static ir_node *gen_Mul(ir_node *node)
 	ir_node *op2  = get_Mul_right(node);
 	ir_mode *mode = get_irn_mode(node);
 
-	if (mode_is_float(mode)) {
+	if (mode_is_vector(mode)) {
+		/* only 16bit integer elements have a packed multiplication */
+		return gen_binop_vector(node, op1, op2, is_float_vector(mode)
+		                        ? new_bd_ia32_Mulp : new_bd_ia32_Pmullw);
+	} else if (mode_is_float(mode)) {
 		if (ia32_cg_config.use_sse2)
 			return gen_binop(node, op1, op2, new_bd_ia32_Muls,
 			                 match_commutative | match_am);
@@ -1569,6 +1643,8 @@ static ir_node *gen_And(ir_node *node)
 	ir_node *op1 = get_And_left(node);
 	ir_node *op2 = get_And_right(node);
 	assert(!mode_is_float(get_irn_mode(node)));
+	if (mode_is_vector(get_irn_mode(node)))
+		return gen_binop_vector(node, op1, op2, new_bd_ia32_Pand);
 
 	/* is it a zero extension? */
 	if (is_Const(op2)) {
@@ -1593,6 +1669,11 @@ static ir_node *gen_And(ir_node *node)
 
 static ir_node *gen_Or(ir_node *node)
 {
+	if (mode_is_vector(get_irn_mode(node))) {
+		return gen_binop_vector(node, get_Or_left(node), get_Or_right(node),
+		                        new_bd_ia32_Por);
+	}
+
 	ir_node *rot_left;
 	ir_node *rot_right;
 	if (be_pattern_is_rotl(node, &rot_left, &rot_right)) {
@@ -1622,6 +1703,8 @@ static ir_node *gen_Eor(ir_node *node)
 	assert(!mode_is_float(get_irn_mode(node)));
 	ir_node *op1 = get_Eor_left(node);
 	ir_node *op2 = get_Eor_right(node);
+	if (mode_is_vector(get_irn_mode(node)))
+		return gen_binop_vector(node, op1, op2, new_bd_ia32_Pxor);
 	return gen_binop(node, op1, op2, new_bd_ia32_Xor, match_commutative
 	                 | match_mode_neutral | match_am | match_immediate);
 }
@@ -1637,7 +1720,10 @@ static ir_node *gen_Sub(ir_node *node)
 	ir_node *op2  = get_Sub_right(node);
 	ir_mode *mode = get_irn_mode(node);
 
-	if (mode_is_float(mode)) {
+	if (mode_is_vector(mode)) {
+		return gen_binop_vector(node, op1, op2, is_float_vector(mode)
+		                        ? new_bd_ia32_Subp : new_bd_ia32_Psub);
+	} else if (mode_is_float(mode)) {
 		if (ia32_cg_config.use_sse2)
 			return gen_binop(node, op1, op2, new_bd_ia32_Subs, match_am);
 		else
@@ -1905,6 +1991,29 @@ static ir_node *gen_Shrs(ir_node *node)
  *
  * @return The created ia32 Minus node
  */
+/**
+ * Negates the lanes of a vector. Floats get their sign bits flipped, integers
+ * are subtracted from zero.
+ */
+static ir_node *gen_vector_neg(dbg_info *const dbgi, ir_node *const block,
+                               ir_mode *const mode, ir_node *const new_op)
+{
+	if (is_float_vector(mode)) {
+		ir_mode    *const element_mode = get_mode_vector_element_mode(mode);
+		unsigned    const n_lanes      = get_mode_vector_n_lanes(mode);
+		ir_tarval **const lanes        = ALLOCAN(ir_tarval*, n_lanes);
+		for (unsigned i = 0; i < n_lanes; ++i)
+			lanes[i] = tarval_neg(get_mode_null(element_mode));
+		ir_tarval *const tv   = new_tarval_from_lanes(mode, lanes);
+		ir_node   *const mask = create_vector_const(dbgi, block, tv);
+		return create_binop_vector(dbgi, block, mode, new_op, mask,
+		                           new_bd_ia32_Pxor);
+	}
+	ir_node *const zero = new_bd_ia32_xPzero(dbgi, block, X86_SIZE_128);
+	return create_binop_vector(dbgi, block, mode, zero, new_op,
+	                           new_bd_ia32_Psub);
+}
+
 static ir_node *gen_Minus(ir_node *node)
 {
 	ir_node  *op    = get_Minus_op(node);
@@ -1912,7 +2021,9 @@ static ir_node *gen_Minus(ir_node *node)
 	dbg_info *dbgi  = get_irn_dbg_info(node);
 	ir_mode  *mode  = get_irn_mode(node);
 
-	if (mode_is_float(mode)) {
+	if (mode_is_vector(mode)) {
+		return gen_vector_neg(dbgi, block, mode, be_transform_node(op));
+	} else if (mode_is_float(mode)) {
 		ir_node *new_op = be_transform_node(op);
 		if (ia32_cg_config.use_sse2) {
 			/* TODO: non-optimal... if we have many xXors, then we should
@@ -1949,6 +2060,16 @@ static ir_node *gen_Not(ir_node *node)
 	assert(get_irn_mode(node) != mode_b); /* should be lowered already */
 	ir_node *op = get_Not_op(node);
 
+	ir_mode *const mode = get_irn_mode(node);
+	if (mode_is_vector(mode)) {
+		dbg_info *const dbgi   = get_irn_dbg_info(node);
+		ir_node  *const block  = be_transform_nodes_block(node);
+		ir_node  *const new_op = be_transform_node(op);
+		ir_node  *const ones   = new_bd_ia32_xAllOnes(dbgi, block, X86_SIZE_128);
+		return create_binop_vector(dbgi, block, mode, new_op, ones,
+		                           new_bd_ia32_Pxor);
+	}
+
 	if (is_Shl_1(op)) {
 		/* ~(1 << x) -> Rol(~1, x) */
 		dbg_info   *const dbgi    = get_irn_dbg_info(node);
@@ -2201,7 +2322,9 @@ static ir_node *gen_Load(ir_node *node)
 
 	x86_insn_size_t const size = x86_size_from_mode(mode);
 	ir_node *new_node;
-	if (mode_is_float(mode)) {
+	if (mode_is_vector(mode)) {
+		new_node = new_bd_ia32_xxLoad(dbgi, block, base, idx, new_mem, size);
+	} else if (mode_is_float(mode)) {
 		if (ia32_cg_config.use_sse2) {
 			new_node = new_bd_ia32_xLoad(dbgi, block, base, idx, new_mem, size);
 		} else {
@@ -2228,7 +2351,8 @@ static ir_node *gen_Load(ir_node *node)
 	set_address(new_node, &addr);
 
 	if (!get_irn_pinned(node)) {
-		assert((int)pn_ia32_xLoad_res == (int)pn_ia32_fld_res
+		assert((int)pn_ia32_xxLoad_res == (int)pn_ia32_xLoad_res
+		       && (int)pn_ia32_xLoad_res == (int)pn_ia32_fld_res
 		       && (int)pn_ia32_fld_res == (int)pn_ia32_Load_res
 		       && (int)pn_ia32_Load_res == (int)pn_ia32_res);
 		arch_add_irn_flags(new_node, arch_irn_flag_rematerializable);
@@ -2685,7 +2809,11 @@ static ir_node *create_store(dbg_info *dbgi, ir_node *new_block,
 	ir_mode        *const mode = get_irn_mode(value);
 	x86_insn_size_t const size = x86_size_from_mode(mode);
 	ir_node *store;
-	if (mode_is_float(mode)) {
+	if (mode_is_vector(mode)) {
+		ir_node *new_val = be_transform_node(value);
+		store = new_bd_ia32_xxStore(dbgi, new_block, addr->base, addr->index,
+		                            addr->mem, new_val, size);
+	} else if (mode_is_float(mode)) {
 		if (ia32_cg_config.use_sse2) {
 			ir_node *new_val = be_transform_node(value);
 			store = new_bd_ia32_xStore(dbgi, new_block, addr->base, addr->index,
@@ -4180,6 +4308,8 @@ static ir_node *gen_Phi(ir_node *node)
 		} else {
 			req = &ia32_class_reg_req_fp;
 		}
+	} else if (mode_is_vector(mode)) {
+		req = &ia32_class_reg_req_xmm;
 	} else {
 		req = arch_memory_req;
 	}
@@ -4515,6 +4645,19 @@ static ir_node *gen_Proj_Load(ir_node *node)
 		case pn_Load_X_regular:
 			return be_new_Proj(new_pred, pn_ia32_xLoad_X_regular);
 		}
+	} else if (is_ia32_xxLoad(new_pred)) {
+		switch ((pn_Load)pn) {
+		case pn_Load_res:
+			return be_new_Proj(new_pred, pn_ia32_xxLoad_res);
+		case pn_Load_M:
+			return be_new_Proj(new_pred, pn_ia32_xxLoad_M);
+		case pn_Load_X_except:
+			/* This Load might raise an exception. Mark it. */
+			set_ia32_exc_label(new_pred, 1);
+			return be_new_Proj(new_pred, pn_ia32_xxLoad_X_except);
+		case pn_Load_X_regular:
+			return be_new_Proj(new_pred, pn_ia32_xxLoad_X_regular);
+		}
 	} else if (is_ia32_fld(new_pred)) {
 		switch ((pn_Load)pn) {
 		case pn_Load_res:
@@ -4596,6 +4739,15 @@ static ir_node *create_proj_for_store(ir_node *store, pn_Store pn)
 		case pn_Store_X_regular:
 			return be_new_Proj(store, pn_ia32_xStore_X_regular);
 		}
+	} else if (is_ia32_xxStore(store)) {
+		switch ((pn_Store)pn) {
+		case pn_Store_M:
+			return be_new_Proj(store, pn_ia32_xxStore_M);
+		case pn_Store_X_except:
+			return be_new_Proj(store, pn_ia32_xxStore_X_except);
+		case pn_Store_X_regular:
+			return be_new_Proj(store, pn_ia32_xxStore_X_regular);
+		}
 	} else if (is_Sync(store)) {
 		/* hack for the case that gen_float_const_Store produced a Sync */
 		if (pn == pn_Store_M) {
@@ -5617,6 +5769,7 @@ void ia32_transform_graph(ir_graph *irg)
 
 	be_timer_push(T_HEIGHTS);
 	heights = heights_new(irg);
+	heights_enable_reachability_index(heights);
 	be_timer_pop(T_HEIGHTS);
 	x86_calculate_non_address_mode_nodes(irg);
 
@@ -77,6 +77,7 @@ typedef enum x86_insn_size_t {
 	X86_SIZE_64,
 	X86_SIZE_80,
 	X86_SIZE_128,
+	X86_SIZE_256,
 } x86_insn_size_t;
 
 /** immediate/relocation types (see also ELF file format) */
@@ -170,6 +171,7 @@ static inline x86_insn_size_t x86_size_from_bytes(unsigned bytes)
 	case 8:  return X86_SIZE_64;
 	case 10: return X86_SIZE_80;
 	case 16: return X86_SIZE_128;
+	case 32: return X86_SIZE_256;
 	}
 	panic("Unexpected size");
 }
@@ -188,6 +190,7 @@ static inline unsigned x86_bytes_from_size(x86_insn_size_t const size)
 	case X86_SIZE_64:  return 8;
 	case X86_SIZE_80:  return 10;
 	case X86_SIZE_128: return 16;
+	case X86_SIZE_256: return 32;
 	}
 	panic("Invalid size");
 }
@@ -263,6 +263,11 @@ static void mips_generate_code(FILE *const output, char const *const cup_name)
 
 static void mips_lower_for_target(void)
 {
+	foreach_irp_irg(i, irg) {
+		lower_vector(irg, NULL);
+		be_after_transform(irg, "lower-vector");
+	}
+
 	ir_arch_lower(&mips_arch_dep);
 	be_after_irp_transform("lower-arch-dep");
 
@@ -20,6 +20,7 @@ typedef struct target_info_t {
 	arch_isa_if_t   const *isa;
 	char const            *experimental;
 	arch_allow_ifconv_func allow_ifconv;
+	arch_vector_cost_func  vector_cost;
 	ir_mode               *mode_float_arithmetic;
 	bool isa_initialized          : 1;
 	bool fast_unaligned_memaccess : 1;
@@ -18,11 +18,14 @@
 #include "debug.h"
 
 #include "hashptr.h"
+#include "lock.h"
 #include "obst.h"
 #include "set.h"
 
 static struct obstack dbg_obst;
 static set *module_set;
+/** Passes register their modules when they run, maybe in several threads. */
+static firm_lock_t module_lock = FIRM_LOCK_INIT;
 
 /**
  * A debug module.
@@ -61,10 +64,13 @@ firm_dbg_module_t *firm_dbg_register(const char *name)
   mod.name = name;
   mod.file = stderr;
 
+  firm_lock(&module_lock);
   if (!module_set)
     firm_dbg_init();
 
-  return set_insert(firm_dbg_module_t, module_set, &mod, sizeof(mod), hash_str(name));
+  firm_dbg_module_t *const res = set_insert(firm_dbg_module_t, module_set, &mod, sizeof(mod), hash_str(name));
+  firm_unlock(&module_lock);
+  return res;
 }
 
 void firm_dbg_set_mask(firm_dbg_module_t *module, unsigned mask)
@@ -55,7 +55,7 @@ struct ir_timer_t {
 };
 
 /** The top of the timer stack */
-static ir_timer_t *timer_stack;
+static FIRM_THREAD_LOCAL ir_timer_t *timer_stack;
 
 ir_timer_t *ir_timer_new(void)
 {
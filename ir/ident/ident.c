@@ -11,6 +11,7 @@
 #include "ident_t.h"
 
 #include "hashptr.h"
+#include "lock.h"
 #include "obst.h"
 #include "set.h"
 #include <stdio.h>
@@ -18,6 +19,9 @@
 
 static set *id_set;
 
+/** Protects id_set, id_obst and the id_unique() counter. */
+static firm_lock_t id_lock = FIRM_LOCK_INIT;
+
 /** An obstack used for temporary space */
 static struct obstack id_obst;
 
@@ -30,8 +34,10 @@ void init_ident(void)
 
 ident *new_id_from_chars(const char *str, size_t len)
 {
-	unsigned   hash   = hash_data((const unsigned char*)str, len);
+	unsigned hash = hash_data((const unsigned char*)str, len);
+	firm_lock(&id_lock);
 	set_entry *result = set_hinsert0(id_set, str, len, hash);
+	firm_unlock(&id_lock);
 	return (ident*)result->dptr;
 }
 
@@ -44,18 +50,22 @@ static ident *new_ident_from_obst(struct obstack *const obst)
 {
 	size_t const len    = obstack_object_size(obst);
 	char  *const string = (char*)obstack_finish(obst);
-	ident *const res    = new_id_from_chars(string, len);
+	unsigned     hash   = hash_data((const unsigned char*)string, len);
+	set_entry   *result = set_hinsert0(id_set, string, len, hash);
 	obstack_free(obst, string);
-	return res;
+	return (ident*)result->dptr;
 }
 
 ident *new_id_fmt(char const *const fmt, ...)
 {
 	va_list ap;
 	va_start(ap, fmt);
+	firm_lock(&id_lock);
 	obstack_vprintf(&id_obst, fmt, ap);
+	ident *const res = new_ident_from_obst(&id_obst);
+	firm_unlock(&id_lock);
 	va_end(ap);
-	return new_ident_from_obst(&id_obst);
+	return res;
 }
 
 const char *(get_id_str)(ident *id)
@@ -73,5 +83,8 @@ void finish_ident(void)
 ident *id_unique(const char *tag)
 {
 	static unsigned unique_id = 0;
-	return new_id_fmt("%s.%u", tag, unique_id++);
+	firm_lock(&id_lock);
+	unsigned const id = unique_id++;
+	firm_unlock(&id_lock);
+	return new_id_fmt("%s.%u", tag, id);
 }
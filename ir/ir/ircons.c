@@ -28,6 +28,7 @@
 #include "irprog_t.h"
 #include "irverify.h"
 #include "util.h"
+#include <string.h>
 
 /**
  * Language dependent variable initialization callback.
@@ -564,6 +565,122 @@ void irg_finalize_cons(ir_graph *irg)
 	clear_irg_constraints(irg, IR_GRAPH_CONSTRAINT_CONSTRUCTION);
 }
 
+void irg_begin_bulk_cons(ir_graph *irg, size_t n_nodes)
+{
+	ir_bulk_cons_t *const bulk = &irg->bulk_cons;
+	assert(!bulk->active);
+
+	/* reserve index map entries and value table buckets */
+	size_t const n_map = ARR_LEN(irg->idx_irn_map);
+	size_t const n_idx = irg->last_node_idx + n_nodes;
+	if (n_idx > n_map) {
+		ARR_RESIZE(ir_node*, irg->idx_irn_map, n_idx);
+		memset(&irg->idx_irn_map[n_map], 0, (n_idx - n_map) * sizeof(ir_node*));
+	}
+	if (irg->value_table != NULL)
+		ir_identities_reserve(irg->value_table, n_nodes);
+
+	/* optimize_node() does no CSE without a value table */
+	bulk->value_table = irg->value_table;
+	irg->value_table  = NULL;
+	bulk->first_idx   = irg->last_node_idx;
+	bulk->active      = true;
+	bulk->had_edges   = edges_activated(irg);
+	bulk->had_consistent_edges
+		= irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
+	if (bulk->had_edges)
+		edges_deactivate(irg);
+}
+
+/**
+ * Redirects the inputs of @p node and, for a block under construction, its
+ * current values away from Id nodes. The in array is inspected directly, as
+ * get_irn_n() would already skip the Ids.
+ *
+ * @return true if an input was changed
+ */
+static bool skip_Id_ins(ir_node *node)
+{
+	if (is_Block(node)) {
+		ir_node **const values = node->attr.block.graph_arr;
+		if (values != NULL) {
+			for (size_t i = 0, n = ARR_LEN(values); i < n; ++i) {
+				if (values[i] != NULL && is_Id(values[i]))
+					values[i] = skip_Id(values[i]);
+			}
+		}
+	}
+	bool changed = false;
+	for (int i = -1, arity = get_irn_arity(node); i < arity; ++i) {
+		ir_node *const pred = node->in[i + 1];
+		if (pred != NULL && is_Id(pred)) {
+			set_irn_n(node, i, skip_Id(pred));
+			changed = true;
+		}
+	}
+	return changed;
+}
+
+void irg_commit_bulk_cons(ir_graph *irg)
+{
+	ir_bulk_cons_t *const bulk = &irg->bulk_cons;
+	assert(bulk->active);
+	assert(irg->value_table == NULL && !edges_activated(irg));
+	irg->value_table = bulk->value_table;
+	bulk->active     = false;
+
+	/* Operands are created before their users (except for Phi and Block
+	 * inputs), so walking in creation order finds the representatives of the
+	 * operands before a node is looked up itself. */
+	bool const     cse      = irg->value_table != NULL && get_optimize()
+	                          && get_opt_cse();
+	bool           has_ids  = false;
+	unsigned const last_idx = get_irg_last_idx(irg);
+	for (unsigned idx = bulk->first_idx; idx < last_idx; ++idx) {
+		ir_node *const node = get_idx_irn(irg, idx);
+		if (node == NULL || is_Deleted(node))
+			continue;
+		if (is_Id(node)) {
+			/* left behind by the construction, e.g. a removed Phi */
+			has_ids = true;
+			continue;
+		}
+		if (!cse)
+			continue;
+		/* A node whose operands were merged may now be optimizable as well,
+		 * e.g. x - y after y was found to be x. Phis of immature blocks still
+		 * get inputs and are left alone. */
+		ir_node *repr;
+		if (skip_Id_ins(node) && !is_Block(node)
+		    && (!is_Phi(node) || get_Block_matured(get_nodes_block(node))))
+			repr = optimize_in_place(node);
+		else
+			repr = identify_remember(node);
+		if (repr != node) {
+			exchange(node, repr);
+			has_ids = true;
+		}
+	}
+
+	/* Phi and Block inputs, End keep-alives and the values of blocks under
+	 * construction may still point to exchanged nodes, including the ones
+	 * created before the bulk. */
+	if (has_ids) {
+		for (unsigned idx = 0, n = get_irg_last_idx(irg); idx < n; ++idx) {
+			ir_node *const node = get_idx_irn(irg, idx);
+			if (node != NULL && !is_Id(node) && !is_Deleted(node))
+				skip_Id_ins(node);
+		}
+	}
+
+	/* Nodes that are not yet reachable had edges before the bulk, too. */
+	if (bulk->had_edges) {
+		edges_activate_all_nodes(irg);
+		if (bulk->had_consistent_edges)
+			add_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
+	}
+}
+
 ir_node *new_Const_long(ir_mode *mode, long value)
 {
 	return new_d_Const_long(NULL, mode, value);
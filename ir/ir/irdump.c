@@ -1328,6 +1328,10 @@ static void dump_graph_info(FILE *F, ir_graph *irg)
 		fprintf(F, " consistent_entity_usage");
 	if (irg_has_properties(irg, IR_GRAPH_PROPERTY_MANY_RETURNS))
 		fprintf(F, " many_returns");
+	if (irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_ALIAS_CACHE))
+		fprintf(F, " consistent_alias_cache");
+	if (irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_PARAM_SUMMARY))
+		fprintf(F, " consistent_param_summary");
 	fprintf(F, "\"\n");
 }
 
@@ -167,7 +167,8 @@ void dump_irnode_to_file(FILE *const F, const ir_node *const n)
 	}
 
 	/* Loop node.   Someone else please tell me what's wrong ... */
-	if (irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO)) {
+	if (is_Block(n)
+	    && irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO)) {
 		const ir_loop *loop = get_irn_loop(n);
 		if (loop != NULL) {
 			fprintf(F, "  in loop %ld with depth %u\n",
@@ -14,45 +14,18 @@
  */
 #include "iredges_t.h"
 
+#include "array.h"
 #include "bitset.h"
 #include "debug.h"
-#include "hashptr.h"
 #include "irdump_t.h"
 #include "iredgekinds.h"
-#include "iredgeset.h"
 #include "irgwalk.h"
 #include "irnode_t.h"
 #include "irnodemap.h"
 #include "iropt_t.h"
 #include "irprintf.h"
 #include "set.h"
-
-#define DO_REHASH
-#define SCALAR_RETURN
-#define HashSet                   ir_edgeset_t
-#define HashSetIterator           ir_edgeset_iterator_t
-#define ValueType                 ir_edge_t*
-#define NullValue                 NULL
-#define DeletedValue              ((ir_edge_t*)-1)
-#define Hash(this,key)            (hash_ptr(key->src) ^ (key->pos * 40013))
-#define KeysEqual(this,key1,key2) ((key1->src) == (key2->src) && (key1->pos == key2->pos))
-#define SetRangeEmpty(ptr,size)   memset(ptr, 0, (size) * sizeof((ptr)[0]))
-
-#define hashset_init            ir_edgeset_init
-void ir_edgeset_init_size(ir_edgeset_t *self, size_t size);
-#define hashset_init_size       ir_edgeset_init_size
-#define hashset_destroy         ir_edgeset_destroy
-#define hashset_insert          ir_edgeset_insert
-#define hashset_remove          ir_edgeset_remove
-ir_edge_t *ir_edgeset_find(const ir_edgeset_t *self, const ir_edge_t*);
-#define hashset_find            ir_edgeset_find
-size_t ir_edgeset_size(const ir_edgeset_t *self);
-#define hashset_size            ir_edgeset_size
-#define hashset_iterator_init   ir_edgeset_iterator_init
-#define hashset_iterator_next   ir_edgeset_iterator_next
-#define hashset_remove_iterator ir_edgeset_remove_iterator
-
-#include "hashset.c.h"
+#include "util.h"
 
 /**
  * A function that allows for setting an edge.
@@ -138,21 +111,89 @@ static inline long edge_get_id(const ir_edge_t *e)
 void edges_init_graph_kind(ir_graph *irg, ir_edge_kind_t kind)
 {
 	if (edges_activated_kind(irg, kind)) {
-		irg_edge_info_t *info   = get_irg_edge_info(irg, kind);
-		size_t           amount = get_irg_last_idx(irg) * 5 / 4;
-
-		if (info->allocated) {
-			amount = ir_edgeset_size(&info->edges);
-			ir_edgeset_destroy(&info->edges);
+		irg_edge_info_t *info = get_irg_edge_info(irg, kind);
+		if (info->allocated)
 			obstack_free(&info->edges_obst, NULL);
-		}
 		obstack_init(&info->edges_obst);
 		INIT_LIST_HEAD(&info->free_edges);
-		ir_edgeset_init_size(&info->edges, amount);
+		/* forget the in_edges of all nodes, they were on the old obstack */
+		if (info->in_edges == NULL)
+			info->in_edges = NEW_ARR_F(ir_in_edges_t*, 0);
+		else
+			ARR_SHRINKLEN(info->in_edges, 0);
 		info->allocated = 1;
 	}
 }
 
+/**
+ * Returns the in_edges of @p src, or NULL if they were not built since the
+ * edges were last activated.
+ *
+ * Nodes which were not reached when the edges were rebuilt, or copies of
+ * nodes, still carry an old index, so the owner of the in_edges is checked.
+ */
+static inline ir_in_edges_t *get_in_edges(ir_node *src, ir_edge_kind_t kind,
+                                          const irg_edge_info_t *info)
+{
+	const irn_edge_info_t *src_info = get_irn_edge_info(src, kind);
+	size_t                 idx      = src_info->in_edges - 1;
+	if (info->in_edges == NULL || idx >= ARR_LEN(info->in_edges))
+		return NULL;
+	ir_in_edges_t *in_edges = info->in_edges[idx];
+	return in_edges->src == src ? in_edges : NULL;
+}
+
+/**
+ * Returns the slot of the edge at position @p pos of @p src, or NULL if
+ * there is no such slot.
+ */
+static inline ir_edge_t **find_in_edge_slot(ir_node *src, int pos,
+                                            ir_edge_kind_t kind,
+                                            const irg_edge_info_t *info)
+{
+	ir_in_edges_t *in_edges = get_in_edges(src, kind, info);
+	unsigned       idx      = pos - edge_kind_info[kind].first_idx;
+	if (in_edges == NULL || idx >= in_edges->n_edges)
+		return NULL;
+	return &in_edges->edges[idx];
+}
+
+/**
+ * Returns the slot of the edge at position @p pos of @p src, enlarging the
+ * in_edges of @p src if necessary.
+ */
+static ir_edge_t **get_in_edge_slot(ir_node *src, int pos, ir_edge_kind_t kind,
+                                    irg_edge_info_t *info)
+{
+	ir_edge_t **slot = find_in_edge_slot(src, pos, kind, info);
+	if (slot != NULL)
+		return slot;
+
+	/* Allocate room for all current operands. Nodes with dynamic arity grow
+	 * one operand at a time, so at least double the old size. */
+	int            first     = edge_kind_info[kind].first_idx;
+	assert(pos >= first);
+	ir_in_edges_t *old_edges = get_in_edges(src, kind, info);
+	unsigned       n_old     = old_edges != NULL ? old_edges->n_edges : 0;
+	unsigned       n_edges   = edge_kind_info[kind].get_arity(src) - first;
+	n_edges = MAX(n_edges, (unsigned)(pos - first) + 1);
+	n_edges = MAX(n_edges, 2 * n_old);
+
+	ir_in_edges_t *in_edges
+		= OALLOCFZ(&info->edges_obst, ir_in_edges_t, edges, n_edges);
+	in_edges->src     = src;
+	in_edges->n_edges = n_edges;
+	irn_edge_info_t *src_info = get_irn_edge_info(src, kind);
+	if (old_edges != NULL) {
+		MEMCPY(in_edges->edges, old_edges->edges, n_old);
+		info->in_edges[src_info->in_edges - 1] = in_edges;
+	} else {
+		ARR_APP1(ir_in_edges_t*, info->in_edges, in_edges);
+		src_info->in_edges = ARR_LEN(info->in_edges);
+	}
+	return &in_edges->edges[pos - first];
+}
+
 /**
  * Change the out count
  *
@@ -193,18 +234,29 @@ static inline void verify_list_head(ir_node *irn, ir_edge_kind_t kind)
 	del_pset(lh_set);
 }
 
+static void dump_in_edges_walker(ir_node *irn, void *data)
+{
+	ir_edge_kind_t   kind = *(ir_edge_kind_t*)data;
+	irg_edge_info_t *info = get_irg_edge_info(get_irn_irg(irn), kind);
+	if (kind == EDGE_KIND_BLOCK && !is_Block(irn))
+		return;
+
+	ir_in_edges_t *in_edges = get_in_edges(irn, kind, info);
+	if (in_edges == NULL)
+		return;
+	for (unsigned i = 0; i < in_edges->n_edges; ++i) {
+		const ir_edge_t *e = in_edges->edges[i];
+		if (e != NULL)
+			ir_printf("%+F %d\n", e->src, e->pos);
+	}
+}
+
 void edges_dump_kind(ir_graph *irg, ir_edge_kind_t kind)
 {
 	if (!edges_activated_kind(irg, kind))
 		return;
 
-	irg_edge_info_t       *info  = get_irg_edge_info(irg, kind);
-	ir_edgeset_t          *edges = &info->edges;
-	ir_edge_t             *e;
-	ir_edgeset_iterator_t  iter;
-	foreach_ir_edgeset(edges, e, iter) {
-		ir_printf("%+F %d\n", e->src, e->pos);
-	}
+	irg_walk_graph(irg, dump_in_edges_walker, NULL, &kind);
 }
 
 static void add_edge(ir_node *src, int pos, ir_node *tgt, ir_edge_kind_t kind,
@@ -213,14 +265,16 @@ static void add_edge(ir_node *src, int pos, ir_node *tgt, ir_edge_kind_t kind,
 	if (tgt == NULL)
 		return;
 	assert(edges_activated_kind(irg, kind));
-	irg_edge_info_t *info  = get_irg_edge_info(irg, kind);
-	ir_edgeset_t    *edges = &info->edges;
+	irg_edge_info_t *info = get_irg_edge_info(irg, kind);
 
 	irn_edge_info_t  *tgt_info = get_irn_edge_info(tgt, kind);
 	struct list_head *head     = &tgt_info->outs_head;
 	assert(head->next && head->prev &&
 	       "target list head must have been initialized");
 
+	ir_edge_t **slot = get_in_edge_slot(src, pos, kind, info);
+	assert(*slot == NULL && "edge already exists");
+
 	/* The old target was NULL, thus, the edge is newly created. */
 	ir_edge_t *edge;
 	if (list_empty(&info->free_edges)) {
@@ -230,16 +284,11 @@ static void add_edge(ir_node *src, int pos, ir_node *tgt, ir_edge_kind_t kind,
 		list_del(&edge->list);
 	}
 
-	edge->src     = src;
-	edge->pos     = pos;
-#ifdef DEBUG_libfirm
-	edge->present = false;
-#endif
-
-	ir_edge_t *new_edge = ir_edgeset_insert(edges, edge);
-	assert(new_edge == edge);
+	edge->src = src;
+	edge->pos = pos;
+	*slot     = edge;
 
-	list_add(&new_edge->list, head);
+	list_add(&edge->list, head);
 	edge_change_cnt(tgt_info, +1);
 }
 
@@ -250,23 +299,16 @@ static void delete_edge(ir_node *src, int pos, ir_node *old_tgt,
 		return;
 	assert(edges_activated_kind(irg, kind));
 
-	irg_edge_info_t *info  = get_irg_edge_info(irg, kind);
-	ir_edgeset_t    *edges = &info->edges;
-
-	/* Initialize the edge template to search in the set. */
-	ir_edge_t templ;
-	templ.src = src;
-	templ.pos = pos;
-
-	/* search the edge in the set. */
-	ir_edge_t *edge = ir_edgeset_find(edges, &templ);
+	irg_edge_info_t *info = get_irg_edge_info(irg, kind);
 
-	/* mark the edge invalid if it was found */
-	if (edge == NULL)
+	/* search the edge at its source */
+	ir_edge_t **slot = find_in_edge_slot(src, pos, kind, info);
+	if (slot == NULL || *slot == NULL)
 		return;
 
+	ir_edge_t *edge = *slot;
+	*slot = NULL;
 	list_del(&edge->list);
-	ir_edgeset_remove(edges, edge);
 	list_add(&edge->list, &info->free_edges);
 	edge->pos = -2;
 	edge->src = NULL;
@@ -289,8 +331,7 @@ static void edges_notify_edge_kind(ir_node *src, int pos, ir_node *tgt, ir_node
 	if (tgt == old_tgt)
 		return;
 
-	irg_edge_info_t *info  = get_irg_edge_info(irg, kind);
-	ir_edgeset_t    *edges = &info->edges;
+	irg_edge_info_t *info = get_irg_edge_info(irg, kind);
 
 	/* The target is not NULL and the old target differs
 	 * from the new target, the edge shall be moved (if the
@@ -301,13 +342,9 @@ static void edges_notify_edge_kind(ir_node *src, int pos, ir_node *tgt, ir_node
 	assert(head->next && head->prev &&
 	       "target list head must have been initialized");
 
-	/* Initialize the edge template to search in the set. */
-	ir_edge_t templ;
-	templ.src = src;
-	templ.pos = pos;
-
-	ir_edge_t *edge = ir_edgeset_find(edges, &templ);
-	assert(edge && "edge to redirect not found!");
+	ir_edge_t **slot = find_in_edge_slot(src, pos, kind, info);
+	assert(slot != NULL && *slot != NULL && "edge to redirect not found!");
+	ir_edge_t *edge = *slot;
 
 	list_move(&edge->list, head);
 	irn_edge_info_t *old_tgt_info = get_irn_edge_info(old_tgt, kind);
@@ -417,7 +454,6 @@ static void edges_node_revival_kind(ir_node *irn, ir_edge_kind_t kind)
 
 typedef struct build_walker {
 	ir_edge_kind_t kind;
-	bitset_t      *reachable;
 	bool           fine;
 } build_walker;
 
@@ -445,10 +481,13 @@ static void init_lh_walker(ir_node *irn, void *data)
 {
 	build_walker   *w    = (build_walker*)data;
 	ir_edge_kind_t  kind = w->kind;
-	list_head      *head = &get_irn_edge_info(irn, kind)->outs_head;
-	INIT_LIST_HEAD(head);
-	get_irn_edge_info(irn, kind)->edges_built = 0;
-	get_irn_edge_info(irn, kind)->out_count   = 0;
+	if (kind == EDGE_KIND_BLOCK && !is_Block(irn))
+		return;
+	irn_edge_info_t *info = get_irn_edge_info(irn, kind);
+	INIT_LIST_HEAD(&info->outs_head);
+	info->edges_built = 0;
+	info->out_count   = 0;
+	info->in_edges    = 0;
 }
 
 void edges_activate_kind(ir_graph *irg, ir_edge_kind_t kind)
@@ -498,9 +537,12 @@ void edges_deactivate_kind(ir_graph *irg, ir_edge_kind_t kind)
 	info->activated = 0;
 	if (info->allocated) {
 		obstack_free(&info->edges_obst, NULL);
-		ir_edgeset_destroy(&info->edges);
 		info->allocated = 0;
 	}
+	if (info->in_edges != NULL) {
+		DEL_ARR_F(info->in_edges);
+		info->in_edges = NULL;
+	}
 	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
 }
 
@@ -549,24 +591,42 @@ void edges_reroute_except(ir_node *from, ir_node *to, ir_node *exception)
 
 static void verify_set_presence(ir_node *irn, void *data)
 {
-	build_walker *w     = (build_walker*)data;
-	ir_graph     *irg   = get_irn_irg(irn);
-	ir_edgeset_t *edges = &get_irg_edge_info(irg, w->kind)->edges;
+	build_walker    *w    = (build_walker*)data;
+	ir_edge_kind_t   kind = w->kind;
+	irg_edge_info_t *info = get_irg_edge_info(get_irn_irg(irn), kind);
+	if (kind == EDGE_KIND_BLOCK && !is_Block(irn))
+		return;
 
-	foreach_tgt(irn, i, n, w->kind) {
-		ir_edge_t  templ = { .src = irn, .pos = i };
-		ir_edge_t *e     = ir_edgeset_find(edges, &templ);
-		ir_node   *dst   = get_n(irn, i, w->kind);
+	foreach_tgt(irn, i, n, kind) {
+		ir_node *dst = get_n(irn, i, kind);
 		if (dst == NULL)
 			continue;
-		if (e != NULL) {
-#ifdef DEBUG_libfirm
-			e->present = true;
-#endif
-		} else {
+		ir_edge_t **slot = find_in_edge_slot(irn, i, kind, info);
+		if (slot == NULL || *slot == NULL) {
 			w->fine = false;
 			ir_fprintf(stderr, "Edge Verifier: %+F,%d is missing\n",
 			           irn, i);
+		} else if ((*slot)->src != irn || (*slot)->pos != i) {
+			w->fine = false;
+			ir_fprintf(stderr, "Edge Verifier: edge(%ld) at %+F,%d belongs to %+F,%d\n",
+			           edge_get_id(*slot), irn, i, (*slot)->src,
+			           (*slot)->pos);
+		}
+	}
+
+	/* Edges of operands which do not exist or are NULL are superfluous. */
+	ir_in_edges_t *in_edges = get_in_edges(irn, kind, info);
+	if (in_edges == NULL)
+		return;
+	int first = edge_kind_info[kind].first_idx;
+	int arity = edge_kind_info[kind].get_arity(irn);
+	for (unsigned idx = 0; idx < in_edges->n_edges; ++idx) {
+		const ir_edge_t *e   = in_edges->edges[idx];
+		int              pos = (int)idx + first;
+		if (e != NULL && (pos >= arity || get_n(irn, pos, kind) == NULL)) {
+			w->fine = false;
+			ir_fprintf(stderr, "Edge Verifier: edge(%ld) %+F,%d is superfluous\n",
+			           edge_get_id(e), irn, pos);
 		}
 	}
 }
@@ -575,7 +635,8 @@ static void verify_list_presence(ir_node *irn, void *data)
 {
 	build_walker *w = (build_walker*)data;
 
-	bitset_set(w->reachable, get_irn_idx(irn));
+	if (w->kind == EDGE_KIND_BLOCK && !is_Block(irn))
+		return;
 
 	/* check list heads */
 	verify_list_head(irn, w->kind);
@@ -599,40 +660,14 @@ static void verify_list_presence(ir_node *irn, void *data)
 
 int edges_verify_kind(ir_graph *irg, ir_edge_kind_t kind)
 {
-	struct build_walker    w     = { .kind      = kind,
-	                                 .reachable = bitset_alloca(get_irg_last_idx(irg)),
-	                                 .fine      = true };
-
-#ifdef DEBUG_libfirm
-	ir_edgeset_t          *edges = &get_irg_edge_info(irg, kind)->edges;
-	ir_edge_t             *e;
-	ir_edgeset_iterator_t iter;
-	/* Clear the present bit in all edges available. */
-	foreach_ir_edgeset(edges, e, iter) {
-		e->present = false;
-	}
-#endif
+	struct build_walker w = { .kind = kind, .fine = true };
 
 	irg_walk_graph(irg, verify_set_presence, verify_list_presence, &w);
 
-#ifdef DEBUG_libfirm
-	/*
-	 * Dump all edges which are not invalid and not present.
-	 * These edges are superfluous and their presence in the
-	 * edge set is wrong.
-	 */
-	foreach_ir_edgeset(edges, e, iter) {
-		if (! e->present && bitset_is_set(w.reachable, get_irn_idx(e->src))) {
-			w.fine = false;
-			ir_fprintf(stderr, "Edge Verifier: edge(%ld) %+F,%d is superfluous\n", edge_get_id(e), e->src, e->pos);
-		}
-	}
-#endif
-
 	return w.fine;
 }
 
-static ir_nodemap usermap;
+static FIRM_THREAD_LOCAL ir_nodemap usermap;
 
 /**
  * Initializes the user node map for each node.
@@ -747,6 +782,35 @@ void edges_activate(ir_graph *irg)
 	edges_activate_kind(irg, EDGE_KIND_BLOCK);
 }
 
+static void edges_activate_all_nodes_kind(ir_graph *irg, ir_edge_kind_t kind)
+{
+	build_walker     w    = { .kind = kind };
+	irg_edge_info_t *info = get_irg_edge_info(irg, kind);
+
+	assert(!info->activated);
+
+	info->activated = 1;
+	edges_init_graph_kind(irg, kind);
+	unsigned const last_idx = get_irg_last_idx(irg);
+	for (unsigned idx = 0; idx < last_idx; ++idx) {
+		ir_node *const irn = get_idx_irn(irg, idx);
+		if (irn != NULL && !is_Id(irn) && !is_Deleted(irn))
+			init_lh_walker(irn, &w);
+	}
+	for (unsigned idx = 0; idx < last_idx; ++idx) {
+		ir_node *const irn = get_idx_irn(irg, idx);
+		if (irn != NULL && !is_Id(irn) && !is_Deleted(irn)
+		    && (kind != EDGE_KIND_BLOCK || is_Block(irn)))
+			build_edges_walker(irn, &w);
+	}
+}
+
+void edges_activate_all_nodes(ir_graph *irg)
+{
+	edges_activate_all_nodes_kind(irg, EDGE_KIND_NORMAL);
+	edges_activate_all_nodes_kind(irg, EDGE_KIND_BLOCK);
+}
+
 void edges_deactivate(ir_graph *irg)
 {
 	edges_deactivate_kind(irg, EDGE_KIND_BLOCK);
@@ -38,9 +38,6 @@
 struct ir_edge_t {
 	ir_node *src;         /**< The source node of the edge. */
 	int      pos;         /**< The position of the edge at @p src. */
-#ifdef DEBUG_libfirm
-	bool     present : 1; /**< Used by the verifier. */
-#endif
 	struct list_head list;  /**< The list head to queue all out edges at a node. */
 };
 
@@ -49,14 +46,22 @@ static inline irn_edge_info_t *get_irn_edge_info(ir_node *node,
                                                  ir_edge_kind_t kind)
 {
 	assert(edges_activated_kind(get_irn_irg(node), kind));
-	return &node->edge_info[kind];
+	if (kind == EDGE_KIND_BLOCK) {
+		assert(is_Block(node));
+		return &node->attr.block.edge_info;
+	}
+	return &node->edge_info;
 }
 
 static inline const irn_edge_info_t *get_irn_edge_info_const(
 		const ir_node *node, ir_edge_kind_t kind)
 {
 	assert(edges_activated_kind(get_irn_irg(node), kind));
-	return &node->edge_info[kind];
+	if (kind == EDGE_KIND_BLOCK) {
+		assert(is_Block(node));
+		return &node->attr.block.edge_info;
+	}
+	return &node->edge_info;
 }
 
 /** Accessor for private irg info. */
@@ -133,6 +138,13 @@ static inline void edges_assure_kind_(ir_graph *irg, ir_edge_kind_t kind)
 
 void edges_init_graph_kind(ir_graph *irg, ir_edge_kind_t kind);
 
+/**
+ * Activates the edges like edges_activate(), but builds them for all nodes
+ * of the graph instead of the ones reachable from the anchors, just like
+ * they would have been maintained during the graph construction.
+ */
+void edges_activate_all_nodes(ir_graph *irg);
+
 void edges_node_deleted(ir_node *irn);
 
 /**
@@ -11,6 +11,7 @@
 #include "irgraph_t.h"
 
 #include "array.h"
+#include "execfreq.h"
 #include "irbackedge_t.h"
 #include "ircons_t.h"
 #include "iredges_t.h"
@@ -19,20 +20,22 @@
 #include "irgopt.h"
 #include "irgwalk.h"
 #include "irhooks.h"
-#include "irmemory.h"
+#include "irlivechk.h"
+#include "irmemory_t.h"
 #include "irnode_t.h"
 #include "iropt_t.h"
 #include "iroptimize.h"
 #include "irouts.h"
 #include "irprog_t.h"
 #include "irtools.h"
+#include "lock.h"
 #include "type_t.h"
 #include "util.h"
 #include "xmalloc.h"
 
 #define INITIAL_IDX_IRN_MAP_SIZE 1024
 
-ir_graph *current_ir_graph;
+FIRM_THREAD_LOCAL ir_graph *current_ir_graph;
 
 ir_graph *get_current_ir_graph(void)
 {
@@ -77,6 +80,7 @@ static void free_graph(ir_graph *irg)
 	for (ir_edge_kind_t i = EDGE_KIND_FIRST; i <= EDGE_KIND_LAST; ++i)
 		edges_deactivate_kind(irg, i);
 	DEL_ARR_F(irg->idx_irn_map);
+	free(irg->walk_stack.frames);
 	free(irg);
 }
 
@@ -275,6 +279,7 @@ void free_ir_graph(ir_graph *irg)
 	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_NONE);
 
 	free_irg_outs(irg);
+	free_alias_cache(irg);
 	del_identities(irg);
 	if (irg->ent) {
 		set_entity_irg(irg->ent, NULL);  /* not set in const code irg */
@@ -456,41 +461,54 @@ ir_visited_t (get_irg_visited)(const ir_graph *irg)
 
 /** maximum visited flag content of all ir_graph visited fields. */
 static ir_visited_t max_irg_visited = 0;
+/** Protects max_irg_visited against graphs being walked concurrently. */
+static firm_lock_t max_irg_visited_lock = FIRM_LOCK_INIT;
+
+static void update_max_irg_visited(ir_visited_t const visited)
+{
+	firm_lock(&max_irg_visited_lock);
+	if (visited > max_irg_visited)
+		max_irg_visited = visited;
+	firm_unlock(&max_irg_visited_lock);
+}
 
 void set_irg_visited(ir_graph *irg, ir_visited_t visited)
 {
 	irg->visited = visited;
-	if (irg->visited > max_irg_visited) {
-		max_irg_visited = irg->visited;
-	}
+	update_max_irg_visited(visited);
 }
 
 void inc_irg_visited(ir_graph *irg)
 {
-	++irg->visited;
-	if (irg->visited > max_irg_visited) {
-		max_irg_visited = irg->visited;
-	}
+	update_max_irg_visited(++irg->visited);
 }
 
 ir_visited_t get_max_irg_visited(void)
 {
-	return max_irg_visited;
+	firm_lock(&max_irg_visited_lock);
+	ir_visited_t const res = max_irg_visited;
+	firm_unlock(&max_irg_visited_lock);
+	return res;
 }
 
 void set_max_irg_visited(int val)
 {
+	firm_lock(&max_irg_visited_lock);
 	max_irg_visited = val;
+	firm_unlock(&max_irg_visited_lock);
 }
 
 ir_visited_t inc_max_irg_visited(void)
 {
+	firm_lock(&max_irg_visited_lock);
 #ifndef NDEBUG
 	foreach_irp_irg(i, irg) {
 		assert(max_irg_visited >= get_irg_visited(irg));
 	}
 #endif
-	return ++max_irg_visited;
+	ir_visited_t const res = ++max_irg_visited;
+	firm_unlock(&max_irg_visited_lock);
+	return res;
 }
 
 ir_visited_t (get_irg_block_visited)(const ir_graph *irg)
@@ -588,6 +606,8 @@ void assure_irg_properties(ir_graph *irg, ir_graph_properties_t props)
 		{ IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE,      remove_unreachable_code },
 		{ IR_GRAPH_PROPERTY_NO_BADS,                  remove_bads },
 		{ IR_GRAPH_PROPERTY_NO_TUPLES,                remove_tuples },
+		/* may remove Bads and unreachable code itself */
+		{ IR_GRAPH_PROPERTY_CONSISTENT_EXECFREQ,      ir_estimate_execfreq },
 		{ IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE,     compute_doms },
 		{ IR_GRAPH_PROPERTY_CONSISTENT_POSTDOMINANCE, compute_postdoms },
 		{ IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES,     assure_edges },
@@ -595,6 +615,7 @@ void assure_irg_properties(ir_graph *irg, ir_graph_properties_t props)
 		{ IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO,      assure_loopinfo },
 		{ IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE,  assure_irg_entity_usage_computed },
 		{ IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE_FRONTIERS, ir_compute_dominance_frontiers },
+		{ IR_GRAPH_PROPERTY_CONSISTENT_LIVENESS,      assure_irg_lv_chk },
 	};
 	for (size_t i = 0; i < ARRAY_SIZE(property_functions); ++i) {
 		ir_graph_properties_t missing = props & ~irg->properties;
@@ -616,4 +637,6 @@ void confirm_irg_properties(ir_graph *irg, ir_graph_properties_t props)
 		set_irp_globals_entity_usage_state(ir_entity_usage_not_computed);
 	if (!(props & IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE_FRONTIERS))
 		ir_free_dominance_frontiers(irg);
+	if (!(props & IR_GRAPH_PROPERTY_CONSISTENT_LIVENESS))
+		free_irg_lv_chk(irg);
 }
@@ -16,7 +16,7 @@
 #include "entity_t.h"
 #include "firm_types.h"
 #include "iredgekinds.h"
-#include "iredgeset.h"
+#include "iridentities.h"
 #include "irloop.h"
 #include "irnodemap.h"
 #include "irprog.h"
@@ -24,6 +24,7 @@
 #include "obst.h"
 #include "pset.h"
 #include "type_t.h"
+#include "xmalloc.h"
 
 #define get_irg_start_block(irg)              get_irg_start_block_(irg)
 #define set_irg_start_block(irg, node)        set_irg_start_block_(irg, node)
@@ -73,11 +74,13 @@
  * Edge info to put into an irg.
  */
 typedef struct irg_edge_info_t {
-	ir_edgeset_t     edges;          /**< A set containing all edges of the current graph. */
-	struct list_head free_edges;     /**< list of all free edges. */
-	struct obstack   edges_obst;     /**< Obstack, where edges are allocated on. */
-	unsigned         allocated : 1;  /**< Set if edges are allocated on the obstack. */
-	unsigned         activated : 1;  /**< Set if edges are activated for the graph. */
+	struct list_head       free_edges;    /**< list of all free edges. */
+	struct obstack         edges_obst;    /**< Obstack, where edges are allocated on. */
+	struct ir_in_edges_t **in_edges;      /**< Operand edges of the nodes, a
+	                                           flexible array emptied whenever
+	                                           the edges are rebuilt. */
+	unsigned               allocated : 1; /**< Set if edges are allocated on the obstack. */
+	unsigned               activated : 1; /**< Set if edges are activated for the graph. */
 } irg_edge_info_t;
 
 typedef irg_edge_info_t irg_edges_info_t[EDGE_KIND_LAST+1];
@@ -99,6 +102,33 @@ typedef struct ir_vrp_info {
 	struct obstack    obst;
 } ir_vrp_info;
 
+/** A node on the explicit stack of the graph walkers. */
+typedef struct irg_walk_frame_t {
+	ir_node *node;
+	int      pos;   /**< walker specific position in the operands of node */
+} irg_walk_frame_t;
+
+/**
+ * Stack of the graph walkers. It is kept with the graph so walks do not
+ * allocate once it has grown to the depth of the graph. Nested walks push
+ * their frames above the ones of the enclosing walk.
+ */
+typedef struct irg_walk_stack_t {
+	irg_walk_frame_t *frames;
+	size_t            len;
+	size_t            size;
+} irg_walk_stack_t;
+
+/** State of a bulk construction, see irg_begin_bulk_cons(). */
+typedef struct ir_bulk_cons_t {
+	ir_identities_t *value_table; /**< The value table while it is detached. */
+	unsigned         first_idx;   /**< Index of the first node of the bulk. */
+	bool             active;
+	bool             had_edges;   /**< Edges were activated before the bulk. */
+	/** The out edges were consistent before the bulk. */
+	bool             had_consistent_edges;
+} ir_bulk_cons_t;
+
 /**
  * An ir_graph represents the code of a function as a graph of nodes.
  */
@@ -124,6 +154,7 @@ struct ir_graph {
 	ir_visited_t     block_visited; /**< Visited flag for block nodes. */
 	ir_visited_t     self_visited;  /**< Visited flag of the irg */
 	ir_node        **idx_irn_map;   /**< Map of node indexes to nodes. */
+	irg_walk_stack_t walk_stack;    /**< Work stack of the graph walkers. */
 	size_t           index;         /**< a unique number for each graph */
 	/** A void* field to link any information to the graph. */
 	void            *link;
@@ -138,13 +169,18 @@ struct ir_graph {
 	ir_node *current_block;    /**< Block for new_*()ly created nodes. */
 
 	/** Hash table for global value numbering (CSE) */
-	pset               *value_table;
+	ir_identities_t    *value_table;
+	ir_bulk_cons_t      bulk_cons;   /**< Bulk construction state. */
 	struct obstack      out_obst;    /**< Space for the Def-Use arrays. */
 	bool                out_obst_allocated;
 	ir_bitinfo          bitinfo;     /**< bit info */
 	ir_vrp_info         vrp;         /**< vrp info */
+	struct ir_alias_cache *alias_cache; /**< cached alias relations */
 	ir_loop            *loop;        /**< The outermost loop for this graph. */
 	ir_dom_front_info_t domfront;    /**< dominance frontier analysis data */
+	struct lv_chk_t    *lv_chk;      /**< cached liveness check */
+	bool                postdom_keepalive; /**< postdominance uses keep-alive
+	                                            edges to endless loops */
 	irg_edges_info_t    edge_info;   /**< edge info for automatic outs */
 	ir_graph          **callers;     /**< Callgraph: list of callers. */
 	unsigned           *caller_isbe; /**< Callgraph: bitset if backedge info is
@@ -394,6 +430,10 @@ static inline void add_irg_properties_(ir_graph *irg,
 static inline void clear_irg_properties_(ir_graph *irg,
                                     ir_graph_properties_t props)
 {
+	/* the summaries of callers were computed from this graph, too */
+	if ((irg->properties & props & IR_GRAPH_PROPERTY_CONSISTENT_PARAM_SUMMARY)
+	    && irg->ent != NULL)
+		free_param_summary(irg->ent);
 	irg->properties &= ~props;
 }
 
@@ -484,6 +524,40 @@ static inline ir_node *get_idx_irn_(const ir_graph *irg, unsigned idx)
 	return irg->idx_irn_map[idx];
 }
 
+/**
+ * Pushes a frame for @p node onto the walker stack of @p irg.
+ */
+static inline void irg_walk_push(ir_graph *irg, ir_node *node, int pos)
+{
+	irg_walk_stack_t *const stack = &irg->walk_stack;
+	if (stack->len == stack->size) {
+		stack->size   = stack->size != 0 ? 2 * stack->size : 256;
+		stack->frames = XREALLOC(stack->frames, irg_walk_frame_t, stack->size);
+	}
+	irg_walk_frame_t *const frame = &stack->frames[stack->len++];
+	frame->node = node;
+	frame->pos  = pos;
+}
+
+/**
+ * Returns the topmost frame of the walker stack of @p irg. The pointer is
+ * invalidated by the next push.
+ */
+static inline irg_walk_frame_t *irg_walk_top(ir_graph const *const irg)
+{
+	assert(irg->walk_stack.len > 0);
+	return &irg->walk_stack.frames[irg->walk_stack.len - 1];
+}
+
+/**
+ * Removes the topmost frame of the walker stack of @p irg.
+ */
+static inline void irg_walk_pop(ir_graph *irg)
+{
+	assert(irg->walk_stack.len > 0);
+	--irg->walk_stack.len;
+}
+
 /**
  * Get the anchor.
  */
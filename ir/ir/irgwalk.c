@@ -25,76 +25,54 @@
 #include "pset_new.h"
 #include <stdlib.h>
 
-/**
- * specialized version of irg_walk_2, called if only pre callback exists
- */
-static void irg_walk_2_pre(ir_node *node, irg_walk_func *pre, void *env)
-{
-	ir_graph    *irg     = get_irn_irg(node);
-	ir_visited_t visited = irg->visited;
-
-	set_irn_visited(node, visited);
-
-	pre(node, env);
-
-	if (!is_Block(node)) {
-		ir_node *pred = get_nodes_block(node);
-		if (pred->visited < visited)
-			irg_walk_2_pre(pred, pre, env);
-	}
-	foreach_irn_in_r(node, i, pred) {
-		if (pred->visited < visited)
-			irg_walk_2_pre(pred, pre, env);
-	}
-}
+/** Frame position of a node whose block has not been visited yet. */
+#define WALK_BLOCK (-2)
+/** Frame position of a node whose operands have not been counted yet. */
+#define WALK_ARITY (-1)
 
-/**
- * specialized version of irg_walk_2, called if only post callback exists
- */
-static void irg_walk_2_post(ir_node *node, irg_walk_func *post, void *env)
+static void walk_enter(ir_graph *irg, ir_node *node, ir_visited_t visited,
+                       irg_walk_func *pre, void *env)
 {
-	ir_graph    *irg     = get_irn_irg(node);
-	ir_visited_t visited = irg->visited;
-
 	set_irn_visited(node, visited);
-
-	if (!is_Block(node)) {
-		ir_node *pred = get_nodes_block(node);
-		if (pred->visited < visited)
-			irg_walk_2_post(pred, post, env);
-	}
-	foreach_irn_in_r(node, i, pred) {
-		if (pred->visited < visited)
-			irg_walk_2_post(pred, post, env);
-	}
-
-	post(node, env);
+	if (pre != NULL)
+		pre(node, env);
+	irg_walk_push(irg, node, is_Block(node) ? WALK_ARITY : WALK_BLOCK);
 }
 
 /**
- * specialized version of irg_walk_2, called if pre and post callbacks exist
+ * Walks the graph from @p node, visiting the block of a node first and then
+ * its operands from the last to the first one. The frames live on the walker
+ * stack of the graph so the depth of the graph does not matter.
  */
-static void irg_walk_2_both(ir_node *node, irg_walk_func *pre,
-                                irg_walk_func *post, void *env)
+static void walk_nodes(ir_node *node, irg_walk_func *pre, irg_walk_func *post,
+                       void *env)
 {
-	ir_graph    *irg     = get_irn_irg(node);
-	ir_visited_t visited = irg->visited;
-
-	set_irn_visited(node, visited);
-
-	pre(node, env);
-
-	if (!is_Block(node)) {
-		ir_node *pred = get_nodes_block(node);
-		if (pred->visited < visited)
-			irg_walk_2_both(pred, pre, post, env);
-	}
-	foreach_irn_in_r(node, i, pred) {
+	ir_graph    *const irg     = get_irn_irg(node);
+	ir_visited_t const visited = irg->visited;
+	size_t       const base    = irg->walk_stack.len;
+
+	walk_enter(irg, node, visited, pre, env);
+	do {
+		irg_walk_frame_t *const top = irg_walk_top(irg);
+		ir_node          *const cur = top->node;
+		ir_node                *pred;
+		if (top->pos == WALK_BLOCK) {
+			top->pos = WALK_ARITY;
+			pred     = get_nodes_block(cur);
+		} else {
+			if (top->pos == WALK_ARITY)
+				top->pos = get_irn_arity(cur);
+			if (top->pos == 0) {
+				irg_walk_pop(irg);
+				if (post != NULL)
+					post(cur, env);
+				continue;
+			}
+			pred = get_irn_n(cur, --top->pos);
+		}
 		if (pred->visited < visited)
-			irg_walk_2_both(pred, pre, post, env);
-	}
-
-	post(node, env);
+			walk_enter(irg, pred, visited, pre, env);
+	} while (irg->walk_stack.len > base);
 }
 
 void irg_walk_2(ir_node *node, irg_walk_func *pre, irg_walk_func *post,
@@ -103,9 +81,7 @@ void irg_walk_2(ir_node *node, irg_walk_func *pre, irg_walk_func *post,
 	if (irn_visited(node))
 		return;
 
-	if      (post == NULL) irg_walk_2_pre (node, pre, env);
-	else if (pre  == NULL) irg_walk_2_post(node, post, env);
-	else                   irg_walk_2_both(node, pre, post, env);
+	walk_nodes(node, pre, post, env);
 }
 
 void irg_walk_core(ir_node *node, irg_walk_func *pre, irg_walk_func *post,
@@ -138,80 +114,6 @@ void all_irg_walk(irg_walk_func *pre, irg_walk_func *post, void *env)
 	}
 }
 
-/**
- * specialized version of irg_walk_in_or_dep_2, called if only pre callback exists
- */
-static void irg_walk_in_or_dep_2_pre(ir_node *node, irg_walk_func *pre,
-                                     void *env)
-{
-	ir_graph    *irg     = get_irn_irg(node);
-	ir_visited_t visited = irg->visited;
-
-	set_irn_visited(node, visited);
-
-	pre(node, env);
-
-	if (!is_Block(node)) {
-		ir_node *pred = get_nodes_block(node);
-		if (pred->visited < visited)
-			irg_walk_in_or_dep_2_pre(pred, pre, env);
-	}
-	foreach_irn_in_r(node, i, pred) {
-		if (pred->visited < visited)
-			irg_walk_in_or_dep_2_pre(pred, pre, env);
-	}
-}
-
-/**
- * specialized version of irg_walk_in_or_dep_2, called if only post callback exists
- */
-static void irg_walk_in_or_dep_2_post(ir_node *node, irg_walk_func *post,
-                                      void *env)
-{
-	ir_graph    *irg     = get_irn_irg(node);
-	ir_visited_t visited = irg->visited;
-
-	set_irn_visited(node, visited);
-
-	if (!is_Block(node)) {
-		ir_node *pred = get_nodes_block(node);
-		if (pred->visited < visited)
-			irg_walk_in_or_dep_2_post(pred, post, env);
-	}
-	foreach_irn_in_r(node, i, pred) {
-		if (pred->visited < visited)
-			irg_walk_in_or_dep_2_post(pred, post, env);
-	}
-
-	post(node, env);
-}
-
-/**
- * specialized version of irg_walk_in_or_dep_2, called if pre and post callbacks exist
- */
-static void irg_walk_in_or_dep_2_both(ir_node *node, irg_walk_func *pre,
-                                      irg_walk_func *post, void *env)
-{
-	ir_graph    *irg     = get_irn_irg(node);
-	ir_visited_t visited = irg->visited;
-
-	set_irn_visited(node, visited);
-
-	pre(node, env);
-
-	if (!is_Block(node)) {
-		ir_node *pred = get_nodes_block(node);
-		if (pred->visited < visited)
-			irg_walk_in_or_dep_2_both(pred, pre, post, env);
-	}
-	foreach_irn_in_r(node, i, pred) {
-		if (pred->visited < visited)
-			irg_walk_in_or_dep_2_both(pred, pre, post, env);
-	}
-
-	post(node, env);
-}
-
 /**
  * Intraprozedural graph walker. Follows dependency edges as well.
  */
@@ -221,9 +123,7 @@ static void irg_walk_in_or_dep_2(ir_node *node, irg_walk_func *pre,
 	if (irn_visited(node))
 		return;
 
-	if      (post == NULL) irg_walk_in_or_dep_2_pre (node, pre, env);
-	else if (pre == NULL)  irg_walk_in_or_dep_2_post(node, post, env);
-	else                   irg_walk_in_or_dep_2_both(node, pre, post, env);
+	walk_nodes(node, pre, post, env);
 }
 
 void irg_walk_in_or_dep(ir_node *node, irg_walk_func *pre, irg_walk_func *post,
@@ -244,36 +144,45 @@ void irg_walk_in_or_dep_graph(ir_graph *irg, irg_walk_func *pre,
 	irg_walk_in_or_dep(get_irg_end(irg), pre, post, env);
 }
 
-static void walk_topo_helper(ir_node *irn, irg_walk_func *walker, void *env)
+/** Pushes @p irn for the topological walk unless it was visited already. */
+static void walk_topo_enter(ir_graph *irg, ir_node *irn)
 {
 	if (irn_visited(irn))
 		return;
 
 	/* only break loops at phi/block nodes */
-	const bool is_loop_breaker = is_Phi(irn) || is_Block(irn);
-	if (is_loop_breaker)
+	if (is_Phi(irn) || is_Block(irn))
 		mark_irn_visited(irn);
+	irg_walk_push(irg, irn, is_Block(irn) ? 0 : WALK_BLOCK);
+}
 
-	if (!is_Block(irn)) {
-		ir_node *const block = get_nodes_block(irn);
-		walk_topo_helper(block, walker, env);
-	}
-
-	for (int i = 0; i < get_irn_arity(irn); ++i) {
-		ir_node *const pred = get_irn_n(irn, i);
-		walk_topo_helper(pred, walker, env);
+static void walk_topo(ir_graph *irg, irg_walk_func *walker, void *env)
+{
+	size_t const base = irg->walk_stack.len;
+
+	walk_topo_enter(irg, get_irg_end(irg));
+	while (irg->walk_stack.len > base) {
+		irg_walk_frame_t *const top = irg_walk_top(irg);
+		ir_node          *const irn = top->node;
+		if (top->pos == WALK_BLOCK) {
+			top->pos = 0;
+			walk_topo_enter(irg, get_nodes_block(irn));
+		} else if (top->pos < get_irn_arity(irn)) {
+			walk_topo_enter(irg, get_irn_n(irn, top->pos++));
+		} else {
+			irg_walk_pop(irg);
+			const bool is_loop_breaker = is_Phi(irn) || is_Block(irn);
+			if (is_loop_breaker || !irn_visited(irn))
+				walker(irn, env);
+			mark_irn_visited(irn);
+		}
 	}
-
-	if (is_loop_breaker || !irn_visited(irn))
-		walker(irn, env);
-
-	mark_irn_visited(irn);
 }
 
 void irg_walk_topological(ir_graph *irg, irg_walk_func *walker, void *env)
 {
 	inc_irg_visited(irg);
-	walk_topo_helper(get_irg_end(irg), walker, env);
+	walk_topo(irg, walker, env);
 }
 
 /** Walks back from n until it finds a real cf op. */
@@ -286,28 +195,42 @@ static ir_node *get_cf_op(ir_node *n)
 	return n;
 }
 
+static void block_walk_enter(ir_graph *irg, ir_node *block,
+                             irg_walk_func *pre, void *env)
+{
+	mark_Block_block_visited(block);
+	if (pre != NULL)
+		pre(block, env);
+	irg_walk_push(irg, block, get_Block_n_cfgpreds(block));
+}
+
 static void irg_block_walk_2(ir_node *node, irg_walk_func *pre,
                              irg_walk_func *post, void *env)
 {
 	if (Block_block_visited(node))
 		return;
-	mark_Block_block_visited(node);
 
-	if (pre != NULL)
-		pre(node, env);
+	ir_graph *const irg  = get_irn_irg(node);
+	size_t    const base = irg->walk_stack.len;
+	block_walk_enter(irg, node, pre, env);
+	do {
+		irg_walk_frame_t *const top   = irg_walk_top(irg);
+		ir_node          *const block = top->node;
+		if (top->pos == 0) {
+			irg_walk_pop(irg);
+			if (post != NULL)
+				post(block, env);
+			continue;
+		}
 
-	for (int i = get_Block_n_cfgpreds(node); i-- > 0; ) {
 		/* find the corresponding predecessor block. */
-		ir_node *pred_cfop  = get_cf_op(get_Block_cfgpred(node, i));
+		ir_node *pred_cfop = get_cf_op(get_Block_cfgpred(block, --top->pos));
 		if (is_Bad(pred_cfop))
 			continue;
 		ir_node *pred_block = get_nodes_block(pred_cfop);
-		/* recursion */
-		irg_block_walk_2(pred_block, pre, post, env);
-	}
-
-	if (post != NULL)
-		post(node, env);
+		if (!Block_block_visited(pred_block))
+			block_walk_enter(irg, pred_block, pre, env);
+	} while (irg->walk_stack.len > base);
 }
 
 void irg_block_walk(ir_node *node, irg_walk_func *pre, irg_walk_func *post,
@@ -247,58 +247,91 @@ static void traverse_dom_blocks_top_down(ir_graph *irg, blk_collect_data_t* blks
 		dom_tree_walk_irg(irg, dom_block_visit_post, NULL, &ctx);
 }
 
-/**
- * walks over the graph and collects all blocks and all block entries
- */
-static void collect_walk(ir_node *node, blk_collect_data_t *env)
+/** Frame position of a node whose block has not been visited yet. */
+#define COLLECT_BLOCK (-2)
+/** Frame position of a node whose operands have not been counted yet. */
+#define COLLECT_ARITY (-1)
+
+static void collect_enter(ir_graph *irg, ir_node *node)
 {
 	mark_irn_visited(node);
+	irg_walk_push(irg, node, is_Block(node) ? get_irn_arity(node)
+	                                        : COLLECT_BLOCK);
+}
 
+/**
+ * Called when the walk returns from operand @p pos of @p node.
+ */
+static void collect_pred_done(ir_node *node, int pos, blk_collect_data_t *env)
+{
+	ir_node *const pred = get_irn_n(node, pos);
 	if (is_Block(node)) {
-		/* predecessors of a block are control flow nodes */
-		foreach_irn_in_r(node, i, pred) {
-			if (irn_visited(pred))
-				continue;
+		/* control flow predecessors are always block inputs */
+		block_entry_t *entry = block_find_entry(get_nodes_block(pred), env);
+		ARR_APP1(ir_node *, entry->entry_list, pred);
+		return;
+	}
 
-			ir_node *blk = get_nodes_block(pred);
-			collect_walk(pred, env);
+	/* BEWARE: predecessors of End nodes might be blocks */
+	if (is_Block(pred))
+		return;
+
+	/* Note that Phi predecessors are always block entries
+	 * because Phi edges are always "outside" a block */
+	ir_node *const blk = get_nodes_block(pred);
+	if (get_nodes_block(node) != blk || is_Phi(node)) {
+		block_entry_t *entry = block_find_entry(blk, env);
+		ARR_APP1(ir_node *, entry->entry_list, pred);
+	}
+}
 
-			/* control flow predecessors are always block inputs */
-			block_entry_t *entry = block_find_entry(blk, env);
-			ARR_APP1(ir_node *, entry->entry_list, pred);
+/**
+ * walks over the graph and collects all blocks and all block entries
+ */
+static void collect_walk(ir_node *node, blk_collect_data_t *env)
+{
+	ir_graph *const irg       = get_irn_irg(node);
+	ir_node  *const end_block = get_irg_end_block(irg);
+	size_t    const base      = irg->walk_stack.len;
+
+	collect_enter(irg, node);
+	do {
+		irg_walk_frame_t *const top = irg_walk_top(irg);
+		ir_node          *const cur = top->node;
+		if (top->pos == COLLECT_BLOCK) {
+			/* the block is no operand, so it is not an entry either */
+			top->pos = COLLECT_ARITY;
+			ir_node *const block = get_nodes_block(cur);
+			if (!irn_visited(block))
+				collect_enter(irg, block);
+			continue;
+		}
+		if (top->pos == COLLECT_ARITY)
+			top->pos = get_irn_arity(cur);
+
+		while (top->pos > 0 && irn_visited(get_irn_n(cur, top->pos - 1)))
+			--top->pos;
+		if (top->pos > 0) {
+			/* the frame stays at the operand until its walk returns */
+			collect_enter(irg, get_irn_n(cur, top->pos - 1));
+			continue;
 		}
 
 		/* it's a block, put it into the block list, except for the end block
 		 * which we append in the main loop. This avoids it being placed
 		 * elsewhere if the graph contains endless loops. */
-		if (node != get_irg_end_block(get_irn_irg(node)))
-			ARR_APP1(ir_node *, env->blk_list, node);
-	} else {
-		ir_node *block = get_nodes_block(node);
-		if (!irn_visited(block))
-			collect_walk(block, env);
-
-		bool is_phi = is_Phi(node);
-		foreach_irn_in_r(node, i, pred) {
-			if (irn_visited(pred))
-				continue;
-
-			collect_walk(pred, env);
-
-			/* BEWARE: predecessors of End nodes might be blocks */
-			if (is_Block(pred))
-				continue;
-
-			ir_node *blk = get_nodes_block(pred);
-
-			/* Note that Phi predecessors are always block entries
-			 * because Phi edges are always "outside" a block */
-			if (block != blk || is_phi) {
-				block_entry_t *entry = block_find_entry(blk, env);
-				ARR_APP1(ir_node *, entry->entry_list, pred);
+		irg_walk_pop(irg);
+		if (is_Block(cur) && cur != end_block)
+			ARR_APP1(ir_node *, env->blk_list, cur);
+
+		if (irg->walk_stack.len > base) {
+			irg_walk_frame_t *const parent = irg_walk_top(irg);
+			if (parent->pos > 0) {
+				collect_pred_done(parent->node, parent->pos - 1, env);
+				--parent->pos;
 			}
 		}
-	}
+	} while (irg->walk_stack.len > base);
 }
 
 /**
@@ -306,36 +339,44 @@ static void collect_walk(ir_node *node, blk_collect_data_t *env)
  * and collects them into the right list
  */
 static void collect_blks_lists(ir_node *node, ir_node *block,
-                               block_entry_t *entry, blk_collect_data_t *env)
+                               block_entry_t *entry)
 {
+	ir_graph *const irg  = get_irn_irg(block);
+	size_t    const base = irg->walk_stack.len;
+
 	mark_irn_visited(node);
+	irg_walk_push(irg, node, get_irn_arity(node));
+	do {
+		irg_walk_frame_t *const top = irg_walk_top(irg);
+		ir_node          *const cur = top->node;
+
+		/* Do not descent into Phi predecessors, these are always
+		 * outside the current block because Phi edges are always
+		 * "outside". */
+		if (is_Phi(cur)) {
+			irg_walk_pop(irg);
+			ARR_APP1(ir_node *, entry->phi_list, cur);
+			continue;
+		}
 
-	/* Do not descent into Phi predecessors, these are always
-	 * outside the current block because Phi edges are always
-	 * "outside". */
-	if (!is_Phi(node)) {
-		foreach_irn_in_r(node, i, pred) {
+		if (top->pos > 0) {
+			ir_node *const pred = get_irn_n(cur, --top->pos);
 			/* BEWARE: predecessors of End nodes might be blocks */
-			if (is_Block(pred))
-				continue;
-			if (irn_visited(pred))
-				continue;
-
-			ir_node *blk = get_nodes_block(pred);
-			if (block != blk)
+			if (is_Block(pred) || irn_visited(pred)
+			    || get_nodes_block(pred) != block)
 				continue;
-			collect_blks_lists(pred, block, entry, env);
+			mark_irn_visited(pred);
+			irg_walk_push(irg, pred, get_irn_arity(pred));
+			continue;
 		}
-	} else {
-		ARR_APP1(ir_node *, entry->phi_list, node);
-		return;
-	}
 
-	if (get_irn_mode(node) == mode_X) {
-		ARR_APP1(ir_node *, entry->cf_list, node);
-	} else {
-		ARR_APP1(ir_node *, entry->df_list, node);
-	}
+		irg_walk_pop(irg);
+		if (get_irn_mode(cur) == mode_X) {
+			ARR_APP1(ir_node *, entry->cf_list, cur);
+		} else {
+			ARR_APP1(ir_node *, entry->df_list, cur);
+		}
+	} while (irg->walk_stack.len > base);
 }
 
 /**
@@ -353,7 +394,7 @@ static void collect_lists(ir_graph *const irg, blk_collect_data_t *const env)
 			/* a entry might already be visited due to Phi loops */
 			if (irn_visited(node))
 				continue;
-			collect_blks_lists(node, block, entry, env);
+			collect_blks_lists(node, block, entry);
 		}
 	}
 }
@@ -0,0 +1,67 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2016 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief     The value table used for CSE.
+ */
+#include "iridentities.h"
+
+#include "irnode_t.h"
+#include "iropt_t.h"
+
+/**
+ * Every compare function requires equal opcode, mode and arity, so check
+ * these here before calling it. Most probes with matching hash values are
+ * rejected without an indirect call this way.
+ */
+static inline bool identities_equal(const ir_identities_t *self,
+                                    const ir_node *a, const ir_node *b)
+{
+	if (a == b)
+		return true;
+	if (a->op != b->op || a->mode != b->mode
+	    || get_irn_arity(a) != get_irn_arity(b))
+		return false;
+	return self->cmp(a, b) == 0;
+}
+
+#define HashSet                   ir_identities_t
+#define HashSetIterator           ir_identities_iterator_t
+#define HashSetEntry              ir_identities_entry_t
+#define ValueType                 ir_node*
+#define NullValue                 NULL
+#define DeletedValue              ((ir_node*)-1)
+#define SCALAR_RETURN
+#define Hash(self,key)            ir_node_hash(key)
+#define KeysEqual(self,key1,key2) identities_equal(self, key1, key2)
+#define SetRangeEmpty(ptr,size)   memset(ptr, 0, (size) * sizeof((ptr)[0]))
+
+#define hashset_init_size       ir_identities_init_size_
+#define hashset_destroy         ir_identities_destroy
+#define hashset_insert          ir_identities_insert
+#define hashset_size            ir_identities_size
+#define hashset_iterator_init   ir_identities_iterator_init
+#define hashset_iterator_next   ir_identities_iterator_next
+
+void ir_identities_init_size_(ir_identities_t *self, size_t expected_elements);
+
+#include "hashset.c.h"
+
+void ir_identities_init_size(ir_identities_t *identities,
+                             ir_identities_cmp_func *cmp,
+                             size_t expected_elements)
+{
+	ir_identities_init_size_(identities, expected_elements);
+	identities->cmp = cmp;
+}
+
+void ir_identities_reserve(ir_identities_t *identities, size_t n_elements)
+{
+	size_t const needed
+		= (hashset_size(identities) + n_elements) * HT_1_DIV_OCCUPANCY_FLT;
+	if (needed > identities->num_buckets)
+		resize(identities, ceil_po2(needed));
+}
@@ -0,0 +1,114 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2016 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief     The value table used for CSE. An open addressing hash set of
+ *            nodes which keeps the hash value next to each node.
+ */
+#ifndef FIRM_IR_IRIDENTITIES_H
+#define FIRM_IR_IRIDENTITIES_H
+
+#include <stdbool.h>
+#include "firm_types.h"
+#include "xmalloc.h"
+
+#define HashSet          ir_identities_t
+#define HashSetIterator  ir_identities_iterator_t
+#define HashSetEntry     ir_identities_entry_t
+#define ValueType        ir_node*
+#define ADDITIONAL_DATA  ir_identities_cmp_func *cmp;
+
+/**
+ * Compares two nodes of the same opcode, mode and arity.
+ * Returns 0 if both compute the same value, like pset compare functions.
+ */
+typedef int ir_identities_cmp_func(const ir_node *elt, const ir_node *key);
+
+#include "hashset.h"
+
+#undef ADDITIONAL_DATA
+#undef ValueType
+#undef HashSetEntry
+#undef HashSetIterator
+#undef HashSet
+
+typedef struct ir_identities_t          ir_identities_t;
+typedef struct ir_identities_iterator_t ir_identities_iterator_t;
+
+/**
+ * Initializes a value table.
+ *
+ * @param identities         Pointer to allocated space for the table
+ * @param cmp                Function deciding whether two nodes are equal
+ * @param expected_elements  Number of nodes expected in the table (roughly)
+ */
+void ir_identities_init_size(ir_identities_t *identities,
+                             ir_identities_cmp_func *cmp,
+                             size_t expected_elements);
+
+/**
+ * Destroys a value table and frees the memory allocated for the hashtable.
+ * The memory of the table itself is not freed.
+ */
+void ir_identities_destroy(ir_identities_t *identities);
+
+/**
+ * Allocates memory for a value table and initializes it.
+ */
+static inline ir_identities_t *ir_identities_new(ir_identities_cmp_func *cmp,
+                                                 size_t expected_elements)
+{
+	ir_identities_t *res = XMALLOC(ir_identities_t);
+	ir_identities_init_size(res, cmp, expected_elements);
+	return res;
+}
+
+/**
+ * Destroys a value table and frees the memory of the table itself.
+ */
+static inline void ir_identities_del(ir_identities_t *identities)
+{
+	ir_identities_destroy(identities);
+	free(identities);
+}
+
+/**
+ * Looks up a node equal to @p node in the table and returns it. If there is
+ * none, @p node is inserted and returned.
+ */
+ir_node *ir_identities_insert(ir_identities_t *identities, ir_node *node);
+
+/**
+ * Makes room for @p n_elements further nodes without rehashing.
+ */
+void ir_identities_reserve(ir_identities_t *identities, size_t n_elements);
+
+/**
+ * Returns the number of nodes in the value table.
+ */
+size_t ir_identities_size(const ir_identities_t *identities);
+
+/**
+ * Initializes an iterator. Sets the iterator before the first element in
+ * the value table.
+ */
+void ir_identities_iterator_init(ir_identities_iterator_t *iterator,
+                                 const ir_identities_t *identities);
+
+/**
+ * Advances the iterator and returns the current element or NULL if all
+ * elements have been processed.
+ * @attention It is not allowed to insert into the table while iterating.
+ */
+ir_node *ir_identities_iterator_next(ir_identities_iterator_t *iterator);
+
+#define foreach_ir_identities(identities, irn, iter) \
+	for (bool irn##__once = true; irn##__once;) \
+		for (ir_identities_iterator_t iter; irn##__once;) \
+			for (ir_node *irn; irn##__once; irn##__once = false) \
+				for (ir_identities_iterator_init(&iter, identities); (irn = ir_identities_iterator_next(&iter));)
+
+#endif
@@ -27,6 +27,12 @@
 #include <stdarg.h>
 #include <stdbool.h>
 #include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 #define SYMERROR ((unsigned) ~0)
 
@@ -68,6 +74,7 @@ typedef enum keyword_t {
 	kw_type,
 	kw_typegraph,
 	kw_unknown,
+	kw_vector_mode,
 } keyword_t;
 
 typedef struct symbol_t {
@@ -81,6 +88,59 @@ typedef struct id_entry {
 	void *elem;
 } id_entry;
 
+/**
+ * The binary format consists of the same tokens as the textual format.
+ * Each token starts with one of these tags. Numbers follow as zigzag encoded
+ * varints. Strings are stored once, terminated by a zero byte, and
+ * referenced by their index afterwards.
+ */
+typedef enum bin_tag_t {
+	bt_eof,
+	bt_number,      /**< followed by the value */
+	bt_string,      /**< followed by the index of a previous string */
+	bt_string_def,  /**< followed by length and characters of a new string */
+	bt_null,
+	bt_list_begin,
+	bt_list_end,
+	bt_scope_begin,
+	bt_scope_end,
+} bin_tag_t;
+
+/**
+ * Starts a file in binary format, the last byte is the format version.
+ * The magic is followed by the graph index: the number of graphs and for
+ * each graph the entity number, offset and size of its body and the size of
+ * the string table at its body, all as 64 bit little endian numbers. Strings
+ * first used in a graph body are local to it, so a body can be read without
+ * the bodies before it. The offsets are 0 if the output was not seekable.
+ */
+static const char binary_magic[] = "\x89" "FIRMBIN" "\x02";
+#define BINARY_MAGIC_SIZE      (sizeof(binary_magic) - 1)
+#define BINARY_INDEX_ENTRY_SIZE (4 * 8)
+
+/** The graph of an entity that is read on first use. */
+struct lazy_irg_t {
+	struct lazy_import_t *import;
+	ir_entity            *entity;
+	ir_type              *frame;
+	size_t                index;     /**< index in import->irgs */
+	size_t                offset;    /**< offset of the graph body */
+	size_t                n_strings; /**< string table size at the body */
+};
+
+/** A file read by ir_import_lazy() that still has graphs to build. */
+typedef struct lazy_import_t {
+	read_env_t            env;       /**< reader state after the import */
+	void                 *map;       /**< the mapped file */
+	size_t                map_size;
+	lazy_irg_t          **irgs;      /**< deferred graphs, NULL once built */
+	size_t                n_pending;
+	struct lazy_import_t *next;
+} lazy_import_t;
+
+/** Imports with deferred graphs. */
+static lazy_import_t *lazy_imports;
+
 /** The symbol table, a set of symbol_t elements. */
 static set *symtbl;
 
@@ -109,14 +169,19 @@ static int id_cmp(const void *elt, const void *key, size_t size)
 static void FIRM_PRINTF(2, 3)
 parse_error(read_env_t *env, const char *fmt, ...)
 {
-	/* workaround read_c "feature" that a '\n' triggers the line++
-	 * instead of the character after the '\n' */
-	unsigned line = env->line;
-	if (env->c == '\n') {
-		line--;
-	}
+	if (env->binary) {
+		fprintf(stderr, "%s:%zu: error ", env->inputname,
+		        (size_t)(env->pos - env->begin));
+	} else {
+		/* workaround read_c "feature" that a '\n' triggers the line++
+		 * instead of the character after the '\n' */
+		unsigned line = env->line;
+		if (env->c == '\n') {
+			line--;
+		}
 
-	fprintf(stderr, "%s:%u: error ", env->inputname, line);
+		fprintf(stderr, "%s:%u: error ", env->inputname, line);
+	}
 	env->read_errors = true;
 
 	va_list ap;
@@ -199,6 +264,7 @@ static void symtbl_init(void)
 	INSERTKEYWORD(type);
 	INSERTKEYWORD(typegraph);
 	INSERTKEYWORD(unknown);
+	INSERTKEYWORD(vector_mode);
 
 	INSERTENUM(tt_align, align_non_aligned);
 	INSERTENUM(tt_align, align_is_aligned);
@@ -298,28 +364,121 @@ static unsigned symbol(const char *str, typetag_t typetag)
 	return entry ? entry->code : SYMERROR;
 }
 
+static void write_varint(write_env_t *env, unsigned long value)
+{
+	while (value >= 0x80) {
+		fputc((int)(value & 0x7F) | 0x80, env->file);
+		value >>= 7;
+	}
+	fputc((int)value, env->file);
+}
+
+static void write_bin_number(write_env_t *env, long value)
+{
+	/* zigzag encoding keeps small negative numbers short */
+	unsigned long const zigzag = value < 0 ? ~((unsigned long)value << 1)
+	                                       : (unsigned long)value << 1;
+	fputc(bt_number, env->file);
+	write_varint(env, zigzag);
+}
+
+static int bin_string_cmp(const void *elt, const void *key, size_t size)
+{
+	(void)size;
+	const bin_string_entry_t *entry    = (const bin_string_entry_t*)elt;
+	const bin_string_entry_t *keyentry = (const bin_string_entry_t*)key;
+	return strcmp(entry->str, keyentry->str);
+}
+
+/**
+ * Writes a string of the binary format. The string table is owned by the
+ * writer, so strings are neither interned as idents nor kept afterwards.
+ */
+static void write_bin_string(write_env_t *env, const char *str)
+{
+	bin_string_entry_t key = { .str = str, .nr = 0 };
+	unsigned const     hash = hash_str(str);
+	bin_string_entry_t *entry
+		= set_find(bin_string_entry_t, env->strings, &key, sizeof(key), hash);
+	if (entry == NULL && env->local_strings != NULL) {
+		entry = set_find(bin_string_entry_t, env->local_strings, &key,
+		                 sizeof(key), hash);
+	}
+	if (entry != NULL) {
+		fputc(bt_string, env->file);
+		write_varint(env, entry->nr - 1);
+		return;
+	}
+
+	size_t const len = strlen(str);
+	key.str = (const char*)obstack_copy0(&env->strings_obst, str, len);
+	if (env->local_strings != NULL) {
+		key.nr = env->n_strings + ++env->n_local_strings;
+		(void)set_insert(bin_string_entry_t, env->local_strings, &key,
+		                 sizeof(key), hash);
+	} else {
+		key.nr = ++env->n_strings;
+		(void)set_insert(bin_string_entry_t, env->strings, &key, sizeof(key),
+		                 hash);
+	}
+
+	fputc(bt_string_def, env->file);
+	write_varint(env, len);
+	fwrite(str, 1, len + 1, env->file);
+}
+
+/** Starts a line of the textual format. */
+static void write_line_begin(write_env_t *env)
+{
+	if (!env->binary)
+		fputc('\t', env->file);
+}
+
+/** Ends a line of the textual format. */
+static void write_line_end(write_env_t *env)
+{
+	if (!env->binary)
+		fputc('\n', env->file);
+}
+
 void write_long(write_env_t *env, long value)
 {
-	fprintf(env->file, "%ld ", value);
+	if (env->binary)
+		write_bin_number(env, value);
+	else
+		fprintf(env->file, "%ld ", value);
 }
 
 void write_int(write_env_t *env, int value)
 {
-	fprintf(env->file, "%d ", value);
+	if (env->binary)
+		write_bin_number(env, value);
+	else
+		fprintf(env->file, "%d ", value);
 }
 
 void write_unsigned(write_env_t *env, unsigned value)
 {
-	fprintf(env->file, "%u ", value);
+	if (env->binary)
+		write_bin_number(env, value);
+	else
+		fprintf(env->file, "%u ", value);
 }
 
 void write_size_t(write_env_t *env, size_t value)
 {
-	ir_fprintf(env->file, "%zu ", value);
+	if (env->binary)
+		write_bin_number(env, (long)value);
+	else
+		ir_fprintf(env->file, "%zu ", value);
 }
 
 void write_symbol(write_env_t *env, const char *symbol)
 {
+	if (env->binary) {
+		write_bin_string(env, symbol);
+		return;
+	}
 	fputs(symbol, env->file);
 	fputc(' ', env->file);
 }
@@ -346,6 +505,10 @@ void write_type_ref(write_env_t *env, ir_type *type)
 
 void write_string(write_env_t *env, const char *string)
 {
+	if (env->binary) {
+		write_bin_string(env, string);
+		return;
+	}
 	fputc('"', env->file);
 	for (const char *c = string; *c != '\0'; ++c) {
 		switch (*c) {
@@ -368,13 +531,19 @@ void write_string(write_env_t *env, const char *string)
 
 void write_ident(write_env_t *env, ident *id)
 {
-	write_string(env, get_id_str(id));
+	if (env->binary)
+		write_bin_string(env, get_id_str(id));
+	else
+		write_string(env, get_id_str(id));
 }
 
 void write_ident_null(write_env_t *env, ident *id)
 {
 	if (id == NULL) {
-		fputs("NULL ", env->file);
+		if (env->binary)
+			fputc(bt_null, env->file);
+		else
+			fputs("NULL ", env->file);
 	} else {
 		write_ident(env, id);
 	}
@@ -391,26 +560,22 @@ void write_tarval_ref(write_env_t *env, ir_tarval *tv)
 	write_mode_ref(env, mode);
 	char buf[128];
 	const char *ascii = ir_tarval_to_ascii(buf, sizeof(buf), tv);
-	fputs(ascii, env->file);
-	fputc(' ', env->file);
+	write_symbol(env, ascii);
 }
 
 void write_align(write_env_t *env, ir_align align)
 {
-	fputs(get_align_name(align), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_align_name(align));
 }
 
 void write_builtin_kind(write_env_t *env, ir_builtin_kind kind)
 {
-	fputs(get_builtin_kind_name(kind), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_builtin_kind_name(kind));
 }
 
 void write_cond_jmp_predicate(write_env_t *env, cond_jmp_predicate pred)
 {
-	fputs(get_cond_jmp_predicate_name(pred), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_cond_jmp_predicate_name(pred));
 }
 
 void write_relation(write_env_t *env, ir_relation relation)
@@ -430,22 +595,34 @@ void write_loop(write_env_t *env, bool loop)
 
 static void write_list_begin(write_env_t *env)
 {
-	fputs("[", env->file);
+	if (env->binary)
+		fputc(bt_list_begin, env->file);
+	else
+		fputs("[", env->file);
 }
 
 static void write_list_end(write_env_t *env)
 {
-	fputs("] ", env->file);
+	if (env->binary)
+		fputc(bt_list_end, env->file);
+	else
+		fputs("] ", env->file);
 }
 
 static void write_scope_begin(write_env_t *env)
 {
-	fputs("{\n", env->file);
+	if (env->binary)
+		fputc(bt_scope_begin, env->file);
+	else
+		fputs("{\n", env->file);
 }
 
 static void write_scope_end(write_env_t *env)
 {
-	fputs("}\n\n", env->file);
+	if (env->binary)
+		fputc(bt_scope_end, env->file);
+	else
+		fputs("}\n\n", env->file);
 }
 
 void write_node_ref(write_env_t *env, const ir_node *node)
@@ -456,11 +633,9 @@ void write_node_ref(write_env_t *env, const ir_node *node)
 void write_initializer(write_env_t *const env,
                        ir_initializer_t const *const ini)
 {
-	FILE *f = env->file;
 	ir_initializer_kind_t ini_kind = get_initializer_kind(ini);
 
-	fputs(get_initializer_kind_name(ini_kind), f);
-	fputc(' ', f);
+	write_symbol(env, get_initializer_kind_name(ini_kind));
 
 	switch (ini_kind) {
 	case IR_INITIALIZER_CONST:
@@ -487,37 +662,32 @@ void write_initializer(write_env_t *const env,
 
 void write_pin_state(write_env_t *env, op_pin_state state)
 {
-	fputs(get_op_pin_state_name(state), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_op_pin_state_name(state));
 }
 
 void write_volatility(write_env_t *env, ir_volatility vol)
 {
-	fputs(get_volatility_name(vol), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_volatility_name(vol));
 }
 
 static void write_type_state(write_env_t *env, ir_type_state state)
 {
-	fputs(get_type_state_name(state), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_type_state_name(state));
 }
 
 void write_visibility(write_env_t *env, ir_visibility visibility)
 {
-	fputs(get_visibility_name(visibility), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_visibility_name(visibility));
 }
 
 static void write_mode_arithmetic(write_env_t *env, ir_mode_arithmetic arithmetic)
 {
-	fputs(get_mode_arithmetic_name(arithmetic), env->file);
-	fputc(' ', env->file);
+	write_symbol(env, get_mode_arithmetic_name(arithmetic));
 }
 
 static void write_type_common(write_env_t *env, ir_type *tp)
 {
-	fputc('\t', env->file);
+	write_line_begin(env);
 	write_symbol(env, "type");
 	write_long(env, get_type_nr(tp));
 	write_symbol(env, get_type_opcode_name(get_type_opcode(tp)));
@@ -532,7 +702,7 @@ static void write_type(write_env_t *env, ir_type *tp);
 static bool is_internal_mode(ir_mode *mode)
 {
 	return !mode_is_int(mode) && !mode_is_reference(mode)
-	    && !mode_is_float(mode);
+	    && !mode_is_float(mode) && !mode_is_vector(mode);
 }
 
 static bool is_default_mode(ir_mode *mode)
@@ -551,7 +721,7 @@ static void write_type_primitive(write_env_t *env, ir_type *tp)
 
 	write_type_common(env, tp);
 	write_mode_ref(env, mode);
-	fputc('\n', env->file);
+	write_line_end(env);
 }
 
 static void write_type_compound(write_env_t *env, ir_type *tp)
@@ -565,7 +735,7 @@ static void write_type_compound(write_env_t *env, ir_type *tp)
 	}
 	write_type_common(env, tp);
 	write_ident_null(env, get_compound_ident(tp));
-	fputc('\n', env->file);
+	write_line_end(env);
 
 	for (size_t i = 0, n = get_compound_n_members(tp); i < n; ++i) {
 		ir_entity *member = get_compound_member(tp, i);
@@ -581,7 +751,7 @@ static void write_type_array(write_env_t *env, ir_type *tp)
 	write_type_common(env, tp);
 	write_type_ref(env, element_type);
 	write_unsigned(env, get_array_size(tp));
-	fputc('\n', env->file);
+	write_line_end(env);
 }
 
 static void write_type_method(write_env_t *env, ir_type *tp)
@@ -603,7 +773,7 @@ static void write_type_method(write_env_t *env, ir_type *tp)
 		write_type_ref(env, get_method_param_type(tp, i));
 	for (size_t i = 0; i < nresults; i++)
 		write_type_ref(env, get_method_res_type(tp, i));
-	fputc('\n', env->file);
+	write_line_end(env);
 }
 
 static void write_type_pointer(write_env_t *env, ir_type *tp)
@@ -614,7 +784,7 @@ static void write_type_pointer(write_env_t *env, ir_type *tp)
 
 	write_type_common(env, tp);
 	write_type_ref(env, points_to);
-	fputc('\n', env->file);
+	write_line_end(env);
 }
 
 static void write_type(write_env_t *env, ir_type *tp)
@@ -663,7 +833,7 @@ static void write_entity(write_env_t *env, ir_entity *ent)
 		write_entity(env, aliased);
 	}
 
-	fputc('\t', env->file);
+	write_line_begin(env);
 	switch ((ir_entity_kind)ent->kind) {
 	case IR_ENTITY_ALIAS:           write_symbol(env, "alias");           break;
 	case IR_ENTITY_NORMAL:          write_symbol(env, "entity");          break;
@@ -751,7 +921,7 @@ static void write_entity(write_env_t *env, ir_entity *ent)
 	}
 
 end_line:
-	fputc('\n', env->file);
+	write_line_end(env);
 }
 
 void write_switch_table_ref(write_env_t *env, const ir_switch_table *table)
@@ -880,11 +1050,11 @@ static void write_node(const ir_node *node, write_env_t *env)
 	ir_op           *const op   = get_irn_op(node);
 	write_node_func *const func = get_generic_function_ptr(write_node_func, op);
 
-	fputc('\t', env->file);
+	write_line_begin(env);
 	if (func == NULL)
 		panic("no write_node_func for %+F", node);
 	func(env, node);
-	fputc('\n', env->file);
+	write_line_end(env);
 }
 
 static void write_node_recursive(ir_node *node, write_env_t *env);
@@ -947,6 +1117,11 @@ static void write_mode(write_env_t *env, ir_mode *mode)
 		write_unsigned(env, get_mode_exponent_size(mode));
 		write_unsigned(env, get_mode_mantissa_size(mode));
 		write_unsigned(env, get_mode_float_int_overflow(mode));
+	} else if (mode_is_vector(mode)) {
+		write_symbol(env, "vector_mode");
+		write_string(env, get_mode_name(mode));
+		write_mode_ref(env, get_mode_vector_element_mode(mode));
+		write_unsigned(env, get_mode_vector_n_lanes(mode));
 	} else {
 		panic("cannot write internal modes");
 	}
@@ -955,18 +1130,18 @@ static void write_mode(write_env_t *env, ir_mode *mode)
 static void write_modes(write_env_t *env)
 {
 	write_symbol(env, "modes");
-	fputs("{\n", env->file);
+	write_scope_begin(env);
 
 	for (size_t i = 0, n_modes = ir_get_n_modes(); i < n_modes; i++) {
 		ir_mode *mode = ir_get_mode(i);
 		if (is_internal_mode(mode))
 			continue;
-		fputc('\t', env->file);
+		write_line_begin(env);
 		write_mode(env, mode);
-		fputc('\n', env->file);
+		write_line_end(env);
 	}
 
-	fputs("}\n\n", env->file);
+	write_scope_end(env);
 }
 
 static void write_program(write_env_t *env)
@@ -974,15 +1149,15 @@ static void write_program(write_env_t *env)
 	write_symbol(env, "program");
 	write_scope_begin(env);
 	if (irp_prog_name_is_set()) {
-		fputc('\t', env->file);
+		write_line_begin(env);
 		write_symbol(env, "name");
 		write_string(env, get_irp_name());
-		fputc('\n', env->file);
+		write_line_end(env);
 	}
 
 	for (ir_segment_t s = IR_SEGMENT_FIRST; s <= IR_SEGMENT_LAST; ++s) {
 		ir_type *segment_type = get_segment_type(s);
-		fputc('\t', env->file);
+		write_line_begin(env);
 		write_symbol(env, "segment_type");
 		write_symbol(env, get_segment_name(s));
 		if (segment_type == NULL) {
@@ -990,15 +1165,15 @@ static void write_program(write_env_t *env)
 		} else {
 			write_type_ref(env, segment_type);
 		}
-		fputc('\n', env->file);
+		write_line_end(env);
 	}
 
 	for (size_t i = 0, n_asms = get_irp_n_asms(); i < n_asms; ++i) {
 		ident *asm_text = get_irp_asm(i);
-		fputc('\t', env->file);
+		write_line_begin(env);
 		write_symbol(env, "asm");
 		write_ident(env, asm_text);
-		fputc('\n', env->file);
+		write_line_end(env);
 	}
 	write_scope_end(env);
 }
@@ -1018,6 +1193,21 @@ int ir_export(const char *filename)
 	return res;
 }
 
+int ir_export_binary(const char *filename)
+{
+	FILE *file = fopen(filename, "wb");
+	int   res  = 0;
+	if (file == NULL) {
+		perror(filename);
+		return 1;
+	}
+
+	ir_export_binary_file(file);
+	res = ferror(file);
+	fclose(file);
+	return res;
+}
+
 static void write_node_cb(ir_node *node, void *ctx)
 {
 	write_env_t *env = (write_env_t*)ctx;
@@ -1046,9 +1236,21 @@ static void write_typegraph(write_env_t *env)
 
 static void write_irg(write_env_t *env, ir_graph *irg)
 {
+	ir_entity *entity = get_irg_entity(irg);
 	write_symbol(env, "irg");
-	write_entity_ref(env, get_irg_entity(irg));
+	write_entity_ref(env, entity);
 	write_type_ref(env, get_irg_frame_type(irg));
+
+	bin_index_entry_t *entry = NULL;
+	if (env->binary) {
+		entry = &env->index[env->n_index++];
+		entry->entity_nr    = get_entity_nr(entity);
+		entry->offset       = ftell(env->file);
+		entry->n_strings    = env->n_strings;
+		env->local_strings   = new_set(bin_string_cmp, 64);
+		env->n_local_strings = 0;
+	}
+
 	write_scope_begin(env);
 	ir_reserve_resources(irg, IR_RESOURCE_IRN_VISITED);
 	inc_irg_visited(irg);
@@ -1060,18 +1262,79 @@ static void write_irg(write_env_t *env, ir_graph *irg)
 	} while (!deq_empty(&env->write_queue));
 	ir_free_resources(irg, IR_RESOURCE_IRN_VISITED);
 	write_scope_end(env);
+
+	if (entry != NULL) {
+		entry->size = ftell(env->file) - entry->offset;
+		del_set(env->local_strings);
+		env->local_strings = NULL;
+	}
+}
+
+static void write_fixed64(FILE *file, uint64_t value)
+{
+	for (unsigned i = 0; i < 8; ++i) {
+		fputc((int)(value & 0xFF), file);
+		value >>= 8;
+	}
+}
+
+/** Writes the graph index, placeholders if the graphs are not written yet. */
+static void write_bin_index(write_env_t *env, size_t n_irgs)
+{
+	write_fixed64(env->file, n_irgs);
+	for (size_t i = 0; i < n_irgs; ++i) {
+		bin_index_entry_t const *entry = i < env->n_index ? &env->index[i]
+		                                                  : NULL;
+		if (entry == NULL || entry->offset < 0 || entry->size < 0) {
+			for (unsigned j = 0; j < 4; ++j)
+				write_fixed64(env->file, 0);
+			continue;
+		}
+		write_fixed64(env->file, entry->entity_nr);
+		write_fixed64(env->file, entry->offset);
+		write_fixed64(env->file, entry->size);
+		write_fixed64(env->file, entry->n_strings);
+	}
+}
+
+/** Builds all graphs deferred by ir_import_lazy(). */
+static void load_lazy_irgs(void)
+{
+	for (lazy_import_t *import; (import = lazy_imports) != NULL;) {
+		/* the import is freed after building its last graph */
+		for (size_t i = 0, n = import->n_pending; n > 0; ++i) {
+			lazy_irg_t *lazy = import->irgs[i];
+			if (lazy == NULL)
+				continue;
+			--n;
+			ir_load_entity_irg(lazy->entity);
+		}
+	}
 }
 
 /* Exports the whole irp to the given file in a textual form. */
-void ir_export_file(FILE *file)
+static void export_file(FILE *file, bool binary)
 {
 	write_env_t my_env;
 	write_env_t *env = &my_env;
 
+	load_lazy_irgs();
+
 	memset(env, 0, sizeof(*env));
 	env->file         = file;
+	env->binary       = binary;
 	deq_init(&env->write_queue);
 	deq_init(&env->entity_queue);
+	size_t const n_irgs    = get_irp_n_irgs();
+	long         index_pos = -1;
+	if (binary) {
+		env->strings = new_set(bin_string_cmp, 256);
+		env->index   = XMALLOCN(bin_index_entry_t, n_irgs);
+		obstack_init(&env->strings_obst);
+		fwrite(binary_magic, 1, BINARY_MAGIC_SIZE, file);
+		index_pos = ftell(file);
+		write_bin_index(env, n_irgs);
+	}
 
 	writers_init();
 	write_modes(env);
@@ -1090,10 +1353,30 @@ void ir_export_file(FILE *file)
 
 	write_program(env);
 
+	if (binary) {
+		/* fill in the graph index if the output is seekable */
+		if (index_pos >= 0 && fseek(file, index_pos, SEEK_SET) == 0) {
+			write_bin_index(env, n_irgs);
+			fseek(file, 0, SEEK_END);
+		}
+		free(env->index);
+		del_set(env->strings);
+		obstack_free(&env->strings_obst, NULL);
+	}
 	deq_free(&env->entity_queue);
 	deq_free(&env->write_queue);
 }
 
+void ir_export_file(FILE *file)
+{
+	export_file(file, false);
+}
+
+void ir_export_binary_file(FILE *file)
+{
+	export_file(file, true);
+}
+
 
 
 static void read_c(read_env_t *env)
@@ -1122,29 +1405,155 @@ static void skip_ws(read_env_t *env)
 	}
 }
 
+static bin_tag_t peek_tag(read_env_t *env)
+{
+	return env->pos < env->end ? (bin_tag_t)*env->pos : bt_eof;
+}
+
+static bin_tag_t read_tag(read_env_t *env)
+{
+	bin_tag_t tag = peek_tag(env);
+	if (tag != bt_eof)
+		++env->pos;
+	return tag;
+}
+
+static unsigned long read_varint(read_env_t *env)
+{
+	unsigned long res = 0;
+	for (unsigned shift = 0;; shift += 7) {
+		if (env->pos >= env->end || shift >= sizeof(res) * CHAR_BIT) {
+			parse_error(env, "Invalid number\n");
+			exit(1);
+		}
+		unsigned char byte = *env->pos++;
+		res |= (unsigned long)(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+			return res;
+	}
+}
+
+static long read_bin_number(read_env_t *env)
+{
+	if (read_tag(env) != bt_number) {
+		parse_error(env, "Expected number\n");
+		exit(1);
+	}
+	unsigned long zigzag = read_varint(env);
+	return (zigzag & 1) ? (long)~(zigzag >> 1) : (long)(zigzag >> 1);
+}
+
+static bin_string_t *read_bin_string(read_env_t *env)
+{
+	switch (read_tag(env)) {
+	case bt_string: {
+		unsigned long idx = read_varint(env);
+		if (idx >= ARR_LEN(env->strings)) {
+			parse_error(env, "Invalid string index %lu\n", idx);
+			exit(1);
+		}
+		return &env->strings[idx];
+	}
+	case bt_string_def: {
+		unsigned long len = read_varint(env);
+		if (len >= (size_t)(env->end - env->pos) || env->pos[len] != '\0') {
+			parse_error(env, "Invalid string\n");
+			exit(1);
+		}
+		bin_string_t string = { (const char*)env->pos, len, NULL };
+		env->pos += len + 1;
+		ARR_APP1(bin_string_t, env->strings, string);
+		return &env->strings[ARR_LEN(env->strings) - 1];
+	}
+	default:
+		parse_error(env, "Expected string\n");
+		exit(1);
+	}
+}
+
+static ident *read_bin_ident(read_env_t *env)
+{
+	bin_string_t *string = read_bin_string(env);
+	if (string->id == NULL)
+		string->id = new_id_from_chars(string->str, string->len);
+	return string->id;
+}
+
 static void skip_to(read_env_t *env, char to_ch)
 {
+	if (env->binary) {
+		/* no way to resynchronize, stop reading */
+		env->pos = env->end;
+		return;
+	}
 	while (env->c != to_ch && env->c != EOF) {
 		read_c(env);
 	}
 }
 
-static bool expect_char(read_env_t *env, char ch)
+static bool at_eof(read_env_t *env)
 {
+	if (env->binary)
+		return peek_tag(env) == bt_eof;
 	skip_ws(env);
-	if (env->c != ch) {
-		parse_error(env, "Unexpected char '%c', expected '%c'\n",
-		            env->c, ch);
+	return env->c == EOF;
+}
+
+static bool expect_scope_begin(read_env_t *env)
+{
+	if (env->binary) {
+		if (read_tag(env) != bt_scope_begin) {
+			parse_error(env, "Expected scope\n");
+			return false;
+		}
+		return true;
+	}
+	skip_ws(env);
+	if (env->c != '{') {
+		parse_error(env, "Unexpected char '%c', expected '{'\n", env->c);
 		return false;
 	}
 	read_c(env);
 	return true;
 }
 
-#define EXPECT(c) if (expect_char(env, (c))) {} else return
+#define EXPECT_SCOPE_BEGIN() if (expect_scope_begin(env)) {} else return
+
+/** Returns false and skips the end if the end of a scope is reached. */
+static bool scope_has_next(read_env_t *env)
+{
+	if (env->binary) {
+		switch (peek_tag(env)) {
+		case bt_scope_end:
+			++env->pos;
+			/* FALLTHROUGH */
+		case bt_eof:
+			return false;
+		default:
+			return true;
+		}
+	}
+	skip_ws(env);
+	if (env->c == '}' || env->c == EOF) {
+		read_c(env);
+		return false;
+	}
+	return true;
+}
 
 static char *read_word(read_env_t *env)
 {
+	if (env->binary) {
+		if (peek_tag(env) == bt_number) {
+			/* type references and parameter numbers are words or numbers */
+			obstack_printf(&env->obst, "%ld", read_bin_number(env));
+			obstack_1grow(&env->obst, '\0');
+			return (char*)obstack_finish(&env->obst);
+		}
+		bin_string_t *string = read_bin_string(env);
+		return (char*)obstack_copy0(&env->obst, string->str, string->len);
+	}
+
 	skip_ws(env);
 
 	assert(obstack_object_size(&env->obst) == 0);
@@ -1172,6 +1581,11 @@ endofword:
 
 static char *read_string(read_env_t *env)
 {
+	if (env->binary) {
+		bin_string_t *string = read_bin_string(env);
+		return (char*)obstack_copy0(&env->obst, string->str, string->len);
+	}
+
 	skip_ws(env);
 	if (env->c != '"') {
 		parse_error(env, "Expected string, got '%c'\n", env->c);
@@ -1213,6 +1627,9 @@ static char *read_string(read_env_t *env)
 
 static ident *read_ident(read_env_t *env)
 {
+	if (env->binary)
+		return read_bin_ident(env);
+
 	char  *str = read_string(env);
 	ident *res = new_id_from_str(str);
 	obstack_free(&env->obst, str);
@@ -1221,6 +1638,9 @@ static ident *read_ident(read_env_t *env)
 
 static ident *read_symbol(read_env_t *env)
 {
+	if (env->binary)
+		return read_bin_ident(env);
+
 	char  *str = read_word(env);
 	ident *res = new_id_from_str(str);
 	obstack_free(&env->obst, str);
@@ -1232,6 +1652,14 @@ static ident *read_symbol(read_env_t *env)
  */
 static char *read_string_null(read_env_t *env)
 {
+	if (env->binary) {
+		if (peek_tag(env) == bt_null) {
+			++env->pos;
+			return NULL;
+		}
+		return read_string(env);
+	}
+
 	skip_ws(env);
 	if (env->c == 'N') {
 		char *str = read_word(env);
@@ -1249,6 +1677,14 @@ static char *read_string_null(read_env_t *env)
 
 static ident *read_ident_null(read_env_t *env)
 {
+	if (env->binary) {
+		if (peek_tag(env) == bt_null) {
+			++env->pos;
+			return NULL;
+		}
+		return read_bin_ident(env);
+	}
+
 	char *str = read_string_null(env);
 	if (str == NULL)
 		return NULL;
@@ -1260,6 +1696,9 @@ static ident *read_ident_null(read_env_t *env)
 
 static long read_long(read_env_t *env)
 {
+	if (env->binary)
+		return read_bin_number(env);
+
 	skip_ws(env);
 	if (!isdigit(env->c) && env->c != '-') {
 		parse_error(env, "Expected number, got '%c'\n", env->c);
@@ -1298,6 +1737,14 @@ size_t read_size_t(read_env_t *env)
 
 static void expect_list_begin(read_env_t *env)
 {
+	if (env->binary) {
+		if (read_tag(env) != bt_list_begin) {
+			parse_error(env, "Expected list\n");
+			exit(1);
+		}
+		return;
+	}
+
 	skip_ws(env);
 	if (env->c != '[') {
 		parse_error(env, "Expected list, got '%c'\n", env->c);
@@ -1308,6 +1755,19 @@ static void expect_list_begin(read_env_t *env)
 
 static bool list_has_next(read_env_t *env)
 {
+	if (env->binary) {
+		switch (peek_tag(env)) {
+		case bt_list_end:
+			++env->pos;
+			return false;
+		case bt_eof:
+			parse_error(env, "Unexpected EOF while reading list");
+			exit(1);
+		default:
+			return true;
+		}
+	}
+
 	if (feof(env->file)) {
 		parse_error(env, "Unexpected EOF while reading list");
 		exit(1);
@@ -1366,6 +1826,9 @@ static ir_type *get_type(read_env_t *env, long typenr)
 
 ir_type *read_type_ref(read_env_t *env)
 {
+	if (env->binary && peek_tag(env) == bt_number)
+		return get_type(env, read_bin_number(env));
+
 	char *str = read_word(env);
 	if (streq(str, "unknown")) {
 		obstack_free(&env->obst, str);
@@ -1813,18 +2276,15 @@ static void read_typegraph(read_env_t *env)
 {
 	ir_graph *old_irg = env->irg;
 
-	EXPECT('{');
+	EXPECT_SCOPE_BEGIN();
 
 	env->irg = get_const_code_irg();
 
 	/* parse all types first */
 	while (true) {
 		keyword_t kwkind;
-		skip_ws(env);
-		if (env->c == '}') {
-			read_c(env);
+		if (!scope_has_next(env))
 			break;
-		}
 
 		kwkind = read_keyword(env);
 		switch (kwkind) {
@@ -2033,13 +2493,10 @@ static void read_graph(read_env_t *env, ir_graph *irg)
 	env->irg           = irg;
 	env->delayed_preds = NEW_ARR_F(const delayed_pred_t*, 0);
 
-	EXPECT('{');
+	EXPECT_SCOPE_BEGIN();
 	while (true) {
-		skip_ws(env);
-		if (env->c == '}' || env->c == EOF) {
-			read_c(env);
+		if (!scope_has_next(env))
 			break;
-		}
 
 		read_node(env);
 	}
@@ -2070,29 +2527,95 @@ next_delayed_pred: ;
 	env->delayed_preds = NULL;
 }
 
+static uint64_t read_fixed64(const unsigned char *p)
+{
+	uint64_t res = 0;
+	for (unsigned i = 8; i-- > 0;)
+		res = res << 8 | p[i];
+	return res;
+}
+
+/**
+ * Reads the index entry of the next graph and checks that it describes the
+ * graph body at the current position.
+ */
+static bool read_index_entry(read_env_t *env, long entity_nr,
+                             bin_index_entry_t *entry)
+{
+	if (env->next_index >= env->n_index)
+		return false;
+	const unsigned char *p
+		= env->index + env->next_index++ * BINARY_INDEX_ENTRY_SIZE;
+	entry->entity_nr = (long)read_fixed64(p);
+	entry->offset    = (long)read_fixed64(p + 8);
+	entry->size      = (long)read_fixed64(p + 16);
+	entry->n_strings = (size_t)read_fixed64(p + 24);
+	return entry->entity_nr == entity_nr
+	    && entry->offset == env->pos - env->begin
+	    && entry->size > 0 && entry->size <= env->end - env->pos
+	    && entry->n_strings == ARR_LEN(env->strings);
+}
+
+/** Remembers the graph body at the current position and skips it. */
+static bool defer_irg(read_env_t *env, long entity_nr, ir_entity *entity,
+                      ir_type *frame)
+{
+	bin_index_entry_t entry;
+	if (!read_index_entry(env, entity_nr, &entry) || !is_method_entity(entity)
+	    || entity->attr.mtd_attr.irg != NULL
+	    || entity->attr.mtd_attr.lazy_irg != NULL)
+		return false;
+
+	lazy_import_t *import = env->lazy;
+	lazy_irg_t    *lazy   = XMALLOC(lazy_irg_t);
+	lazy->import    = import;
+	lazy->entity    = entity;
+	lazy->frame     = frame;
+	lazy->index     = ARR_LEN(import->irgs);
+	lazy->offset    = entry.offset;
+	lazy->n_strings = entry.n_strings;
+	ARR_APP1(lazy_irg_t*, import->irgs, lazy);
+	++import->n_pending;
+	entity->attr.mtd_attr.lazy_irg = lazy;
+
+	env->pos += entry.size;
+	return true;
+}
+
 static ir_graph *read_irg(read_env_t *env)
 {
-	ir_entity *irgent = get_entity(env, read_long(env));
-	ir_graph  *irg    = new_ir_graph(irgent, 0);
-	ir_type   *frame  = read_type_ref(env);
+	long       entity_nr = read_long(env);
+	ir_entity *irgent    = get_entity(env, entity_nr);
+	ir_type   *frame     = read_type_ref(env);
+	if (!env->binary) {
+		ir_graph *irg = new_ir_graph(irgent, 0);
+		set_irg_frame_type(irg, frame);
+		read_graph(env, irg);
+		irg_finalize_cons(irg);
+		return irg;
+	}
+
+	if (env->lazy != NULL && defer_irg(env, entity_nr, irgent, frame))
+		return NULL;
+
+	size_t    n_strings = ARR_LEN(env->strings);
+	ir_graph *irg       = new_ir_graph(irgent, 0);
 	set_irg_frame_type(irg, frame);
 	read_graph(env, irg);
 	irg_finalize_cons(irg);
+	/* strings first used in the graph body are local to it */
+	ARR_SHRINKLEN(env->strings, n_strings);
 	return irg;
 }
 
 static void read_modes(read_env_t *env)
 {
-	EXPECT('{');
+	EXPECT_SCOPE_BEGIN();
 
 	while (true) {
 		keyword_t kwkind;
-
-		skip_ws(env);
-		if (env->c == '}' || env->c == EOF) {
-			read_c(env);
+		if (!scope_has_next(env))
 			break;
-		}
 
 		kwkind = read_keyword(env);
 		switch (kwkind) {
@@ -2132,6 +2655,13 @@ static void read_modes(read_env_t *env)
 			               overflow);
 			break;
 		}
+		case kw_vector_mode: {
+			const char *name         = read_string(env);
+			ir_mode    *element_mode = read_mode_ref(env);
+			unsigned    n_lanes      = read_long(env);
+			new_vector_mode(name, element_mode, n_lanes);
+			break;
+		}
 
 		default:
 			skip_to(env, '\n');
@@ -2142,14 +2672,11 @@ static void read_modes(read_env_t *env)
 
 static void read_program(read_env_t *env)
 {
-	EXPECT('{');
+	EXPECT_SCOPE_BEGIN();
 
 	while (true) {
-		skip_ws(env);
-		if (env->c == '}') {
-			read_c(env);
+		if (!scope_has_next(env))
 			break;
-		}
 
 		keyword_t kwkind = read_keyword(env);
 		switch (kwkind) {
@@ -2171,43 +2698,24 @@ static void read_program(read_env_t *env)
 	}
 }
 
-int ir_import(const char *filename)
+/** Reads the whole input; env->file or the binary buffer must be set up. */
+static int import_env(read_env_t *env, const char *inputname)
 {
-	FILE *file = fopen(filename, "rt");
-	if (file == NULL) {
-		perror(filename);
-		return 1;
-	}
-
-	int res = ir_import_file(file, filename);
-	fclose(file);
-	return res;
-}
-
-int ir_import_file(FILE *input, const char *inputname)
-{
-	read_env_t          myenv;
-	int                 oldoptimize = get_optimize();
-	read_env_t         *env         = &myenv;
+	int oldoptimize = get_optimize();
 
 	readers_init();
 	symtbl_init();
 
-	memset(env, 0, sizeof(*env));
 	obstack_init(&env->obst);
 	obstack_init(&env->preds_obst);
 	env->idset      = new_set(id_cmp, 128);
 	env->fixedtypes = NEW_ARR_F(ir_type *, 0);
 	env->inputname  = inputname;
-	env->file       = input;
 	env->line       = 1;
 	env->delayed_initializers = NEW_ARR_F(delayed_initializer_t, 0);
 
-	/* read first character */
-	read_c(env);
-
 	/* if the first line starts with '#', it contains a comment. */
-	if (env->c == '#')
+	if (!env->binary && env->c == '#')
 		skip_to(env, '\n');
 
 	set_optimize(0);
@@ -2215,8 +2723,7 @@ int ir_import_file(FILE *input, const char *inputname)
 	while (true) {
 		keyword_t kw;
 
-		skip_ws(env);
-		if (env->c == EOF)
+		if (at_eof(env))
 			break;
 
 		kw = read_keyword(env);
@@ -2272,15 +2779,254 @@ int ir_import_file(FILE *input, const char *inputname)
 	DEL_ARR_F(env->delayed_initializers);
 	env->delayed_initializers = NULL;
 
-	del_set(env->idset);
-
 	set_optimize(oldoptimize);
 
-	obstack_free(&env->preds_obst, NULL);
-	obstack_free(&env->obst, NULL);
-
 	pmap_destroy(node_readers);
 	node_readers = NULL;
 
 	return env->read_errors;
 }
+
+/** Frees the state kept after import_env(). */
+static void free_read_env(read_env_t *env)
+{
+	if (env->idset != NULL) {
+		del_set(env->idset);
+		obstack_free(&env->preds_obst, NULL);
+		obstack_free(&env->obst, NULL);
+	}
+	if (env->strings != NULL)
+		DEL_ARR_F(env->strings);
+}
+
+/**
+ * Imports @p size bytes of binary IR starting with the magic. The state in
+ * @p env has to be freed with free_read_env() afterwards.
+ */
+static int import_binary(read_env_t *env, const unsigned char *data,
+                         size_t size, const char *inputname)
+{
+	env->binary = true;
+	env->begin  = data;
+	env->end    = data + size;
+	if (size < BINARY_MAGIC_SIZE + 8
+	    || memcmp(data, binary_magic, BINARY_MAGIC_SIZE) != 0) {
+		fprintf(stderr, "%s: not a binary firm file or unsupported version\n",
+		        inputname);
+		return 1;
+	}
+
+	env->strings = NEW_ARR_F(bin_string_t, 0);
+
+	const unsigned char *index   = data + BINARY_MAGIC_SIZE;
+	uint64_t             n_index = read_fixed64(index);
+	if (n_index > (size - BINARY_MAGIC_SIZE - 8) / BINARY_INDEX_ENTRY_SIZE) {
+		fprintf(stderr, "%s: invalid graph index\n", inputname);
+		return 1;
+	}
+	env->index   = index + 8;
+	env->n_index = n_index;
+	env->pos     = env->index + n_index * BINARY_INDEX_ENTRY_SIZE;
+
+	return import_env(env, inputname);
+}
+
+/**
+ * Maps the file @p filename into memory if it is in binary format.
+ * Returns NULL otherwise.
+ */
+static const unsigned char *map_binary_file(const char *filename,
+                                            size_t *size)
+{
+#ifndef _WIN32
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	const unsigned char *res = NULL;
+	struct stat st;
+	if (fstat(fd, &st) == 0 && (size_t)st.st_size >= BINARY_MAGIC_SIZE) {
+		*size = st.st_size;
+		void *map = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map != MAP_FAILED) {
+			if (memcmp(map, binary_magic, BINARY_MAGIC_SIZE) == 0)
+				res = (const unsigned char*)map;
+			else
+				munmap(map, *size);
+		}
+	}
+	close(fd);
+	return res;
+#else
+	(void)filename;
+	(void)size;
+	return NULL;
+#endif
+}
+
+static void unmap_binary_file(const unsigned char *data, size_t size)
+{
+#ifndef _WIN32
+	munmap((void*)data, size);
+#else
+	(void)data;
+	(void)size;
+#endif
+}
+
+int ir_import(const char *filename)
+{
+	/* binary files are mapped into memory instead of copied */
+	size_t               size;
+	const unsigned char *data = map_binary_file(filename, &size);
+	if (data != NULL) {
+		read_env_t env;
+		memset(&env, 0, sizeof(env));
+		int res = import_binary(&env, data, size, filename);
+		free_read_env(&env);
+		unmap_binary_file(data, size);
+		return res;
+	}
+
+	FILE *file = fopen(filename, "rb");
+	if (file == NULL) {
+		perror(filename);
+		return 1;
+	}
+
+	int res = ir_import_file(file, filename);
+	fclose(file);
+	return res;
+}
+
+static void free_lazy_import(lazy_import_t *import)
+{
+	for (lazy_import_t **anchor = &lazy_imports;; anchor = &(*anchor)->next) {
+		if (*anchor == import) {
+			*anchor = import->next;
+			break;
+		}
+	}
+	free_read_env(&import->env);
+	unmap_binary_file(import->env.begin, import->env.end - import->env.begin);
+	DEL_ARR_F(import->irgs);
+	free(import);
+}
+
+int ir_import_lazy(const char *filename)
+{
+	size_t               size;
+	const unsigned char *data = map_binary_file(filename, &size);
+	if (data == NULL)
+		return ir_import(filename);
+
+	lazy_import_t *import = XMALLOCZ(lazy_import_t);
+	import->irgs     = NEW_ARR_F(lazy_irg_t*, 0);
+	import->env.lazy = import;
+	import->next     = lazy_imports;
+	lazy_imports     = import;
+
+	int res = import_binary(&import->env, data, size, filename);
+	if (import->n_pending == 0) {
+		free_lazy_import(import);
+	} else {
+		/* keep the name for errors in deferred graphs */
+		import->env.inputname
+			= (char*)obstack_copy0(&import->env.obst, filename,
+			                       strlen(filename));
+	}
+	return res;
+}
+
+/** Builds the irg of @p ent whose import was deferred. */
+static ir_graph *load_lazy_irg(ir_entity *ent)
+{
+	lazy_irg_t    *lazy   = ent->attr.mtd_attr.lazy_irg;
+	lazy_import_t *import = lazy->import;
+	read_env_t    *env    = &import->env;
+	ent->attr.mtd_attr.lazy_irg = NULL;
+	import->irgs[lazy->index]   = NULL;
+
+	/* the graph body sees the string table as it was when it was written */
+	bin_string_t *strings = env->strings;
+	env->strings = NEW_ARR_F(bin_string_t, lazy->n_strings);
+	MEMCPY(env->strings, strings, lazy->n_strings);
+	env->pos = env->begin + lazy->offset;
+
+	bool init_readers = node_readers == NULL;
+	if (init_readers)
+		readers_init();
+	int oldoptimize = get_optimize();
+	set_optimize(0);
+
+	ir_graph *irg = new_ir_graph(ent, 0);
+	set_irg_frame_type(irg, lazy->frame);
+	read_graph(env, irg);
+	irg_finalize_cons(irg);
+
+	set_optimize(oldoptimize);
+	if (init_readers) {
+		pmap_destroy(node_readers);
+		node_readers = NULL;
+	}
+	DEL_ARR_F(env->strings);
+	env->strings = strings;
+
+	free(lazy);
+	if (--import->n_pending == 0)
+		free_lazy_import(import);
+	return irg;
+}
+
+ir_graph *ir_load_entity_irg(ir_entity *entity)
+{
+	ir_graph *const irg = get_entity_irg(entity);
+	if (irg == NULL && entity->attr.mtd_attr.lazy_irg != NULL)
+		return load_lazy_irg(entity);
+	return irg;
+}
+
+void free_lazy_irg(ir_entity *ent)
+{
+	lazy_irg_t    *lazy   = ent->attr.mtd_attr.lazy_irg;
+	lazy_import_t *import = lazy->import;
+	ent->attr.mtd_attr.lazy_irg = NULL;
+	import->irgs[lazy->index]   = NULL;
+	free(lazy);
+	if (--import->n_pending == 0)
+		free_lazy_import(import);
+}
+
+int ir_import_file(FILE *input, const char *inputname)
+{
+	read_env_t env;
+	memset(&env, 0, sizeof(env));
+	env.file = input;
+
+	/* read first character */
+	read_c(&env);
+	if (env.c != (unsigned char)binary_magic[0]) {
+		int res = import_env(&env, inputname);
+		free_read_env(&env);
+		return res;
+	}
+
+	/* binary input, read it completely */
+	size_t         size     = 1;
+	size_t         capacity = 4096;
+	unsigned char *data     = XMALLOCN(unsigned char, capacity);
+	data[0] = (unsigned char)env.c;
+	for (;;) {
+		size += fread(data + size, 1, capacity - size, input);
+		if (size < capacity)
+			break;
+		capacity *= 2;
+		data      = XREALLOC(data, unsigned char, capacity);
+	}
+
+	memset(&env, 0, sizeof(env));
+	int res = import_binary(&env, data, size, inputname);
+	free_read_env(&env);
+	free(data);
+	return res;
+}
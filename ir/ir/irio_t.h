@@ -22,12 +22,29 @@ typedef struct delayed_pred_t {
 	long     preds[];
 } delayed_pred_t;
 
+/** An entry of the string table of the binary format. */
+typedef struct bin_string_t {
+	const char *str;
+	size_t      len;
+	ident      *id;     /**< identifier for str, created on first use */
+} bin_string_t;
+
 typedef struct read_env_t {
 	int            c;           /**< currently read char */
 	FILE          *file;
 	const char    *inputname;
 	unsigned       line;
 
+	bool                 binary;  /**< input is in binary format */
+	const unsigned char *begin;   /**< binary input */
+	const unsigned char *pos;     /**< current position in binary input */
+	const unsigned char *end;     /**< end of binary input */
+	bin_string_t        *strings; /**< string table of binary input */
+	const unsigned char *index;   /**< graph index of binary input */
+	size_t               n_index;
+	size_t               next_index; /**< index entry of the next graph */
+	struct lazy_import_t *lazy;   /**< defer graphs, see ir_import_lazy() */
+
 	ir_graph      *irg;
 	set           *idset;       /**< id_entry set, which maps from file ids to
 	                                 new Firm elements */
@@ -39,10 +56,33 @@ typedef struct read_env_t {
 	const delayed_pred_t **delayed_preds;
 } read_env_t;
 
+/** An entry of the graph index of the binary format. */
+typedef struct bin_index_entry_t {
+	long   entity_nr;
+	long   offset;     /**< start of the graph body */
+	long   size;       /**< size of the graph body */
+	size_t n_strings;  /**< size of the string table at the graph body */
+} bin_index_entry_t;
+
+/** An entry of the string table of the binary format writer. */
+typedef struct bin_string_entry_t {
+	const char *str;
+	size_t      nr;  /**< index in the string table + 1 */
+} bin_string_entry_t;
+
 typedef struct write_env_t {
-	FILE *file;
-	deq_t write_queue;
-	deq_t entity_queue;
+	FILE  *file;
+	deq_t  write_queue;
+	deq_t  entity_queue;
+	bool   binary;     /**< write binary format */
+	set   *strings;    /**< bin_string_entry_t set of the binary string
+	                        table */
+	size_t n_strings;
+	set   *local_strings; /**< strings first used in the current graph body */
+	size_t n_local_strings;
+	struct obstack strings_obst; /**< copies of the strings in the sets */
+	bin_index_entry_t *index;
+	size_t             n_index;
 } write_env_t;
 
 void write_align(write_env_t *env, ir_align align);
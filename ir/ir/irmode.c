@@ -34,6 +34,8 @@ static bool modes_are_equal(const ir_mode *m, const ir_mode *n)
 		return false;
 	if (m->sort == irms_auxiliary || m->sort == irms_data)
 		return streq(m->name, n->name);
+	if (m->sort == irms_vector)
+		return m->element_mode == n->element_mode && m->n_lanes == n->n_lanes;
 	return m->arithmetic        == n->arithmetic
 	    && m->size              == n->size
 	    && m->sign              == n->sign
@@ -206,6 +208,24 @@ ir_mode *new_non_arithmetic_mode(const char *name, unsigned bit_size)
 	return register_mode(result);
 }
 
+ir_mode *new_vector_mode(const char *name, ir_mode *element_mode,
+                         unsigned n_lanes)
+{
+	if (!mode_is_int(element_mode) && !mode_is_float(element_mode))
+		panic("vector elements must have an integer or float mode");
+	unsigned const element_size = get_mode_size_bits(element_mode);
+	if (element_size % 8 != 0 || element_mode->float_desc.explicit_one)
+		panic("unsupported vector element mode");
+	if (n_lanes < 2)
+		panic("vector modes need at least 2 elements");
+
+	ir_mode *result = alloc_mode(name, irms_vector, irma_none,
+	                             element_size * n_lanes, 0, 0);
+	result->element_mode = element_mode;
+	result->n_lanes      = n_lanes;
+	return register_mode(result);
+}
+
 static ir_mode *new_non_data_mode(const char *name)
 {
 	ir_mode *result = alloc_mode(name, irms_auxiliary, irma_none, 0, 0, 0);
@@ -310,6 +330,21 @@ int (mode_is_data)(const ir_mode *mode)
 	return mode_is_data_(mode);
 }
 
+int (mode_is_vector)(const ir_mode *mode)
+{
+	return mode_is_vector_(mode);
+}
+
+ir_mode *(get_mode_vector_element_mode)(const ir_mode *mode)
+{
+	return get_mode_vector_element_mode_(mode);
+}
+
+unsigned (get_mode_vector_n_lanes)(const ir_mode *mode)
+{
+	return get_mode_vector_n_lanes_(mode);
+}
+
 unsigned (get_mode_mantissa_size)(const ir_mode *mode)
 {
 	return get_mode_mantissa_size_(mode);
@@ -361,6 +396,7 @@ int smaller_mode(const ir_mode *sm, const ir_mode *lm)
 		case irms_internal_boolean:
 		case irms_reference:
 		case irms_float_number:
+		case irms_vector:
 			/* int to float works if the float is large enough */
 			return false;
 		}
@@ -375,6 +411,7 @@ int smaller_mode(const ir_mode *sm, const ir_mode *lm)
 	case irms_data:
 	case irms_internal_boolean:
 	case irms_reference:
+	case irms_vector:
 		/* do exist machines out there with different pointer lengths ?*/
 		return false;
 	}
@@ -491,6 +528,8 @@ ir_mode *find_double_bits_int_mode(const ir_mode *mode)
 
 int mode_has_signed_zero(const ir_mode *mode)
 {
+	if (mode_is_vector(mode))
+		return mode_has_signed_zero(mode->element_mode);
 	switch (mode->arithmetic) {
 	case irma_ieee754:
 	case irma_x86_extended_float:
@@ -504,6 +543,8 @@ int mode_has_signed_zero(const ir_mode *mode)
 
 int mode_overflow_on_unary_Minus(const ir_mode *mode)
 {
+	if (mode_is_vector(mode))
+		return mode_overflow_on_unary_Minus(mode->element_mode);
 	switch (mode->arithmetic) {
 	case irma_twos_complement:
 		return true;
@@ -517,6 +558,8 @@ int mode_overflow_on_unary_Minus(const ir_mode *mode)
 
 int mode_wrap_around(const ir_mode *mode)
 {
+	if (mode_is_vector(mode))
+		return mode_wrap_around(mode->element_mode);
 	switch (mode->arithmetic) {
 	case irma_twos_complement:
 	case irma_none:
@@ -73,6 +73,13 @@ ir_relation get_inversed_relation(ir_relation relation)
 	return code;
 }
 
+static void init_irn_edge_info(irn_edge_info_t *const info)
+{
+	INIT_LIST_HEAD(&info->outs_head);
+	info->edges_built = 1;
+	info->out_count   = 0;
+}
+
 ir_node *new_ir_node(dbg_info *db, ir_graph *irg, ir_node *block, ir_op *op,
                      ir_mode *mode, int arity, ir_node *const *in)
 {
@@ -102,12 +109,10 @@ ir_node *new_ir_node(dbg_info *db, ir_graph *irg, ir_node *block, ir_op *op,
 	set_irn_dbg_info(res, db);
 	res->node_nr = get_irp_new_node_nr();
 
-	for (ir_edge_kind_t i = EDGE_KIND_FIRST; i <= EDGE_KIND_LAST; ++i) {
-		INIT_LIST_HEAD(&res->edge_info[i].outs_head);
-		/* Edges will be built immediately. */
-		res->edge_info[i].edges_built = 1;
-		res->edge_info[i].out_count = 0;
-	}
+	/* Edges will be built immediately. */
+	init_irn_edge_info(&res->edge_info);
+	if (op == op_Block)
+		init_irn_edge_info(&res->attr.block.edge_info);
 
 	/* don't put this into the for loop, arity is -1 for some nodes! */
 	if (block != NULL)
@@ -85,6 +85,28 @@ struct ir_switch_table {
 	ir_switch_table_entry entries[];
 };
 
+/**
+ * The edges starting at the operands of a node, indexed by the operand
+ * position minus the first position of the edge kind.
+ */
+typedef struct ir_in_edges_t {
+	ir_node const *src;     /**< The node owning the edges. */
+	unsigned       n_edges; /**< Number of slots in the array. */
+	ir_edge_t     *edges[]; /**< The edges, NULL for unused slots. */
+} ir_in_edges_t;
+
+/**
+ * Edge info to put into an irn.
+ */
+typedef struct irn_edge_kind_info_t {
+	struct list_head outs_head;  /**< The list of all outs. */
+	unsigned edges_built : 1;    /**< Set edges where built for this node. */
+	unsigned out_count   : 31;   /**< Number of outs in the list. */
+	unsigned in_edges;           /**< Index + 1 of the edges of the operands
+	                                  in the in_edges of the graph, 0 if
+	                                  there are none. Fills the padding. */
+} irn_edge_info_t;
+
 /** Attributes for Block nodes. */
 typedef struct block_attr {
 	ir_visited_t block_visited; /**< Visited flag for block walker. */
@@ -98,6 +120,8 @@ typedef struct block_attr {
 	ir_entity  *entity;         /**< entity representing this block */
 	ir_node    *phis;           /**< The list of Phi nodes in this block. */
 	double      execfreq;       /**< block execution frequency */
+	ir_loop    *loop;           /**< Loop information. */
+	irn_edge_info_t edge_info;  /**< Everlasting block successor edges. */
 } block_attr;
 
 /** Attributes for Cond nodes. */
@@ -263,17 +287,6 @@ typedef union ir_attr {
 	switch_attr    switcha;
 } ir_attr;
 
-/**
- * Edge info to put into an irn.
- */
-typedef struct irn_edge_kind_info_t {
-	struct list_head outs_head;  /**< The list of all outs. */
-	unsigned edges_built : 1;    /**< Set edges where built for this node. */
-	unsigned out_count   : 31;   /**< Number of outs in the list. */
-} irn_edge_info_t;
-
-typedef irn_edge_info_t irn_edges_info_t[EDGE_KIND_LAST+1];
-
 /**
  * A Def-Use edge.
  */
@@ -309,9 +322,9 @@ struct ir_node {
 		unsigned          n_outs; /**< number of def-use edges (temporarily used
 		                               during construction of data structure) */
 	} o;
-	ir_loop         *loop;         /**< Loop information. */
 	void            *backend_info;
-	irn_edges_info_t edge_info;    /**< Everlasting out edges. */
+	irn_edge_info_t  edge_info;    /**< Everlasting out edges. Blocks keep
+	                                    their successor edges in attr. */
 
 	/** Attributes of this node. Depends on opcode. Must be last field. */
 	ir_attr attr;
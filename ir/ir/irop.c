@@ -459,7 +459,11 @@ static void call_copy_attr(ir_graph *irg, const ir_node *old_node,
 static void block_copy_attr(ir_graph *irg, const ir_node *old_node,
                             ir_node *new_node)
 {
+	/* the edge info belongs to the new node and is already initialized */
+	irn_edge_info_t const edge_info = new_node->attr.block.edge_info;
 	default_copy_attr(irg, old_node, new_node);
+	new_node->attr.block.edge_info     = edge_info;
+	new_node->attr.block.loop          = NULL;
 	new_node->attr.block.phis          = NULL;
 	new_node->attr.block.backedge      = new_backedge_arr(get_irg_obstack(irg), get_irn_arity(new_node));
 	new_node->attr.block.block_visited = 0;
@@ -23,6 +23,7 @@
 #define INITAL_PROG_NAME "no_name_set"
 
 ir_prog *irp;
+firm_lock_t irp_lock = FIRM_LOCK_INIT;
 ir_prog *get_irp(void) { return irp; }
 void set_irp(ir_prog *new_irp)
 {
@@ -165,8 +166,10 @@ ir_entity *ir_get_global(ident *name)
 void add_irp_irg(ir_graph *irg)
 {
 	assert(irg != NULL);
-	assert(irp && irp->graphs);
+	assert(irp);
+	firm_lock(&irp_lock);
 	ARR_APP1(ir_graph *, irp->graphs, irg);
+	firm_unlock(&irp_lock);
 }
 
 void remove_irp_irg(ir_graph *irg)
@@ -174,6 +177,7 @@ void remove_irp_irg(ir_graph *irg)
 	size_t i, l;
 
 	assert(irg);
+	firm_lock(&irp_lock);
 	l = ARR_LEN(irp->graphs);
 	for (i = 0; i < l; ++i) {
 		if (irp->graphs[i] == irg) {
@@ -184,6 +188,7 @@ void remove_irp_irg(ir_graph *irg)
 			break;
 		}
 	}
+	firm_unlock(&irp_lock);
 }
 
 size_t (get_irp_n_irgs)(void)
@@ -212,7 +217,9 @@ void add_irp_type(ir_type *typ)
 {
 	assert(typ != NULL);
 	assert(irp);
+	firm_lock(&irp_lock);
 	ARR_APP1(ir_type *, irp->types, typ);
+	firm_unlock(&irp_lock);
 }
 
 void remove_irp_type(ir_type *typ)
@@ -220,6 +227,7 @@ void remove_irp_type(ir_type *typ)
 	size_t i, l;
 	assert(typ);
 
+	firm_lock(&irp_lock);
 	l = ARR_LEN(irp->types);
 	for (i = 0; i < l; ++i) {
 		if (irp->types[i] == typ) {
@@ -230,6 +238,7 @@ void remove_irp_type(ir_type *typ)
 			break;
 		}
 	}
+	firm_unlock(&irp_lock);
 }
 
 size_t (get_irp_n_types) (void)
@@ -17,6 +17,7 @@
 #include "array.h"
 #include "callgraph.h"
 #include "irmemory.h"
+#include "lock.h"
 #include "pmap.h"
 #include "typerep.h"
 
@@ -116,15 +117,24 @@ static inline ir_type *get_irp_type_(size_t pos)
 	return irp->types[pos];
 }
 
+/** Protects the counters and the graph and type lists of irp. */
+extern firm_lock_t irp_lock;
+
 /** Returns a new, unique number to number nodes or the like. */
 static inline long get_irp_new_node_nr(void)
 {
-	return irp->max_node_nr++;
+	firm_lock(&irp_lock);
+	long const nr = irp->max_node_nr++;
+	firm_unlock(&irp_lock);
+	return nr;
 }
 
 static inline size_t get_irp_new_irg_idx(void)
 {
-	return irp->max_irg_idx++;
+	firm_lock(&irp_lock);
+	size_t const idx = irp->max_irg_idx++;
+	firm_unlock(&irp_lock);
+	return idx;
 }
 
 static inline ir_graph *get_const_code_irg_(void)
@@ -246,6 +246,19 @@ static int verify_node_Proj_Alloc(const ir_node *p)
 	return invalid_proj(p);
 }
 
+/**
+ * Checks that a parameter or result type of a method is not a vector. There is
+ * no calling convention for vectors and lower_vector() cannot split them.
+ */
+static bool check_not_vector_type(const ir_node *n, const ir_type *type)
+{
+	if (is_atomic_type(type) && mode_is_vector(get_type_mode(type))) {
+		warn(n, "vector type %+F passed to or from a method", type);
+		return false;
+	}
+	return true;
+}
+
 static int verify_node_Proj_Proj_Start(const ir_node *p)
 {
 	ir_graph *irg = get_irn_irg(p);
@@ -259,7 +272,9 @@ static int verify_node_Proj_Proj_Start(const ir_node *p)
 		return false;
 	}
 	ir_type *param_type = get_method_param_type(mt, pn);
-	return check_mode(p, get_type_mode(param_type));
+	bool     fine       = check_not_vector_type(p, param_type);
+	fine &= check_mode(p, get_type_mode(param_type));
+	return fine;
 }
 
 static int verify_node_Proj_Proj_Call(const ir_node *p)
@@ -276,7 +291,9 @@ static int verify_node_Proj_Proj_Call(const ir_node *p)
 	}
 	ir_type *type = get_method_res_type(mt, pn);
 	ir_mode *mode = is_aggregate_type(type) ? mode_P : get_type_mode(type);
-	return check_mode(p, mode);
+	bool     fine = check_not_vector_type(p, type);
+	fine &= check_mode(p, mode);
+	return fine;
 }
 
 static int verify_node_Proj_Proj(const ir_node *p)
@@ -502,6 +519,7 @@ static int verify_node_Return(const ir_node *n)
 	} else {
 		for (int i = get_Return_n_ress(n); i-- > 0; ) {
 			ir_type *expected = get_method_res_type(mt, i);
+			fine &= check_not_vector_type(n, expected);
 			if (is_atomic_type(expected)) {
 				ir_mode *mode = get_type_mode(expected);
 				fine &= check_input_mode(n, n_Return_max+1+i, NULL, mode);
@@ -599,6 +617,17 @@ static int mode_is_data_not_b(const ir_mode *mode)
 	return mode_is_data(mode) && mode != mode_b;
 }
 
+static int mode_is_scalar_data_not_b(const ir_mode *mode)
+{
+	return mode_is_data_not_b(mode) && !mode_is_vector(mode);
+}
+
+/** Vector elements are always numeric, so all vector modes qualify. */
+static int mode_is_num_or_vector(const ir_mode *mode)
+{
+	return mode_is_num(mode) || mode_is_vector(mode);
+}
+
 static int verify_node_Call(const ir_node *n)
 {
 	bool fine = check_mode(n, mode_T);
@@ -621,6 +650,7 @@ static int verify_node_Call(const ir_node *n)
 		for (int i = 0, n_params = get_Call_n_params(n); i < n_params; ++i) {
 			if (i < (int)get_method_n_params(mt)) {
 				const ir_type *param_type = get_method_param_type(mt, i);
+				fine &= check_not_vector_type(n, param_type);
 				if (is_atomic_type(param_type)) {
 					ir_mode *mode = get_type_mode(param_type);
 					fine &= check_input_mode(n, n_Call_max+1+i, NULL, mode);
@@ -630,7 +660,8 @@ static int verify_node_Call(const ir_node *n)
 				}
 			} else {
 				fine &= check_input_func(n, n_Call_max+1+i, NULL,
-				                         mode_is_data_not_b, "data_not_b");
+				                         mode_is_scalar_data_not_b,
+				                         "scalar data_not_b");
 			}
 		}
 	}
@@ -641,7 +672,7 @@ static int verify_node_Add(const ir_node *n)
 {
 	bool     fine = true;
 	ir_mode *mode = get_irn_mode(n);
-	if (mode_is_num(mode)) {
+	if (mode_is_num_or_vector(mode)) {
 		fine &= check_mode_same_input(n, n_Add_left, "left");
 		fine &= check_mode_same_input(n, n_Add_right, "right");
 	} else if (mode_is_reference(mode)) {
@@ -683,20 +714,26 @@ static int verify_node_Sub(const ir_node *n)
 		fine &= check_mode_same_input(n, n_Sub_left, "left");
 		ir_mode *offset_mode = get_reference_offset_mode(mode);
 		fine &= check_input_mode(n, n_Sub_right, "right", offset_mode);
+	} else if (mode_is_vector(mode)) {
+		fine &= check_mode_same_input(n, n_Sub_left, "left");
+		fine &= check_mode_same_input(n, n_Sub_right, "right");
+	} else {
+		warn(n, "mode must be numeric, reference or vector but is %+F", mode);
+		fine = false;
 	}
 	return fine;
 }
 
 static int verify_node_Minus(const ir_node *n)
 {
-	bool fine = check_mode_func(n, mode_is_num, "numeric");
+	bool fine = check_mode_func(n, mode_is_num_or_vector, "numeric or vector");
 	fine &= check_mode_same_input(n, n_Minus_op, "op");
 	return fine;
 }
 
 static int verify_node_Mul(const ir_node *n)
 {
-	bool fine = check_mode_func(n, mode_is_num, "numeric");
+	bool fine = check_mode_func(n, mode_is_num_or_vector, "numeric or vector");
 	fine &= check_mode_same_input(n, n_Mul_left, "left");
 	fine &= check_mode_same_input(n, n_Mul_right, "right");
 	return fine;
@@ -743,9 +780,17 @@ static int mode_is_intb(const ir_mode *mode)
 	return mode_is_int(mode) || mode == mode_b;
 }
 
+static int mode_is_intb_or_int_vector(const ir_mode *mode)
+{
+	return mode_is_intb(mode)
+	    || (mode_is_vector(mode)
+	        && mode_is_int(get_mode_vector_element_mode(mode)));
+}
+
 static int verify_node_And(const ir_node *n)
 {
-	bool fine = check_mode_func(n, mode_is_intb, "int or mode_b");
+	bool fine = check_mode_func(n, mode_is_intb_or_int_vector,
+	                            "int, mode_b or int vector");
 	fine &= check_mode_same_input(n, n_And_left, "left");
 	fine &= check_mode_same_input(n, n_And_right, "right");
 	return fine;
@@ -753,7 +798,8 @@ static int verify_node_And(const ir_node *n)
 
 static int verify_node_Or(const ir_node *n)
 {
-	bool fine = check_mode_func(n, mode_is_intb, "int or mode_b");
+	bool fine = check_mode_func(n, mode_is_intb_or_int_vector,
+	                            "int, mode_b or int vector");
 	fine &= check_mode_same_input(n, n_Or_left, "left");
 	fine &= check_mode_same_input(n, n_Or_right, "right");
 	return fine;
@@ -761,7 +807,8 @@ static int verify_node_Or(const ir_node *n)
 
 static int verify_node_Eor(const ir_node *n)
 {
-	bool fine = check_mode_func(n, mode_is_intb, "int or mode_b");
+	bool fine = check_mode_func(n, mode_is_intb_or_int_vector,
+	                            "int, mode_b or int vector");
 	fine &= check_mode_same_input(n, n_Eor_left, "left");
 	fine &= check_mode_same_input(n, n_Eor_right, "right");
 	return fine;
@@ -769,7 +816,8 @@ static int verify_node_Eor(const ir_node *n)
 
 static int verify_node_Not(const ir_node *n)
 {
-	bool fine = check_mode_func(n, mode_is_intb, "int or mode_b");
+	bool fine = check_mode_func(n, mode_is_intb_or_int_vector,
+	                            "int, mode_b or int vector");
 	fine &= check_mode_same_input(n, n_Not_op, "op");
 	return fine;
 }
@@ -777,10 +825,10 @@ static int verify_node_Not(const ir_node *n)
 static int verify_node_Cmp(const ir_node *n)
 {
 	bool fine = check_mode(n, mode_b);
-	fine &= check_input_func(n, n_Cmp_left, "left", mode_is_data_not_b,
-	                         "data_not_b");
-	fine &= check_input_func(n, n_Cmp_right, "right", mode_is_data_not_b,
-	                         "data_not_b");
+	fine &= check_input_func(n, n_Cmp_left, "left", mode_is_scalar_data_not_b,
+	                         "scalar data_not_b");
+	fine &= check_input_func(n, n_Cmp_right, "right", mode_is_scalar_data_not_b,
+	                         "scalar data_not_b");
 	ir_mode *model = get_irn_mode(get_Cmp_left(n));
 	ir_mode *moder = get_irn_mode(get_Cmp_right(n));
 	if (model != moder) {
@@ -822,17 +870,19 @@ static int verify_node_Shrs(const ir_node *n)
 
 static int verify_node_Conv(const ir_node *n)
 {
-	bool fine = check_mode_func(n, mode_is_data_not_b, "data_not_b");
-	fine &= check_input_func(n, n_Conv_op, "op", mode_is_data_not_b,
-	                         "data_not_b");
+	bool fine = check_mode_func(n, mode_is_scalar_data_not_b,
+	                            "scalar data_not_b");
+	fine &= check_input_func(n, n_Conv_op, "op", mode_is_scalar_data_not_b,
+	                         "scalar data_not_b");
 	return fine;
 }
 
 static int verify_node_Bitcast(const ir_node *n)
 {
-	bool fine = check_mode_func(n, mode_is_data_not_b, "data_not_b");
-	fine &= check_input_func(n, n_Bitcast_op, "op", mode_is_data_not_b,
-	                         "data_not_b");
+	bool fine = check_mode_func(n, mode_is_scalar_data_not_b,
+	                            "scalar data_not_b");
+	fine &= check_input_func(n, n_Bitcast_op, "op", mode_is_scalar_data_not_b,
+	                         "scalar data_not_b");
 	ir_node *op       = get_Bitcast_op(n);
 	ir_mode *src_mode = get_irn_mode(op);
 	ir_mode *dst_mode = get_irn_mode(n);
@@ -1370,8 +1420,8 @@ static bool has_multiple_X_succs(const ir_node *node)
 	    || (is_fragile_op(node) && ir_throws_exception(node));
 }
 
-static unsigned n_returns;
-static bool     properties_fine;
+static FIRM_THREAD_LOCAL unsigned n_returns;
+static FIRM_THREAD_LOCAL bool     properties_fine;
 
 static void check_simple_properties(ir_node *node, void *env)
 {
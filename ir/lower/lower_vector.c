@@ -0,0 +1,445 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2016 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Lowers operations on vector modes to operations on their elements.
+ *
+ * All values of a vector mode are lowered together, so a vector never has to
+ * be assembled from or split into scalar registers. Every lowered node gets an
+ * array with one scalar node per lane.
+ */
+#include "array.h"
+#include "debug.h"
+#include "ircons_t.h"
+#include "iredges_t.h"
+#include "irgmod.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irmode_t.h"
+#include "irnode_t.h"
+#include "irnodemap.h"
+#include "lowering.h"
+#include "obst.h"
+#include "panic.h"
+#include "tv_t.h"
+#include "util.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+typedef struct lower_vector_env_t {
+	lower_vector_callback *cb_func;
+	ir_mode              **lowered_modes; /**< vector modes to lower */
+	ir_node              **nodes;         /**< nodes to lower, operands first */
+	ir_nodemap             lanes;         /**< node -> array of lane nodes */
+	struct obstack         obst;
+} lower_vector_env_t;
+
+typedef ir_node *new_unop_func(dbg_info *dbgi, ir_node *block, ir_node *op);
+typedef ir_node *new_binop_func(dbg_info *dbgi, ir_node *block, ir_node *left,
+                                ir_node *right);
+
+/**
+ * Returns the vector mode @p node operates on, NULL if there is none.
+ */
+static ir_mode *get_vector_op_mode(ir_node const *node)
+{
+	ir_mode *mode;
+	switch (get_irn_opcode(node)) {
+	case iro_Load:  mode = get_Load_mode(node);                 break;
+	case iro_Store: mode = get_irn_mode(get_Store_value(node)); break;
+	default:        mode = get_irn_mode(node);                  break;
+	}
+	return mode_is_vector(mode) ? mode : NULL;
+}
+
+static bool is_lowered_mode(lower_vector_env_t const *env, ir_mode const *mode)
+{
+	for (size_t i = 0, n = ARR_LEN(env->lowered_modes); i < n; ++i) {
+		if (env->lowered_modes[i] == mode)
+			return true;
+	}
+	return false;
+}
+
+static void find_lowered_modes(ir_node *node, void *data)
+{
+	lower_vector_env_t *env  = (lower_vector_env_t*)data;
+	ir_mode            *mode = get_vector_op_mode(node);
+	if (mode == NULL || is_lowered_mode(env, mode))
+		return;
+	if (env->cb_func == NULL || !env->cb_func(node))
+		ARR_APP1(ir_mode*, env->lowered_modes, mode);
+}
+
+static void collect_nodes(ir_node *node, void *data)
+{
+	lower_vector_env_t *env  = (lower_vector_env_t*)data;
+	ir_mode            *mode = get_vector_op_mode(node);
+	if (mode != NULL && is_lowered_mode(env, mode)) {
+		ARR_APP1(ir_node*, env->nodes, node);
+		return;
+	}
+
+	/* The remaining users of vector values must not need them as a whole. */
+	if (is_End(node))
+		return;
+	foreach_irn_in(node, i, pred) {
+		if (is_lowered_mode(env, get_irn_mode(pred)))
+			panic("cannot lower vector operand %+F of %+F", pred, node);
+	}
+}
+
+static ir_node **get_lanes(lower_vector_env_t const *env, ir_node const *node)
+{
+	ir_node **lanes = ir_nodemap_get(ir_node*, &env->lanes, node);
+	assert(lanes != NULL);
+	return lanes;
+}
+
+static ir_node **new_lanes(lower_vector_env_t *env, ir_node const *node)
+{
+	unsigned  const n_lanes = get_mode_vector_n_lanes(get_vector_op_mode(node));
+	ir_node **const lanes   = OALLOCN(&env->obst, ir_node*, n_lanes);
+	ir_nodemap_insert(&env->lanes, node, lanes);
+	return lanes;
+}
+
+/**
+ * Returns the address of lane @p lane of a vector at address @p ptr. Lane 0
+ * is at the lowest address, regardless of the endianness of the target.
+ */
+static ir_node *get_lane_address(ir_node *block, ir_node *ptr,
+                                 ir_mode *element_mode, unsigned lane)
+{
+	if (lane == 0)
+		return ptr;
+	ir_graph *irg         = get_irn_irg(block);
+	ir_mode  *offset_mode = get_reference_offset_mode(get_irn_mode(ptr));
+	long      offset      = lane * get_mode_size_bytes(element_mode);
+	ir_node  *cnst        = new_r_Const_long(irg, offset_mode, offset);
+	return new_r_Add(block, ptr, cnst);
+}
+
+static void lower_Const(lower_vector_env_t *env, ir_node *node)
+{
+	ir_node  **lanes = new_lanes(env, node);
+	dbg_info  *dbgi  = get_irn_dbg_info(node);
+	ir_graph  *irg   = get_irn_irg(node);
+	ir_tarval *tv    = get_Const_tarval(node);
+	for (unsigned i = 0, n = get_mode_vector_n_lanes(get_irn_mode(node));
+	     i < n; ++i) {
+		lanes[i] = new_rd_Const(dbgi, irg, get_tarval_lane(tv, i));
+	}
+}
+
+static void lower_Unknown(lower_vector_env_t *env, ir_node *node)
+{
+	ir_node **lanes        = new_lanes(env, node);
+	ir_mode  *mode         = get_irn_mode(node);
+	ir_mode  *element_mode = get_mode_vector_element_mode(mode);
+	ir_graph *irg          = get_irn_irg(node);
+	for (unsigned i = 0, n = get_mode_vector_n_lanes(mode); i < n; ++i) {
+		lanes[i] = is_Bad(node) ? new_r_Bad(irg, element_mode)
+		                        : new_r_Unknown(irg, element_mode);
+	}
+}
+
+/**
+ * Returns the type of the lanes of a vector accessed as @p type. Arrays keep
+ * their element type, so the lane accesses alias the same objects.
+ */
+static ir_type *get_lane_type(ir_type *type, ir_mode *element_mode)
+{
+	if (is_Array_type(type))
+		return get_array_element_type(type);
+	return get_type_for_mode(element_mode);
+}
+
+/**
+ * Splits a Load into one Load per lane. The Loads are chained, the first one
+ * takes over the exception control flow of the original Load.
+ */
+static void lower_Load(lower_vector_env_t *env, ir_node *node)
+{
+	ir_mode  *mode         = get_Load_mode(node);
+	ir_mode  *element_mode = get_mode_vector_element_mode(mode);
+	ir_type  *type         = get_lane_type(get_Load_type(node), element_mode);
+	ir_node  *block        = get_nodes_block(node);
+	ir_node  *ptr          = get_Load_ptr(node);
+	ir_node  *mem          = get_Load_mem(node);
+	dbg_info *dbgi         = get_irn_dbg_info(node);
+	unsigned  n_lanes      = get_mode_vector_n_lanes(mode);
+
+	ir_cons_flags cons = cons_none;
+	if (get_Load_volatility(node) == volatility_is_volatile)
+		cons |= cons_volatile;
+	if (get_Load_unaligned(node) == align_non_aligned)
+		cons |= cons_unaligned;
+	if (get_irn_pinned(node) == op_pin_state_floats)
+		cons |= cons_floats;
+
+	ir_node **loads = ALLOCAN(ir_node*, n_lanes);
+	for (unsigned i = 0; i < n_lanes; ++i) {
+		ir_cons_flags lane_cons = cons;
+		if (i == 0 && ir_throws_exception(node))
+			lane_cons |= cons_throws_exception;
+		ir_node *addr = get_lane_address(block, ptr, element_mode, i);
+		loads[i] = new_rd_Load(dbgi, block, mem, addr, element_mode, type,
+		                       lane_cons);
+		mem = new_r_Proj(loads[i], mode_M, pn_Load_M);
+	}
+
+	foreach_out_edge_safe(node, edge) {
+		ir_node *proj = get_edge_src_irn(edge);
+		if (!is_Proj(proj))
+			continue;
+
+		switch ((pn_Load)get_Proj_num(proj)) {
+		case pn_Load_M:
+			set_Proj_pred(proj, loads[n_lanes - 1]);
+			break;
+		case pn_Load_X_regular:
+		case pn_Load_X_except:
+			set_Proj_pred(proj, loads[0]);
+			break;
+		case pn_Load_res: {
+			ir_node **lanes = new_lanes(env, proj);
+			for (unsigned i = 0; i < n_lanes; ++i)
+				lanes[i] = new_r_Proj(loads[i], element_mode, pn_Load_res);
+			break;
+		}
+		}
+	}
+}
+
+/**
+ * Splits a Store into one Store per lane, like lower_Load().
+ */
+static void lower_Store(lower_vector_env_t *env, ir_node *node)
+{
+	ir_node  *value        = get_Store_value(node);
+	ir_mode  *mode         = get_irn_mode(value);
+	ir_mode  *element_mode = get_mode_vector_element_mode(mode);
+	ir_type  *type         = get_lane_type(get_Store_type(node), element_mode);
+	ir_node  *block        = get_nodes_block(node);
+	ir_node  *ptr          = get_Store_ptr(node);
+	ir_node  *mem          = get_Store_mem(node);
+	dbg_info *dbgi         = get_irn_dbg_info(node);
+	ir_node **values       = get_lanes(env, value);
+	unsigned  n_lanes      = get_mode_vector_n_lanes(mode);
+
+	ir_cons_flags cons = cons_none;
+	if (get_Store_volatility(node) == volatility_is_volatile)
+		cons |= cons_volatile;
+	if (get_Store_unaligned(node) == align_non_aligned)
+		cons |= cons_unaligned;
+	if (get_irn_pinned(node) == op_pin_state_floats)
+		cons |= cons_floats;
+
+	ir_node **stores = ALLOCAN(ir_node*, n_lanes);
+	for (unsigned i = 0; i < n_lanes; ++i) {
+		ir_cons_flags lane_cons = cons;
+		if (i == 0 && ir_throws_exception(node))
+			lane_cons |= cons_throws_exception;
+		ir_node *addr = get_lane_address(block, ptr, element_mode, i);
+		stores[i] = new_rd_Store(dbgi, block, mem, addr, values[i], type,
+		                         lane_cons);
+		mem = new_r_Proj(stores[i], mode_M, pn_Store_M);
+	}
+
+	foreach_out_edge_safe(node, edge) {
+		ir_node *proj = get_edge_src_irn(edge);
+		if (!is_Proj(proj))
+			continue;
+
+		switch ((pn_Store)get_Proj_num(proj)) {
+		case pn_Store_M:
+			set_Proj_pred(proj, stores[n_lanes - 1]);
+			break;
+		case pn_Store_X_regular:
+		case pn_Store_X_except:
+			set_Proj_pred(proj, stores[0]);
+			break;
+		}
+	}
+}
+
+static void lower_unop(lower_vector_env_t *env, ir_node *node,
+                       new_unop_func *new_unop)
+{
+	ir_node **lanes = new_lanes(env, node);
+	ir_node **ops   = get_lanes(env, get_irn_n(node, 0));
+	dbg_info *dbgi  = get_irn_dbg_info(node);
+	ir_node  *block = get_nodes_block(node);
+	for (unsigned i = 0, n = get_mode_vector_n_lanes(get_irn_mode(node));
+	     i < n; ++i) {
+		lanes[i] = new_unop(dbgi, block, ops[i]);
+	}
+}
+
+static void lower_binop(lower_vector_env_t *env, ir_node *node,
+                        new_binop_func *new_binop)
+{
+	ir_node **lanes  = new_lanes(env, node);
+	ir_node **lefts  = get_lanes(env, get_binop_left(node));
+	ir_node **rights = get_lanes(env, get_binop_right(node));
+	dbg_info *dbgi   = get_irn_dbg_info(node);
+	ir_node  *block  = get_nodes_block(node);
+	for (unsigned i = 0, n = get_mode_vector_n_lanes(get_irn_mode(node));
+	     i < n; ++i) {
+		lanes[i] = new_binop(dbgi, block, lefts[i], rights[i]);
+	}
+}
+
+static void lower_Mux(lower_vector_env_t *env, ir_node *node)
+{
+	ir_node **lanes  = new_lanes(env, node);
+	ir_node **falses = get_lanes(env, get_Mux_false(node));
+	ir_node **trues  = get_lanes(env, get_Mux_true(node));
+	ir_node  *sel    = get_Mux_sel(node);
+	dbg_info *dbgi   = get_irn_dbg_info(node);
+	ir_node  *block  = get_nodes_block(node);
+	for (unsigned i = 0, n = get_mode_vector_n_lanes(get_irn_mode(node));
+	     i < n; ++i) {
+		lanes[i] = new_rd_Mux(dbgi, block, sel, falses[i], trues[i]);
+	}
+}
+
+/**
+ * Creates the lane Phis. Their operands are set by fixup_Phi() once all
+ * operands are lowered.
+ */
+static void lower_Phi(lower_vector_env_t *env, ir_node *node)
+{
+	ir_node **lanes        = new_lanes(env, node);
+	ir_mode  *mode         = get_irn_mode(node);
+	ir_mode  *element_mode = get_mode_vector_element_mode(mode);
+	ir_graph *irg          = get_irn_irg(node);
+	ir_node  *block        = get_nodes_block(node);
+	dbg_info *dbgi         = get_irn_dbg_info(node);
+	int       arity        = get_Phi_n_preds(node);
+	ir_node **in           = ALLOCAN(ir_node*, arity);
+	for (unsigned l = 0, n = get_mode_vector_n_lanes(mode); l < n; ++l) {
+		/* a Dummy per lane, or CSE would merge the lane Phis */
+		ir_node *dummy = new_r_Dummy(irg, element_mode);
+		for (int i = 0; i < arity; ++i)
+			in[i] = dummy;
+		lanes[l] = new_rd_Phi(dbgi, block, arity, in, element_mode);
+	}
+}
+
+static void fixup_Phi(lower_vector_env_t *env, ir_node *node)
+{
+	ir_node **lanes = get_lanes(env, node);
+	foreach_irn_in(node, i, pred) {
+		ir_node **pred_lanes = get_lanes(env, pred);
+		for (unsigned l = 0, n = get_mode_vector_n_lanes(get_irn_mode(node));
+		     l < n; ++l) {
+			set_Phi_pred(lanes[l], i, pred_lanes[l]);
+		}
+	}
+}
+
+static void lower_node(lower_vector_env_t *env, ir_node *node)
+{
+	DB((dbg, LEVEL_2, "  %+F\n", node));
+	switch (get_irn_opcode(node)) {
+	case iro_Add:     lower_binop(env, node, new_rd_Add); return;
+	case iro_And:     lower_binop(env, node, new_rd_And); return;
+	case iro_Eor:     lower_binop(env, node, new_rd_Eor); return;
+	case iro_Mul:     lower_binop(env, node, new_rd_Mul); return;
+	case iro_Or:      lower_binop(env, node, new_rd_Or);  return;
+	case iro_Sub:     lower_binop(env, node, new_rd_Sub); return;
+	case iro_Minus:   lower_unop(env, node, new_rd_Minus); return;
+	case iro_Not:     lower_unop(env, node, new_rd_Not);   return;
+	case iro_Bad:
+	case iro_Unknown: lower_Unknown(env, node); return;
+	case iro_Const:   lower_Const(env, node);   return;
+	case iro_Load:    lower_Load(env, node);    return;
+	case iro_Mux:     lower_Mux(env, node);     return;
+	case iro_Store:   lower_Store(env, node);   return;
+	case iro_Phi:
+		/* already created before all other nodes */
+		return;
+	case iro_Proj:
+		/* Load results got their lanes together with the Load */
+		if (is_Load(get_Proj_pred(node)))
+			return;
+		break;
+	default:
+		break;
+	}
+	panic("cannot lower %+F with vector mode", node);
+}
+
+/**
+ * Replaces kept alive vector Phis by their lanes, other kept alive vector
+ * values are dropped.
+ */
+static void fix_keepalives(lower_vector_env_t *env, ir_graph *irg)
+{
+	ir_node  *end = get_irg_end(irg);
+	ir_node **in  = NEW_ARR_F(ir_node*, 0);
+	for (int i = 0, n = get_End_n_keepalives(end); i < n; ++i) {
+		ir_node *ka   = get_End_keepalive(end, i);
+		ir_mode *mode = get_irn_mode(ka);
+		if (!is_lowered_mode(env, mode)) {
+			ARR_APP1(ir_node*, in, ka);
+		} else if (is_Phi(ka)) {
+			ir_node **lanes = get_lanes(env, ka);
+			for (unsigned l = 0, n_lanes = get_mode_vector_n_lanes(mode);
+			     l < n_lanes; ++l) {
+				ARR_APP1(ir_node*, in, lanes[l]);
+			}
+		}
+	}
+	set_End_keepalives(end, ARR_LEN(in), in);
+	DEL_ARR_F(in);
+}
+
+void lower_vector(ir_graph *irg, lower_vector_callback *cb_func)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.lower.vector");
+
+	lower_vector_env_t env;
+	env.cb_func       = cb_func;
+	env.lowered_modes = NEW_ARR_F(ir_mode*, 0);
+	irg_walk_graph(irg, NULL, find_lowered_modes, &env);
+	if (ARR_LEN(env.lowered_modes) == 0) {
+		DEL_ARR_F(env.lowered_modes);
+		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_ALL);
+		return;
+	}
+
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
+	DB((dbg, LEVEL_1, "lowering vectors in %+F\n", irg));
+
+	env.nodes = NEW_ARR_F(ir_node*, 0);
+	irg_walk_graph(irg, NULL, collect_nodes, &env);
+	ir_nodemap_init(&env.lanes, irg);
+	obstack_init(&env.obst);
+
+	/* Phis first, so every operand has its lanes when its user is lowered. */
+	for (size_t i = 0, n = ARR_LEN(env.nodes); i < n; ++i) {
+		ir_node *node = env.nodes[i];
+		if (is_Phi(node))
+			lower_Phi(&env, node);
+	}
+	for (size_t i = 0, n = ARR_LEN(env.nodes); i < n; ++i)
+		lower_node(&env, env.nodes[i]);
+	for (size_t i = 0, n = ARR_LEN(env.nodes); i < n; ++i) {
+		ir_node *node = env.nodes[i];
+		if (is_Phi(node))
+			fixup_Phi(&env, node);
+	}
+	fix_keepalives(&env, irg);
+
+	obstack_free(&env.obst, NULL);
+	ir_nodemap_destroy(&env.lanes);
+	DEL_ARR_F(env.nodes);
+	DEL_ARR_F(env.lowered_modes);
+	confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_CONTROL_FLOW);
+}
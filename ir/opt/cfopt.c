@@ -24,7 +24,7 @@
 #include <assert.h>
 #include <stdbool.h>
 
-DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+DEBUG_ONLY(static FIRM_THREAD_LOCAL firm_dbg_module_t *dbg;)
 
 /** Set or reset the removable property of a block. */
 static void set_Block_removable(ir_node *block, bool removable)
@@ -35,7 +35,7 @@
 #include "vrp.h"
 #include <stdbool.h>
 
-DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+DEBUG_ONLY(static FIRM_THREAD_LOCAL firm_dbg_module_t *dbg;)
 
 static bool is_optimizable_node(const ir_node *node, ir_mode *dest_mode)
 {
@@ -19,6 +19,8 @@
 #include "irgraph_t.h"
 #include "irgwalk.h"
 #include "irhooks.h"
+#include "irlivechk.h"
+#include "irmemory_t.h"
 #include "irnode_t.h"
 #include "iropt_t.h"
 #include "iroptimize.h"
@@ -81,7 +83,10 @@ void dead_node_elimination(ir_graph *irg)
 	free_irg_outs(irg);
 	free_loop_information(irg);
 	free_vrp_data(irg);
-	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+	free_alias_cache(irg);
+	free_irg_lv_chk(irg);
+	clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+	                        | IR_GRAPH_PROPERTY_CONSISTENT_LIVENESS);
 
 	/* A quiet place, where the old obstack can rest in peace,
 	   until it will be cremated. */
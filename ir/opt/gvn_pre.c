@@ -100,8 +100,8 @@ typedef struct pre_env {
 	char            first_iter;   /* non-zero for first fixed point iteration */
 	int             iteration;    /* iteration counter */
 #if OPTIMIZE_NODES
-	pset           *value_table;   /* standard value table*/
-	pset           *gvnpre_values; /* GVN-PRE value table */
+	ir_identities_t *value_table;   /* standard value table*/
+	ir_identities_t *gvnpre_values; /* GVN-PRE value table */
 #endif
 } pre_env;
 
@@ -224,14 +224,8 @@ static void dump_all_expgen_sets(block_info *list)
  * Compares node collisions in value table.
  * Modified identities_cmp().
  */
-static int compare_gvn_identities(const void *elt, const void *key)
+static int compare_gvn_identities(const ir_node *a, const ir_node *b)
 {
-	ir_node *a = (ir_node *)elt;
-	ir_node *b = (ir_node *)key;
-
-	if (a == b)
-		return 0;
-
 	/* phi nodes kill predecessor values and are always different */
 	if (is_Phi(a) || is_Phi(b))
 		return 1;
@@ -247,14 +241,7 @@ static int compare_gvn_identities(const void *elt, const void *key)
 			return 1;
 	}
 
-	if ((get_irn_op(a) != get_irn_op(b)) ||
-	    (get_irn_mode(a) != get_irn_mode(b)))
-		return 1;
-
-	/* compare if a's in and b's in are of equal length */
-	int irn_arity_a = get_irn_arity(a);
-	if (irn_arity_a != get_irn_arity(b))
-		return 1;
+	/* opcode, mode and arity are already checked by the value table */
 
 	/* blocks are never the same */
 	if (is_Block(a) || is_Block(b))
@@ -264,7 +251,7 @@ static int compare_gvn_identities(const void *elt, const void *key)
 	assert(get_opt_global_cse());
 
 	/* compare a->in[0..ins] with b->in[0..ins] */
-	for (int i = 0; i < irn_arity_a; ++i) {
+	for (int i = 0, irn_arity_a = get_irn_arity(a); i < irn_arity_a; ++i) {
 		ir_node *pred_a = get_irn_n(a, i);
 		ir_node *pred_b = get_irn_n(b, i);
 		if (pred_a != pred_b)
@@ -1838,9 +1825,9 @@ void do_gvn_pre(ir_graph *irg)
 	set_opt_global_cse(1);
 	/* new_identities() */
 	if (irg->value_table != NULL)
-		del_pset(irg->value_table);
-	/* initially assumed nodes in pset are 512 */
-	irg->value_table = new_pset(compare_gvn_identities, 512);
+		ir_identities_del(irg->value_table);
+	/* initially assumed nodes in the value table are 512 */
+	irg->value_table = ir_identities_new(compare_gvn_identities, 512);
 #if OPTIMIZE_NODES
 	env.gvnpre_values = irg->value_table;
 #endif
@@ -1867,7 +1854,7 @@ void do_gvn_pre(ir_graph *irg)
 
 #if OPTIMIZE_NODES
 	irg->value_table = env.value_table;
-	del_pset(irg->value_table);
+	ir_identities_del(irg->value_table);
 	irg->value_table = env.gvnpre_values;
 #endif
 
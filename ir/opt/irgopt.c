@@ -11,8 +11,10 @@
  */
 #include "irgopt.h"
 
+#include "array.h"
 #include "constbits.h"
 #include "ircons.h"
+#include "irdom_t.h"
 #include "iredges_t.h"
 #include "irflag_t.h"
 #include "irgmod.h"
@@ -23,8 +25,17 @@
 #include "iroptimize.h"
 #include "irtools.h"
 #include "pdeq.h"
+#include "statev_t.h"
 #include <assert.h>
 
+typedef struct df_env_t {
+	deq_t       waitq;
+	dom_edge_t *removed_cf;   /**< control flow edges removed in this round */
+	bool        recompute_cf; /**< other control flow changes occurred */
+	ir_node   **block_in;     /**< inputs of the Block being optimized */
+	unsigned    dom_cost;     /**< blocks visited to update dominance */
+} df_env_t;
+
 /**
  * A wrapper around optimize_inplace_2() to be called from a walker.
  */
@@ -100,12 +111,14 @@ static void enqueue_users(ir_node *n, deq_t *waitq)
 /**
  * Block-Walker: uses dominance depth to mark dead blocks.
  */
-static void find_unreachable_blocks(ir_node *block, void *env)
+static void find_unreachable_blocks(ir_node *block, void *data)
 {
+	df_env_t *env = (df_env_t*)data;
+	++env->dom_cost;
 	if (get_Block_dom_depth(block) >= 0)
 		return;
 
-	deq_t *waitq = (deq_t *)env;
+	deq_t *waitq = &env->waitq;
 	foreach_block_succ(block, edge) {
 		ir_node *succ_block = get_edge_src_irn(edge);
 		enqueue_node(succ_block, waitq);
@@ -126,12 +139,32 @@ void local_optimize_graph(ir_graph *irg)
 	local_optimize_node(get_irg_end(irg));
 }
 
+/**
+ * Records the change of the control flow predecessor @p old of @p block to
+ * @p nw.
+ */
+static void note_cf_change(df_env_t *env, ir_node *block, ir_node *old,
+                           ir_node *nw)
+{
+	ir_node *const from = get_nodes_block(old);
+	if (!is_Block(from))
+		return;
+	if (!is_Bad(nw)) {
+		if (get_nodes_block(nw) == from)
+			return;
+		/* an edge from another block was added */
+		env->recompute_cf = true;
+	}
+	dom_edge_t const edge = { from, block };
+	ARR_APP1(dom_edge_t, env->removed_cf, edge);
+}
+
 /**
  * Data flow optimization walker.
  * Optimizes all nodes and enqueue its users
  * if done.
  */
-static void opt_walker(ir_node *n, deq_t *waitq)
+static void opt_walker(ir_node *n, df_env_t *env)
 {
 	/* If CSE occurs during the optimization,
 	 * our operands have fewer users than before.
@@ -141,12 +174,39 @@ static void opt_walker(ir_node *n, deq_t *waitq)
 	ir_node *optimized = n;
 	ir_node *last;
 	do {
-		last      = optimized;
+		last = optimized;
+		ir_op *const op = get_irn_op(last);
+		/* Blocks are optimized in place, remember their predecessors. */
+		if (op == op_Block) {
+			int const arity = get_Block_n_cfgpreds(last);
+			ARR_RESIZE(ir_node*, env->block_in, arity);
+			for (int i = 0; i < arity; ++i)
+				env->block_in[i] = get_Block_cfgpred(last, i);
+		}
 		optimized = optimize_in_place_2(last);
 
 		if (optimized != last) {
-			enqueue_users(last, waitq);
+			if (get_irn_mode(last) == mode_X) {
+				foreach_out_edge(last, edge) {
+					ir_node *const succ = get_edge_src_irn(edge);
+					if (is_Block(succ))
+						note_cf_change(env, succ, last, optimized);
+				}
+			} else if (op == op_Block) {
+				env->recompute_cf = true;
+			}
+			enqueue_users(last, &env->waitq);
 			exchange(last, optimized);
+		} else if (get_irn_op(last) != op) {
+			/* Turned into a Tuple, its Projs have to follow. */
+			enqueue_users(last, &env->waitq);
+		} else if (op == op_Block) {
+			for (int i = 0, arity = get_Block_n_cfgpreds(last); i < arity; ++i) {
+				ir_node *const old  = env->block_in[i];
+				ir_node *const pred = get_Block_cfgpred(last, i);
+				if (pred != old && !is_Bad(old))
+					note_cf_change(env, last, old, pred);
+			}
 		}
 	} while (optimized != last);
 }
@@ -174,29 +234,55 @@ void optimize_graph_df(ir_graph *irg)
 
 	constbits_analyze(irg);
 
-	deq_t waitq;
-	deq_init(&waitq);
-	irg_walk_graph(irg, NULL, enqueue_node_init, &waitq);
+	df_env_t env;
+	deq_init(&env.waitq);
+	env.removed_cf   = NEW_ARR_F(dom_edge_t, 0);
+	env.recompute_cf = true;
+	env.block_in     = NEW_ARR_F(ir_node*, 0);
+	env.dom_cost     = 0;
+	ir_node **unreachable = NEW_ARR_F(ir_node*, 0);
+	unsigned  rounds      = 0;
+	irg_walk_graph(irg, NULL, enqueue_node_init, &env.waitq);
 
 	/* any optimized nodes are stored in the wait queue,
 	 * so if it's not empty, the graph has been changed */
-	while (!deq_empty(&waitq)) {
+	while (!deq_empty(&env.waitq)) {
 		assure_irg_properties(irg, props);
 
 		/* finish the wait queue */
-		while (!deq_empty(&waitq)) {
-			ir_node *n = deq_pop_pointer_left(ir_node, &waitq);
+		while (!deq_empty(&env.waitq)) {
+			ir_node *n = deq_pop_pointer_left(ir_node, &env.waitq);
 			set_irn_link(n, NULL);
-			opt_walker(n, &waitq);
+			opt_walker(n, &env);
 		}
-		/* Calculate dominance so we can kill unreachable code
+		/* Update dominance so we can kill unreachable code
 		 * We want this intertwined with localopts for better optimization
-		 * (phase coupling) */
-		compute_doms(irg);
-		assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
-		irg_block_walk_graph(irg, NULL, find_unreachable_blocks, &waitq);
+		 * (phase coupling). Local optimizations only remove control flow
+		 * edges, so after the first round only the dominator subtrees
+		 * below them are recomputed. */
+		++rounds;
+		if (env.recompute_cf) {
+			compute_doms(irg);
+			assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
+			irg_block_walk_graph(irg, NULL, find_unreachable_blocks, &env);
+		} else if (ARR_LEN(env.removed_cf) > 0) {
+			env.dom_cost += dom_remove_edges(irg, env.removed_cf,
+			                                 ARR_LEN(env.removed_cf),
+			                                 &unreachable);
+			for (size_t i = 0, n = ARR_LEN(unreachable); i < n; ++i)
+				find_unreachable_blocks(unreachable[i], &env);
+			ARR_SHRINKLEN(unreachable, 0);
+			clear_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_POSTDOMINANCE);
+		}
+		ARR_SHRINKLEN(env.removed_cf, 0);
+		env.recompute_cf = false;
 	}
-	deq_free(&waitq);
+	DEL_ARR_F(unreachable);
+	DEL_ARR_F(env.block_in);
+	DEL_ARR_F(env.removed_cf);
+	deq_free(&env.waitq);
+	stat_ev_int("optdf_rounds", rounds);
+	stat_ev_int("optdf_dom_blocks", env.dom_cost);
 	ir_free_resources(irg, IR_RESOURCE_IRN_LINK);
 
 	constbits_clear(irg);
@@ -1002,6 +1002,24 @@ static ir_tarval *computed_value_Proj(const ir_node *proj)
 	return tarval_unknown;
 }
 
+/**
+ * Returns true if @p n computes a vector value lane-wise. The algebraic rules
+ * only consider scalar modes, so these operations are just constant folded.
+ */
+static bool is_vector_operation(const ir_node *n)
+{
+	if (!mode_is_vector(get_irn_mode(n)))
+		return false;
+	switch (get_irn_opcode_(n)) {
+	case iro_Id:
+	case iro_Phi:
+	case iro_Proj:
+		return false;
+	default:
+		return true;
+	}
+}
+
 /**
  * If the parameter n can be computed, return its value, else tarval_unknown.
  * Performs constant folding.
@@ -1010,6 +1028,13 @@ static ir_tarval *computed_value_Proj(const ir_node *proj)
  */
 ir_tarval *computed_value(const ir_node *n)
 {
+	if (is_vector_operation(n)) {
+		foreach_irn_in(n, i, pred) {
+			if (!is_Const(pred) && get_irn_mode(pred) != mode_b)
+				return tarval_unknown;
+		}
+	}
+
 	const vrp_attr *vrp = vrp_get_info(n);
 	if (vrp != NULL && vrp->bits_set == vrp->bits_not_set)
 		return vrp->bits_set;
@@ -1754,7 +1779,7 @@ static ir_node *equivalent_node_Confirm(ir_node *n)
  */
 ir_node *equivalent_node(ir_node *n)
 {
-	if (n->op->ops.equivalent_node)
+	if (n->op->ops.equivalent_node && !is_vector_operation(n))
 		return n->op->ops.equivalent_node(n);
 	return n;
 }
@@ -7599,7 +7624,7 @@ restart:;
 	if (get_opt_algebraic_simplification() ||
 		(iro == iro_Cond) ||
 		(iro == iro_Proj)) {    /* Flags tested local. */
-		if (n->op->ops.transform_node != NULL) {
+		if (n->op->ops.transform_node != NULL && !is_vector_operation(n)) {
 			n = n->op->ops.transform_node(n);
 			if (n != old_n)
 				goto restart;
@@ -7699,23 +7724,12 @@ void ir_register_opt_node_ops(void)
  * in a graph. */
 #define N_IR_NODES 512
 
-static int identities_cmp(const void *elt, const void *key)
+/**
+ * Compares two nodes for CSE. The value table already made sure that both
+ * have the same opcode, mode and arity.
+ */
+static int identities_cmp(const ir_node *a, const ir_node *b)
 {
-	ir_node *a = (ir_node *)elt;
-	ir_node *b = (ir_node *)key;
-
-	if (a == b)
-		return 0;
-
-	if ((get_irn_op(a) != get_irn_op(b)) ||
-	    (get_irn_mode(a) != get_irn_mode(b)))
-	    return 1;
-
-	/* compare if a's in and b's in are of equal length */
-	int irn_arity_a = get_irn_arity(a);
-	if (irn_arity_a != get_irn_arity(b))
-		return 1;
-
 	/* blocks are never the same */
 	if (is_Block(a))
 		return 1;
@@ -7752,7 +7766,7 @@ static int identities_cmp(const void *elt, const void *key)
 	}
 
 	/* compare a->in[0..ins] with b->in[0..ins] */
-	for (int i = 0; i < irn_arity_a; ++i) {
+	for (int i = 0, irn_arity_a = get_irn_arity(a); i < irn_arity_a; ++i) {
 		ir_node *pred_a = get_irn_n(a, i);
 		ir_node *pred_b = get_irn_n(b, i);
 		if (pred_a != pred_b)
@@ -7772,13 +7786,13 @@ unsigned ir_node_hash(const ir_node *node)
 void new_identities(ir_graph *irg)
 {
 	del_identities(irg);
-	irg->value_table = new_pset(identities_cmp, N_IR_NODES);
+	irg->value_table = ir_identities_new(identities_cmp, N_IR_NODES);
 }
 
 void del_identities(ir_graph *irg)
 {
 	if (irg->value_table != NULL)
-		del_pset(irg->value_table);
+		ir_identities_del(irg->value_table);
 }
 
 static int cmp_node_nr(const void *a, const void *b)
@@ -7832,15 +7846,15 @@ void ir_normalize_node(ir_node *n)
 
 ir_node *identify_remember(ir_node *n)
 {
-	ir_graph *irg         = get_irn_irg(n);
-	pset     *value_table = irg->value_table;
+	ir_graph        *irg         = get_irn_irg(n);
+	ir_identities_t *value_table = irg->value_table;
 
 	if (value_table == NULL)
 		return n;
 
 	ir_normalize_node(n);
 	/* lookup or insert in hash table with given hash key. */
-	ir_node *nn = (ir_node *)pset_insert(value_table, n, ir_node_hash(n));
+	ir_node *nn = ir_identities_insert(value_table, n);
 
 	/* nn is reachable again */
 	if (nn != n)
@@ -7880,7 +7894,9 @@ void add_identities(ir_node *node)
 
 void visit_all_identities(ir_graph *irg, irg_walk_func visit, void *env)
 {
-	foreach_pset(irg->value_table, ir_node, node) {
+	if (irg->value_table == NULL)
+		return;
+	foreach_ir_identities(irg->value_table, node, iter) {
 		visit(node, env);
 	}
 }
@@ -11,6 +11,7 @@
  */
 #include "array.h"
 #include "debug.h"
+#include "irdom_t.h"
 #include "ircons.h"
 #include "iredges_t.h"
 #include "irgmod.h"
@@ -28,7 +29,7 @@
 
 #undef AVOID_PHIB
 
-DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+DEBUG_ONLY(static FIRM_THREAD_LOCAL firm_dbg_module_t *dbg;)
 
 /**
  * Add the new predecessor x to node node, which is either a Block or a Phi
@@ -44,8 +45,8 @@ static void add_pred(ir_node *node, ir_node *x)
 	set_irn_in(node, n + 1, ins);
 }
 
-static ir_node *ssa_second_def;
-static ir_node *ssa_second_def_block;
+static FIRM_THREAD_LOCAL ir_node *ssa_second_def;
+static FIRM_THREAD_LOCAL ir_node *ssa_second_def_block;
 
 static ir_node *search_def_and_create_phis(ir_node *block, ir_mode *mode,
                                            bool first)
@@ -199,6 +200,28 @@ static void split_critical_edge(ir_node *block, int pos)
 	set_Block_cfgpred(block, pos, new_jmp);
 }
 
+/** The changes of the control flow made by jump threading. */
+typedef struct jumpthreading_changes_t {
+	bool        changed;    /**< the graph was changed */
+	bool        threaded;   /**< jumps were threaded, so blocks were added */
+	dom_edge_t *removed_cf; /**< the removed control flow edges */
+} jumpthreading_changes_t;
+
+/**
+ * Records the removal of the control flow edges of @p jump.
+ */
+static void note_removed_jump(jumpthreading_changes_t *changes, ir_node *jump)
+{
+	ir_node *const block = get_nodes_block(jump);
+	foreach_out_edge(jump, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (!is_Block(user))
+			continue;
+		dom_edge_t const removed = { block, user };
+		ARR_APP1(dom_edge_t, changes->removed_cf, removed);
+	}
+}
+
 typedef struct jumpthreading_env_t {
 	ir_node      *true_block;  /**< Block we try to thread into */
 	ir_node      *cmp;         /**< The Compare node that might be partial
@@ -210,6 +233,7 @@ typedef struct jumpthreading_env_t {
 	ir_node      *cnst_pred;   /**< the block before the constant */
 	int           cnst_pos;    /**< the pos to the constant block (needed to
 	                                kill that edge later) */
+	jumpthreading_changes_t *changes;
 } jumpthreading_env_t;
 
 static ir_node *copy_and_fix_node(const jumpthreading_env_t *env,
@@ -411,6 +435,7 @@ static ir_node *find_const_or_confirm(jumpthreading_env_t *env, ir_node *jump,
 			if (evaluated == 0) {
 				ir_graph *irg = get_irn_irg(block);
 				ir_node  *bad = new_r_Bad(irg, mode_X);
+				note_removed_jump(env->changes, jump);
 				exchange(jump, bad);
 			} else if (evaluated == 1) {
 				dbg_info *dbgi = get_irn_dbg_info(skip_Proj(jump));
@@ -428,6 +453,7 @@ static ir_node *find_const_or_confirm(jumpthreading_env_t *env, ir_node *jump,
 			block, env->true_block));
 
 		/* adjust true_block to point directly towards our jump */
+		env->changes->threaded = true;
 		add_pred(env->true_block, jump);
 
 		split_critical_edge(env->true_block, 0);
@@ -481,6 +507,7 @@ static ir_node *find_candidate(jumpthreading_env_t *env, ir_node *jump,
 			block, env->true_block));
 
 		/* adjust true_block to point directly towards our jump */
+		env->changes->threaded = true;
 		add_pred(env->true_block, jump);
 
 		split_critical_edge(env->true_block, 0);
@@ -560,7 +587,7 @@ static ir_node *find_candidate(jumpthreading_env_t *env, ir_node *jump,
  */
 static void thread_jumps(ir_node* block, void* data)
 {
-	bool *changed = (bool*)data;
+	jumpthreading_changes_t *changes = (jumpthreading_changes_t*)data;
 
 	/* we do not deal with Phis, so restrict this to exactly one cfgpred */
 	if (get_Block_n_cfgpreds(block) != 1)
@@ -584,17 +611,25 @@ static void thread_jumps(ir_node* block, void* data)
 		ir_node    *const cond_block = get_nodes_block(cond);
 		ir_node    *const jmp        = new_r_Jmp(cond_block);
 		ir_node    *const bad        = new_r_Bad(irg, mode_X);
-		const bool        is_true    = tv == tarval_b_true;
-		ir_node *const in[] = {
-			[pn_Cond_false] = is_true ? bad : jmp,
-			[pn_Cond_true]  = is_true ? jmp : bad,
-		};
-		turn_into_tuple(cond, ARRAY_SIZE(in), in);
-		*changed = true;
+		unsigned    const taken      = tv == tarval_b_true
+		                               ? pn_Cond_true : pn_Cond_false;
+		/* replace the Projs directly, Tuples would hide the removed edge
+		 * from the dominance update */
+		foreach_out_edge_safe(cond, edge) {
+			ir_node *const proj = get_edge_src_irn(edge);
+			if (get_Proj_num(proj) == taken) {
+				exchange(proj, jmp);
+			} else {
+				note_removed_jump(changes, proj);
+				exchange(proj, bad);
+			}
+		}
+		changes->changed = true;
 		return;
 	}
 	inc_irg_visited(irg);
 	jumpthreading_env_t env;
+	env.changes    = changes;
 	env.cnst_pred  = NULL;
 	env.tv         = get_Proj_num(projx) == pn_Cond_false
 	                 ? tarval_b_false : tarval_b_true;
@@ -606,6 +641,8 @@ static void thread_jumps(ir_node* block, void* data)
 		return;
 
 	if (copy_block != get_nodes_block(cond)) {
+		changes->threaded = true;
+
 		/* We might thread the condition block of an infinite loop,
 		 * such that there is no path to End anymore. */
 		keep_alive(block);
@@ -630,7 +667,7 @@ static void thread_jumps(ir_node* block, void* data)
 	}
 
 	/* the graph is changed now */
-	*changed = true;
+	changes->changed = true;
 }
 
 void opt_jumpthreading(ir_graph* irg)
@@ -641,16 +678,24 @@ void opt_jumpthreading(ir_graph* irg)
 		| IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES);
 
 	FIRM_DBG_REGISTER(dbg, "firm.opt.jumpthreading");
+	bool const had_dominance
+		= irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
 
 	DB((dbg, LEVEL_1, "===> Performing jumpthreading on %+F\n", irg));
 
 	ir_reserve_resources(irg, IR_RESOURCE_IRN_LINK | IR_RESOURCE_IRN_VISITED);
 
+	jumpthreading_changes_t changes = {
+		.changed    = false,
+		.threaded   = false,
+		.removed_cf = NEW_ARR_F(dom_edge_t, 0),
+	};
 	bool changed = false;
 	bool rerun;
 	do {
-		rerun = false;
-		irg_block_walk_graph(irg, thread_jumps, NULL, &rerun);
+		changes.changed = false;
+		irg_block_walk_graph(irg, thread_jumps, NULL, &changes);
+		rerun    = changes.changed;
 		changed |= rerun;
 	} while (rerun);
 
@@ -659,8 +704,20 @@ void opt_jumpthreading(ir_graph* irg)
 	if (changed) {
 		/* we tend to produce a lot of duplicated keep edges, remove them */
 		remove_End_Bads_and_doublets(get_irg_end(irg));
-		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_NONE);
+
+		/* Folded conditions only remove edges, which the dominator tree
+		 * follows. Threaded jumps add blocks. */
+		ir_graph_properties_t props = IR_GRAPH_PROPERTIES_NONE;
+		if (had_dominance && !changes.threaded) {
+			ir_node **unreachable = NEW_ARR_F(ir_node*, 0);
+			dom_remove_edges(irg, changes.removed_cf,
+			                 ARR_LEN(changes.removed_cf), &unreachable);
+			DEL_ARR_F(unreachable);
+			props |= IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE;
+		}
+		confirm_irg_properties(irg, props);
 	} else {
 		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_ALL);
 	}
+	DEL_ARR_F(changes.removed_cf);
 }
@@ -0,0 +1,573 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2016 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Loop invariant code motion: hoists invariant computations and
+ *          Loads into the preheaders of loops.
+ *
+ * Loops are processed from the innermost outwards, so a value hoisted out of
+ * an inner loop may leave the enclosing loop, too. Floating nodes only need
+ * invariant operands. A Load additionally must not be affected by any write
+ * of the loop, which is checked with the memory disambiguator. As a hoisted
+ * Load is executed even if the loop is left before reaching it, it must not
+ * trap: Either it is marked as floating or its block is guarded by the loop
+ * exits, i.e. it dominates every block leaving the loop or ending an
+ * iteration.
+ */
+#include "array.h"
+#include "debug.h"
+#include "ircons.h"
+#include "irdom.h"
+#include "iredges_t.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irloop_t.h"
+#include "irmemory.h"
+#include "irnode_t.h"
+#include "irnodemap.h"
+#include "irnodeset.h"
+#include "iroptimize.h"
+#include "obst.h"
+#include "statev_t.h"
+#include "typerep.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+typedef struct licm_loop_t {
+	ir_loop  *loop;
+	ir_node  *header;    /**< the only block entered from outside */
+	ir_node  *preheader; /**< block to hoist into, created on demand */
+	ir_node **blocks;    /**< blocks of the loop including inner loops */
+	ir_node **nodes;     /**< nodes of the loop including inner loops */
+	ir_node **exits;     /**< blocks leaving the loop or ending an iteration */
+	ir_node **writes;    /**< Stores and CopyBs of the loop */
+	bool      memory_analyzed;
+	bool      unknown_writes; /**< memory is written by unknown operations */
+	bool      may_stop;       /**< a Call might not return */
+} licm_loop_t;
+
+typedef struct licm_env_t {
+	struct obstack obst;
+	licm_loop_t  **loops;
+	ir_nodeset_t   variant;    /**< nodes not hoistable out of the loop */
+	ir_nodemap     dom_block;  /**< new preheader -> its header */
+	unsigned       n_hoisted;
+	unsigned       n_loads;
+	bool           cf_changed;
+} licm_env_t;
+
+static licm_loop_t *get_licm_loop(ir_loop const *loop)
+{
+	return (licm_loop_t*)get_loop_link(loop);
+}
+
+/** Returns true if @p block belongs to @p loop or one of its inner loops. */
+static bool in_loop(ir_node const *block, ir_loop const *loop)
+{
+	ir_loop const *l = get_irn_loop(block);
+	if (l == NULL)
+		return false;
+	for (unsigned d = get_loop_depth(l), depth = get_loop_depth(loop);
+	     d > depth; --d) {
+		l = get_loop_outer_loop(l);
+	}
+	return l == loop;
+}
+
+static void create_loops(licm_env_t *env, ir_loop *loop)
+{
+	if (get_loop_depth(loop) > 0) {
+		licm_loop_t *const lp = OALLOCZ(&env->obst, licm_loop_t);
+		lp->loop   = loop;
+		lp->blocks = NEW_ARR_F(ir_node*, 0);
+		lp->nodes  = NEW_ARR_F(ir_node*, 0);
+		lp->exits  = NEW_ARR_F(ir_node*, 0);
+		lp->writes = NEW_ARR_F(ir_node*, 0);
+		set_loop_link(loop, lp);
+		ARR_APP1(licm_loop_t*, env->loops, lp);
+	}
+	for (size_t i = 0, n = get_loop_n_elements(loop); i < n; ++i) {
+		loop_element const elem = get_loop_element(loop, i);
+		if (*elem.kind == k_ir_loop)
+			create_loops(env, elem.son);
+	}
+}
+
+/** Adds @p node to the node or block lists of all loops containing it. */
+static void add_to_loops(ir_node *node, ir_loop *loop)
+{
+	for (; loop != NULL && get_loop_depth(loop) > 0;
+	     loop = get_loop_outer_loop(loop)) {
+		licm_loop_t *const lp = get_licm_loop(loop);
+		if (is_Block(node)) {
+			ARR_APP1(ir_node*, lp->blocks, node);
+		} else {
+			ARR_APP1(ir_node*, lp->nodes, node);
+		}
+	}
+}
+
+static void collect_node(ir_node *node, void *data)
+{
+	(void)data;
+	ir_node *const block = is_Block(node) ? node : get_nodes_block(node);
+	add_to_loops(node, get_irn_loop(block));
+}
+
+/** Finds the header of a loop, returns NULL if it has several. */
+static ir_node *find_header(licm_loop_t const *lp)
+{
+	ir_node *header = NULL;
+	for (size_t i = 0, n = ARR_LEN(lp->blocks); i < n; ++i) {
+		ir_node *const block = lp->blocks[i];
+		for (int p = 0, arity = get_Block_n_cfgpreds(block); p < arity; ++p) {
+			ir_node *const pred = get_Block_cfgpred_block(block, p);
+			if (pred != NULL && in_loop(pred, lp->loop))
+				continue;
+			if (header != NULL && header != block)
+				return NULL;
+			header = block;
+		}
+	}
+	return header;
+}
+
+/**
+ * Returns the preheader of a loop. If the header is not entered by a single
+ * Jmp, a new block collects all entries.
+ */
+static ir_node *get_preheader(licm_env_t *env, licm_loop_t *lp)
+{
+	if (lp->preheader != NULL)
+		return lp->preheader;
+
+	ir_node *const header  = lp->header;
+	int      const arity   = get_Block_n_cfgpreds(header);
+	ir_node      **entries = ALLOCAN(ir_node*, arity);
+	int            n       = 0;
+	int            first   = -1;
+	for (int i = 0; i < arity; ++i) {
+		if (in_loop(get_Block_cfgpred_block(header, i), lp->loop))
+			continue;
+		if (first < 0)
+			first = i;
+		entries[n++] = get_Block_cfgpred(header, i);
+	}
+	if (n == 1 && is_Jmp(entries[0])) {
+		lp->preheader = get_nodes_block(entries[0]);
+		return lp->preheader;
+	}
+
+	ir_graph *const irg       = get_irn_irg(header);
+	ir_node  *const preheader = new_r_Block(irg, n, entries);
+	ir_loop  *const outer     = get_loop_outer_loop(lp->loop);
+	set_irn_loop(preheader, outer);
+	add_to_loops(preheader, outer);
+	ir_nodemap_insert(&env->dom_block, preheader, header);
+
+	/* The preheader replaces the entries of the header and its Phis. */
+	ir_node **phis = NEW_ARR_F(ir_node*, 0);
+	foreach_out_edge(header, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (is_Phi(user))
+			ARR_APP1(ir_node*, phis, user);
+	}
+	ir_node **in = ALLOCAN(ir_node*, arity);
+	for (size_t p = 0, n_phis = ARR_LEN(phis); p < n_phis; ++p) {
+		ir_node *const phi = phis[p];
+		int            k   = 0;
+		for (int i = 0; i < arity; ++i) {
+			if (!in_loop(get_Block_cfgpred_block(header, i), lp->loop))
+				entries[k++] = get_Phi_pred(phi, i);
+		}
+		ir_node *const entry = n == 1 ? entries[0]
+		                     : new_r_Phi(preheader, n, entries, get_irn_mode(phi));
+		k = 0;
+		for (int i = 0; i < arity; ++i) {
+			if (i == first)
+				in[k++] = entry;
+			else if (in_loop(get_Block_cfgpred_block(header, i), lp->loop))
+				in[k++] = get_Phi_pred(phi, i);
+		}
+		set_irn_in(phi, k, in);
+	}
+	DEL_ARR_F(phis);
+
+	ir_node *const jmp = new_r_Jmp(preheader);
+	int            k   = 0;
+	for (int i = 0; i < arity; ++i) {
+		if (i == first)
+			in[k++] = jmp;
+		else if (in_loop(get_Block_cfgpred_block(header, i), lp->loop))
+			in[k++] = get_Block_cfgpred(header, i);
+	}
+	set_irn_in(header, k, in);
+
+	DB((dbg, LEVEL_2, "created preheader %+F of %+F\n", preheader, header));
+	env->cf_changed = true;
+	lp->preheader   = preheader;
+	return preheader;
+}
+
+/**
+ * Dominance query, which knows the preheaders created by this pass. A
+ * preheader dominates the same blocks as its header, besides itself.
+ */
+static bool dominates(licm_env_t *env, ir_node *a, ir_node *b)
+{
+	assert(ir_nodemap_get(ir_node, &env->dom_block, b) == NULL);
+	ir_node *const header = ir_nodemap_get(ir_node, &env->dom_block, a);
+	return block_dominates(header != NULL ? header : a, b);
+}
+
+static void analyze_exits(licm_loop_t *lp)
+{
+	if (ARR_LEN(lp->exits) > 0)
+		return;
+	for (size_t i = 0, n = ARR_LEN(lp->blocks); i < n; ++i) {
+		ir_node *const block = lp->blocks[i];
+		/* a block without successors ends the loop, too */
+		bool exit = true;
+		foreach_block_succ(block, edge) {
+			ir_node *const succ = get_edge_src_irn(edge);
+			exit = succ == lp->header || !in_loop(succ, lp->loop);
+			if (exit)
+				break;
+		}
+		if (exit)
+			ARR_APP1(ir_node*, lp->exits, block);
+	}
+}
+
+static void analyze_memory(licm_loop_t *lp)
+{
+	if (lp->memory_analyzed)
+		return;
+	lp->memory_analyzed = true;
+	for (size_t i = 0, n = ARR_LEN(lp->nodes); i < n; ++i) {
+		ir_node *const node = lp->nodes[i];
+		switch (get_irn_opcode(node)) {
+		case iro_Store:
+		case iro_CopyB:
+			ARR_APP1(ir_node*, lp->writes, node);
+			break;
+		case iro_Call: {
+			mtp_additional_properties const props
+				= get_method_additional_properties(get_Call_type(node));
+			if (!(props & (mtp_property_no_write | mtp_property_pure)))
+				lp->unknown_writes = true;
+			if (!(props & mtp_property_terminates))
+				lp->may_stop = true;
+			break;
+		}
+		case iro_Load:
+		case iro_Div:
+		case iro_Mod:
+		case iro_Phi:
+		case iro_Proj:
+		case iro_Sync:
+			break;
+		default:
+			if (get_irn_mode(node) == mode_M) {
+				lp->unknown_writes = true;
+				break;
+			}
+			foreach_irn_in(node, p, pred) {
+				if (get_irn_mode(pred) == mode_M)
+					lp->unknown_writes = true;
+			}
+			break;
+		}
+	}
+}
+
+/**
+ * Returns true if @p block is executed in every iteration, which reaches the
+ * end of the loop body or leaves the loop.
+ */
+static bool is_guarded_by_exits(licm_env_t *env, licm_loop_t *lp,
+                                ir_node *block)
+{
+	analyze_memory(lp);
+	if (lp->may_stop)
+		return false;
+	analyze_exits(lp);
+	for (size_t i = 0, n = ARR_LEN(lp->exits); i < n; ++i) {
+		if (!dominates(env, block, lp->exits[i]))
+			return false;
+	}
+	return true;
+}
+
+/** Returns true if a write of the loop may change the Load @p load. */
+static bool may_be_written(licm_loop_t *lp, ir_node const *load)
+{
+	analyze_memory(lp);
+	if (lp->unknown_writes)
+		return true;
+
+	ir_node const *const ptr  = get_Load_ptr(load);
+	ir_type const *const type = get_Load_type(load);
+	unsigned       const size = get_mode_size_bytes(get_Load_mode(load));
+	for (size_t i = 0, n = ARR_LEN(lp->writes); i < n; ++i) {
+		ir_node const    *const write = lp->writes[i];
+		ir_alias_relation       rel;
+		if (is_Store(write)) {
+			ir_node const *const value = get_Store_value(write);
+			rel = get_alias_relation(get_Store_ptr(write), get_Store_type(write),
+			                         get_mode_size_bytes(get_irn_mode(value)),
+			                         ptr, type, size);
+		} else {
+			ir_type const *const copy_type = get_CopyB_type(write);
+			rel = get_alias_relation(get_CopyB_dst(write), copy_type,
+			                         get_type_size(copy_type), ptr, type, size);
+		}
+		if (rel != ir_no_alias)
+			return true;
+	}
+	return false;
+}
+
+/**
+ * Returns the memory entering the loop, which the loop memory @p mem is
+ * equivalent to for a Load not affected by any write of the loop.
+ */
+static ir_node *get_entry_mem(licm_env_t *env, licm_loop_t *lp, ir_node *mem)
+{
+	while (in_loop(get_nodes_block(mem), lp->loop)) {
+		if (is_Phi(mem)) {
+			ir_node *const block = get_nodes_block(mem);
+			if (block != lp->header)
+				return NULL;
+			ir_node *const preheader = get_preheader(env, lp);
+			ir_node       *entry     = NULL;
+			for (int i = 0, n = get_Phi_n_preds(mem); i < n; ++i) {
+				if (get_Block_cfgpred_block(block, i) == preheader)
+					entry = get_Phi_pred(mem, i);
+			}
+			mem = entry;
+			if (mem == NULL)
+				return NULL;
+			continue;
+		}
+		if (!is_Proj(mem))
+			return NULL;
+
+		ir_node *const pred = get_Proj_pred(mem);
+		switch (get_irn_opcode(pred)) {
+		case iro_Load:  mem = get_Load_mem(pred);  break;
+		case iro_Store: mem = get_Store_mem(pred); break;
+		case iro_Call:  mem = get_Call_mem(pred);  break;
+		case iro_CopyB: mem = get_CopyB_mem(pred); break;
+		case iro_Div:   mem = get_Div_mem(pred);   break;
+		case iro_Mod:   mem = get_Mod_mem(pred);   break;
+		default:        return NULL;
+		}
+	}
+	return mem;
+}
+
+static bool is_invariant(licm_env_t *env, licm_loop_t *lp, ir_node *node);
+
+static bool hoist_load(licm_env_t *env, licm_loop_t *lp, ir_node *load)
+{
+	if (get_Load_volatility(load) == volatility_is_volatile)
+		return false;
+	ir_node *proj_m = NULL;
+	foreach_out_edge(load, edge) {
+		ir_node *const proj = get_edge_src_irn(edge);
+		if (get_irn_mode(proj) == mode_X)
+			return false;
+		if (get_Proj_num(proj) == pn_Load_M)
+			proj_m = proj;
+	}
+	if (get_irn_pinned(load) != op_pin_state_floats
+	    && !is_guarded_by_exits(env, lp, get_nodes_block(load)))
+		return false;
+	if (may_be_written(lp, load))
+		return false;
+	if (!is_invariant(env, lp, get_Load_ptr(load)))
+		return false;
+	ir_node *const mem = get_entry_mem(env, lp, get_Load_mem(load));
+	if (mem == NULL)
+		return false;
+
+	/* Take the Load out of the loop memory and put it in front of it. */
+	ir_node *const preheader = get_preheader(env, lp);
+	if (proj_m != NULL)
+		edges_reroute(proj_m, get_Load_mem(load));
+	else
+		proj_m = new_r_Proj(load, mode_M, pn_Load_M);
+	set_Load_mem(load, mem);
+	set_nodes_block(load, preheader);
+	foreach_out_edge(load, edge) {
+		set_nodes_block(get_edge_src_irn(edge), preheader);
+	}
+	foreach_out_edge_safe(mem, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (user == load || is_End(user) || is_Anchor(user))
+			continue;
+		int      const pos   = get_edge_src_pos(edge);
+		ir_node *const block = get_nodes_block(user);
+		if (is_Phi(user) && block == lp->header) {
+			if (get_Block_cfgpred_block(block, pos) == preheader)
+				set_irn_n(user, pos, proj_m);
+		} else if (in_loop(block, lp->loop)) {
+			set_irn_n(user, pos, proj_m);
+		}
+	}
+	++env->n_loads;
+	return true;
+}
+
+/** Floating nodes, which do not depend on memory, can be moved freely. */
+static bool is_hoistable(ir_node const *node)
+{
+	if (get_irn_pinned(node) != op_pin_state_floats || is_Phi(node))
+		return false;
+	ir_mode *const mode = get_irn_mode(node);
+	if (mode == mode_M || mode == mode_X)
+		return false;
+	foreach_irn_in(node, i, pred) {
+		if (get_irn_mode(pred) == mode_M)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Returns true if @p node is available in front of the loop, hoists it there
+ * if necessary.
+ */
+static bool is_invariant(licm_env_t *env, licm_loop_t *lp, ir_node *node)
+{
+	if (!in_loop(get_nodes_block(node), lp->loop))
+		return true;
+	if (ir_nodeset_contains(&env->variant, node))
+		return false;
+
+	bool invariant;
+	if (is_Proj(node)) {
+		ir_node *const pred = get_Proj_pred(node);
+		invariant = is_invariant(env, lp, pred);
+		if (invariant)
+			set_nodes_block(node, get_nodes_block(pred));
+	} else if (is_Load(node)) {
+		invariant = hoist_load(env, lp, node);
+	} else if (is_hoistable(node)) {
+		invariant = true;
+		foreach_irn_in(node, i, pred) {
+			if (!is_invariant(env, lp, pred)) {
+				invariant = false;
+				break;
+			}
+		}
+		if (invariant) {
+			set_nodes_block(node, get_preheader(env, lp));
+			++env->n_hoisted;
+		}
+	} else {
+		invariant = false;
+	}
+
+	if (invariant) {
+		DB((dbg, LEVEL_3, "hoisted %+F out of loop %ld\n", node,
+		    get_loop_loop_nr(lp->loop)));
+	} else {
+		ir_nodeset_insert(&env->variant, node);
+	}
+	return invariant;
+}
+
+static void optimize_loop(licm_env_t *env, licm_loop_t *lp)
+{
+	lp->header = find_header(lp);
+	if (lp->header == NULL)
+		return;
+
+	ir_nodeset_init(&env->variant);
+	for (size_t i = 0; i < ARR_LEN(lp->nodes); ++i) {
+		ir_node *const node = lp->nodes[i];
+		if (is_Load(node) || (is_hoistable(node) && !is_Proj(node)))
+			(void)is_invariant(env, lp, node);
+	}
+	ir_nodeset_destroy(&env->variant);
+}
+
+/** Processes inner loops before their outer loops. */
+static void optimize_loops(licm_env_t *env, ir_loop *loop)
+{
+	for (size_t i = 0, n = get_loop_n_elements(loop); i < n; ++i) {
+		loop_element const elem = get_loop_element(loop, i);
+		if (*elem.kind == k_ir_loop)
+			optimize_loops(env, elem.son);
+	}
+	if (get_loop_depth(loop) > 0)
+		optimize_loop(env, get_licm_loop(loop));
+}
+
+void do_loop_invariant_motion(ir_graph *irg)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.opt.licm");
+	assure_irg_properties(irg,
+		IR_GRAPH_PROPERTY_NO_BADS
+		| IR_GRAPH_PROPERTY_NO_TUPLES
+		| IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
+		| IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
+		| IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO
+		| IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+		| IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE);
+
+	licm_env_t env;
+	obstack_init(&env.obst);
+	env.loops      = NEW_ARR_F(licm_loop_t*, 0);
+	env.n_hoisted  = 0;
+	env.n_loads    = 0;
+	env.cf_changed = false;
+	ir_nodemap_init(&env.dom_block, irg);
+
+	ir_loop *const root = get_irg_loop(irg);
+	create_loops(&env, root);
+	irg_walk_graph(irg, NULL, collect_node, NULL);
+	optimize_loops(&env, root);
+
+	for (size_t i = 0, n = ARR_LEN(env.loops); i < n; ++i) {
+		licm_loop_t *const lp = env.loops[i];
+		DEL_ARR_F(lp->blocks);
+		DEL_ARR_F(lp->nodes);
+		DEL_ARR_F(lp->exits);
+		DEL_ARR_F(lp->writes);
+	}
+	DEL_ARR_F(env.loops);
+	ir_nodemap_destroy(&env.dom_block);
+	obstack_free(&env.obst, NULL);
+
+	stat_ev_int("licm_hoisted", env.n_hoisted);
+	stat_ev_int("licm_loads", env.n_loads);
+
+	/* Moving nodes keeps the control flow properties, but not the outs. The
+	 * preheaders change the control flow, too. */
+	ir_graph_properties_t props = IR_GRAPH_PROPERTIES_ALL;
+	if (env.n_hoisted + env.n_loads > 0) {
+		props = IR_GRAPH_PROPERTIES_CONTROL_FLOW
+		      | IR_GRAPH_PROPERTY_NO_BADS
+		      | IR_GRAPH_PROPERTY_NO_TUPLES
+		      | IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
+		      | IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE
+		      | IR_GRAPH_PROPERTY_MANY_RETURNS;
+	}
+	if (env.cf_changed) {
+		props = IR_GRAPH_PROPERTY_NO_BADS
+		      | IR_GRAPH_PROPERTY_NO_TUPLES
+		      | IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
+		      | IR_GRAPH_PROPERTY_NO_CRITICAL_EDGES
+		      | IR_GRAPH_PROPERTY_ONE_RETURN
+		      | IR_GRAPH_PROPERTY_MANY_RETURNS
+		      | IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
+		      | IR_GRAPH_PROPERTY_CONSISTENT_ENTITY_USAGE;
+	}
+	confirm_irg_properties(irg, props);
+}
@@ -11,6 +11,7 @@
  */
 
 #include "array.h"
+#include "bitfiddle.h"
 #include "debug.h"
 #include "irbackedge_t.h"
 #include "ircons_t.h"
@@ -20,13 +21,18 @@
 #include "irgopt.h"
 #include "irgwalk.h"
 #include "irloop_t.h"
+#include "irmemory.h"
 #include "irnode_t.h"
 #include "irnodemap.h"
+#include "irnodeset.h"
 #include "iroptimize.h"
 #include "irouts.h"
 #include "irtools.h"
 #include "opt_init.h"
 #include "panic.h"
+#include "target_t.h"
+#include "tv_t.h"
+#include "type_t.h"
 #include "util.h"
 #include <math.h>
 #include <stdbool.h>
@@ -89,6 +95,7 @@ typedef struct loop_stats_t {
 	unsigned u_simple_counting_loop;
 	unsigned constant_unroll;
 	unsigned invariant_unroll;
+	unsigned vectorized;
 
 	unsigned unhandled;
 } loop_stats_t;
@@ -114,6 +121,7 @@ static void print_stats(void)
 	DB((dbg, LEVEL_2, "u_simple_counting :   %d\n", stats.u_simple_counting_loop));
 	DB((dbg, LEVEL_2, "constant_unroll   :   %d\n", stats.constant_unroll));
 	DB((dbg, LEVEL_2, "invariant_unroll  :   %d\n", stats.invariant_unroll));
+	DB((dbg, LEVEL_2, "vectorized        :   %d\n", stats.vectorized));
 	DB((dbg, LEVEL_2, "=======================================\n"));
 }
 
@@ -188,7 +196,8 @@ static struct obstack obst;
 typedef enum loop_op_t {
 	loop_op_inversion,
 	loop_op_unrolling,
-	loop_op_peeling
+	loop_op_peeling,
+	loop_op_vectorization
 } loop_op_t;
 
 /* Returns the maximum nodes for the given nest depth */
@@ -1973,15 +1982,15 @@ static unsigned get_preferred_factor_constant(ir_tarval *const count_tar)
 
 /* Check if cur_loop is a simple counting loop.
  * Start, step and end are constants.
+ * Returns the number of loop passes or NULL.
  * TODO The whole constant case should use procedures similar to
  * the invariant case, as they are more versatile. */
-/* TODO split. */
-static unsigned get_unroll_decision_constant(void)
+static ir_tarval *get_constant_count(void)
 {
 	/* RETURN if loop is not 'simple' */
 	ir_node *const cmp = is_simple_loop();
 	if (cmp == NULL)
-		return 0;
+		return NULL;
 
 	/* One in of the loop condition needs to be loop invariant. => end_val
 	 * The other in is assigned by an add. => add
@@ -2000,7 +2009,7 @@ static unsigned get_unroll_decision_constant(void)
 
 	ir_node *iteration_path;
 	if (!get_const_pred(cmp, &loop_info.end_val, &iteration_path))
-		return 0;
+		return NULL;
 
 	DB((dbg, LEVEL_4, "End_val %N, other %N\n", loop_info.end_val, iteration_path));
 
@@ -2016,19 +2025,19 @@ static unsigned get_unroll_decision_constant(void)
 
 		/* Preds of the add should be step and the iteration_phi */
 		if (!get_const_pred(loop_info.add, &loop_info.step, &loop_info.iteration_phi))
-			return 0;
+			return NULL;
 
 		DB((dbg, LEVEL_4, "Got step %N\n", loop_info.step));
 
 		if (!is_Phi(loop_info.iteration_phi))
-			return 0;
+			return NULL;
 
 		DB((dbg, LEVEL_4, "Got phi %N\n", loop_info.iteration_phi));
 
 		/* Find start_val.
 		 * Does necessary sanity check of add, if it is already set.  */
 		if (!get_start_and_add(constant))
-			return 0;
+			return NULL;
 
 		DB((dbg, LEVEL_4, "Got start %N\n", loop_info.start_val));
 	} else if (is_Phi(iteration_path)) {
@@ -2041,32 +2050,32 @@ static unsigned get_unroll_decision_constant(void)
 		/* Find start_val and add-node.
 		 * Does necessary sanity check of add, if it is already set.  */
 		if (!get_start_and_add(constant))
-			return 0;
+			return NULL;
 
 		DB((dbg, LEVEL_4, "Got start %N\n", loop_info.start_val));
 		DB((dbg, LEVEL_4, "Got add or sub %N\n", loop_info.add));
 
 		ir_node *new_iteration_phi;
 		if (!get_const_pred(loop_info.add, &loop_info.step, &new_iteration_phi))
-			return 0;
+			return NULL;
 
 		DB((dbg, LEVEL_4, "Got step %N\n", loop_info.step));
 
 		if (loop_info.iteration_phi != new_iteration_phi)
-			return 0;
+			return NULL;
 	} else {
-		return 0;
+		return NULL;
 	}
 
 	DB((dbg, LEVEL_4, "start %N, end %N, step %N\n", loop_info.start_val, loop_info.end_val, loop_info.step));
 
 	ir_mode *const mode = get_irn_mode(loop_info.end_val);
 	if (mode != mode_Is && mode != mode_Iu)
-		return 0;
+		return NULL;
 
 	/* TODO necessary? */
 	if (!are_mode_I(loop_info.start_val, loop_info.step, loop_info.end_val))
-		return 0;
+		return NULL;
 
 	DB((dbg, LEVEL_4, "mode integer\n"));
 
@@ -2076,7 +2085,7 @@ static unsigned get_unroll_decision_constant(void)
 
 	if (tarval_is_null(step_tar))
 		/* TODO Might be worth a warning. */
-		return 0;
+		return NULL;
 
 	DB((dbg, LEVEL_4, "step is not 0\n"));
 
@@ -2096,7 +2105,7 @@ static unsigned get_unroll_decision_constant(void)
 	if (tarval_is_negative(count_tar)) {
 		DB((dbg, LEVEL_4, "Loop is endless or never taken."));
 		/* TODO Might be worth a warning. */
-		return 0;
+		return NULL;
 	}
 
 	++stats.u_simple_counting_loop;
@@ -2122,11 +2131,11 @@ static unsigned get_unroll_decision_constant(void)
 	/* Executed at most once (stay in counting loop if a Eq b) */
 	if (norm_relation == ir_relation_equal)
 		/* TODO Might be worth a warning. */
-		return 0;
+		return NULL;
 
 	/* calculates next values and increases count_tar according to it */
 	if (!simulate_next(&count_tar, stepped, step_tar, end_tar, norm_relation))
-		return 0;
+		return NULL;
 
 	/* We run loop once more, if we compare to the
 	 * not yet in-/decreased iv. */
@@ -2140,9 +2149,19 @@ static unsigned get_unroll_decision_constant(void)
 	/* Assure the loop is taken at least 1 time. */
 	if (tarval_is_null(count_tar)) {
 		/* TODO Might be worth a warning. */
-		return 0;
+		return NULL;
 	}
 
+	return count_tar;
+}
+
+/* Returns the unroll factor of a simple counting loop,
+ * whose start, step and end are constants. */
+static unsigned get_unroll_decision_constant(void)
+{
+	ir_tarval *const count_tar = get_constant_count();
+	if (count_tar == NULL)
+		return 0;
 	return get_preferred_factor_constant(count_tar);
 }
 
@@ -2223,6 +2242,463 @@ static void unroll_loop(ir_graph *const irg)
 	}
 }
 
+/* Vectorization */
+
+/* Cost function of the target, set by do_loop_vectorization_cb. */
+static arch_vector_cost_func vector_cost_func;
+
+/* Vector sizes in bits which are tried, the widest first. */
+static unsigned const vector_sizes[] = { 256, 128 };
+
+typedef struct vectorize_env_t {
+	ir_node    **nodes;        /* nodes of the loop */
+	ir_node    **memops;       /* Loads and Stores of the loop */
+	ir_node    **bases;        /* invariant base address of each memop */
+	ir_nodeset_t addresses;    /* address computations from the iv */
+	ir_nodeset_t values;       /* element values, Load results and operations */
+	unsigned     element_size; /* size of every accessed element [bytes] */
+} vectorize_env_t;
+
+static void collect_loop_nodes(ir_node *const node, void *const env)
+{
+	ir_node ***const nodes = (ir_node***)env;
+	if (!is_Block(node) && is_in_loop(node))
+		ARR_APP1(ir_node*, *nodes, node);
+}
+
+static bool is_vector_element_mode(ir_mode const *const mode)
+{
+	if (!mode_is_int(mode) && !mode_is_float(mode))
+		return false;
+	return get_mode_size_bits(mode) % 8 == 0
+	    && get_mode_arithmetic(mode) != irma_x86_extended_float;
+}
+
+static ir_mode *get_vector_mode(ir_mode *const element_mode, unsigned const n_lanes)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "V%u%s", n_lanes, get_mode_name(element_mode));
+	return new_vector_mode(name, element_mode, n_lanes);
+}
+
+static bool is_const_long(ir_node const *const node, long const value)
+{
+	if (!is_Const(node))
+		return false;
+	ir_tarval *const tv = get_Const_tarval(node);
+	return tarval_is_long(tv) && get_tarval_long(tv) == value;
+}
+
+/* Matches ptr = base + iv * element_size with a loop invariant base.
+ * Marks the nodes computing ptr as addresses.
+ * Returns the base or NULL. */
+static ir_node *match_vector_address(vectorize_env_t *const env, ir_node *const ptr)
+{
+	if (!is_Add(ptr) || !is_in_loop(ptr))
+		return NULL;
+
+	ir_node *base   = get_Add_left(ptr);
+	ir_node *offset = get_Add_right(ptr);
+	if (!mode_is_reference(get_irn_mode(base))) {
+		ir_node *const tmp = base;
+		base   = offset;
+		offset = tmp;
+	}
+	if (is_in_loop(base))
+		return NULL;
+
+	ir_node       *index = offset;
+	unsigned const size  = env->element_size;
+	if (size > 1) {
+		if (is_Mul(offset)) {
+			if (!is_const_long(get_Mul_right(offset), size))
+				return NULL;
+			index = get_Mul_left(offset);
+		} else if (is_Shl(offset)) {
+			if (!is_po2_or_zero(size)
+			 || !is_const_long(get_Shl_right(offset), log2_floor(size)))
+				return NULL;
+			index = get_Shl_left(offset);
+		} else {
+			return NULL;
+		}
+		ir_nodeset_insert(&env->addresses, offset);
+	}
+
+	/* The index may be widened to the mode of the address offset. */
+	if (is_Conv(index)) {
+		ir_node *const op = get_Conv_op(index);
+		if (!mode_is_int(get_irn_mode(index))
+		 || get_mode_size_bits(get_irn_mode(index)) <= get_mode_size_bits(get_irn_mode(op)))
+			return NULL;
+		ir_nodeset_insert(&env->addresses, index);
+		index = op;
+	}
+	if (index != loop_info.iteration_phi)
+		return NULL;
+
+	ir_nodeset_insert(&env->addresses, ptr);
+	return base;
+}
+
+/* Collects the memory operations and element values of the loop.
+ * Returns false if a node of the loop cannot be executed lane by lane. */
+static bool collect_vector_ops(vectorize_env_t *const env)
+{
+	ir_node *const cond = get_Proj_pred(loop_info.cf_out);
+	ir_node *const cmp  = get_Cond_selector(cond);
+
+	/* Memory operations first, they determine the element size. */
+	for (size_t i = 0, n = ARR_LEN(env->nodes); i < n; ++i) {
+		ir_node *const node = env->nodes[i];
+		ir_mode       *mode;
+		ir_node       *ptr;
+		ir_volatility  volatility;
+		switch (get_irn_opcode(node)) {
+		case iro_Load:
+			mode       = get_Load_mode(node);
+			ptr        = get_Load_ptr(node);
+			volatility = get_Load_volatility(node);
+			break;
+		case iro_Store:
+			mode       = get_irn_mode(get_Store_value(node));
+			ptr        = get_Store_ptr(node);
+			volatility = get_Store_volatility(node);
+			break;
+		case iro_Phi:
+			if (node != loop_info.iteration_phi && get_irn_mode(node) != mode_M)
+				return false;
+			continue;
+		case iro_Cmp:
+			if (node != cmp)
+				return false;
+			continue;
+		case iro_Cond:
+			if (node != cond)
+				return false;
+			continue;
+		case iro_Add:
+		case iro_And:
+		case iro_Conv:
+		case iro_Eor:
+		case iro_Jmp:
+		case iro_Minus:
+		case iro_Mul:
+		case iro_Not:
+		case iro_Or:
+		case iro_Proj:
+		case iro_Shl:
+		case iro_Sub:
+		case iro_Sync:
+			continue;
+		default:
+			DB((dbg, LEVEL_3, "%+F cannot be vectorized\n", node));
+			return false;
+		}
+
+		if (volatility != volatility_non_volatile || ir_throws_exception(node)
+		 || !is_vector_element_mode(mode))
+			return false;
+		unsigned const size = get_mode_size_bytes(mode);
+		if (env->element_size == 0)
+			env->element_size = size;
+		else if (env->element_size != size)
+			return false;
+
+		ir_node *const base = match_vector_address(env, ptr);
+		if (base == NULL) {
+			DB((dbg, LEVEL_3, "address of %+F does not follow the iv\n", node));
+			return false;
+		}
+		ARR_APP1(ir_node*, env->memops, node);
+		ARR_APP1(ir_node*, env->bases, base);
+
+		if (is_Load(node)) {
+			foreach_out_edge(node, edge) {
+				ir_node *const proj = get_edge_src_irn(edge);
+				if (get_Proj_num(proj) == pn_Load_res)
+					ir_nodeset_insert(&env->values, proj);
+			}
+		}
+	}
+	if (ARR_LEN(env->memops) == 0)
+		return false;
+
+	/* The remaining computations are element values. */
+	for (size_t i = 0, n = ARR_LEN(env->nodes); i < n; ++i) {
+		ir_node *const node = env->nodes[i];
+		switch (get_irn_opcode(node)) {
+		case iro_Add:
+		case iro_And:
+		case iro_Eor:
+		case iro_Minus:
+		case iro_Mul:
+		case iro_Not:
+		case iro_Or:
+		case iro_Sub: {
+			if (node == loop_info.add || ir_nodeset_contains(&env->addresses, node))
+				continue;
+			ir_mode *const mode = get_irn_mode(node);
+			if (!is_vector_element_mode(mode) || get_mode_size_bytes(mode) != env->element_size)
+				return false;
+			ir_nodeset_insert(&env->values, node);
+			continue;
+		}
+		case iro_Conv:
+		case iro_Shl:
+			if (!ir_nodeset_contains(&env->addresses, node))
+				return false;
+			continue;
+		default:
+			continue;
+		}
+	}
+	return true;
+}
+
+/* Returns true if every user of node is in the loop and accepted by the
+ * vectorized loop. */
+static bool has_vector_users(vectorize_env_t const *const env, ir_node const *const node)
+{
+	bool const is_value = ir_nodeset_contains(&env->values, node);
+	foreach_out_edge(node, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		int      const pos  = get_edge_src_pos(edge);
+		if (is_value) {
+			if (ir_nodeset_contains(&env->values, user))
+				continue;
+			if (is_Store(user) && pos == n_Store_value)
+				continue;
+		} else {
+			if (ir_nodeset_contains(&env->addresses, user))
+				continue;
+			if ((is_Load(user) && pos == n_Load_ptr)
+			 || (is_Store(user) && pos == n_Store_ptr))
+				continue;
+		}
+		DB((dbg, LEVEL_3, "%+F has the unexpected user %+F\n", node, user));
+		return false;
+	}
+	return true;
+}
+
+/* Checks that the loop computes every lane on its own.
+ * Values flow from Loads or constants to Stores only
+ * and do not leave the loop. */
+static bool check_vector_dataflow(vectorize_env_t const *const env)
+{
+	foreach_ir_nodeset(&env->values, node, iter) {
+		if (!is_Proj(node)) {
+			foreach_irn_in(node, i, op) {
+				if (!ir_nodeset_contains(&env->values, op) && !is_Const(op))
+					return false;
+			}
+		}
+		if (!has_vector_users(env, node))
+			return false;
+	}
+	foreach_ir_nodeset(&env->addresses, node, iter) {
+		if (!has_vector_users(env, node))
+			return false;
+	}
+	for (size_t i = 0, n = ARR_LEN(env->memops); i < n; ++i) {
+		ir_node *const memop = env->memops[i];
+		if (!is_Store(memop))
+			continue;
+		ir_node *const value = get_Store_value(memop);
+		if (!ir_nodeset_contains(&env->values, value) && !is_Const(value))
+			return false;
+	}
+
+	/* The iv Phi lags one iteration behind the iv Add, so its value after
+	 * the last iteration changes. The value of the Add does not. */
+	foreach_out_edge(loop_info.iteration_phi, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (user != loop_info.add && !ir_nodeset_contains(&env->addresses, user))
+			return false;
+	}
+	ir_node *const cmp = get_Cond_selector(get_Proj_pred(loop_info.cf_out));
+	foreach_out_edge(loop_info.add, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (user != loop_info.iteration_phi && user != cmp && is_in_loop(user))
+			return false;
+	}
+	return true;
+}
+
+/* Checks that no Store of the loop writes memory, which another memory
+ * operation of the loop accesses through a different base address.
+ * Memory operations on the same base access the same element in each
+ * iteration, so they keep their order lane by lane. */
+static bool check_vector_memory(vectorize_env_t const *const env, ir_tarval *const count)
+{
+	ir_tarval *const start_tar = get_Const_tarval(loop_info.start_val);
+	ir_tarval *const end_tar   = tarval_add(start_tar, count);
+	if (tarval_is_negative(start_tar) || !tarval_is_long(end_tar))
+		return false;
+	long const range = get_tarval_long(end_tar) * (long)env->element_size;
+
+	for (size_t i = 0, n = ARR_LEN(env->memops); i < n; ++i) {
+		ir_node *const store = env->memops[i];
+		if (!is_Store(store))
+			continue;
+		for (size_t k = 0; k < n; ++k) {
+			ir_node *const other = env->memops[k];
+			if (env->bases[k] == env->bases[i])
+				continue;
+			ir_type *const other_type = is_Load(other) ? get_Load_type(other)
+			                                           : get_Store_type(other);
+			ir_alias_relation const rel = get_alias_relation(
+				env->bases[i], get_Store_type(store), range,
+				env->bases[k], other_type, range);
+			if (rel != ir_no_alias) {
+				DB((dbg, LEVEL_3, "%+F may alias %+F\n", store, other));
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+static ir_mode *get_memop_mode(ir_node const *const node)
+{
+	return is_Load(node) ? get_Load_mode(node)
+	                     : get_irn_mode(get_Store_value(node));
+}
+
+/* Returns true if the target executes the loop with n_lanes lanes cheaper
+ * than the scalar loop. */
+static bool is_vectorization_profitable(vectorize_env_t const *const env, unsigned const n_lanes)
+{
+	int cost     = 0;
+	int n_scalar = 0;
+	for (size_t i = 0, n = ARR_LEN(env->memops); i < n; ++i) {
+		ir_node *const memop = env->memops[i];
+		int      const c     = vector_cost_func(memop, get_vector_mode(get_memop_mode(memop), n_lanes));
+		if (c < 0)
+			return false;
+		cost += c;
+		++n_scalar;
+	}
+	foreach_ir_nodeset(&env->values, node, iter) {
+		if (is_Proj(node))
+			continue;
+		int const c = vector_cost_func(node, get_vector_mode(get_irn_mode(node), n_lanes));
+		if (c < 0)
+			return false;
+		cost += c;
+		++n_scalar;
+	}
+	DB((dbg, LEVEL_3, "%u lanes cost %d, scalar cost %d\n", n_lanes, cost, n_scalar * (int)n_lanes));
+	return cost < n_scalar * (int)n_lanes;
+}
+
+static ir_node *new_splat_Const(ir_graph *const irg, ir_node *const c, ir_mode *const mode)
+{
+	unsigned    const n_lanes = get_mode_vector_n_lanes(mode);
+	ir_tarval **const tvs     = ALLOCAN(ir_tarval*, n_lanes);
+	for (unsigned i = 0; i < n_lanes; ++i)
+		tvs[i] = get_Const_tarval(c);
+	return new_r_Const(irg, new_tarval_from_lanes(mode, tvs));
+}
+
+/* Replaces the scalar constant operands of node by splats. */
+static void splat_const_operands(ir_node *const node, ir_mode *const mode)
+{
+	ir_graph *const irg = get_irn_irg(node);
+	foreach_irn_in(node, i, op) {
+		if (is_Const(op) && !mode_is_vector(get_irn_mode(op)))
+			set_irn_n(node, i, new_splat_Const(irg, op, mode));
+	}
+}
+
+/* Turns the loop into a loop processing n_lanes iterations at once. */
+static void vectorize_loop_nodes(vectorize_env_t const *const env, unsigned const n_lanes)
+{
+	foreach_ir_nodeset(&env->values, node, iter) {
+		ir_mode *const mode = get_vector_mode(get_irn_mode(node), n_lanes);
+		if (!is_Proj(node))
+			splat_const_operands(node, mode);
+		set_irn_mode(node, mode);
+	}
+
+	for (size_t i = 0, n = ARR_LEN(env->memops); i < n; ++i) {
+		ir_node *const memop = env->memops[i];
+		if (is_Load(memop)) {
+			ir_mode *const mode = get_vector_mode(get_Load_mode(memop), n_lanes);
+			set_Load_mode(memop, mode);
+			set_Load_type(memop, new_type_array(get_Load_type(memop), n_lanes));
+			set_Load_unaligned(memop, align_non_aligned);
+		} else {
+			ir_node *const value = get_Store_value(memop);
+			if (is_Const(value)) {
+				ir_mode *const mode = get_vector_mode(get_irn_mode(value), n_lanes);
+				set_Store_value(memop, new_splat_Const(get_irn_irg(memop), value, mode));
+			}
+			set_Store_type(memop, new_type_array(get_Store_type(memop), n_lanes));
+			set_Store_unaligned(memop, align_non_aligned);
+		}
+	}
+
+	ir_node *const add  = loop_info.add;
+	ir_node *const step = new_r_Const_long(get_irn_irg(add), get_irn_mode(add), n_lanes);
+	if (get_Add_left(add) == loop_info.step)
+		set_Add_left(add, step);
+	else
+		set_Add_right(add, step);
+}
+
+/* Loop vectorization
+ * Executes several iterations of a simple counting loop at once,
+ * if every iteration only accesses the elements indexed by the iv. */
+static void vectorize_loop(ir_graph *const irg)
+{
+	if (loop_info.calls > 0)
+		return;
+
+	ir_tarval *const count = get_constant_count();
+	if (count == NULL)
+		return;
+	if (!is_Add(loop_info.add) || !loop_info.latest_value
+	 || !is_Const(loop_info.start_val) || !is_const_long(loop_info.step, 1))
+		return;
+
+	vectorize_env_t env;
+	memset(&env, 0, sizeof(env));
+	env.nodes  = NEW_ARR_F(ir_node*, 0);
+	env.memops = NEW_ARR_F(ir_node*, 0);
+	env.bases  = NEW_ARR_F(ir_node*, 0);
+	ir_nodeset_init(&env.addresses);
+	ir_nodeset_init(&env.values);
+	irg_walk_graph(irg, collect_loop_nodes, NULL, &env.nodes);
+
+	if (collect_vector_ops(&env) && check_vector_dataflow(&env)
+	 && check_vector_memory(&env, count)) {
+		unsigned const bits = env.element_size * 8;
+		for (size_t s = 0; s < ARRAY_SIZE(vector_sizes); ++s) {
+			unsigned const n_lanes = vector_sizes[s] / bits;
+			if (n_lanes < 2)
+				continue;
+			ir_tarval *const lanes_tv = new_tarval_from_long(n_lanes, get_tarval_mode(count));
+			if (!tarval_is_null(tarval_mod(count, lanes_tv)))
+				continue;
+			if (!is_vectorization_profitable(&env, n_lanes))
+				continue;
+
+			DB((dbg, LEVEL_2, " *** Vectorizing with %u lanes ***\n", n_lanes));
+			vectorize_loop_nodes(&env, n_lanes);
+			++stats.vectorized;
+			break;
+		}
+	}
+
+	ir_nodeset_destroy(&env.values);
+	ir_nodeset_destroy(&env.addresses);
+	DEL_ARR_F(env.bases);
+	DEL_ARR_F(env.memops);
+	DEL_ARR_F(env.nodes);
+}
+
 /* Analyzes the loop, and checks if size is within allowed range.
  * Decides if loop will be processed. */
 static void init_analyze(ir_graph *const irg, ir_loop *const loop, loop_op_t const loop_op)
@@ -2254,8 +2730,9 @@ static void init_analyze(ir_graph *const irg, ir_loop *const loop, loop_op_t con
 	}
 
 	switch (loop_op) {
-		case loop_op_inversion: loop_inversion(irg); break;
-		case loop_op_unrolling: unroll_loop(irg);    break;
+		case loop_op_inversion:     loop_inversion(irg); break;
+		case loop_op_unrolling:     unroll_loop(irg);    break;
+		case loop_op_vectorization: vectorize_loop(irg); break;
 		default: panic("loop optimization not implemented");
 	}
 	DB((dbg, LEVEL_1, "       <<<< end of loop with node %ld >>>>\n", get_loop_loop_nr(loop)));
@@ -2371,6 +2848,21 @@ void do_loop_peeling(ir_graph *const irg)
 	loop_optimization(irg, loop_op_peeling);
 }
 
+void do_loop_vectorization_cb(ir_graph *const irg, arch_vector_cost_func const cost_func)
+{
+	if (cost_func == NULL) {
+		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_ALL);
+		return;
+	}
+	vector_cost_func = cost_func;
+	loop_optimization(irg, loop_op_vectorization);
+}
+
+void do_loop_vectorization(ir_graph *const irg)
+{
+	do_loop_vectorization_cb(irg, ir_target.vector_cost);
+}
+
 void firm_init_loop_opt(void)
 {
 	FIRM_DBG_REGISTER(dbg, "firm.opt.loop");
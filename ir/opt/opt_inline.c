@@ -34,6 +34,7 @@
 #include "irtools.h"
 #include "list.h"
 #include "opt_init.h"
+#include "passmanager_t.h"
 #include "pmap.h"
 #include "pqueue.h"
 #include "xmalloc.h"
@@ -646,6 +647,7 @@ typedef struct {
 	unsigned  n_call_nodes_orig; /**< for statistics */
 	unsigned  n_callers;         /**< Number of known graphs that call this graphs. */
 	unsigned  n_callers_orig;    /**< for statistics */
+	unsigned  level;             /**< Level in the callgraph, callees have lower levels. */
 	unsigned  got_inline:1;      /**< Set, if at least one call inside this graph was inlined. */
 	unsigned  recursive:1;       /**< Set, if this function is self recursive. */
 } inline_irg_env;
@@ -665,6 +667,7 @@ static inline_irg_env *alloc_inline_irg_env(void)
 	env->n_call_nodes_orig = 0;
 	env->n_callers         = 0;
 	env->n_callers_orig    = 0;
+	env->level             = UINT_MAX;
 	env->got_inline        = 0;
 	env->recursive         = 0;
 	return env;
@@ -1232,12 +1235,87 @@ static void inline_into(ir_graph *irg, unsigned maxsize,
 	del_pqueue(pqueue);
 }
 
+/**
+ * Recollects the calls and the size of a graph after it was optimized, so
+ * its callers see the optimized body.
+ */
+static void recollect_calls(ir_graph *irg)
+{
+	inline_irg_env *env               = (inline_irg_env*)get_irg_link(irg);
+	unsigned        n_nodes_orig      = env->n_nodes_orig;
+	unsigned        n_call_nodes_orig = env->n_call_nodes_orig;
+
+	INIT_LIST_HEAD(&env->calls);
+	env->local_weights = NULL;
+	env->n_nodes       = 0;
+	env->n_blocks      = -1; /* do not count count End Block */
+	env->n_call_nodes  = 0;
+	env->recursive     = 0;
+
+	current_ir_graph = irg;
+	assure_loopinfo(irg);
+	wenv_t wenv = { .x = env, .ignore_callers = true };
+	irg_walk_graph(irg, NULL, collect_calls2, &wenv);
+
+	env->n_nodes_orig      = n_nodes_orig;
+	env->n_call_nodes_orig = n_call_nodes_orig;
+}
+
+/**
+ * Sorts the graphs by their level in the callgraph. A graph gets the level
+ * above its highest callee, so all graphs of a level only inline graphs of
+ * lower levels. Calls to graphs later in @p irgs close a recursion and are
+ * ignored. The order of @p irgs is kept within a level.
+ *
+ * @param irgs    the graphs, callees first
+ * @param n_irgs  the number of graphs
+ */
+static void sort_irgs_by_level(ir_graph **irgs, size_t n_irgs)
+{
+	unsigned n_levels = 0;
+	for (size_t i = 0; i < n_irgs; ++i) {
+		inline_irg_env *env   = (inline_irg_env*)get_irg_link(irgs[i]);
+		unsigned        level = 0;
+		list_for_each_entry(call_entry, entry, &env->calls, list) {
+			inline_irg_env *callee_env
+				= (inline_irg_env*)get_irg_link(entry->callee);
+			if (callee_env->level != UINT_MAX)
+				level = MAX(level, callee_env->level + 1);
+		}
+		env->level = level;
+		n_levels   = MAX(n_levels, level + 1);
+	}
+
+	/* counting sort, which is stable */
+	size_t *begin = XMALLOCNZ(size_t, n_levels + 1);
+	for (size_t i = 0; i < n_irgs; ++i) {
+		inline_irg_env *env = (inline_irg_env*)get_irg_link(irgs[i]);
+		++begin[env->level + 1];
+	}
+	for (unsigned l = 0; l < n_levels; ++l)
+		begin[l + 1] += begin[l];
+	ir_graph **sorted = XMALLOCN(ir_graph*, n_irgs);
+	for (size_t i = 0; i < n_irgs; ++i) {
+		inline_irg_env *env = (inline_irg_env*)get_irg_link(irgs[i]);
+		sorted[begin[env->level]++] = irgs[i];
+	}
+	MEMCPY(irgs, sorted, n_irgs);
+	free(sorted);
+	free(begin);
+}
+
 /*
  * Heuristic inliner. Calculates a benefice value for every call and inlines
  * those calls with a value higher than the threshold.
  */
 void inline_functions(unsigned maxsize, int inline_threshold,
                       opt_ptr after_inline_opt)
+{
+	inline_functions_parallel(maxsize, inline_threshold, after_inline_opt, 1);
+}
+
+void inline_functions_parallel(unsigned maxsize, int inline_threshold,
+                               opt_ptr after_inline_opt, unsigned n_threads)
 {
 	ir_graph *rem = current_ir_graph;
 	obstack_init(&temp_obst);
@@ -1265,20 +1343,39 @@ void inline_functions(unsigned maxsize, int inline_threshold,
 		irg_walk_graph(irg, NULL, collect_calls2, &wenv);
 	}
 
-	/* -- and now inline. -- */
-	for (size_t i = 0; i < n_irgs; ++i) {
-		ir_graph *irg = irgs[i];
-		inline_into(irg, maxsize, inline_threshold, copied_graphs);
+	/* -- and now inline, level by level. -- */
+	sort_irgs_by_level(irgs, n_irgs);
+	ir_graph **inlined = XMALLOCN(ir_graph*, n_irgs);
+	for (size_t begin = 0, end; begin < n_irgs; begin = end) {
+		inline_irg_env *begin_env = (inline_irg_env*)get_irg_link(irgs[begin]);
+		size_t          n_inlined = 0;
+		for (end = begin; end < n_irgs; ++end) {
+			ir_graph       *irg = irgs[end];
+			inline_irg_env *env = (inline_irg_env*)get_irg_link(irg);
+			if (env->level != begin_env->level)
+				break;
+			/* inlining creates entities and copies graphs, so it stays in
+			 * this thread */
+			inline_into(irg, maxsize, inline_threshold, copied_graphs);
+			if (env->got_inline)
+				inlined[n_inlined++] = irg;
+		}
+		if (after_inline_opt == NULL)
+			continue;
+
+		/* Optimizing a graph only touches the graph itself, so the graphs
+		 * of a level are optimized concurrently.  Recollecting their calls
+		 * lets the callers on the next levels inline the optimized graphs. */
+		run_irgs_parallel(after_inline_opt, inlined, n_inlined, n_threads);
+		for (size_t i = 0; i < n_inlined; ++i)
+			recollect_calls(inlined[i]);
 	}
+	free(inlined);
 
 	for (size_t i = 0; i < n_irgs; ++i) {
 		ir_graph *irg = irgs[i];
 
 		inline_irg_env *env = (inline_irg_env*)get_irg_link(irg);
-		if (env->got_inline && after_inline_opt != NULL) {
-			/* this irg got calls inlined: optimize it */
-			after_inline_opt(irg);
-		}
 		if (env->got_inline || (env->n_callers_orig != env->n_callers)) {
 			DB((dbg, LEVEL_1, "Nodes:%3d ->%3d, calls:%3d ->%3d, callers:%3d ->%3d, -- %s\n",
 			env->n_nodes_orig, env->n_nodes, env->n_call_nodes_orig, env->n_call_nodes,
@@ -37,7 +37,7 @@
 #include <stdbool.h>
 
 /** The debug handle. */
-DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+DEBUG_ONLY(static FIRM_THREAD_LOCAL firm_dbg_module_t *dbg;)
 
 /** A scc. */
 typedef struct scc {
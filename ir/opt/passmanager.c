@@ -0,0 +1,466 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2016 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Pass manager with analysis caching and per pass statistics.
+ *
+ * The analyses are the graph properties, so caching them only means not to
+ * confirm more than a pass preserved. Consecutive graph passes are grouped,
+ * so a graph runs through the whole group before the next graph is touched.
+ * With FIRM_THREADS such a group may run on several graphs concurrently: a
+ * pool of workers takes the graphs one by one from a shared index.
+ */
+#include "array.h"
+#include "irgraph_t.h"
+#include "iroptimize.h"
+#include "irprog_t.h"
+#include "lock.h"
+#include "passmanager_t.h"
+#include "obst.h"
+#include "statev_t.h"
+#include "timing.h"
+#include "util.h"
+#include "xmalloc.h"
+
+#ifdef FIRM_THREADS
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+#endif
+
+typedef struct ir_pass_t {
+	char                 *name;
+	ir_graph_pass_func    graph_func; /**< NULL for program passes */
+	ir_prog_pass_func     prog_func;  /**< NULL for graph passes */
+	ir_graph_properties_t required;
+	ir_graph_properties_t preserved;
+	unsigned long         time_usec;     /**< time spent in the pass */
+	unsigned long         analysis_usec; /**< time spent assuring analyses */
+	unsigned              runs;
+	unsigned              n_analyses;     /**< number of analyses computed */
+	size_t                memory;         /**< bytes allocated on graphs */
+} ir_pass_t;
+
+/** The statistics of a single run of a pass. */
+typedef struct pass_run_t {
+	unsigned long time_usec;
+	unsigned long analysis_usec;
+	unsigned      n_analyses;
+	size_t        memory;
+} pass_run_t;
+
+struct ir_pass_manager_t {
+	char       *name;
+	ir_pass_t  *passes;    /**< flexible array of the pipeline */
+	unsigned    n_threads; /**< number of workers for graph passes */
+	firm_lock_t lock;      /**< protects the statistics of the passes */
+};
+
+ir_pass_manager_t *new_ir_pass_manager(char const *name)
+{
+	ir_pass_manager_t *const mgr = XMALLOC(ir_pass_manager_t);
+	mgr->name      = xstrdup(name);
+	mgr->passes    = NEW_ARR_F(ir_pass_t, 0);
+	mgr->n_threads = 1;
+	mgr->lock      = (firm_lock_t)FIRM_LOCK_INIT;
+	return mgr;
+}
+
+void free_ir_pass_manager(ir_pass_manager_t *mgr)
+{
+	for (size_t i = 0, n = ARR_LEN(mgr->passes); i < n; ++i) {
+		free(mgr->passes[i].name);
+	}
+	DEL_ARR_F(mgr->passes);
+	free(mgr->name);
+	free(mgr);
+}
+
+static void add_pass(ir_pass_manager_t *mgr, char const *name,
+                     ir_graph_pass_func graph_func, ir_prog_pass_func prog_func,
+                     ir_graph_properties_t required,
+                     ir_graph_properties_t preserved)
+{
+	ir_pass_t const pass = {
+		.name           = xstrdup(name),
+		.graph_func     = graph_func,
+		.prog_func      = prog_func,
+		.required       = required,
+		.preserved      = preserved,
+	};
+	ARR_APP1(ir_pass_t, mgr->passes, pass);
+}
+
+void ir_pass_manager_add_graph_pass(ir_pass_manager_t *mgr, char const *name,
+                                    ir_graph_pass_func func,
+                                    ir_graph_properties_t required,
+                                    ir_graph_properties_t preserved)
+{
+	add_pass(mgr, name, func, NULL, required, preserved);
+}
+
+void ir_pass_manager_add_prog_pass(ir_pass_manager_t *mgr, char const *name,
+                                   ir_prog_pass_func func,
+                                   ir_graph_properties_t required,
+                                   ir_graph_properties_t preserved)
+{
+	add_pass(mgr, name, NULL, func, required, preserved);
+}
+
+void ir_pass_manager_set_n_threads(ir_pass_manager_t *mgr, unsigned n_threads)
+{
+	assert(n_threads > 0);
+	mgr->n_threads = n_threads;
+}
+
+static unsigned count_missing(ir_graph const *irg, ir_graph_properties_t props)
+{
+	unsigned missing = props & ~irg->properties;
+	unsigned n       = 0;
+	for (; missing != 0; missing &= missing - 1)
+		++n;
+	return n;
+}
+
+static size_t get_irg_memory(ir_graph *irg)
+{
+	return obstack_memory_used(&irg->obst);
+}
+
+static size_t get_irp_memory(void)
+{
+	size_t memory = 0;
+	foreach_irp_irg(i, irg) {
+		memory += get_irg_memory(irg);
+	}
+	return memory;
+}
+
+/** Assures the required properties of @p pass on @p irg. */
+static unsigned assure_pass_analyses(ir_pass_t const *pass, ir_graph *irg)
+{
+	unsigned const n_missing = count_missing(irg, pass->required);
+	if (n_missing != 0)
+		assure_irg_properties(irg, pass->required);
+	return n_missing;
+}
+
+/** Invalidates all properties @p pass did not preserve on @p irg. */
+static void confirm_pass_analyses(ir_pass_t const *pass, ir_graph *irg)
+{
+	confirm_irg_properties(irg, irg->properties & pass->preserved);
+}
+
+/**
+ * Adds a run of @p pass to its statistics. Statistic events are only
+ * reported if @p events is set, as their context is not thread safe.
+ */
+static void report_run(ir_pass_manager_t *mgr, ir_pass_t *pass,
+                       pass_run_t const *run, bool events)
+{
+	firm_lock(&mgr->lock);
+	pass->runs          += 1;
+	pass->time_usec     += run->time_usec;
+	pass->analysis_usec += run->analysis_usec;
+	pass->n_analyses    += run->n_analyses;
+	pass->memory        += run->memory;
+	firm_unlock(&mgr->lock);
+	if (events) {
+		stat_ev_dbl("pass_time", run->time_usec);
+		stat_ev_int("pass_analyses", run->n_analyses);
+		stat_ev_ull("pass_memory", run->memory);
+	}
+}
+
+static unsigned long stop_timer(ir_timer_t *timer)
+{
+	ir_timer_stop(timer);
+	return ir_timer_elapsed_usec(timer);
+}
+
+static void run_graph_pass(ir_pass_manager_t *mgr, ir_pass_t *pass,
+                           ir_graph *irg, ir_timer_t *timer, bool events)
+{
+	if (events)
+		stat_ev_ctx_push_str("pass", pass->name);
+	pass_run_t run;
+
+	ir_timer_reset_and_start(timer);
+	run.n_analyses    = assure_pass_analyses(pass, irg);
+	run.analysis_usec = stop_timer(timer);
+
+	size_t const memory_before = get_irg_memory(irg);
+	ir_timer_reset_and_start(timer);
+	pass->graph_func(irg);
+	run.time_usec = stop_timer(timer);
+	size_t const memory_after = get_irg_memory(irg);
+
+	confirm_pass_analyses(pass, irg);
+	run.memory = memory_after > memory_before
+	           ? memory_after - memory_before : 0;
+	report_run(mgr, pass, &run, events);
+	if (events)
+		stat_ev_ctx_pop("pass");
+}
+
+static void run_prog_pass(ir_pass_manager_t *mgr, ir_pass_t *pass,
+                          ir_timer_t *timer)
+{
+	stat_ev_ctx_push_str("pass", pass->name);
+	pass_run_t run;
+
+	ir_timer_reset_and_start(timer);
+	run.n_analyses = 0;
+	foreach_irp_irg(i, irg) {
+		run.n_analyses += assure_pass_analyses(pass, irg);
+	}
+	run.analysis_usec = stop_timer(timer);
+
+	/* graphs may be created or freed by the pass */
+	size_t const memory_before = get_irp_memory();
+	ir_timer_reset_and_start(timer);
+	pass->prog_func();
+	run.time_usec = stop_timer(timer);
+	size_t const memory_after = get_irp_memory();
+
+	foreach_irp_irg(i, irg) {
+		confirm_pass_analyses(pass, irg);
+	}
+	run.memory = memory_after > memory_before
+	           ? memory_after - memory_before : 0;
+	report_run(mgr, pass, &run, true);
+	stat_ev_ctx_pop("pass");
+}
+
+/** A queue of graphs shared by the workers. */
+typedef struct irg_queue_t {
+	ir_graph *const *irgs;
+	size_t           n_irgs;
+	size_t           next; /**< index of the next graph to take */
+	firm_lock_t      lock; /**< protects next */
+} irg_queue_t;
+
+static ir_graph *take_graph(irg_queue_t *queue)
+{
+	firm_lock(&queue->lock);
+	size_t const idx = queue->next;
+	if (idx < queue->n_irgs)
+		queue->next = idx + 1;
+	firm_unlock(&queue->lock);
+	return idx < queue->n_irgs ? queue->irgs[idx] : NULL;
+}
+
+/** Work done by every worker, it takes graphs until the queue is empty. */
+typedef void (*work_func)(void *data);
+
+typedef struct work_t {
+	work_func func;
+	void     *data;
+} work_t;
+
+static bool runs_parallel(unsigned n_threads, size_t n_irgs)
+{
+#ifdef FIRM_THREADS
+	return n_threads > 1 && n_irgs > 1;
+#else
+	(void)n_threads;
+	(void)n_irgs;
+	return false;
+#endif
+}
+
+#ifdef FIRM_THREADS
+#ifdef _WIN32
+typedef HANDLE worker_t;
+
+static DWORD WINAPI run_worker(LPVOID data)
+{
+	work_t const *const work = (work_t const*)data;
+	work->func(work->data);
+	return 0;
+}
+
+static bool start_worker(worker_t *worker, work_t *work)
+{
+	*worker = CreateThread(NULL, 0, run_worker, work, 0, NULL);
+	return *worker != NULL;
+}
+
+static void join_worker(worker_t worker)
+{
+	WaitForSingleObject(worker, INFINITE);
+	CloseHandle(worker);
+}
+#else
+typedef pthread_t worker_t;
+
+static void *run_worker(void *data)
+{
+	work_t const *const work = (work_t const*)data;
+	work->func(work->data);
+	return NULL;
+}
+
+static bool start_worker(worker_t *worker, work_t *work)
+{
+	return pthread_create(worker, NULL, run_worker, work) == 0;
+}
+
+static void join_worker(worker_t worker)
+{
+	pthread_join(worker, NULL);
+}
+#endif
+#endif
+
+/**
+ * Runs @p func with up to @p n_threads workers on the graphs of @p queue. The
+ * calling thread works, too, so all graphs are done even if no worker could
+ * be started.
+ */
+static void run_workers(unsigned n_threads, irg_queue_t *queue,
+                        work_func func, void *data)
+{
+#ifdef FIRM_THREADS
+	if (runs_parallel(n_threads, queue->n_irgs)) {
+		work_t       work      = { .func = func, .data = data };
+		size_t const n_workers = MIN(n_threads, queue->n_irgs) - 1;
+		worker_t    *workers   = XMALLOCN(worker_t, n_workers);
+		size_t       n_started = 0;
+		while (n_started < n_workers
+		       && start_worker(&workers[n_started], &work))
+			++n_started;
+		func(data);
+		for (size_t i = 0; i < n_started; ++i)
+			join_worker(workers[i]);
+		free(workers);
+		return;
+	}
+#else
+	(void)n_threads;
+	(void)queue;
+#endif
+	func(data);
+}
+
+/** A group of consecutive graph passes shared by the workers. */
+typedef struct pass_group_t {
+	ir_pass_manager_t *mgr;
+	size_t             begin;  /**< first pass of the group */
+	size_t             end;    /**< end of the passes of the group */
+	bool               events; /**< report statistic events */
+	irg_queue_t        queue;
+} pass_group_t;
+
+static void run_graph_passes(void *data)
+{
+	/* timers cannot be shared between threads, each worker has its own */
+	pass_group_t      *const group  = (pass_group_t*)data;
+	ir_timer_t        *const timer  = ir_timer_new();
+	ir_pass_manager_t *const mgr    = group->mgr;
+	bool               const events = group->events;
+	for (ir_graph *irg; (irg = take_graph(&group->queue)) != NULL;) {
+		if (events)
+			stat_ev_ctx_push_fmt("pass_irg", "%+F", irg);
+		for (size_t p = group->begin; p < group->end; ++p)
+			run_graph_pass(mgr, &mgr->passes[p], irg, timer, events);
+		if (events)
+			stat_ev_ctx_pop("pass_irg");
+	}
+	ir_timer_free(timer);
+}
+
+typedef struct irg_func_work_t {
+	ir_graph_pass_func func;
+	irg_queue_t        queue;
+} irg_func_work_t;
+
+static void run_irg_func(void *data)
+{
+	irg_func_work_t *const work = (irg_func_work_t*)data;
+	for (ir_graph *irg; (irg = take_graph(&work->queue)) != NULL;)
+		work->func(irg);
+}
+
+void run_irgs_parallel(ir_graph_pass_func func, ir_graph *const *irgs,
+                       size_t n_irgs, unsigned n_threads)
+{
+	irg_func_work_t work = {
+		.func  = func,
+		.queue = {
+			.irgs   = irgs,
+			.n_irgs = n_irgs,
+			.lock   = FIRM_LOCK_INIT,
+		},
+	};
+	run_workers(n_threads, &work.queue, run_irg_func, &work);
+}
+
+void ir_pass_manager_run(ir_pass_manager_t *mgr)
+{
+	stat_ev_ctx_push_str("pass_manager", mgr->name);
+	ir_timer_t *const timer = ir_timer_new();
+	for (size_t i = 0, n = ARR_LEN(mgr->passes); i < n;) {
+		if (mgr->passes[i].prog_func != NULL) {
+			run_prog_pass(mgr, &mgr->passes[i], timer);
+			++i;
+			continue;
+		}
+
+		/* run the group of consecutive graph passes graph by graph */
+		size_t end = i;
+		while (end < n && mgr->passes[end].graph_func != NULL)
+			++end;
+		/* program passes may have created or freed graphs */
+		size_t    const n_irgs = get_irp_n_irgs();
+		ir_graph **const irgs  = XMALLOCN(ir_graph*, n_irgs);
+		foreach_irp_irg(j, irg) {
+			irgs[j] = irg;
+		}
+		pass_group_t group = {
+			.mgr    = mgr,
+			.begin  = i,
+			.end    = end,
+			.events = !runs_parallel(mgr->n_threads, n_irgs),
+			.queue  = {
+				.irgs   = irgs,
+				.n_irgs = n_irgs,
+				.lock   = FIRM_LOCK_INIT,
+			},
+		};
+		run_workers(mgr->n_threads, &group.queue, run_graph_passes, &group);
+		free(irgs);
+		i = end;
+	}
+	ir_timer_free(timer);
+	stat_ev_ctx_pop("pass_manager");
+}
+
+void ir_pass_manager_print_stats(ir_pass_manager_t const *mgr, FILE *out)
+{
+	fprintf(out, "==>> pass manager %s <<==\n", mgr->name);
+	fprintf(out, "%-24s %8s %8s %12s %12s %12s\n", "pass", "runs",
+	        "analyses", "time[ms]", "analyses[ms]", "memory[KiB]");
+	for (size_t i = 0, n = ARR_LEN(mgr->passes); i < n; ++i) {
+		ir_pass_t const *const pass = &mgr->passes[i];
+		fprintf(out, "%-24s %8u %8u %12.3f %12.3f %12zu\n", pass->name,
+		        pass->runs, pass->n_analyses,
+		        pass->time_usec / 1000.0, pass->analysis_usec / 1000.0,
+		        pass->memory / 1024);
+	}
+}
+
+void ir_pass_manager_reset_stats(ir_pass_manager_t *mgr)
+{
+	for (size_t i = 0, n = ARR_LEN(mgr->passes); i < n; ++i) {
+		ir_pass_t *const pass = &mgr->passes[i];
+		pass->runs          = 0;
+		pass->time_usec     = 0;
+		pass->analysis_usec = 0;
+		pass->n_analyses    = 0;
+		pass->memory        = 0;
+	}
+}
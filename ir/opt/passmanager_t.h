@@ -0,0 +1,25 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2016 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Running graph passes with the workers of the pass manager.
+ */
+#ifndef FIRM_OPT_PASSMANAGER_T_H
+#define FIRM_OPT_PASSMANAGER_T_H
+
+#include <stddef.h>
+
+#include "iroptimize.h"
+
+/**
+ * Runs @p func on the graphs @p irgs with up to @p n_threads threads, every
+ * graph in a single thread. Without FIRM_THREADS the graphs are run one after
+ * the other.
+ */
+void run_irgs_parallel(ir_graph_pass_func func, ir_graph *const *irgs,
+                       size_t n_irgs, unsigned n_threads);
+
+#endif
@@ -0,0 +1,848 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2016 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Superword level parallelism: packs isomorphic scalar operations of
+ *          a block into vector operations.
+ *
+ * Groups of Stores to adjacent addresses are the seeds. Starting from their
+ * values the expression trees are packed lane by lane as long as the lanes
+ * are isomorphic. A vector cannot be assembled from scalar values, so the
+ * leaves of a tree must be Loads from adjacent addresses or Consts.
+ *
+ * Memory operations are only packed within a linear part of the memory chain
+ * of a block. The vector Load takes the place of the first of its lanes in
+ * the chain, the vector Store the place of the last one. Alias queries make
+ * sure that no lane is moved across an operation accessing the same memory.
+ */
+#include "array.h"
+#include "debug.h"
+#include "ircons.h"
+#include "iredges_t.h"
+#include "irgmod.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irmemory.h"
+#include "irmode_t.h"
+#include "irnode_t.h"
+#include "irnodemap.h"
+#include "irnodeset.h"
+#include "iroptimize.h"
+#include "obst.h"
+#include "target_t.h"
+#include "tv_t.h"
+#include "type_t.h"
+#include "util.h"
+#include <stdlib.h>
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+/** Vector sizes in bits which are tried, the widest first. */
+static unsigned const vector_sizes[] = { 256, 128, 64 };
+
+/** A linear part of the memory chain of a block. */
+typedef struct slp_chain_t {
+	ir_node **ops; /**< Loads and Stores in chain order, NULL if removed */
+} slp_chain_t;
+
+/** A Load or Store in a chain. */
+typedef struct slp_memop_t {
+	slp_chain_t *chain;
+	size_t       index;  /**< position in the chain */
+	ir_node     *base;   /**< the address without constant offsets */
+	long         offset; /**< the constant offset from base */
+} slp_memop_t;
+
+/** A group of isomorphic scalar nodes, one per lane. */
+typedef struct slp_pack_t slp_pack_t;
+struct slp_pack_t {
+	ir_mode      *mode;     /**< the vector mode */
+	ir_node     **lanes;    /**< the scalar nodes, the value Projs of Loads */
+	slp_pack_t  **operands; /**< the packs of the operands */
+	int           n_operands;
+	ir_node      *vector;   /**< the vector node, once it is built */
+	unsigned      visited;
+};
+
+typedef struct slp_env_t {
+	arch_vector_cost_func cost_func;
+	ir_nodemap            memops;    /**< Load/Store -> slp_memop_t */
+	ir_nodemap            packs;     /**< scalar node -> slp_pack_t */
+	slp_pack_t          **new_packs; /**< packs of the current attempt */
+	ir_node              *block;
+	ir_mode              *mode;      /**< the vector mode of the attempt */
+	unsigned              n_lanes;
+	unsigned              visited;
+	struct obstack        obst;
+	bool                  changed;
+} slp_env_t;
+
+/**
+ * Splits @p ptr into a base address and a constant offset.
+ */
+static ir_node *get_base_offset(ir_node *ptr, long *const offset)
+{
+	long res = 0;
+	for (;;) {
+		if (is_Add(ptr)) {
+			ir_node *const right = get_Add_right(ptr);
+			if (!is_Const(right) || !tarval_is_long(get_Const_tarval(right)))
+				break;
+			res += get_tarval_long(get_Const_tarval(right));
+			ptr  = get_Add_left(ptr);
+		} else if (is_Member(ptr)) {
+			ir_entity *const entity = get_Member_entity(ptr);
+			ir_type   *const owner  = get_entity_owner(entity);
+			if (get_type_state(owner) != layout_fixed
+			 || get_entity_bitfield_size(entity) != 0)
+				break;
+			res += get_entity_offset(entity);
+			ptr  = get_Member_ptr(ptr);
+		} else {
+			break;
+		}
+	}
+	*offset = res;
+	return ptr;
+}
+
+static bool is_element_mode(ir_mode const *const mode)
+{
+	if (!mode_is_int(mode) && !mode_is_float(mode))
+		return false;
+	return get_mode_size_bits(mode) % 8 == 0
+	    && get_mode_arithmetic(mode) != irma_x86_extended_float;
+}
+
+static ir_node *get_memop_ptr(ir_node const *const node)
+{
+	return is_Load(node) ? get_Load_ptr(node) : get_Store_ptr(node);
+}
+
+static ir_type *get_memop_type(ir_node const *const node)
+{
+	return is_Load(node) ? get_Load_type(node) : get_Store_type(node);
+}
+
+static ir_mode *get_memop_mode(ir_node const *const node)
+{
+	return is_Load(node) ? get_Load_mode(node)
+	                     : get_irn_mode(get_Store_value(node));
+}
+
+static bool memops_alias(ir_node const *const a, ir_node const *const b)
+{
+	ir_alias_relation const rel = get_alias_relation(
+		get_memop_ptr(a), get_memop_type(a),
+		get_mode_size_bytes(get_memop_mode(a)),
+		get_memop_ptr(b), get_memop_type(b),
+		get_mode_size_bytes(get_memop_mode(b)));
+	return rel != ir_no_alias;
+}
+
+/**
+ * Returns true if @p node may be a lane of a vector memory operation.
+ */
+static bool is_packable_memop(ir_node const *const node)
+{
+	if (ir_throws_exception(node))
+		return false;
+	if (is_Load(node)) {
+		return get_Load_volatility(node) == volatility_non_volatile
+		    && is_element_mode(get_Load_mode(node));
+	} else {
+		return get_Store_volatility(node) == volatility_non_volatile
+		    && is_element_mode(get_irn_mode(get_Store_value(node)));
+	}
+}
+
+static bool is_chain_op(ir_node const *const node)
+{
+	return is_Load(node) || is_Store(node);
+}
+
+/**
+ * Returns the next Load or Store in the chain of @p node, if the chain
+ * continues linearly in the same block.
+ */
+static ir_node *get_chain_successor(ir_node const *const node)
+{
+	foreach_out_edge(node, edge) {
+		ir_node *const proj = get_edge_src_irn(edge);
+		if (get_irn_mode(proj) != mode_M)
+			continue;
+		if (get_irn_n_edges(proj) != 1)
+			return NULL;
+		ir_node *const succ = get_edge_src_irn(get_irn_out_edge_first(proj));
+		if (!is_chain_op(succ) || get_nodes_block(succ) != get_nodes_block(node))
+			return NULL;
+		return succ;
+	}
+	return NULL;
+}
+
+static bool is_chain_head(ir_node const *const node)
+{
+	ir_node *const mem = is_Load(node) ? get_Load_mem(node)
+	                                   : get_Store_mem(node);
+	if (!is_Proj(mem))
+		return true;
+	ir_node *const pred = get_Proj_pred(mem);
+	return !is_chain_op(pred) || get_chain_successor(pred) != node;
+}
+
+static void collect_memops(ir_node *node, void *data)
+{
+	ir_node ***const memops = (ir_node***)data;
+	if (is_chain_op(node))
+		ARR_APP1(ir_node*, *memops, node);
+}
+
+static slp_memop_t *get_memop(slp_env_t const *const env,
+                              ir_node const *const node)
+{
+	return ir_nodemap_get(slp_memop_t, &env->memops, node);
+}
+
+static void build_chain(slp_env_t *const env, slp_chain_t *const chain,
+                        ir_node *node)
+{
+	chain->ops = NEW_ARR_F(ir_node*, 0);
+	for (; node != NULL; node = get_chain_successor(node)) {
+		slp_memop_t *const memop = OALLOCZ(&env->obst, slp_memop_t);
+		memop->chain = chain;
+		memop->index = ARR_LEN(chain->ops);
+		memop->base  = get_base_offset(get_memop_ptr(node), &memop->offset);
+		ir_nodemap_insert(&env->memops, node, memop);
+		ARR_APP1(ir_node*, chain->ops, node);
+	}
+}
+
+/**
+ * Inserts @p node into the chain of @p memop in front of it.
+ */
+static void insert_before(slp_env_t *const env, slp_memop_t const *const memop,
+                          ir_node *const node)
+{
+	slp_chain_t *const chain = memop->chain;
+	size_t       const index = memop->index;
+	ARR_APP1(ir_node*, chain->ops, NULL);
+	for (size_t i = ARR_LEN(chain->ops) - 1; i > index; --i) {
+		ir_node *const op = chain->ops[i - 1];
+		chain->ops[i] = op;
+		if (op != NULL)
+			get_memop(env, op)->index = i;
+	}
+	chain->ops[index] = node;
+
+	slp_memop_t *const new_memop = OALLOCZ(&env->obst, slp_memop_t);
+	new_memop->chain = chain;
+	new_memop->index = index;
+	new_memop->base  = get_base_offset(get_memop_ptr(node), &new_memop->offset);
+	ir_nodemap_insert(&env->memops, node, new_memop);
+}
+
+static ir_node *get_memop_proj_M(ir_node const *const node)
+{
+	foreach_out_edge(node, edge) {
+		ir_node *const proj = get_edge_src_irn(edge);
+		if (get_irn_mode(proj) == mode_M)
+			return proj;
+	}
+	return NULL;
+}
+
+/**
+ * Removes a Load or Store from the memory chain.
+ */
+static void remove_memop(slp_env_t *const env, ir_node *const node)
+{
+	slp_memop_t *const memop = get_memop(env, node);
+	memop->chain->ops[memop->index] = NULL;
+	ir_node *const proj = get_memop_proj_M(node);
+	if (proj != NULL) {
+		ir_node *const mem = is_Load(node) ? get_Load_mem(node)
+		                                   : get_Store_mem(node);
+		exchange(proj, mem);
+	}
+}
+
+static slp_pack_t *get_pack(slp_env_t const *const env,
+                            ir_node const *const node)
+{
+	return ir_nodemap_get(slp_pack_t, &env->packs, node);
+}
+
+static slp_pack_t *new_pack(slp_env_t *const env, ir_node *const *const lanes,
+                            int const n_operands)
+{
+	slp_pack_t *const pack = OALLOCZ(&env->obst, slp_pack_t);
+	pack->mode       = env->mode;
+	pack->lanes      = OALLOCN(&env->obst, ir_node*, env->n_lanes);
+	pack->operands   = OALLOCNZ(&env->obst, slp_pack_t*, n_operands);
+	pack->n_operands = n_operands;
+	MEMCPY(pack->lanes, lanes, env->n_lanes);
+	ARR_APP1(slp_pack_t*, env->new_packs, pack);
+	if (!is_Const(lanes[0])) {
+		for (unsigned i = 0; i < env->n_lanes; ++i)
+			ir_nodemap_insert(&env->packs, lanes[i], pack);
+	}
+	return pack;
+}
+
+/**
+ * Checks that the Loads of @p lanes access adjacent addresses in lane order
+ * and may be read at the position of the first of them in the chain.
+ */
+static bool check_load_lanes(slp_env_t const *const env,
+                             ir_node *const *const lanes)
+{
+	ir_node     *const load0  = get_Proj_pred(lanes[0]);
+	slp_memop_t *const memop0 = get_memop(env, load0);
+	if (memop0 == NULL || !is_packable_memop(load0))
+		return false;
+	ir_mode *const mode  = get_Load_mode(load0);
+	long     const size  = get_mode_size_bytes(mode);
+	size_t         first = memop0->index;
+	for (unsigned i = 1; i < env->n_lanes; ++i) {
+		ir_node     *const load  = get_Proj_pred(lanes[i]);
+		slp_memop_t *const memop = get_memop(env, load);
+		if (memop == NULL || memop->chain != memop0->chain
+		 || !is_packable_memop(load) || get_Load_mode(load) != mode
+		 || memop->base != memop0->base
+		 || memop->offset != memop0->offset + (long)i * size)
+			return false;
+		first = MIN(first, memop->index);
+	}
+
+	ir_node *const *const ops = memop0->chain->ops;
+	for (unsigned i = 0; i < env->n_lanes; ++i) {
+		ir_node     *const load  = get_Proj_pred(lanes[i]);
+		slp_memop_t *const memop = get_memop(env, load);
+		for (size_t j = first + 1; j < memop->index; ++j) {
+			ir_node *const op = ops[j];
+			if (op != NULL && is_Store(op) && memops_alias(op, load))
+				return false;
+		}
+	}
+	return true;
+}
+
+static slp_pack_t *build_pack(slp_env_t *env, ir_node *const *lanes);
+
+static bool build_operand_packs(slp_env_t *const env, slp_pack_t *const pack)
+{
+	unsigned  const n_lanes = env->n_lanes;
+	ir_node **const ops     = ALLOCAN(ir_node*, n_lanes);
+	for (int n = 0; n < pack->n_operands; ++n) {
+		for (unsigned i = 0; i < n_lanes; ++i)
+			ops[i] = get_irn_n(pack->lanes[i], n);
+		pack->operands[n] = build_pack(env, ops);
+		if (pack->operands[n] == NULL)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Packs the isomorphic nodes @p lanes and their operands.
+ *
+ * @return the pack or NULL if the lanes cannot be packed
+ */
+static slp_pack_t *build_pack(slp_env_t *const env, ir_node *const *const lanes)
+{
+	unsigned const n_lanes      = env->n_lanes;
+	ir_node *const lane0        = lanes[0];
+	ir_mode *const element_mode = get_mode_vector_element_mode(env->mode);
+	if (get_irn_mode(lane0) != element_mode)
+		return NULL;
+
+	/* Packs of earlier attempts are reused, if they match exactly. */
+	slp_pack_t *const existing = get_pack(env, lane0);
+	if (existing != NULL) {
+		if (existing->mode != env->mode
+		 || get_nodes_block(lane0) != env->block)
+			return NULL;
+		for (unsigned i = 0; i < n_lanes; ++i) {
+			if (existing->lanes[i] != lanes[i])
+				return NULL;
+		}
+		return existing;
+	}
+
+	unsigned const opcode = get_irn_opcode(lane0);
+	for (unsigned i = 1; i < n_lanes; ++i) {
+		ir_node *const lane = lanes[i];
+		if (get_irn_opcode(lane) != opcode)
+			return NULL;
+		if (opcode == iro_Const)
+			continue;
+		if (get_nodes_block(lane) != env->block || get_pack(env, lane) != NULL)
+			return NULL;
+		for (unsigned j = 0; j < i; ++j) {
+			if (lanes[j] == lane)
+				return NULL;
+		}
+	}
+
+	ir_node *cost_node = lane0;
+	int      n_operands;
+	switch (opcode) {
+	case iro_Const:
+		n_operands = 0;
+		break;
+	case iro_Proj:
+		if (get_Proj_num(lane0) != pn_Load_res)
+			return NULL;
+		for (unsigned i = 0; i < n_lanes; ++i) {
+			if (!is_Load(get_Proj_pred(lanes[i])))
+				return NULL;
+		}
+		if (!check_load_lanes(env, lanes))
+			return NULL;
+		cost_node  = get_Proj_pred(lane0);
+		n_operands = 0;
+		break;
+	case iro_Add:
+	case iro_And:
+	case iro_Eor:
+	case iro_Mul:
+	case iro_Or:
+	case iro_Sub:
+		n_operands = 2;
+		break;
+	case iro_Minus:
+	case iro_Not:
+		n_operands = 1;
+		break;
+	default:
+		return NULL;
+	}
+	if (get_nodes_block(lane0) != env->block && opcode != iro_Const)
+		return NULL;
+	if (env->cost_func(cost_node, env->mode) < 0)
+		return NULL;
+
+	slp_pack_t *const pack = new_pack(env, lanes, n_operands);
+	if (!build_operand_packs(env, pack))
+		return NULL;
+	return pack;
+}
+
+static void collect_packs(slp_env_t *const env, slp_pack_t *const pack,
+                          slp_pack_t ***const packs)
+{
+	if (pack->visited == env->visited)
+		return;
+	pack->visited = env->visited;
+	ARR_APP1(slp_pack_t*, *packs, pack);
+	for (int n = 0; n < pack->n_operands; ++n)
+		collect_packs(env, pack->operands[n], packs);
+}
+
+static bool all_users_dead(ir_node const *const node, ir_nodeset_t *const dead)
+{
+	foreach_out_edge(node, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (!ir_nodeset_contains(dead, user))
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Determines the scalar nodes which are not needed anymore, once the Stores
+ * of @p root are replaced by a vector Store.
+ *
+ * @return the number of scalar operations saved
+ */
+static int compute_dead_nodes(slp_env_t const *const env,
+                              slp_pack_t *const *const packs,
+                              ir_nodeset_t *const dead)
+{
+	int saved = 0;
+	for (unsigned i = 0; i < env->n_lanes; ++i) {
+		ir_nodeset_insert(dead, packs[0]->lanes[i]);
+		++saved;
+	}
+
+	bool changed;
+	do {
+		changed = false;
+		for (size_t p = 1, n = ARR_LEN(packs); p < n; ++p) {
+			ir_node *const *const lanes = packs[p]->lanes;
+			if (is_Const(lanes[0]))
+				continue;
+			for (unsigned i = 0; i < env->n_lanes; ++i) {
+				ir_node *const lane = lanes[i];
+				if (ir_nodeset_contains(dead, lane) || !all_users_dead(lane, dead))
+					continue;
+				ir_nodeset_insert(dead, lane);
+				if (is_Proj(lane))
+					ir_nodeset_insert(dead, get_Proj_pred(lane));
+				++saved;
+				changed = true;
+			}
+		}
+	} while (changed);
+	return saved;
+}
+
+/**
+ * Checks that the Stores of @p pack may all be performed at the position of
+ * the last one in the chain.
+ */
+static bool check_store_lanes(slp_env_t const *const env,
+                              slp_pack_t const *const pack)
+{
+	size_t last = 0;
+	for (unsigned i = 0; i < env->n_lanes; ++i)
+		last = MAX(last, get_memop(env, pack->lanes[i])->index);
+
+	slp_memop_t const *const memop0 = get_memop(env, pack->lanes[0]);
+	ir_node    *const *const ops    = memop0->chain->ops;
+	for (unsigned i = 0; i < env->n_lanes; ++i) {
+		ir_node     *const store = pack->lanes[i];
+		slp_memop_t *const memop = get_memop(env, store);
+		for (size_t j = memop->index + 1; j < last; ++j) {
+			ir_node *const op = ops[j];
+			if (op == NULL || get_pack(env, op) == pack)
+				continue;
+			if (memops_alias(op, store))
+				return false;
+		}
+	}
+	return true;
+}
+
+static ir_cons_flags get_vector_cons(ir_node *const *const memops,
+                                     unsigned const n_lanes)
+{
+	ir_cons_flags cons = cons_unaligned | cons_floats;
+	for (unsigned i = 0; i < n_lanes; ++i) {
+		if (get_irn_pinned(memops[i]) != op_pin_state_floats)
+			cons &= ~cons_floats;
+	}
+	return cons;
+}
+
+static ir_node *build_vector_Load(slp_env_t *const env,
+                                  slp_pack_t const *const pack)
+{
+	unsigned const n_lanes = env->n_lanes;
+	ir_node **const loads  = ALLOCAN(ir_node*, n_lanes);
+	ir_node  *first        = NULL;
+	size_t    first_index  = 0;
+	for (unsigned i = 0; i < n_lanes; ++i) {
+		loads[i] = get_Proj_pred(pack->lanes[i]);
+		size_t const index = get_memop(env, loads[i])->index;
+		if (first == NULL || index < first_index) {
+			first       = loads[i];
+			first_index = index;
+		}
+	}
+
+	ir_type  *const type  = new_type_array(get_Load_type(loads[0]), n_lanes);
+	dbg_info *const dbgi  = get_irn_dbg_info(loads[0]);
+	ir_node  *const load  = new_rd_Load(dbgi, env->block, get_Load_mem(first),
+	                                    get_Load_ptr(loads[0]), env->mode, type,
+	                                    get_vector_cons(loads, n_lanes));
+	ir_node  *const mem   = new_r_Proj(load, mode_M, pn_Load_M);
+	set_Load_mem(first, mem);
+	insert_before(env, get_memop(env, first), load);
+	return new_r_Proj(load, env->mode, pn_Load_res);
+}
+
+static ir_node *build_vector(slp_env_t *const env, slp_pack_t *const pack)
+{
+	if (pack->vector != NULL)
+		return pack->vector;
+
+	ir_node **const in = ALLOCAN(ir_node*, pack->n_operands);
+	for (int n = 0; n < pack->n_operands; ++n)
+		in[n] = build_vector(env, pack->operands[n]);
+
+	ir_node  *const lane0 = pack->lanes[0];
+	dbg_info *const dbgi  = get_irn_dbg_info(lane0);
+	ir_node  *const block = env->block;
+	ir_node  *res;
+	switch (get_irn_opcode(lane0)) {
+	case iro_Const: {
+		ir_tarval **const tvs = ALLOCAN(ir_tarval*, env->n_lanes);
+		for (unsigned i = 0; i < env->n_lanes; ++i)
+			tvs[i] = get_Const_tarval(pack->lanes[i]);
+		ir_tarval *const tv = new_tarval_from_lanes(env->mode, tvs);
+		res = new_rd_Const(dbgi, get_irn_irg(block), tv);
+		break;
+	}
+	case iro_Proj:  res = build_vector_Load(env, pack);                break;
+	case iro_Add:   res = new_rd_Add(dbgi, block, in[0], in[1]);       break;
+	case iro_And:   res = new_rd_And(dbgi, block, in[0], in[1]);       break;
+	case iro_Eor:   res = new_rd_Eor(dbgi, block, in[0], in[1]);       break;
+	case iro_Mul:   res = new_rd_Mul(dbgi, block, in[0], in[1]);       break;
+	case iro_Or:    res = new_rd_Or(dbgi, block, in[0], in[1]);        break;
+	case iro_Sub:   res = new_rd_Sub(dbgi, block, in[0], in[1]);       break;
+	case iro_Minus: res = new_rd_Minus(dbgi, block, in[0]);            break;
+	case iro_Not:   res = new_rd_Not(dbgi, block, in[0]);              break;
+	default:        panic("unexpected node %+F in pack", lane0);
+	}
+	DB((dbg, LEVEL_3, "    %+F for %+F\n", res, lane0));
+	pack->vector = res;
+	return res;
+}
+
+/**
+ * Replaces the Stores of @p root by a vector Store and removes the scalar
+ * nodes, which are not needed anymore.
+ */
+static void build_vector_Store(slp_env_t *const env, slp_pack_t *const root,
+                               ir_nodeset_t *const dead)
+{
+	unsigned const n_lanes = env->n_lanes;
+	ir_node *const *const stores = root->lanes;
+	ir_node *value = build_vector(env, root->operands[0]);
+
+	ir_node *last       = NULL;
+	size_t   last_index = 0;
+	for (unsigned i = 0; i < n_lanes; ++i) {
+		size_t const index = get_memop(env, stores[i])->index;
+		if (last == NULL || index > last_index) {
+			last       = stores[i];
+			last_index = index;
+		}
+	}
+	for (unsigned i = 0; i < n_lanes; ++i) {
+		if (stores[i] != last)
+			remove_memop(env, stores[i]);
+	}
+
+	ir_type  *const type  = new_type_array(get_Store_type(stores[0]), n_lanes);
+	dbg_info *const dbgi  = get_irn_dbg_info(stores[0]);
+	ir_node  *const store = new_rd_Store(dbgi, env->block, get_Store_mem(last),
+	                                     get_Store_ptr(stores[0]), value, type,
+	                                     get_vector_cons(stores, n_lanes));
+	slp_memop_t *const memop = get_memop(env, last);
+	memop->chain->ops[memop->index] = store;
+	ir_nodemap_insert(&env->memops, store, memop);
+	ir_node *const proj = get_memop_proj_M(last);
+	if (proj != NULL)
+		exchange(proj, new_r_Proj(store, mode_M, pn_Store_M));
+
+	/* Remove the Loads which are not needed anymore from the chain, then
+	 * kill all dead nodes, so their users do not keep other nodes alive. */
+	foreach_ir_nodeset(dead, node, iter) {
+		if (is_Load(node))
+			remove_memop(env, node);
+	}
+	bool changed;
+	do {
+		changed = false;
+		foreach_ir_nodeset(dead, node, iter) {
+			if (!is_Deleted(node) && get_irn_n_edges(node) == 0) {
+				kill_node(node);
+				changed = true;
+			}
+		}
+	} while (changed);
+}
+
+/**
+ * Tries to replace the Stores @p stores by a vector Store.
+ */
+static bool try_vectorize(slp_env_t *const env, ir_node *const *const stores)
+{
+	ir_node *const store0 = stores[0];
+	if (env->cost_func(store0, env->mode) < 0)
+		return false;
+
+	unsigned const n_lanes = env->n_lanes;
+	ARR_RESIZE(slp_pack_t*, env->new_packs, 0);
+	slp_pack_t *const root   = new_pack(env, stores, 1);
+	ir_node   **const values = ALLOCAN(ir_node*, n_lanes);
+	for (unsigned i = 0; i < n_lanes; ++i)
+		values[i] = get_Store_value(stores[i]);
+	root->operands[0] = build_pack(env, values);
+
+	bool          success = false;
+	ir_nodeset_t  dead;
+	slp_pack_t  **packs   = NEW_ARR_F(slp_pack_t*, 0);
+	ir_nodeset_init(&dead);
+	if (root->operands[0] == NULL || !check_store_lanes(env, root))
+		goto end;
+
+	++env->visited;
+	collect_packs(env, root, &packs);
+	int cost = 0;
+	for (size_t p = 0, n = ARR_LEN(packs); p < n; ++p) {
+		slp_pack_t *const pack = packs[p];
+		if (pack->vector != NULL)
+			continue;
+		ir_node *node = pack->lanes[0];
+		if (is_Proj(node))
+			node = get_Proj_pred(node);
+		cost += env->cost_func(node, env->mode);
+	}
+	int const saved = compute_dead_nodes(env, packs, &dead);
+	DB((dbg, LEVEL_2, "  %+F..: vector cost %d, saved %d\n", store0, cost,
+	    saved));
+	if (cost >= saved)
+		goto end;
+
+	DB((dbg, LEVEL_1, "  vectorizing %+F.. with %+F\n", store0, env->mode));
+	build_vector_Store(env, root, &dead);
+	env->changed = true;
+	success      = true;
+
+end:
+	if (!success) {
+		for (size_t p = 0, n = ARR_LEN(env->new_packs); p < n; ++p) {
+			slp_pack_t *const pack = env->new_packs[p];
+			if (is_Const(pack->lanes[0]))
+				continue;
+			for (unsigned i = 0; i < n_lanes; ++i) {
+				if (get_pack(env, pack->lanes[i]) == pack)
+					ir_nodemap_insert(&env->packs, pack->lanes[i], NULL);
+			}
+		}
+	}
+	DEL_ARR_F(packs);
+	ir_nodeset_destroy(&dead);
+	return success;
+}
+
+static ir_mode *get_vector_mode(ir_mode *const element_mode,
+                                unsigned const n_lanes)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "V%u%s", n_lanes, get_mode_name(element_mode));
+	return new_vector_mode(name, element_mode, n_lanes);
+}
+
+static slp_env_t *sort_env;
+
+static int cmp_seed(void const *const a, void const *const b)
+{
+	ir_node     *const sa = *(ir_node *const*)a;
+	ir_node     *const sb = *(ir_node *const*)b;
+	slp_memop_t *const ma = get_memop(sort_env, sa);
+	slp_memop_t *const mb = get_memop(sort_env, sb);
+	long const ia = get_irn_idx(ma->base);
+	long const ib = get_irn_idx(mb->base);
+	if (ia != ib)
+		return ia < ib ? -1 : 1;
+	if (ma->offset != mb->offset)
+		return ma->offset < mb->offset ? -1 : 1;
+	return ma->index < mb->index ? -1 : ma->index > mb->index;
+}
+
+/**
+ * Returns true if the @p n Stores starting at @p stores write adjacent
+ * memory.
+ */
+static bool are_adjacent_stores(slp_env_t const *const env,
+                                ir_node *const *const stores, unsigned const n)
+{
+	slp_memop_t const *const memop0 = get_memop(env, stores[0]);
+	ir_mode           *const mode   = get_irn_mode(get_Store_value(stores[0]));
+	long               const size   = get_mode_size_bytes(mode);
+	for (unsigned i = 1; i < n; ++i) {
+		slp_memop_t const *const memop = get_memop(env, stores[i]);
+		if (memop->base != memop0->base
+		 || get_irn_mode(get_Store_value(stores[i])) != mode
+		 || memop->offset != memop0->offset + (long)i * size)
+			return false;
+	}
+	return true;
+}
+
+static void vectorize_chain(slp_env_t *const env, slp_chain_t *const chain)
+{
+	ir_node **seeds = NEW_ARR_F(ir_node*, 0);
+	for (size_t i = 0, n = ARR_LEN(chain->ops); i < n; ++i) {
+		ir_node *const op = chain->ops[i];
+		if (is_Store(op) && is_packable_memop(op))
+			ARR_APP1(ir_node*, seeds, op);
+	}
+	sort_env = env;
+	QSORT_ARR(seeds, cmp_seed);
+
+	env->block = get_nodes_block(chain->ops[0]);
+	size_t const n_seeds = ARR_LEN(seeds);
+	for (size_t i = 0; i < n_seeds;) {
+		ir_mode *const mode = get_irn_mode(get_Store_value(seeds[i]));
+		unsigned const bits = get_mode_size_bits(mode);
+		bool vectorized = false;
+		for (size_t s = 0; s < ARRAY_SIZE(vector_sizes); ++s) {
+			unsigned const n_lanes = vector_sizes[s] / bits;
+			if (n_lanes < 2 || i + n_lanes > n_seeds)
+				continue;
+			if (!are_adjacent_stores(env, &seeds[i], n_lanes))
+				continue;
+			env->mode    = get_vector_mode(mode, n_lanes);
+			env->n_lanes = n_lanes;
+			if (try_vectorize(env, &seeds[i])) {
+				i += n_lanes;
+				vectorized = true;
+				break;
+			}
+		}
+		if (!vectorized)
+			++i;
+	}
+	DEL_ARR_F(seeds);
+}
+
+void opt_slp_cb(ir_graph *irg, arch_vector_cost_func cost_func)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.opt.slp");
+	if (cost_func == NULL) {
+		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_ALL);
+		return;
+	}
+
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
+	DB((dbg, LEVEL_1, "Running SLP vectorization on %+F\n", irg));
+
+	slp_env_t env;
+	memset(&env, 0, sizeof(env));
+	env.cost_func = cost_func;
+	env.new_packs = NEW_ARR_F(slp_pack_t*, 0);
+	obstack_init(&env.obst);
+	ir_nodemap_init(&env.memops, irg);
+	ir_nodemap_init(&env.packs, irg);
+
+	ir_node **memops = NEW_ARR_F(ir_node*, 0);
+	irg_walk_graph(irg, NULL, collect_memops, &memops);
+	slp_chain_t **chains = NEW_ARR_F(slp_chain_t*, 0);
+	for (size_t i = 0, n = ARR_LEN(memops); i < n; ++i) {
+		ir_node *const node = memops[i];
+		if (!is_chain_head(node))
+			continue;
+		slp_chain_t *const chain = OALLOCZ(&env.obst, slp_chain_t);
+		build_chain(&env, chain, node);
+		ARR_APP1(slp_chain_t*, chains, chain);
+	}
+	DEL_ARR_F(memops);
+
+	for (size_t i = 0, n = ARR_LEN(chains); i < n; ++i) {
+		vectorize_chain(&env, chains[i]);
+		DEL_ARR_F(chains[i]->ops);
+	}
+	DEL_ARR_F(chains);
+
+	DEL_ARR_F(env.new_packs);
+	ir_nodemap_destroy(&env.packs);
+	ir_nodemap_destroy(&env.memops);
+	obstack_free(&env.obst, NULL);
+
+	confirm_irg_properties(irg, env.changed ? IR_GRAPH_PROPERTIES_CONTROL_FLOW
+	                                        : IR_GRAPH_PROPERTIES_ALL);
+}
+
+void opt_slp(ir_graph *irg)
+{
+	opt_slp_cb(irg, ir_target.vector_cost);
+}
@@ -0,0 +1,501 @@
+/*
+ * This file is part of libFirm.
+ * Copyright (C) 2016 University of Karlsruhe.
+ */
+
+/**
+ * @file
+ * @brief   Loop unswitching: moves loop invariant conditionals out of loops.
+ *
+ * A loop containing a Cond with an invariant selector is duplicated. A new
+ * block in front of the loops evaluates the selector once and enters the
+ * original loop, where the Cond always takes the true branch, or the copy,
+ * where it always takes the false branch. The exits of both loops lead to the
+ * same blocks, values defined in the loop get Phis there.
+ *
+ * Every unswitching duplicates a loop, so the size of the loops and the growth
+ * of the whole graph are limited by budgets.
+ */
+#include "array.h"
+#include "debug.h"
+#include "ircons.h"
+#include "iredges_t.h"
+#include "irgmod.h"
+#include "irgraph_t.h"
+#include "irgwalk.h"
+#include "irloop_t.h"
+#include "irnode_t.h"
+#include "irnodemap.h"
+#include "iroptimize.h"
+#include "irtools.h"
+#include "statev_t.h"
+
+DEBUG_ONLY(static firm_dbg_module_t *dbg;)
+
+typedef struct unswitch_loop_t {
+	ir_node **blocks; /**< blocks of the loop including inner loops */
+	ir_node **nodes;  /**< nodes of the loop including inner loops */
+} unswitch_loop_t;
+
+typedef struct unswitch_env_t {
+	unswitch_loop_t **loops;
+	ir_node         **conds; /**< Conds with an invariant selector */
+	ir_nodemap        copies;
+} unswitch_env_t;
+
+static unswitch_loop_t *get_unswitch_loop(ir_loop const *loop)
+{
+	return (unswitch_loop_t*)get_loop_link(loop);
+}
+
+/** Returns true if @p block belongs to @p loop or one of its inner loops. */
+static bool in_loop(ir_node const *block, ir_loop const *loop)
+{
+	ir_loop const *l = get_irn_loop(block);
+	if (l == NULL)
+		return false;
+	for (unsigned d = get_loop_depth(l), depth = get_loop_depth(loop);
+	     d > depth; --d) {
+		l = get_loop_outer_loop(l);
+	}
+	return l == loop;
+}
+
+static void create_loops(unswitch_env_t *env, ir_loop *loop)
+{
+	if (get_loop_depth(loop) > 0) {
+		unswitch_loop_t *const lp = XMALLOC(unswitch_loop_t);
+		lp->blocks = NEW_ARR_F(ir_node*, 0);
+		lp->nodes  = NEW_ARR_F(ir_node*, 0);
+		set_loop_link(loop, lp);
+		ARR_APP1(unswitch_loop_t*, env->loops, lp);
+	}
+	for (size_t i = 0, n = get_loop_n_elements(loop); i < n; ++i) {
+		loop_element const elem = get_loop_element(loop, i);
+		if (*elem.kind == k_ir_loop)
+			create_loops(env, elem.son);
+	}
+}
+
+static void free_loops(unswitch_env_t *env)
+{
+	for (size_t i = 0, n = ARR_LEN(env->loops); i < n; ++i) {
+		unswitch_loop_t *const lp = env->loops[i];
+		DEL_ARR_F(lp->blocks);
+		DEL_ARR_F(lp->nodes);
+		free(lp);
+	}
+	DEL_ARR_F(env->loops);
+}
+
+static void collect_node(ir_node *node, void *data)
+{
+	unswitch_env_t *const env   = (unswitch_env_t*)data;
+	ir_node        *const block = is_Block(node) ? node : get_nodes_block(node);
+	ir_loop        *const inner = get_irn_loop(block);
+	for (ir_loop *loop = inner; loop != NULL && get_loop_depth(loop) > 0;
+	     loop = get_loop_outer_loop(loop)) {
+		unswitch_loop_t *const lp = get_unswitch_loop(loop);
+		if (is_Block(node)) {
+			ARR_APP1(ir_node*, lp->blocks, node);
+		} else {
+			ARR_APP1(ir_node*, lp->nodes, node);
+		}
+	}
+
+	if (is_Cond(node) && inner != NULL && get_loop_depth(inner) > 0) {
+		ir_node *const selector = get_Cond_selector(node);
+		if (!is_Const(selector) && !in_loop(get_nodes_block(selector), inner))
+			ARR_APP1(ir_node*, env->conds, node);
+	}
+}
+
+/** Finds the header of a loop, returns NULL if it has several. */
+static ir_node *find_header(unswitch_loop_t const *lp, ir_loop const *loop)
+{
+	ir_node *header = NULL;
+	for (size_t i = 0, n = ARR_LEN(lp->blocks); i < n; ++i) {
+		ir_node *const block = lp->blocks[i];
+		if (get_Block_entity(block) != NULL)
+			return NULL;
+		for (int p = 0, arity = get_Block_n_cfgpreds(block); p < arity; ++p) {
+			ir_node *const pred = get_Block_cfgpred_block(block, p);
+			if (pred != NULL && in_loop(pred, loop))
+				continue;
+			if (header != NULL && header != block)
+				return NULL;
+			header = block;
+		}
+	}
+	return header;
+}
+
+static ir_node *get_copy(unswitch_env_t *env, ir_node *node)
+{
+	return ir_nodemap_get(ir_node, &env->copies, node);
+}
+
+static bool is_copied(unswitch_env_t *env, ir_node *node)
+{
+	return get_copy(env, node) != NULL;
+}
+
+static ir_node *get_copy_or_self(unswitch_env_t *env, ir_node *node)
+{
+	ir_node *const copy = get_copy(env, node);
+	return copy != NULL ? copy : node;
+}
+
+/* ssa */
+static ir_node *ssa_second_def;
+static ir_node *ssa_second_def_block;
+
+/**
+ * Walks the graph bottom up, searching for definitions and creates phis.
+ */
+static ir_node *search_def_and_create_phis(ir_node *block, ir_mode *mode,
+                                           bool first)
+{
+	ir_graph *const irg = get_irn_irg(block);
+	if (block == ssa_second_def_block && !first)
+		return ssa_second_def;
+
+	/* already processed this block? */
+	if (irn_visited(block))
+		return (ir_node*)get_irn_link(block);
+
+	assert(block != get_irg_start_block(irg));
+
+	/* a Block with only 1 predecessor needs no Phi */
+	int const n_cfgpreds = get_Block_n_cfgpreds(block);
+	if (n_cfgpreds == 1) {
+		ir_node *const pred_block = get_Block_cfgpred_block(block, 0);
+		ir_node *const value      = pred_block == NULL ? new_r_Bad(irg, mode)
+			: search_def_and_create_phis(pred_block, mode, false);
+		set_irn_link(block, value);
+		mark_irn_visited(block);
+		return value;
+	}
+
+	/* create a new Phi */
+	ir_node **const in    = ALLOCAN(ir_node*, n_cfgpreds);
+	ir_node  *const dummy = new_r_Dummy(irg, mode);
+	for (int i = 0; i < n_cfgpreds; ++i)
+		in[i] = dummy;
+
+	ir_node *const phi = mode == mode_M ? new_r_Phi_loop(block, n_cfgpreds, in)
+	                                    : new_r_Phi(block, n_cfgpreds, in, mode);
+	set_irn_link(block, phi);
+	mark_irn_visited(block);
+
+	/* set Phi predecessors */
+	for (int i = 0; i < n_cfgpreds; ++i) {
+		ir_node *const pred_block = get_Block_cfgpred_block(block, i);
+		ir_node *const pred_val   = pred_block == NULL ? new_r_Bad(irg, mode)
+			: search_def_and_create_phis(pred_block, mode, false);
+		set_irn_n(phi, i, pred_val);
+	}
+	return phi;
+}
+
+/**
+ * Constructs SSA form for the users of @p value outside of both loops, which
+ * are now reached by @p value and its copy.
+ */
+static void construct_ssa(unswitch_env_t *env, ir_node *value)
+{
+	ir_node *const copy = get_copy(env, value);
+	ir_mode *const mode = get_irn_mode(value);
+	bool           init = false;
+	foreach_out_edge_safe(value, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (is_End(user) || is_copied(env, user))
+			continue;
+		ir_node *block = get_nodes_block(user);
+		int const pos  = get_edge_src_pos(edge);
+		if (is_Phi(user)) {
+			/* the Phis of the exits already got an operand for the copy */
+			block = get_Block_cfgpred_block(block, pos);
+			if (block == NULL || is_copied(env, block))
+				continue;
+		} else if (is_copied(env, block)) {
+			continue;
+		}
+
+		if (!init) {
+			ir_graph *const irg = get_irn_irg(value);
+			inc_irg_visited(irg);
+			ir_node *const value_block = get_nodes_block(value);
+			set_irn_link(value_block, value);
+			mark_irn_visited(value_block);
+			ssa_second_def_block = get_nodes_block(copy);
+			ssa_second_def       = copy;
+			init                 = true;
+		}
+		ir_node *const nw = search_def_and_create_phis(block, mode, true);
+		if (nw != user)
+			set_irn_n(user, pos, nw);
+	}
+}
+
+/** Lets the exits of the loop accept the control flow of the copy. */
+static void add_copy_exits(unswitch_env_t *env, unswitch_loop_t *lp)
+{
+	ir_node **exits = NEW_ARR_F(ir_node*, 0);
+	for (size_t i = 0, n = ARR_LEN(lp->blocks); i < n; ++i) {
+		foreach_block_succ(lp->blocks[i], edge) {
+			ir_node *const succ = get_edge_src_irn(edge);
+			if (is_copied(env, succ) || irn_visited_else_mark(succ))
+				continue;
+			ARR_APP1(ir_node*, exits, succ);
+		}
+	}
+
+	for (size_t e = 0, n_exits = ARR_LEN(exits); e < n_exits; ++e) {
+		ir_node  *const block = exits[e];
+		int       const arity = get_Block_n_cfgpreds(block);
+		ir_node **const in    = ALLOCAN(ir_node*, 2 * arity);
+		int             n     = arity;
+		for (int i = 0; i < arity; ++i) {
+			in[i] = get_Block_cfgpred(block, i);
+			if (is_copied(env, get_nodes_block(in[i])))
+				in[n++] = get_copy(env, in[i]);
+		}
+
+		ir_node **phis = NEW_ARR_F(ir_node*, 0);
+		foreach_out_edge(block, edge) {
+			ir_node *const user = get_edge_src_irn(edge);
+			if (is_Phi(user))
+				ARR_APP1(ir_node*, phis, user);
+		}
+		ir_node **const phi_in = ALLOCAN(ir_node*, n);
+		for (size_t p = 0, n_phis = ARR_LEN(phis); p < n_phis; ++p) {
+			ir_node *const phi = phis[p];
+			int            k   = arity;
+			for (int i = 0; i < arity; ++i) {
+				phi_in[i] = get_Phi_pred(phi, i);
+				if (is_copied(env, get_nodes_block(in[i])))
+					phi_in[k++] = get_copy_or_self(env, phi_in[i]);
+			}
+			set_irn_in(phi, n, phi_in);
+		}
+		DEL_ARR_F(phis);
+		set_irn_in(block, n, in);
+	}
+	DEL_ARR_F(exits);
+}
+
+/**
+ * Creates the block in front of both loops, which enters the loop with
+ * @p header on the true and its copy on the false branch of @p cond.
+ */
+static void create_dispatch(unswitch_env_t *env, ir_loop *loop,
+                            ir_node *header, ir_node *cond)
+{
+	ir_node *const header_copy = get_copy(env, header);
+	int      const arity       = get_Block_n_cfgpreds(header);
+	ir_node      **entries     = ALLOCAN(ir_node*, arity);
+	int            n           = 0;
+	int            first       = -1;
+	for (int i = 0; i < arity; ++i) {
+		if (in_loop(get_Block_cfgpred_block(header, i), loop))
+			continue;
+		if (first < 0)
+			first = i;
+		entries[n++] = get_Block_cfgpred(header, i);
+	}
+
+	ir_graph *const irg      = get_irn_irg(header);
+	ir_node  *const dispatch = new_r_Block(irg, n, entries);
+	ir_node  *const selector = get_Cond_selector(cond);
+	ir_node  *const new_cond = new_r_Cond(dispatch, selector);
+	set_Cond_jmp_pred(new_cond, get_Cond_jmp_pred(cond));
+	ir_node  *const proj_t   = new_r_Proj(new_cond, mode_X, pn_Cond_true);
+	ir_node  *const proj_f   = new_r_Proj(new_cond, mode_X, pn_Cond_false);
+
+	ir_node **phis = NEW_ARR_F(ir_node*, 0);
+	foreach_out_edge(header, edge) {
+		ir_node *const user = get_edge_src_irn(edge);
+		if (is_Phi(user))
+			ARR_APP1(ir_node*, phis, user);
+	}
+	ir_node **in      = ALLOCAN(ir_node*, arity);
+	ir_node **in_copy = ALLOCAN(ir_node*, arity);
+	for (size_t p = 0, n_phis = ARR_LEN(phis); p < n_phis; ++p) {
+		ir_node *const phi      = phis[p];
+		ir_node *const phi_copy = get_copy(env, phi);
+		int            k        = 0;
+		for (int i = 0; i < arity; ++i) {
+			if (!in_loop(get_Block_cfgpred_block(header, i), loop))
+				entries[k++] = get_Phi_pred(phi, i);
+		}
+		ir_node *const entry = n == 1 ? entries[0]
+		                     : new_r_Phi(dispatch, n, entries, get_irn_mode(phi));
+		k = 0;
+		for (int i = 0; i < arity; ++i) {
+			if (i == first) {
+				in[k]      = entry;
+				in_copy[k] = entry;
+				++k;
+			} else if (in_loop(get_Block_cfgpred_block(header, i), loop)) {
+				in[k]      = get_Phi_pred(phi, i);
+				in_copy[k] = get_Phi_pred(phi_copy, i);
+				++k;
+			}
+		}
+		set_irn_in(phi, k, in);
+		set_irn_in(phi_copy, k, in_copy);
+	}
+	DEL_ARR_F(phis);
+
+	int k = 0;
+	for (int i = 0; i < arity; ++i) {
+		if (i == first) {
+			in[k]      = proj_t;
+			in_copy[k] = proj_f;
+			++k;
+		} else if (in_loop(get_Block_cfgpred_block(header, i), loop)) {
+			in[k]      = get_Block_cfgpred(header, i);
+			in_copy[k] = get_Block_cfgpred(header_copy, i);
+			++k;
+		}
+	}
+	set_irn_in(header, k, in);
+	set_irn_in(header_copy, k, in_copy);
+}
+
+/** Replaces the Cond @p cond by a Jmp along the branch @p taken. */
+static void fold_cond(ir_node *cond, unsigned taken)
+{
+	ir_graph *const irg   = get_irn_irg(cond);
+	ir_node  *const block = get_nodes_block(cond);
+	foreach_out_edge_safe(cond, edge) {
+		ir_node *const proj = get_edge_src_irn(edge);
+		if (get_Proj_num(proj) == taken)
+			exchange(proj, new_r_Jmp(block));
+		else
+			exchange(proj, new_r_Bad(irg, mode_X));
+	}
+}
+
+static void unswitch_loop(unswitch_env_t *env, unswitch_loop_t *lp,
+                          ir_loop *loop, ir_node *header, ir_node *cond)
+{
+	DB((dbg, LEVEL_1, "unswitching loop %ld of %+F on %+F\n",
+	    get_loop_loop_nr(loop), get_irn_irg(cond), cond));
+
+	/* copy the loop, the copies still use the original nodes */
+	for (size_t i = 0, n = ARR_LEN(lp->blocks); i < n; ++i) {
+		ir_node *const block = lp->blocks[i];
+		ir_nodemap_insert(&env->copies, block, exact_copy(block));
+	}
+	for (size_t i = 0, n = ARR_LEN(lp->nodes); i < n; ++i) {
+		ir_node *const node = lp->nodes[i];
+		ir_nodemap_insert(&env->copies, node, exact_copy(node));
+	}
+	for (size_t i = 0, n = ARR_LEN(lp->blocks); i < n; ++i) {
+		ir_node *const block = lp->blocks[i];
+		ir_node *const copy  = get_copy(env, block);
+		foreach_irn_in(block, p, pred) {
+			set_irn_n(copy, p, get_copy_or_self(env, pred));
+		}
+	}
+	for (size_t i = 0, n = ARR_LEN(lp->nodes); i < n; ++i) {
+		ir_node *const node = lp->nodes[i];
+		ir_node *const copy = get_copy(env, node);
+		set_nodes_block(copy, get_copy(env, get_nodes_block(node)));
+		foreach_irn_in(node, p, pred) {
+			set_irn_n(copy, p, get_copy_or_self(env, pred));
+		}
+	}
+
+	ir_graph *const irg = get_irn_irg(cond);
+	ir_node  *const end = get_irg_end(irg);
+	foreach_irn_in(end, i, kept) {
+		ir_node *const copy = get_copy(env, kept);
+		if (copy != NULL)
+			add_End_keepalive(end, copy);
+	}
+
+	ir_reserve_resources(irg, IR_RESOURCE_IRN_VISITED | IR_RESOURCE_IRN_LINK);
+	inc_irg_visited(irg);
+	add_copy_exits(env, lp);
+	create_dispatch(env, loop, header, cond);
+	for (size_t i = 0, n = ARR_LEN(lp->nodes); i < n; ++i) {
+		ir_node *const node = lp->nodes[i];
+		ir_mode *const mode = get_irn_mode(node);
+		if (mode != mode_X && mode != mode_T)
+			construct_ssa(env, node);
+	}
+	ir_free_resources(irg, IR_RESOURCE_IRN_VISITED | IR_RESOURCE_IRN_LINK);
+
+	fold_cond(get_copy(env, cond), pn_Cond_false);
+	fold_cond(cond, pn_Cond_true);
+}
+
+/**
+ * Unswitches one loop within the budgets.
+ *
+ * @return the number of nodes copied or 0 if no loop was unswitched
+ */
+static unsigned unswitch_one(ir_graph *irg, unsigned max_loop_size,
+                             unsigned budget)
+{
+	unswitch_env_t env;
+	env.loops = NEW_ARR_F(unswitch_loop_t*, 0);
+	env.conds = NEW_ARR_F(ir_node*, 0);
+	create_loops(&env, get_irg_loop(irg));
+	irg_walk_graph(irg, NULL, collect_node, &env);
+
+	unsigned size = 0;
+	for (size_t i = 0, n = ARR_LEN(env.conds); i < n; ++i) {
+		ir_node         *const cond = env.conds[i];
+		ir_loop         *const loop = get_irn_loop(get_nodes_block(cond));
+		unswitch_loop_t *const lp   = get_unswitch_loop(loop);
+		unsigned         const cost = ARR_LEN(lp->blocks) + ARR_LEN(lp->nodes);
+		if (cost > max_loop_size || cost > budget)
+			continue;
+		ir_node *const header = find_header(lp, loop);
+		if (header == NULL)
+			continue;
+
+		ir_nodemap_init(&env.copies, irg);
+		unswitch_loop(&env, lp, loop, header, cond);
+		ir_nodemap_destroy(&env.copies);
+		size = cost;
+		break;
+	}
+
+	free_loops(&env);
+	DEL_ARR_F(env.conds);
+	return size;
+}
+
+void do_loop_unswitching(ir_graph *irg, unsigned max_loop_size,
+                         unsigned max_growth)
+{
+	FIRM_DBG_REGISTER(dbg, "firm.opt.unswitch");
+
+	/* Invariant selectors computed in the loop move in front of it. */
+	do_loop_invariant_motion(irg);
+
+	unsigned budget      = get_irg_last_idx(irg) * max_growth / 100;
+	unsigned n_unswitched = 0;
+	for (;;) {
+		assure_irg_properties(irg,
+			IR_GRAPH_PROPERTY_NO_BADS
+			| IR_GRAPH_PROPERTY_NO_TUPLES
+			| IR_GRAPH_PROPERTY_NO_UNREACHABLE_CODE
+			| IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES
+			| IR_GRAPH_PROPERTY_CONSISTENT_LOOPINFO);
+		unsigned const size = unswitch_one(irg, max_loop_size, budget);
+		if (size == 0)
+			break;
+		budget -= size;
+		++n_unswitched;
+		confirm_irg_properties(irg, IR_GRAPH_PROPERTIES_NONE);
+	}
+	stat_ev_int("unswitch_loops", n_unswitched);
+	confirm_irg_properties(irg, n_unswitched > 0 ? IR_GRAPH_PROPERTIES_NONE
+	                                             : IR_GRAPH_PROPERTIES_ALL);
+}
@@ -15,6 +15,7 @@
 #include "irdump.h"
 #include "irgraph_t.h"
 #include "irhooks.h"
+#include "irio.h"
 #include "irprog_t.h"
 #include "panic.h"
 #include "util.h"
@@ -61,13 +62,16 @@ static ir_entity *new_entity_vis(ir_type *owner, ident *name, ir_type *type,
 	ir_entity *res;
 	if (is_Method_type(type)) {
 		res = intern_new_entity(owner, IR_ENTITY_METHOD, name, type, vis);
-		res->linkage                     = IR_LINKAGE_CONSTANT;
-		res->attr.global.jit_addr        = (void*)-1;
-		res->attr.global.properties      = get_method_additional_properties(type);
-		res->attr.mtd_attr.vtable_number = IR_VTABLE_NUM_NOT_SET;
-		res->attr.mtd_attr.param_access  = NULL;
-		res->attr.mtd_attr.param_weight  = NULL;
-		res->attr.mtd_attr.irg           = NULL;
+		res->linkage                            = IR_LINKAGE_CONSTANT;
+		res->attr.global.jit_addr               = (void*)-1;
+		res->attr.global.properties             = get_method_additional_properties(type);
+		res->attr.mtd_attr.vtable_number        = IR_VTABLE_NUM_NOT_SET;
+		res->attr.mtd_attr.param_access         = NULL;
+		res->attr.mtd_attr.param_access_callees = NULL;
+		res->attr.mtd_attr.param_access_callers = NULL;
+		res->attr.mtd_attr.param_weight         = NULL;
+		res->attr.mtd_attr.irg                  = NULL;
+		res->attr.mtd_attr.lazy_irg             = NULL;
 	} else if (is_compound_type(owner) && !is_segment_type(owner)) {
 		res = intern_new_entity(owner, IR_ENTITY_COMPOUND_MEMBER, name, type,
 		                        vis);
@@ -169,14 +173,9 @@ static void free_entity_attrs(ir_entity *ent)
 	/* TODO: free initializers */
 
 	if (ent->kind == IR_ENTITY_METHOD) {
-		if (ent->attr.mtd_attr.param_access) {
-			DEL_ARR_F(ent->attr.mtd_attr.param_access);
-			ent->attr.mtd_attr.param_access = NULL;
-		}
-		if (ent->attr.mtd_attr.param_weight) {
-			DEL_ARR_F(ent->attr.mtd_attr.param_weight);
-			ent->attr.mtd_attr.param_weight = NULL;
-		}
+		free_param_summary(ent);
+		if (ent->attr.mtd_attr.lazy_irg)
+			free_lazy_irg(ent);
 	}
 }
 
@@ -185,11 +184,17 @@ ir_entity *clone_entity(ir_entity const *const old, ident *const name,
 {
 	ir_entity *res = XMALLOC(ir_entity);
 
+	/* the clone shares the irg, so it has to exist */
+	if (is_method_entity(old))
+		(void)ir_load_entity_irg((ir_entity*)old);
+
 	*res = *old;
 	/* FIXME: the initializers are NOT copied */
 	if (is_method_entity(old)) {
 		/* do NOT copy them, reanalyze. This might be the best solution */
 		res->attr.mtd_attr.param_access = NULL;
+		res->attr.mtd_attr.param_access_callees = NULL;
+		res->attr.mtd_attr.param_access_callers = NULL;
 		res->attr.mtd_attr.param_weight = NULL;
 	}
 	res->overwrites    = NULL;
@@ -706,6 +711,11 @@ ir_graph *(get_entity_linktime_irg)(const ir_entity *ent)
 void set_entity_irg(ir_entity *ent, ir_graph *irg)
 {
 	assert(is_method_entity(ent));
+	/* a new irg replaces a deferred one */
+	if (irg != NULL && ent->attr.mtd_attr.lazy_irg != NULL)
+		free_lazy_irg(ent);
+	if (irg != ent->attr.mtd_attr.irg)
+		free_param_summary(ent);
 	ent->attr.mtd_attr.irg = irg;
 }
 
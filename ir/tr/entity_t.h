@@ -109,16 +109,24 @@ typedef struct normal_ent_attr {
 	ir_initializer_t *initializer; /**< entity initializer */
 } normal_ent_attr;
 
+typedef struct lazy_irg_t lazy_irg_t;
+
 /** The attributes for methods. */
 typedef struct method_ent_attr {
 	global_ent_attr           base;
 	ir_graph *irg;                 /**< The corresponding irg if known.
 	                                    The ir_graph constructor automatically sets this field. */
+	lazy_irg_t *lazy_irg;          /**< The not yet built irg of an
+	                                    ir_import_lazy() import. */
 
 	unsigned vtable_number;        /**< For a dynamically called method, the number assigned
 	                                    in the virtual function table. */
 
 	ptr_access_kind *param_access; /**< the parameter access */
+	ir_entity **param_access_callees; /**< Methods whose parameter access
+	                                       was used to compute ours. */
+	ir_entity **param_access_callers; /**< Methods whose parameter access
+	                                       was computed from ours. */
 	unsigned *param_weight;        /**< The weight of method's parameters. Parameters
 	                                    with a high weight are good candidates for procedure cloning. */
 } method_ent_attr;
@@ -232,6 +240,17 @@ ir_entity *new_spillslot(ir_type *frame, unsigned size, unsigned po2align);
 
 void set_entity_irg(ir_entity *ent, ir_graph *irg);
 
+/**
+ * Discards the deferred irg of @p ent.
+ */
+void free_lazy_irg(ir_entity *ent);
+
+/**
+ * Discards the parameter summaries of @p ent and the parameter access of
+ * all methods derived from it.
+ */
+void free_param_summary(ir_entity *ent);
+
 /* ----------------------- inline functions ------------------------ */
 static inline bool is_entity(const void *thing)
 {
@@ -49,7 +49,7 @@ static unsigned value_size;
 static unsigned max_precision;
 
 /** Exact flag. */
-static bool fc_exact = true;
+static FIRM_THREAD_LOCAL bool fc_exact = true;
 
 static float_descriptor_t long_double_desc;
 
@@ -1178,19 +1178,23 @@ bool fc_is_exact(void)
 void fc_debug(fp_value *value);
 void __attribute__((used)) fc_debug(fp_value *value)
 {
+	size_t const buf_len = sc_get_precision() + 1;
+	char  *const buf     = ALLOCAN(char, buf_len);
 	printf("Class: %d\n", value->clss);
 	printf("Sign: %d\n", value->sign);
-	printf("Exponent: %s\n",
-	       sc_print(_exp(value), sc_get_precision(), SC_HEX, false));
+	printf("Exponent: %s\n", sc_print_buf(buf, buf_len, _exp(value),
+	       sc_get_precision(), SC_HEX, false));
 	printf("Unbiased Exponent: %d\n", fc_get_exponent(value));
-	printf("Mantissa: %s\n",
-	       sc_print(_mant(value), sc_get_precision(), SC_HEX, false));
+	printf("Mantissa: %s\n", sc_print_buf(buf, buf_len, _mant(value),
+	       sc_get_precision(), SC_HEX, false));
 	printf("Mantissa w/o round: ");
 	sc_word *temp = ALLOCAN(sc_word, value_size);
 	sc_shrI(_mant(value), ROUNDING_BITS, temp);
-	printf("%s\n", sc_print(temp, sc_get_precision(), SC_HEX, false));
+	printf("%s\n", sc_print_buf(buf, buf_len, temp, sc_get_precision(), SC_HEX,
+	                            false));
 	printf("Mantissa w/o round implicit one: ");
 	sc_clear_bit_at(temp, value->desc.mantissa_size);
-	printf("%s\n", sc_print(temp, sc_get_precision(), SC_HEX, false));
+	printf("%s\n", sc_print_buf(buf, buf_len, temp, sc_get_precision(), SC_HEX,
+	                            false));
 }
 #endif
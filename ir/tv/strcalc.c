@@ -23,12 +23,86 @@
 
 #define SC_MASK      ((sc_word)0xFF)
 #define SC_RESULT(x) ((x) & SC_MASK)
-#define SC_CARRY(x)  ((unsigned)(x) >> SC_BITS)
 
-static char *output_buffer = NULL;  /**< buffer for output */
+/**
+ * Arithmetic is done on limbs of several digits at once. Values are still
+ * stored as arrays of digits, so tarvals and the float code do not depend on
+ * the host byte order.
+ */
+typedef uint32_t sc_limb;
+typedef uint64_t sc_dlimb;
+#define SC_LIMB_BITS   32
+#define SC_LIMB_DIGITS (SC_LIMB_BITS / SC_BITS)
+
 static unsigned bit_pattern_size;   /**< maximum number of bits */
 static unsigned calc_buffer_size;   /**< size of internally stored values */
-static unsigned max_value_size;     /**< maximum size of values */
+static unsigned calc_buffer_limbs;  /**< number of limbs of stored values */
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ \
+    && SC_BITS == CHAR_BIT
+/* the digits of a limb are already in host order */
+static inline sc_limb load_limb(const sc_word *val, unsigned limb)
+{
+	sc_limb res;
+	memcpy(&res, &val[limb * SC_LIMB_DIGITS], sizeof(res));
+	return res;
+}
+
+static inline void store_limb(sc_word *val, unsigned limb, sc_limb x)
+{
+	memcpy(&val[limb * SC_LIMB_DIGITS], &x, sizeof(x));
+}
+#else
+static inline sc_limb load_limb(const sc_word *val, unsigned limb)
+{
+	const sc_word *p   = &val[limb * SC_LIMB_DIGITS];
+	sc_limb        res = 0;
+	for (unsigned i = 0; i < SC_LIMB_DIGITS; ++i)
+		res |= (sc_limb)p[i] << (i * SC_BITS);
+	return res;
+}
+
+static inline void store_limb(sc_word *val, unsigned limb, sc_limb x)
+{
+	sc_word *p = &val[limb * SC_LIMB_DIGITS];
+	for (unsigned i = 0; i < SC_LIMB_DIGITS; ++i)
+		p[i] = SC_RESULT(x >> (i * SC_BITS));
+}
+#endif
+
+static sc_dlimb load_dlimb(const sc_word *val)
+{
+	return (sc_dlimb)load_limb(val, 1) << SC_LIMB_BITS | load_limb(val, 0);
+}
+
+static void store_dlimb(sc_word *val, sc_dlimb x)
+{
+	store_limb(val, 0, (sc_limb)x);
+	store_limb(val, 1, (sc_limb)(x >> SC_LIMB_BITS));
+}
+
+/**
+ * Returns the number of limbs of @p val without the leading zero limbs.
+ */
+static unsigned get_n_limbs(const sc_word *val)
+{
+	unsigned n = calc_buffer_limbs;
+	while (n > 0 && load_limb(val, n - 1) == 0)
+		--n;
+	return n;
+}
+
+static void load_limbs(const sc_word *val, sc_limb *limbs)
+{
+	for (unsigned i = 0; i < calc_buffer_limbs; ++i)
+		limbs[i] = load_limb(val, i);
+}
+
+static void store_limbs(const sc_limb *limbs, sc_word *val)
+{
+	for (unsigned i = 0; i < calc_buffer_limbs; ++i)
+		store_limb(val, i, limbs[i]);
+}
 
 void sc_zero(sc_word *buffer)
 {
@@ -88,49 +162,53 @@ void sc_andnot(const sc_word *val1, const sc_word *val2, sc_word *buffer)
 
 void sc_inc(sc_word *buffer)
 {
-	for (unsigned counter = 0; counter < calc_buffer_size; ++counter) {
-		sc_word v = buffer[counter];
-		if (v < SC_MASK) {
-			buffer[counter] = v+1;
+	for (unsigned i = 0; i < calc_buffer_limbs; ++i) {
+		sc_limb const v = load_limb(buffer, i) + 1;
+		store_limb(buffer, i, v);
+		if (v != 0)
 			break;
-		}
-		buffer[counter] = 0;
 	}
 }
 
 void sc_neg(const sc_word *val, sc_word *buffer)
 {
-	sc_not(val, buffer);
-	sc_inc(buffer);
+	sc_limb borrow = 0;
+	for (unsigned i = 0; i < calc_buffer_limbs; ++i) {
+		sc_dlimb const diff = 0 - (sc_dlimb)load_limb(val, i) - borrow;
+		store_limb(buffer, i, (sc_limb)diff);
+		borrow = (diff >> SC_LIMB_BITS) & 1;
+	}
 }
 
 void sc_add(const sc_word *val1, const sc_word *val2, sc_word *buffer)
 {
-	sc_word carry = 0;
-	for (unsigned counter = 0; counter < calc_buffer_size; ++counter) {
-		unsigned const sum = val1[counter] + val2[counter] + carry;
-		buffer[counter] = SC_RESULT(sum);
-		carry           = SC_CARRY(sum);
+	sc_limb carry = 0;
+	for (unsigned i = 0; i < calc_buffer_limbs; ++i) {
+		sc_dlimb const sum
+			= (sc_dlimb)load_limb(val1, i) + load_limb(val2, i) + carry;
+		store_limb(buffer, i, (sc_limb)sum);
+		carry = sum >> SC_LIMB_BITS;
 	}
 }
 
 void sc_sub(const sc_word *val1, const sc_word *val2, sc_word *buffer)
 {
-	/* intermediate buffer to hold -val2 */
-	sc_word *temp_buffer = ALLOCAN(sc_word, calc_buffer_size);
-
-	sc_neg(val2, temp_buffer);
-	sc_add(val1, temp_buffer, buffer);
+	sc_limb borrow = 0;
+	for (unsigned i = 0; i < calc_buffer_limbs; ++i) {
+		sc_dlimb const diff
+			= (sc_dlimb)load_limb(val1, i) - load_limb(val2, i) - borrow;
+		store_limb(buffer, i, (sc_limb)diff);
+		borrow = (diff >> SC_LIMB_BITS) & 1;
+	}
 }
 
 void sc_mul(const sc_word *val1, const sc_word *val2, sc_word *buffer)
 {
-	sc_word *temp_buffer = ALLOCANZ(sc_word, calc_buffer_size);
-	sc_word *neg_val1    = ALLOCAN(sc_word, calc_buffer_size);
-	sc_word *neg_val2    = ALLOCAN(sc_word, calc_buffer_size);
+	sc_word *neg_val1 = ALLOCAN(sc_word, calc_buffer_size);
+	sc_word *neg_val2 = ALLOCAN(sc_word, calc_buffer_size);
 
-	/* the multiplication works only for positive values, for negative values *
-	 * it is necessary to negate them and adjust the result accordingly       */
+	/* multiply the absolute values, so that the loops below only run over
+	 * the limbs which are actually used */
 	bool sign = false;
 	if (sc_is_negative(val1)) {
 		sc_neg(val1, neg_val1);
@@ -143,59 +221,81 @@ void sc_mul(const sc_word *val1, const sc_word *val2, sc_word *buffer)
 		sign = !sign;
 	}
 
-	for (unsigned c_outer = 0; c_outer < max_value_size; c_outer++) {
-		sc_word outer = val2[c_outer];
-		if (outer == 0)
-			continue;
-		unsigned carry = 0; /* container for carries */
-		for (unsigned c_inner = 0; c_inner < max_value_size; c_inner++) {
-			sc_word inner = val1[c_inner];
-			/* do the following calculation:
-			 * Add the current carry, the value at position c_outer+c_inner
-			 * and the result of the multiplication of val1[c_inner] and
-			 * val2[c_outer]. This is the usual pen-and-paper multiplication
-			 */
-
-			/* multiplicate the two digits */
-			unsigned const mul = inner*outer;
-			/* add old value to result of multiplication and the carry */
-			unsigned const sum = temp_buffer[c_inner+c_outer] + mul + carry;
-
-			/* all carries together result in new carry. This is always
-			 * smaller than the base b:
-			 * Both multiplicands, the carry and the value already in the
-			 * temp buffer are single digits and their value is therefore
-			 * at most equal to (b-1).
-			 * This leads to:
-			 * (b-1)(b-1)+(b-1)+(b-1) = b*b-1
-			 * The tables list all operations rem b, so the carry is at
-			 * most
-			 * (b*b-1)rem b = -1rem b = b-1
-			 */
-			temp_buffer[c_inner + c_outer] = SC_RESULT(sum);
-			carry                          = SC_CARRY(sum);
+	unsigned const n_limbs1 = get_n_limbs(val1);
+	unsigned const n_limbs2 = get_n_limbs(val2);
+	if (n_limbs1 <= 1 && n_limbs2 <= 1) {
+		/* fast path: the product fits into a native integer */
+		sc_dlimb const mul = (sc_dlimb)load_limb(val1, 0) * load_limb(val2, 0);
+		sc_zero(buffer);
+		store_dlimb(buffer, mul);
+	} else {
+		sc_limb *limbs1 = ALLOCAN(sc_limb, calc_buffer_limbs);
+		sc_limb *res    = ALLOCANZ(sc_limb, calc_buffer_limbs);
+		load_limbs(val1, limbs1);
+		for (unsigned c_outer = 0; c_outer < n_limbs2; ++c_outer) {
+			sc_limb const outer = load_limb(val2, c_outer);
+			if (outer == 0)
+				continue;
+			/* pen-and-paper multiplication, the sum of a limb product and
+			 * two limbs always fits into a double limb */
+			sc_limb  carry   = 0;
+			unsigned c_inner = 0;
+			for (; c_inner < n_limbs1
+			       && c_outer + c_inner < calc_buffer_limbs; ++c_inner) {
+				sc_dlimb const sum = (sc_dlimb)limbs1[c_inner] * outer
+				                   + res[c_outer + c_inner] + carry;
+				res[c_outer + c_inner] = (sc_limb)sum;
+				carry                  = sum >> SC_LIMB_BITS;
+			}
+			if (c_outer + c_inner < calc_buffer_limbs)
+				res[c_outer + c_inner] = carry;
 		}
-
-		/* A carry may hang over */
-		/* c_outer is always smaller than max_value_size! */
-		temp_buffer[max_value_size + c_outer] = carry;
+		store_limbs(res, buffer);
 	}
 
 	if (sign)
-		sc_neg(temp_buffer, buffer);
-	else
-		memcpy(buffer, temp_buffer, calc_buffer_size);
+		sc_neg(buffer, buffer);
+}
+
+static bool limbs_less(const sc_limb *limbs1, const sc_limb *limbs2,
+                       unsigned n_limbs)
+{
+	for (unsigned i = n_limbs; i-- > 0; ) {
+		if (limbs1[i] != limbs2[i])
+			return limbs1[i] < limbs2[i];
+	}
+	return false;
 }
 
 /**
- * Shift the buffer to left and add an sc digit
+ * Divides two positive values given as limbs by shifting the bits of the
+ * dividend into the remainder and subtracting the divisor whenever possible.
+ * @p quot and @p rem must be zero initially.
  */
-static void sc_push(sc_word digit, sc_word *buffer)
-{
-	for (unsigned counter = calc_buffer_size - 1; counter-- > 0; ) {
-		buffer[counter+1] = buffer[counter];
+static void divmod_limbs(const sc_limb *dividend, unsigned n_dividend,
+                         const sc_limb *divisor, unsigned n_divisor,
+                         sc_limb *quot, sc_limb *rem)
+{
+	/* the remainder is always smaller than twice the divisor */
+	unsigned const n_rem = MIN(n_divisor + 1, calc_buffer_limbs);
+	for (unsigned bit = n_dividend * SC_LIMB_BITS; bit-- > 0; ) {
+		sc_limb in = (dividend[bit / SC_LIMB_BITS] >> (bit % SC_LIMB_BITS)) & 1;
+		for (unsigned i = 0; i < n_rem; ++i) {
+			sc_limb const v = rem[i];
+			rem[i] = v << 1 | in;
+			in     = v >> (SC_LIMB_BITS - 1);
+		}
+		if (limbs_less(rem, divisor, n_rem))
+			continue;
+
+		sc_limb borrow = 0;
+		for (unsigned i = 0; i < n_rem; ++i) {
+			sc_dlimb const diff = (sc_dlimb)rem[i] - divisor[i] - borrow;
+			rem[i] = (sc_limb)diff;
+			borrow = (diff >> SC_LIMB_BITS) & 1;
+		}
+		quot[bit / SC_LIMB_BITS] |= (sc_limb)1 << (bit % SC_LIMB_BITS);
 	}
-	buffer[0] = digit;
 }
 
 bool sc_divmod(const sc_word *dividend, const sc_word *divisor,
@@ -210,10 +310,7 @@ bool sc_divmod(const sc_word *dividend, const sc_word *divisor,
 	/* division by zero is not allowed */
 	assert(!sc_is_zero(divisor, calc_buffer_size*SC_BITS));
 
-	/* if the dividend is zero result is zero (quot is zero) */
-	if (sc_is_zero(dividend, calc_buffer_size*SC_BITS))
-		return false;
-
+	/* divide the absolute values and adjust the signs afterwards */
 	bool     div_sign = false;
 	bool     rem_sign = false;
 	sc_word *neg_val1 = ALLOCAN(sc_word, calc_buffer_size);
@@ -225,52 +322,36 @@ bool sc_divmod(const sc_word *dividend, const sc_word *divisor,
 	}
 
 	sc_word *neg_val2 = ALLOCAN(sc_word, calc_buffer_size);
-	sc_neg(divisor, neg_val2);
-	const sc_word *minus_divisor;
 	if (sc_is_negative(divisor)) {
+		sc_neg(divisor, neg_val2);
 		div_sign = !div_sign;
-		minus_divisor = divisor;
 		divisor = neg_val2;
-	} else {
-		minus_divisor = neg_val2;
 	}
 
-	/* if divisor >= dividend division is easy
-	 * (remember these are absolute values) */
-	switch (sc_comp(dividend, divisor)) {
-	case ir_relation_equal: /* dividend == divisor */
-		quot[0] = 1;
-		goto end;
-
-	case ir_relation_less: /* dividend < divisor */
+	unsigned const n_dividend = get_n_limbs(dividend);
+	unsigned const n_divisor  = get_n_limbs(divisor);
+	if (n_divisor > n_dividend) {
+		/* dividend < divisor */
 		memcpy(rem, dividend, calc_buffer_size);
-		goto end;
-
-	default: /* unluckily division is necessary :( */
-		break;
+	} else if (n_dividend <= 2) {
+		/* fast path: both values fit into a native integer */
+		sc_dlimb const val1 = load_dlimb(dividend);
+		sc_dlimb const val2 = load_dlimb(divisor);
+		store_dlimb(quot, val1 / val2);
+		store_dlimb(rem,  val1 % val2);
+	} else {
+		sc_limb *limbs1    = ALLOCAN(sc_limb, calc_buffer_limbs);
+		sc_limb *limbs2    = ALLOCAN(sc_limb, calc_buffer_limbs);
+		sc_limb *quot_limb = ALLOCANZ(sc_limb, calc_buffer_limbs);
+		sc_limb *rem_limb  = ALLOCANZ(sc_limb, calc_buffer_limbs);
+		load_limbs(dividend, limbs1);
+		load_limbs(divisor, limbs2);
+		divmod_limbs(limbs1, n_dividend, limbs2, n_divisor, quot_limb,
+		             rem_limb);
+		store_limbs(quot_limb, quot);
+		store_limbs(rem_limb, rem);
 	}
 
-	for (unsigned c_dividend = calc_buffer_size; c_dividend-- > 0; ) {
-		sc_push(dividend[c_dividend], rem);
-		sc_push(0, quot);
-
-		if (sc_comp(rem, divisor) != ir_relation_less) {
-			/* remainder >= divisor */
-			/* subtract until the remainder becomes negative, this should
-			 * be faster than comparing remainder with divisor  */
-			sc_add(rem, minus_divisor, rem);
-
-			while (!sc_is_negative(rem)) {
-				/* TODO can this generate carry or is masking redundant? */
-				quot[0] = SC_RESULT(quot[0] + 1);
-				sc_add(rem, minus_divisor, rem);
-			}
-
-			/* subtracted one too much */
-			sc_add(rem, divisor, rem);
-		}
-	}
-end:
 	if (div_sign)
 		sc_neg(quot, quot);
 
@@ -477,20 +558,15 @@ ir_relation sc_comp(const sc_word* const val1, const sc_word* const val2)
 	if (val1_negative != val2_negative)
 		return val1_negative ? ir_relation_less : ir_relation_greater;
 
-	/* loop until two digits differ, the values are equal if there
-	 * are no such two digits */
-	unsigned counter = calc_buffer_size - 1;
-	while (val1[counter] == val2[counter]) {
-		if (counter == 0)
-			return ir_relation_equal;
-		counter--;
+	/* loop until two limbs differ, the values are equal if there
+	 * are no such two limbs */
+	for (unsigned i = calc_buffer_limbs; i-- > 0; ) {
+		sc_limb const limb1 = load_limb(val1, i);
+		sc_limb const limb2 = load_limb(val2, i);
+		if (limb1 != limb2)
+			return limb1 > limb2 ? ir_relation_greater : ir_relation_less;
 	}
-
-	/* the leftmost digit is the most significant, so this returns
-	 * the correct result.
-	 * This implies the digit enum is ordered */
-	return val1[counter] > val2[counter]
-	     ? ir_relation_greater : ir_relation_less;
+	return ir_relation_equal;
 }
 
 int sc_get_highest_set_bit(const sc_word *value)
@@ -603,7 +679,7 @@ void sc_val_from_bytes(unsigned char const *const bytes, size_t n_bytes,
 	sc_word *p = buffer;
 	assert(SC_BITS == CHAR_BIT);
 	memcpy(p, bytes, n_bytes);
-	memset(p+n_bytes, 0, buffer+calc_buffer_size-p);
+	memset(p+n_bytes, 0, calc_buffer_size-n_bytes);
 }
 
 void sc_val_to_bytes(const sc_word *buffer, unsigned char *const dest,
@@ -662,13 +738,6 @@ clear_rest:
 	memset(p, 0, buffer+calc_buffer_size - p);
 }
 
-const char *sc_print(const sc_word *value, unsigned bits, enum base_t base,
-                     bool is_signed)
-{
-	return sc_print_buf(output_buffer, bit_pattern_size+1, value, bits,
-	                    base, is_signed);
-}
-
 char *sc_print_buf(char *buf, size_t buf_len, const sc_word *value,
                    unsigned bits, enum base_t base, bool is_signed)
 {
@@ -767,23 +836,22 @@ char *sc_print_buf(char *buf, size_t buf_len, const sc_word *value,
 
 void init_strcalc(unsigned precision)
 {
-	if (output_buffer == NULL) {
+	if (bit_pattern_size == 0) {
 		/* round up to multiple of SC_BITS */
 		assert(is_po2_or_zero(SC_BITS));
 		precision = (precision + (SC_BITS-1)) & ~(SC_BITS-1);
 
-		bit_pattern_size = precision;
-		calc_buffer_size = precision / (SC_BITS/2);
-		max_value_size   = precision / SC_BITS;
-
-		output_buffer = XMALLOCN(char, bit_pattern_size + 1);
+		bit_pattern_size  = precision;
+		calc_buffer_size  = round_up2(precision / (SC_BITS/2), SC_LIMB_DIGITS);
+		calc_buffer_limbs = calc_buffer_size / SC_LIMB_DIGITS;
+		/* the fast paths use native integers of two limbs */
+		assert(calc_buffer_limbs >= 2);
 	}
 }
 
 void finish_strcalc(void)
 {
-	free(output_buffer);
-	output_buffer = NULL;
+	bit_pattern_size = 0;
 }
 
 unsigned sc_get_precision(void)
@@ -217,21 +217,11 @@ bool sc_is_all_one(const sc_word *value, unsigned num_bits);
 unsigned char sc_sub_bits(const sc_word *value, unsigned len,
                           unsigned byte_ofs);
 
-/**
- * Converts a tarval into a string.
- *
- * @param val1        the value pointer
- * @param bits        number of valid bits in this value
- * @param base        output base
- * @param signed_mode print it signed (only decimal mode supported
- */
-const char *sc_print(const sc_word *val1, unsigned bits, enum base_t base,
-                     bool signed_mode);
-
 /**
  * Write value into string. The buffer is filled from the end, use the return
  * value to get the real start position of the string!
  * If the buffer is too small for the value, the behavior is undefined!
+ * A buffer of sc_get_precision() + 1 characters is always large enough.
  */
 char *sc_print_buf(char *buf, size_t buf_len, const sc_word *val, unsigned bits,
                    enum base_t base, bool is_signed);
@@ -27,6 +27,7 @@
 #include "irmode_t.h"
 #include "irnode_t.h"
 #include "irprintf.h"
+#include "lock.h"
 #include "panic.h"
 #include "set.h"
 #include "strcalc.h"
@@ -44,6 +45,8 @@
 
 /** A set containing all existing tarvals. */
 static struct set *tarvals = NULL;
+/** Protects the tarvals set. */
+static firm_lock_t tarvals_lock = FIRM_LOCK_INIT;
 
 static unsigned sc_value_length;
 static unsigned fp_value_size;
@@ -71,8 +74,11 @@ static int cmp_tv(const void *p1, const void *p2, size_t n)
 static ir_tarval *identify_tarval(ir_tarval const *const tv)
 {
 	unsigned hash = hash_tv(tv);
-	return set_insert(ir_tarval, tarvals, tv, sizeof(ir_tarval) + tv->length,
-	                  hash);
+	firm_lock(&tarvals_lock);
+	ir_tarval *const res = set_insert(ir_tarval, tarvals, tv,
+	                                  sizeof(ir_tarval) + tv->length, hash);
+	firm_unlock(&tarvals_lock);
+	return res;
 }
 
 static ir_tarval *get_fp_tarval(const fp_value *value, ir_mode *mode)
@@ -143,6 +149,84 @@ static const float_descriptor_t *get_descriptor(const ir_mode *mode)
 	return &mode->float_desc;
 }
 
+/**
+ * The value of a vector tarval is the array of its lane tarvals. Lane tarvals
+ * are unique, so two vectors are equal if their arrays are.
+ */
+static ir_tarval *get_lane(ir_tarval const *tv, unsigned lane)
+{
+	ir_tarval *res;
+	memcpy(&res, tv->value + lane * sizeof(res), sizeof(res));
+	return res;
+}
+
+static ir_tarval *get_vector_tarval(ir_tarval *const *lanes, ir_mode *mode)
+{
+	unsigned const n_lanes = get_mode_vector_n_lanes(mode);
+	for (unsigned i = 0; i < n_lanes; ++i) {
+		/* the vector has no value if one of its lanes has none */
+		if (lanes[i] == tarval_bad)
+			return tarval_bad;
+		assert(lanes[i]->mode == get_mode_vector_element_mode(mode));
+	}
+	unsigned   const size = n_lanes * sizeof(*lanes);
+	ir_tarval *const tv   = ALLOCAF(ir_tarval, value, size);
+	tv->kind   = k_tarval;
+	tv->mode   = mode;
+	tv->length = size;
+	memcpy(tv->value, lanes, size);
+	return identify_tarval(tv);
+}
+
+static ir_tarval *get_vector_splat(ir_tarval *lane, ir_mode *mode)
+{
+	unsigned    const n_lanes = get_mode_vector_n_lanes(mode);
+	ir_tarval **const lanes   = ALLOCAN(ir_tarval*, n_lanes);
+	for (unsigned i = 0; i < n_lanes; ++i)
+		lanes[i] = lane;
+	return get_vector_tarval(lanes, mode);
+}
+
+typedef ir_tarval *vector_unop_func(ir_tarval const *a);
+typedef ir_tarval *vector_binop_func(ir_tarval const *a, ir_tarval const *b);
+
+/** Applies @p op to each lane of the vector @p a. */
+static ir_tarval *vector_unop(ir_tarval const *a, vector_unop_func *op)
+{
+	ir_mode    *const mode    = a->mode;
+	unsigned    const n_lanes = get_mode_vector_n_lanes(mode);
+	ir_tarval **const lanes   = ALLOCAN(ir_tarval*, n_lanes);
+	for (unsigned i = 0; i < n_lanes; ++i)
+		lanes[i] = op(get_lane(a, i));
+	return get_vector_tarval(lanes, mode);
+}
+
+/** Applies @p op to each pair of lanes of the vectors @p a and @p b. */
+static ir_tarval *vector_binop(ir_tarval const *a, ir_tarval const *b,
+                               vector_binop_func *op)
+{
+	ir_mode *const mode = a->mode;
+	assert(b->mode == mode);
+	unsigned    const n_lanes = get_mode_vector_n_lanes(mode);
+	ir_tarval **const lanes   = ALLOCAN(ir_tarval*, n_lanes);
+	for (unsigned i = 0; i < n_lanes; ++i)
+		lanes[i] = op(get_lane(a, i), get_lane(b, i));
+	return get_vector_tarval(lanes, mode);
+}
+
+ir_tarval *new_tarval_from_lanes(ir_mode *mode, ir_tarval *const *lanes)
+{
+	assert(mode_is_vector(mode));
+	return get_vector_tarval(lanes, mode);
+}
+
+ir_tarval *get_tarval_lane(ir_tarval const *tv, unsigned lane)
+{
+	assert(mode_is_vector(tv->mode));
+	assert(lane < get_mode_vector_n_lanes(tv->mode));
+	return get_lane(tv, lane);
+}
+
 ir_tarval *new_integer_tarval_from_str(const char *str, size_t len,
                                        int negative, unsigned char base,
                                        ir_mode *mode)
@@ -218,6 +302,7 @@ ir_tarval *new_tarval_from_str(const char *str, size_t len, ir_mode *mode)
 	case irms_auxiliary:
 	case irms_data:
 	case irms_internal_boolean:
+	case irms_vector:
 		break;
 	}
 	panic("unsupported tarval creation with mode %F", mode);
@@ -248,6 +333,16 @@ ir_tarval *new_tarval_nan(ir_mode *mode, int signaling,
 ir_tarval *new_tarval_from_bytes(unsigned char const *buf,
                                  ir_mode *mode)
 {
+	if (mode_is_vector(mode)) {
+		ir_mode    *const elem_mode = get_mode_vector_element_mode(mode);
+		unsigned    const elem_size = get_mode_size_bytes(elem_mode);
+		unsigned    const n_lanes   = get_mode_vector_n_lanes(mode);
+		ir_tarval **const lanes     = ALLOCAN(ir_tarval*, n_lanes);
+		for (unsigned i = 0; i < n_lanes; ++i)
+			lanes[i] = new_tarval_from_bytes(buf + i * elem_size, elem_mode);
+		return get_vector_tarval(lanes, mode);
+	}
+
 	switch (get_mode_arithmetic(mode)) {
 	case irma_twos_complement: {
 		unsigned bits    = get_mode_size_bits(mode);
@@ -270,6 +365,15 @@ ir_tarval *new_tarval_from_bytes(unsigned char const *buf,
 
 void tarval_to_bytes(unsigned char *buffer, ir_tarval const *tv)
 {
+	ir_mode *const tv_mode = get_tarval_mode(tv);
+	if (mode_is_vector(tv_mode)) {
+		ir_mode *const elem_mode = get_mode_vector_element_mode(tv_mode);
+		unsigned const elem_size = get_mode_size_bytes(elem_mode);
+		for (unsigned i = 0, n = get_mode_vector_n_lanes(tv_mode); i < n; ++i)
+			tarval_to_bytes(buffer + i * elem_size, get_lane(tv, i));
+		return;
+	}
+
 	switch (get_mode_arithmetic(get_tarval_mode(tv))) {
 	case irma_ieee754:
 	case irma_x86_extended_float:
@@ -473,6 +577,17 @@ void init_mode_values(ir_mode* mode)
 		break;
 	}
 
+	case irms_vector: {
+		ir_mode *const elem_mode = get_mode_vector_element_mode(mode);
+		mode->all_one   = get_vector_splat(get_mode_all_one(elem_mode), mode);
+		mode->infinity  = tarval_bad;
+		mode->min       = tarval_bad;
+		mode->max       = tarval_bad;
+		mode->null      = get_vector_splat(get_mode_null(elem_mode), mode);
+		mode->one       = get_vector_splat(get_mode_one(elem_mode), mode);
+		break;
+	}
+
 	case irms_auxiliary:
 	case irms_data:
 		mode->all_one   = tarval_bad;
@@ -502,6 +617,7 @@ int tarval_is_negative(ir_tarval const *const a)
 	case irms_auxiliary:
 	case irms_internal_boolean:
 	case irms_data:
+	case irms_vector:
 		break;
 	}
 	panic("invalid mode sort");
@@ -564,6 +680,10 @@ ir_relation tarval_cmp(ir_tarval const *const a, ir_tarval const *const b)
 			return ir_relation_equal;
 		return a == tarval_b_true ? ir_relation_greater : ir_relation_less;
 
+	case irms_vector:
+		/* vectors are unordered, lanes holding a NaN are equal though */
+		return a == b ? ir_relation_equal : ir_relation_less_greater;
+
 	case irms_auxiliary:
 	case irms_data:
 		break;
@@ -617,6 +737,7 @@ ir_tarval *tarval_convert_to(ir_tarval const *const src,
 		case irms_internal_boolean:
 		case irms_auxiliary:
 		case irms_data:
+		case irms_vector:
 			break;
 		}
 		/* the rest can't be converted */
@@ -637,20 +758,23 @@ ir_tarval *tarval_convert_to(ir_tarval const *const src,
 			/* XXX floating point unit does not understand internal integer
 			 * representation, convert to string first, then create float from
 			 * string */
-			char *buffer = ALLOCAN(char, 100);
+			size_t const buf_len = sc_get_precision() + 1;
+			char  *const buffer  = ALLOCAN(char, buf_len);
 			/* decimal string representation because hexadecimal output is
 			 * interpreted unsigned by fc_val_from_str, so this is a HACK */
-			int len = snprintf(buffer, 100, "%s",
-				sc_print(src->value, get_mode_size_bits(src->mode), SC_DEC, mode_is_signed(src->mode)));
+			const char *str = sc_print_buf(buffer, buf_len, src->value,
+			                               get_mode_size_bits(src->mode), SC_DEC,
+			                               mode_is_signed(src->mode));
 
 			fp_value *fpval = (fp_value*)ALLOCAN(char, fp_value_size);
-			fc_val_from_str(buffer, len, fpval);
+			fc_val_from_str(str, strlen(str), fpval);
 			fc_cast(fpval, get_descriptor(dst_mode), fpval);
 			return get_fp_tarval(fpval, dst_mode);
 		}
 		case irms_auxiliary:
 		case irms_data:
 		case irms_internal_boolean:
+		case irms_vector:
 			break;
 		}
 		break;
@@ -672,6 +796,7 @@ ir_tarval *tarval_convert_to(ir_tarval const *const src,
 	case irms_auxiliary:
 	case irms_data:
 	case irms_internal_boolean:
+	case irms_vector:
 		return tarval_bad;
 	}
 
@@ -697,6 +822,8 @@ ir_tarval *tarval_not(ir_tarval const *const a)
 	ir_mode *const mode = a->mode;
 	if (get_mode_sort(mode) == irms_internal_boolean)
 		return a == tarval_b_true ? tarval_b_false : tarval_b_true;
+	if (mode_is_vector(mode))
+		return vector_unop(a, tarval_not);
 
 	assert(get_mode_arithmetic(mode) == irma_twos_complement);
 	sc_word *const buffer = ALLOCAN(sc_word, sc_value_length);
@@ -721,6 +848,9 @@ ir_tarval *tarval_neg(ir_tarval const *const a)
 		return get_fp_tarval(buffer, mode);
 	}
 
+	case irms_vector:
+		return vector_unop(a, tarval_neg);
+
 	case irms_auxiliary:
 	case irms_data:
 	case irms_internal_boolean:
@@ -756,6 +886,9 @@ ir_tarval *tarval_add(ir_tarval const *a, ir_tarval const *b)
 		return get_fp_tarval(buffer, mode);
 	}
 
+	case irms_vector:
+		return vector_binop(a, b, tarval_add);
+
 	case irms_auxiliary:
 	case irms_data:
 	case irms_internal_boolean:
@@ -797,6 +930,9 @@ ir_tarval *tarval_sub(ir_tarval const *a, ir_tarval const *b)
 		return get_fp_tarval(buffer, dst_mode);
 	}
 
+	case irms_vector:
+		return vector_binop(a, b, tarval_sub);
+
 	case irms_auxiliary:
 	case irms_data:
 	case irms_internal_boolean:
@@ -825,6 +961,9 @@ ir_tarval *tarval_mul(ir_tarval const *const a, ir_tarval const *const b)
 		return get_fp_tarval(buffer, mode);
 	}
 
+	case irms_vector:
+		return vector_binop(a, b, tarval_mul);
+
 	case irms_auxiliary:
 	case irms_data:
 	case irms_internal_boolean:
@@ -859,6 +998,7 @@ ir_tarval *tarval_div(ir_tarval const *const a, ir_tarval const *const b)
 	case irms_auxiliary:
 	case irms_data:
 	case irms_internal_boolean:
+	case irms_vector:
 		panic("operation not defined on mode");
 	}
 	panic("invalid mode sort");
@@ -910,6 +1050,9 @@ ir_tarval *tarval_and(ir_tarval const *const a, ir_tarval const *const b)
 	if (get_mode_sort(mode) == irms_internal_boolean)
 		return a == tarval_b_false ? (ir_tarval*)a : (ir_tarval*)b;
 
+	if (mode_is_vector(mode))
+		return vector_binop(a, b, tarval_and);
+
 	assert(get_mode_arithmetic(mode) == irma_twos_complement);
 	sc_word *const buffer = ALLOCAN(sc_word, sc_value_length);
 	sc_and(a->value, b->value, buffer);
@@ -923,6 +1066,9 @@ ir_tarval *tarval_andnot(ir_tarval const *const a, ir_tarval const *const b)
 	if (get_mode_sort(mode) == irms_internal_boolean)
 		return a == tarval_b_true && b == tarval_b_false ? tarval_b_true
 		                                                 : tarval_b_false;
+	if (mode_is_vector(mode))
+		return vector_binop(a, b, tarval_andnot);
+
 	assert(get_mode_arithmetic(mode) == irma_twos_complement);
 	sc_word *const buffer = ALLOCAN(sc_word, sc_value_length);
 	sc_andnot(a->value, b->value, buffer);
@@ -936,6 +1082,9 @@ ir_tarval *tarval_or(ir_tarval const *const a, ir_tarval const *const b)
 	if (get_mode_sort(mode) == irms_internal_boolean)
 		return a == tarval_b_true ? (ir_tarval*)a : (ir_tarval*)b;
 
+	if (mode_is_vector(mode))
+		return vector_binop(a, b, tarval_or);
+
 	assert(get_mode_arithmetic(mode) == irma_twos_complement);
 	sc_word *const buffer = ALLOCAN(sc_word, sc_value_length);
 	sc_or(a->value, b->value, buffer);
@@ -949,6 +1098,9 @@ ir_tarval *tarval_ornot(ir_tarval const *const a, ir_tarval const *const b)
 	if (get_mode_sort(mode) == irms_internal_boolean)
 		return a == tarval_b_true || b == tarval_b_false ? tarval_b_true
 		                                                 : tarval_b_false;
+	if (mode_is_vector(mode))
+		return vector_binop(a, b, tarval_ornot);
+
 	assert(get_mode_arithmetic(mode) == irma_twos_complement);
 	sc_word *const buffer = ALLOCAN(sc_word, sc_value_length);
 	sc_ornot(a->value, b->value, buffer);
@@ -962,6 +1114,9 @@ ir_tarval *tarval_eor(ir_tarval const *const a, ir_tarval const *const b)
 	if (get_mode_sort(mode) == irms_internal_boolean)
 		return a == b ? tarval_b_false : tarval_b_true;
 
+	if (mode_is_vector(mode))
+		return vector_binop(a, b, tarval_eor);
+
 	assert(get_mode_arithmetic(mode) == irma_twos_complement);
 	sc_word *const buffer = ALLOCAN(sc_word, sc_value_length);
 	sc_xor(a->value, b->value, buffer);
@@ -1090,8 +1245,11 @@ int tarval_snprintf(char *buf, size_t len, ir_tarval const *tv)
 			return snprintf(buf, len, "NULL");
 		/* FALLTHROUGH */
 	case irms_int_number: {
-		unsigned    bits = get_mode_size_bits(tv->mode);
-		const char *str  = sc_print(tv->value, bits, SC_HEX, 0);
+		size_t const buf_len = sc_get_precision() + 1;
+		char  *const buffer  = ALLOCAN(char, buf_len);
+		unsigned     bits    = get_mode_size_bits(tv->mode);
+		const char  *str     = sc_print_buf(buffer, buf_len, tv->value, bits,
+		                                    SC_HEX, false);
 		return snprintf(buf, len, "0x%s", str);
 	}
 
@@ -1102,6 +1260,19 @@ int tarval_snprintf(char *buf, size_t len, ir_tarval const *tv)
 		return snprintf(buf, len, "%s",
 		                (tv == tarval_b_true) ? "true" : "false");
 
+	case irms_vector: {
+		int res = snprintf(buf, len, "<");
+		for (unsigned i = 0, n = get_mode_vector_n_lanes(tv->mode); i < n; ++i) {
+			size_t const pos = MIN((size_t)res, len);
+			res += snprintf(buf + pos, len - pos, i == 0 ? "" : ", ");
+			size_t const lane_pos = MIN((size_t)res, len);
+			res += tarval_snprintf(buf + lane_pos, len - lane_pos,
+			                       get_lane(tv, i));
+		}
+		size_t const pos = MIN((size_t)res, len);
+		return res + snprintf(buf + pos, len - pos, ">");
+	}
+
 	default:
 		if (tv == tarval_bad)
 			return snprintf(buf, len, "<TV_BAD>");
@@ -1133,12 +1304,14 @@ const char *ir_tarval_to_ascii(char *buf, size_t len, ir_tarval const *tv)
 	case irms_int_number:
 		return sc_print_buf(buf, len, tv->value, get_mode_size_bits(mode),
 		                    SC_HEX, 0);
-	case irms_float_number: {
+	case irms_float_number:
+	case irms_vector: {
 		/* fc_print is not specific enough for nans/infs, so we simply dump the
 		 * bit representation in hex. */
 		unsigned       size  = get_mode_size_bytes(mode);
 		unsigned char *bytes = ALLOCAN(unsigned char, size);
-		fc_val_to_bytes((const fp_value*)tv->value, bytes);
+		assert(len > size * 2);
+		tarval_to_bytes(bytes, tv);
 		for (size_t i = 0; i < size; ++i) {
 			unsigned char bits = bytes[i];
 			buf[i*2]   = hexchar(bits & 0xf);
@@ -1166,16 +1339,15 @@ ir_tarval *ir_tarval_from_ascii(const char *buf, ir_mode *mode)
 	case irms_internal_boolean:
 	case irms_int_number:
 		return new_integer_tarval_from_str(buf, len, false, 16, mode);
-	case irms_float_number: {
+	case irms_float_number:
+	case irms_vector: {
 		unsigned       size = get_mode_size_bytes(mode);
 		unsigned char *temp = ALLOCAN(unsigned char, size);
 		for (size_t i = 0; i < size; ++i) {
 			unsigned char val = hexval(buf[i*2]) | (hexval(buf[i*2+1]) << 4);
 			temp[i] = val;
 		}
-		fp_value *const buffer = (fp_value*)ALLOCAN(char, fp_value_size);
-		fc_val_from_bytes(buffer, temp, get_descriptor(mode));
-		return get_fp_tarval(buffer, mode);
+		return new_tarval_from_bytes(temp, mode);
 	}
 	case irms_data:
 	case irms_auxiliary:
@@ -1190,6 +1362,13 @@ ir_tarval *ir_tarval_from_ascii(const char *buf, ir_mode *mode)
 
 unsigned char get_tarval_sub_bits(ir_tarval const *tv, unsigned byte_ofs)
 {
+	if (mode_is_vector(tv->mode)) {
+		ir_mode *const elem_mode = get_mode_vector_element_mode(tv->mode);
+		unsigned const elem_size = get_mode_size_bytes(elem_mode);
+		return get_tarval_sub_bits(get_lane(tv, byte_ofs / elem_size),
+		                           byte_ofs % elem_size);
+	}
+
 	switch (get_mode_arithmetic(tv->mode)) {
 	case irma_twos_complement:
 		return sc_sub_bits(tv->value, get_mode_size_bits(tv->mode), byte_ofs);
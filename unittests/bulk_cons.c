@@ -0,0 +1,99 @@
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+
+/* f(x) { int s = x; while (s < 10) s = s + 1; return (s + 1) - (s + 1); }
+ * The loop header and its Phi are created before the bulk, the duplicated
+ * additions in the loop body during it. */
+int main(void)
+{
+	ir_init();
+
+	ir_type *int_type = new_type_primitive(get_modeIs());
+	ir_type *mtp      = new_type_method(1, 1, false, cc_cdecl_set,
+	                                    mtp_no_property);
+	set_method_param_type(mtp, 0, int_type);
+	set_method_res_type(mtp, 0, int_type);
+	ir_entity *ent = new_global_entity(get_glob_type(), new_id_from_str("f"),
+	                                   mtp, ir_visibility_external,
+	                                   IR_LINKAGE_DEFAULT);
+	ir_graph  *irg = new_ir_graph(ent, 1);
+	set_current_ir_graph(irg);
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
+
+	set_value(0, new_Proj(get_irg_args(irg), get_modeIs(), 0));
+	ir_node *jmp  = new_Jmp();
+	ir_node *head = new_immBlock();
+	add_immBlock_pred(head, jmp);
+	set_cur_block(head);
+	ir_node *phi  = get_value(0, get_modeIs());
+	ir_node *cmp  = new_Cmp(phi, new_Const_long(get_modeIs(), 10),
+	                        ir_relation_less);
+	ir_node *cond = new_Cond(cmp);
+	ir_node *body = new_immBlock();
+	add_immBlock_pred(body, new_Proj(cond, get_modeX(), pn_Cond_true));
+	mature_immBlock(body);
+	ir_node *exit = new_immBlock();
+	set_cur_block(body);
+
+	irg_begin_bulk_cons(irg, 64);
+	ir_node *one0 = new_Const_long(get_modeIs(), 1);
+	ir_node *add0 = new_Add(phi, one0);
+	ir_node *one1 = new_Const_long(get_modeIs(), 1);
+	ir_node *add1 = new_Add(phi, one1);
+	assert(add0 != add1);
+	set_value(0, add1);
+	add_immBlock_pred(head, new_Jmp());
+	mature_immBlock(head);
+
+	/* two equal memory Phis, both kept alive */
+	ir_node *in[]  = { get_irg_initial_mem(irg), get_irg_no_mem(irg) };
+	ir_node *keep0 = new_r_Phi_loop(head, 2, in);
+	ir_node *keep1 = new_r_Phi_loop(head, 2, in);
+
+	ir_node *proj0 = new_Proj(cond, get_modeX(), pn_Cond_false);
+	ir_node *proj1 = new_Proj(cond, get_modeX(), pn_Cond_false);
+	add_immBlock_pred(exit, proj1);
+	mature_immBlock(exit);
+	set_cur_block(exit);
+	ir_node *sum0 = new_Add(phi, new_Const_long(get_modeIs(), 1));
+	ir_node *sum1 = new_Add(phi, new_Const_long(get_modeIs(), 1));
+	ir_node *res[] = { new_Sub(sum0, sum1) };
+	ir_node *ret   = new_Return(get_store(), 1, res);
+	irg_commit_bulk_cons(irg);
+
+	/* references from before the bulk are redirected, too; the in arrays
+	 * are inspected directly as the getters skip Id nodes themselves */
+	assert(proj0 != proj1 && keep0 != keep1);
+	assert(get_Phi_pred_arr(phi)[1] == add0);
+	assert(get_Block_cfgpred_arr(exit)[0] == proj0);
+	ir_node  *end  = get_irg_end(irg);
+	ir_node **kept = get_End_keepalive_arr(end);
+	for (int i = 0, n = get_End_n_keepalives(end); i < n; ++i)
+		assert(!is_Id(kept[i]));
+	set_cur_block(body);
+	assert(get_value(0, get_modeIs()) == add0);
+
+	/* the difference of the merged additions is optimized again */
+	ir_node *res0 = get_Return_res(ret, 0);
+	assert(is_Const(res0) && is_Const_null(res0));
+
+	/* the out edges are back, also for the nodes not yet reachable */
+	assert(edges_activated(irg));
+	assert(irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES));
+	assert(get_irn_n_edges(add0) == 1);
+	assert(get_edge_src_irn(get_irn_out_edge_first(add0)) == phi);
+	assert(get_irn_n_edges(res0) == 1);
+	assert(get_edge_src_irn(get_irn_out_edge_first(res0)) == ret);
+
+	/* immBlock preds are not tracked by the edges, so only verify the
+	 * finished graph with fresh ones */
+	edges_deactivate(irg);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	assure_irg_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUT_EDGES);
+	assert(irg_verify(irg));
+
+	return 0;
+}
@@ -0,0 +1,194 @@
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+
+#define MAX_BLOCKS 16
+
+typedef struct graph_t {
+	ir_graph *irg;
+	ir_node  *start; /**< S */
+	ir_node  *a;     /**< then block A */
+	ir_node  *b;     /**< else block B */
+	ir_node  *head;  /**< loop header H */
+	ir_node  *body;  /**< loop body L */
+} graph_t;
+
+/* S: if (true) A else B; A, B: goto H; H: while (s < 10) L: s = s + 1;
+ * return s
+ * Built without local optimizations to keep the constant condition. */
+static void build_graph(graph_t *g, ir_entity *ent)
+{
+	ir_graph *irg = new_ir_graph(ent, 1);
+	set_current_ir_graph(irg);
+	set_optimize(0);
+	g->irg   = irg;
+	g->start = get_r_cur_block(irg);
+
+	set_value(0, new_Proj(get_irg_args(irg), get_modeIs(), 0));
+	ir_node *cond = new_Cond(new_Const(tarval_b_true));
+	ir_node *t    = new_Proj(cond, get_modeX(), pn_Cond_true);
+	ir_node *f    = new_Proj(cond, get_modeX(), pn_Cond_false);
+	g->a = new_immBlock();
+	add_immBlock_pred(g->a, t);
+	mature_immBlock(g->a);
+	g->b = new_immBlock();
+	add_immBlock_pred(g->b, f);
+	mature_immBlock(g->b);
+
+	g->head = new_immBlock();
+	set_cur_block(g->a);
+	add_immBlock_pred(g->head, new_Jmp());
+	set_cur_block(g->b);
+	add_immBlock_pred(g->head, new_Jmp());
+	set_cur_block(g->head);
+	ir_node *cmp  = new_Cmp(get_value(0, get_modeIs()),
+	                        new_Const_long(get_modeIs(), 10), ir_relation_less);
+	ir_node *loop = new_Cond(cmp);
+
+	g->body = new_immBlock();
+	add_immBlock_pred(g->body, new_Proj(loop, get_modeX(), pn_Cond_true));
+	mature_immBlock(g->body);
+	set_cur_block(g->body);
+	set_value(0, new_Add(get_value(0, get_modeIs()),
+	                     new_Const_long(get_modeIs(), 1)));
+	add_immBlock_pred(g->head, new_Jmp());
+	mature_immBlock(g->head);
+
+	ir_node *exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(loop, get_modeX(), pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+	ir_node *res[] = { get_value(0, get_modeIs()) };
+	ir_node *ret   = new_Return(get_store(), 1, res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	set_optimize(1);
+}
+
+typedef struct snapshot_t {
+	size_t   n_blocks;
+	ir_node *blocks[MAX_BLOCKS];
+	ir_node *idom[MAX_BLOCKS];
+	ir_node *ipostdom[MAX_BLOCKS];
+} snapshot_t;
+
+static void collect_block(ir_node *block, void *data)
+{
+	snapshot_t *snap = (snapshot_t*)data;
+	assert(snap->n_blocks < MAX_BLOCKS);
+	snap->blocks[snap->n_blocks++] = block;
+}
+
+static bool is_reachable(ir_graph *irg, ir_node *block)
+{
+	/* unreachable blocks have a Bad immediate dominator */
+	ir_node *idom = get_Block_idom(block);
+	return block == get_irg_start_block(irg) || (idom != NULL && !is_Bad(idom));
+}
+
+/** Compares the dominator (and post dominator) trees with recomputed ones. */
+static void check_dominance(ir_graph *irg, bool post)
+{
+	snapshot_t snap = { .n_blocks = 0 };
+	irg_block_walk_graph(irg, collect_block, NULL, &snap);
+	bool dominates[MAX_BLOCKS][MAX_BLOCKS];
+	for (size_t i = 0; i < snap.n_blocks; ++i) {
+		ir_node *block = snap.blocks[i];
+		snap.idom[i] = get_Block_idom(block);
+		if (post)
+			snap.ipostdom[i] = get_Block_ipostdom(block);
+		for (size_t j = 0; j < snap.n_blocks; ++j)
+			dominates[i][j] = block_dominates(block, snap.blocks[j]);
+	}
+
+	compute_doms(irg);
+	if (post)
+		compute_postdoms(irg);
+	for (size_t i = 0; i < snap.n_blocks; ++i) {
+		ir_node *block = snap.blocks[i];
+		assert(snap.idom[i] == get_Block_idom(block));
+		if (post)
+			assert(snap.ipostdom[i] == get_Block_ipostdom(block));
+		if (!is_reachable(irg, block))
+			continue;
+		for (size_t j = 0; j < snap.n_blocks; ++j) {
+			if (is_reachable(irg, snap.blocks[j]))
+				assert(dominates[i][j]
+				       == (bool)block_dominates(block, snap.blocks[j]));
+		}
+	}
+}
+
+/** Changes a control flow predecessor, the outs become invalid then. */
+static void set_cfgpred(ir_node *block, int pos, ir_node *pred)
+{
+	set_Block_cfgpred(block, pos, pred);
+	clear_irg_properties(get_irn_irg(block),
+	                     IR_GRAPH_PROPERTY_CONSISTENT_OUTS);
+}
+
+static ir_node *get_cfgpred(ir_node *block, int pos)
+{
+	return get_Block_cfgpred(block, pos);
+}
+
+int main(void)
+{
+	ir_init();
+
+	ir_type *int_type = new_type_primitive(get_modeIs());
+	ir_type *mtp      = new_type_method(1, 1, false, cc_cdecl_set,
+	                                    mtp_no_property);
+	set_method_param_type(mtp, 0, int_type);
+	set_method_res_type(mtp, 0, int_type);
+
+	/* jump threading folds the constant condition and keeps the dominance,
+	 * the loop header is dominated by the then block afterwards */
+	graph_t g;
+	build_graph(&g, new_global_entity(get_glob_type(), id_unique("f"), mtp,
+	                                  ir_visibility_external,
+	                                  IR_LINKAGE_DEFAULT));
+	assure_irg_properties(g.irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE);
+	assert(get_Block_idom(g.head) == g.start);
+	opt_jumpthreading(g.irg);
+	assert(irg_has_properties(g.irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE));
+	assert(get_Block_idom(g.head) == g.a);
+	check_dominance(g.irg, false);
+
+	build_graph(&g, new_global_entity(get_glob_type(), id_unique("f"), mtp,
+	                                  ir_visibility_external,
+	                                  IR_LINKAGE_DEFAULT));
+	/* the loop body has to reach the End without the back edge */
+	keep_alive(g.body);
+	assure_irg_properties(g.irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE
+	                           | IR_GRAPH_PROPERTY_CONSISTENT_POSTDOMINANCE);
+
+	/* remove and restore the back edge */
+	ir_node *back = get_cfgpred(g.head, 2);
+	set_cfgpred(g.head, 2, new_r_Bad(g.irg, get_modeX()));
+	dom_delete_edge(g.body, g.head);
+	check_dominance(g.irg, true);
+	set_cfgpred(g.head, 2, back);
+	dom_insert_edge(g.body, g.head);
+	check_dominance(g.irg, true);
+
+	/* route the then block through a new block, which is only reported as
+	 * source of an edge */
+	ir_node *in[]  = { get_cfgpred(g.head, 0) };
+	ir_node *split = new_r_Block(g.irg, 1, in);
+	set_cfgpred(g.head, 0, new_r_Jmp(split));
+	dom_delete_edge(g.a, g.head);
+	dom_insert_edge(split, g.head);
+	check_dominance(g.irg, true);
+	assert(get_Block_idom(split) == g.a);
+
+	/* the else block becomes unreachable */
+	set_cfgpred(g.b, 0, new_r_Bad(g.irg, get_modeX()));
+	dom_delete_edge(g.start, g.b);
+	check_dominance(g.irg, true);
+	assert(get_Block_idom(g.head) == split);
+
+	ir_finish();
+	return 0;
+}
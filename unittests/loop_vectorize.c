@@ -0,0 +1,131 @@
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+
+static ir_type  *int_type;
+static unsigned  max_vector_bits;
+static int       vector_cost;
+
+static int get_vector_cost(ir_node const *node, ir_mode *mode)
+{
+	(void)node;
+	return get_mode_size_bits(mode) <= max_vector_bits ? vector_cost : -1;
+}
+
+static ir_node *new_element_address(ir_node *base, ir_node *index)
+{
+	ir_mode *offset_mode = get_reference_offset_mode(get_modeP());
+	ir_node *offset      = new_Mul(new_Conv(index, offset_mode),
+	                               new_Const_long(offset_mode, 4));
+	return new_Add(base, offset);
+}
+
+static ir_node *new_array_address(void)
+{
+	ir_type   *array_type = new_type_array(int_type, 64);
+	ir_entity *array      = new_global_entity(get_glob_type(), id_unique("array"),
+	                                          array_type, ir_visibility_external,
+	                                          IR_LINKAGE_DEFAULT);
+	return new_Address(array);
+}
+
+/* i = 0; do dst[i] = src[i] + 1; while (++i < n);
+ * Returns the Store of the loop. */
+static ir_node *new_loop(long n, bool pointer_params)
+{
+	ir_type *ptr_type = new_type_pointer(int_type);
+	ir_type *mtp      = new_type_method(2, 0, false, cc_cdecl_set,
+	                                    mtp_no_property);
+	set_method_param_type(mtp, 0, ptr_type);
+	set_method_param_type(mtp, 1, ptr_type);
+	ir_entity *entity = new_global_entity(get_glob_type(), id_unique("method"),
+	                                      mtp, ir_visibility_external,
+	                                      IR_LINKAGE_DEFAULT);
+	ir_graph  *irg    = new_ir_graph(entity, 1);
+	set_current_ir_graph(irg);
+
+	ir_node *dst;
+	ir_node *src;
+	if (pointer_params) {
+		dst = new_Proj(get_irg_args(irg), get_modeP(), 0);
+		src = new_Proj(get_irg_args(irg), get_modeP(), 1);
+	} else {
+		dst = new_array_address();
+		src = new_array_address();
+	}
+	set_value(0, new_Const_long(get_modeIs(), 0));
+	ir_node *jmp  = new_Jmp();
+	ir_node *body = new_immBlock();
+	add_immBlock_pred(body, jmp);
+	set_cur_block(body);
+
+	ir_node *i     = get_value(0, get_modeIs());
+	ir_node *load  = new_Load(get_store(), new_element_address(src, i),
+	                          get_modeIs(), int_type, cons_none);
+	set_store(new_Proj(load, get_modeM(), pn_Load_M));
+	ir_node *value = new_Add(new_Proj(load, get_modeIs(), pn_Load_res),
+	                         new_Const_long(get_modeIs(), 1));
+	ir_node *store = new_Store(get_store(), new_element_address(dst, i),
+	                           value, int_type, cons_none);
+	set_store(new_Proj(store, get_modeM(), pn_Store_M));
+
+	ir_node *next = new_Add(i, new_Const_long(get_modeIs(), 1));
+	set_value(0, next);
+	ir_node *cmp  = new_Cmp(next, new_Const_long(get_modeIs(), n),
+	                        ir_relation_less);
+	ir_node *cond = new_Cond(cmp);
+	add_immBlock_pred(body, new_Proj(cond, get_modeX(), pn_Cond_true));
+	mature_immBlock(body);
+
+	ir_node *exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(cond, get_modeX(), pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+	ir_node *ret = new_Return(get_store(), 0, NULL);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	assert(irg_verify(irg));
+	return store;
+}
+
+/* Returns the number of lanes the loop of store executes at once. */
+static unsigned vectorize(ir_node *store)
+{
+	ir_graph *irg = get_irn_irg(store);
+	do_loop_vectorization_cb(irg, get_vector_cost);
+	assert(irg_verify(irg));
+
+	ir_mode *mode = get_irn_mode(get_Store_value(store));
+	return mode_is_vector(mode) ? get_mode_vector_n_lanes(mode) : 1;
+}
+
+int main(void)
+{
+	ir_init();
+
+	int_type        = new_type_primitive(get_modeIs());
+	max_vector_bits = 256;
+	vector_cost     = 1;
+
+	/* The widest vector dividing the number of iterations is used. */
+	assert(vectorize(new_loop(16, false)) == 8);
+	assert(vectorize(new_loop(12, false)) == 4);
+	assert(vectorize(new_loop(10, false)) == 1);
+
+	/* Arrays passed as pointers may overlap. */
+	assert(vectorize(new_loop(16, true)) == 1);
+
+	/* The target decides which vectors are available. */
+	max_vector_bits = 128;
+	assert(vectorize(new_loop(16, false)) == 4);
+	max_vector_bits = 64;
+	assert(vectorize(new_loop(16, false)) == 1);
+
+	/* The vector loop must be cheaper than the scalar one. */
+	max_vector_bits = 256;
+	vector_cost     = 8;
+	assert(vectorize(new_loop(16, false)) == 1);
+
+	return 0;
+}
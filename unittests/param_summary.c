@@ -0,0 +1,87 @@
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+static ir_type *int_type;
+static ir_type *ptr_type;
+static ir_type *method_type;
+
+static ir_graph *new_method(const char *name)
+{
+	ir_entity *ent = new_global_entity(get_glob_type(), new_id_from_str(name),
+	                                   method_type, ir_visibility_external,
+	                                   IR_LINKAGE_DEFAULT);
+	ir_graph  *irg = new_ir_graph(ent, 0);
+	set_current_ir_graph(irg);
+	return irg;
+}
+
+static ir_node *get_param(void)
+{
+	return new_Proj(get_irg_args(get_current_ir_graph()), get_modeP(), 0);
+}
+
+static ir_node *finish_method(ir_node *mem)
+{
+	ir_graph *irg = get_current_ir_graph();
+	ir_node  *ret = new_Return(mem, 0, NULL);
+	mature_immBlock(get_cur_block());
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	return ret;
+}
+
+int main(void)
+{
+	ir_init();
+
+	int_type    = new_type_primitive(get_modeIs());
+	ptr_type    = new_type_pointer(int_type);
+	method_type = new_type_method(1, 0, false, cc_cdecl_set, mtp_no_property);
+	set_method_param_type(method_type, 0, ptr_type);
+
+	/* f(p) { global = p; } analyzed after another walk left the nodes
+	 * visited */
+	ir_entity *global = new_global_entity(get_glob_type(),
+	                                      new_id_from_str("global"), ptr_type,
+	                                      ir_visibility_external,
+	                                      IR_LINKAGE_DEFAULT);
+	ir_graph  *f      = new_method("f");
+	ir_node   *store  = new_Store(get_store(), new_Address(global), get_param(),
+	                              ptr_type, cons_none);
+	finish_method(new_Proj(store, get_modeM(), pn_Store_M));
+	irg_walk_graph(f, NULL, NULL, NULL);
+	assert(get_method_param_access(get_irg_entity(f), 0) & ptr_access_store);
+
+	/* g(p) { return *p; } and h(p) { g(p); } */
+	ir_graph  *g     = new_method("g");
+	ir_node   *g_arg = get_param();
+	ir_node   *load  = new_Load(get_store(), g_arg, get_modeIs(), int_type,
+	                            cons_none);
+	ir_node   *g_ret = finish_method(new_Proj(load, get_modeM(), pn_Load_M));
+	ir_entity *g_ent = get_irg_entity(g);
+
+	ir_graph  *h    = new_method("h");
+	ir_node   *in[] = { get_param() };
+	ir_node   *call = new_Call(get_store(), new_Address(g_ent), 1, in,
+	                           method_type);
+	finish_method(new_Proj(call, get_modeM(), pn_Call_M));
+	ir_entity *h_ent = get_irg_entity(h);
+
+	assert(get_method_param_access(h_ent, 0) == ptr_access_read);
+
+	/* g now writes through p, which h has to see although h is unchanged */
+	ir_node *g_mem   = get_Return_mem(g_ret);
+	ir_node *g_store = new_r_Store(get_nodes_block(g_ret), g_mem, g_arg,
+	                               new_r_Const_long(g, get_modeIs(), 1),
+	                               int_type, cons_none);
+	set_Return_mem(g_ret, new_r_Proj(g_store, get_modeM(), pn_Store_M));
+	confirm_irg_properties(g, IR_GRAPH_PROPERTIES_NONE);
+
+	assert(get_method_param_access(h_ent, 0) & ptr_access_write);
+	assert(get_method_param_access(g_ent, 0) & ptr_access_write);
+
+	return 0;
+}
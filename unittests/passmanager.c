@@ -0,0 +1,139 @@
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/* f(x) { int s = x; while (s < 10) s = s + 1; return s; } */
+static void build_graph(ir_entity *ent)
+{
+	ir_graph *irg = new_ir_graph(ent, 1);
+	set_current_ir_graph(irg);
+
+	set_value(0, new_Proj(get_irg_args(irg), get_modeIs(), 0));
+	ir_node *jmp  = new_Jmp();
+	ir_node *head = new_immBlock();
+	add_immBlock_pred(head, jmp);
+	set_cur_block(head);
+	ir_node *cmp  = new_Cmp(get_value(0, get_modeIs()),
+	                        new_Const_long(get_modeIs(), 10), ir_relation_less);
+	ir_node *cond = new_Cond(cmp);
+
+	ir_node *body = new_immBlock();
+	add_immBlock_pred(body, new_Proj(cond, get_modeX(), pn_Cond_true));
+	mature_immBlock(body);
+	set_cur_block(body);
+	set_value(0, new_Add(get_value(0, get_modeIs()),
+	                     new_Const_long(get_modeIs(), 1)));
+	add_immBlock_pred(head, new_Jmp());
+	mature_immBlock(head);
+
+	ir_node *exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(cond, get_modeX(), pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+	ir_node *res[] = { get_value(0, get_modeIs()) };
+	ir_node *ret   = new_Return(get_store(), 1, res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+}
+
+static void keep_dominance(ir_graph *irg)
+{
+	/* the outs were computed for the dominance before and are kept, too */
+	assert(irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS));
+}
+
+static void change_nothing(ir_graph *irg)
+{
+	(void)irg;
+}
+
+static void check_invalidated(ir_graph *irg)
+{
+	assert(!irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE));
+	assert(!irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_OUTS));
+}
+
+static void recompute_doms(ir_graph *irg)
+{
+	assert(irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LIVENESS));
+	compute_doms(irg);
+}
+
+static void check_no_liveness(ir_graph *irg)
+{
+	/* the liveness check refers to the old dominator tree numbers */
+	assert(!irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_LIVENESS));
+	assert(irg_has_properties(irg, IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE));
+}
+
+/** Returns the number of analyses computed for pass @p name. */
+static unsigned get_n_analyses(ir_pass_manager_t const *mgr, char const *name)
+{
+	FILE *out = tmpfile();
+	assert(out != NULL);
+	ir_pass_manager_print_stats(mgr, out);
+	rewind(out);
+
+	char     line[256];
+	unsigned result = ~0u;
+	while (fgets(line, sizeof(line), out) != NULL) {
+		char     pass[64];
+		unsigned runs;
+		unsigned n_analyses;
+		if (sscanf(line, "%63s %u %u", pass, &runs, &n_analyses) == 3
+		    && strcmp(pass, name) == 0) {
+			assert(runs == 1);
+			result = n_analyses;
+		}
+	}
+	fclose(out);
+	assert(result != ~0u);
+	return result;
+}
+
+int main(void)
+{
+	ir_init();
+
+	ir_type *int_type = new_type_primitive(get_modeIs());
+	ir_type *mtp      = new_type_method(1, 1, false, cc_cdecl_set,
+	                                    mtp_no_property);
+	set_method_param_type(mtp, 0, int_type);
+	set_method_res_type(mtp, 0, int_type);
+	ir_entity *ent = new_global_entity(get_glob_type(), new_id_from_str("f"),
+	                                   mtp, ir_visibility_external,
+	                                   IR_LINKAGE_DEFAULT);
+	build_graph(ent);
+
+	ir_graph_properties_t const none = IR_GRAPH_PROPERTIES_NONE;
+	ir_graph_properties_t const all  = IR_GRAPH_PROPERTIES_ALL;
+	ir_graph_properties_t const dom  = IR_GRAPH_PROPERTY_CONSISTENT_DOMINANCE;
+	ir_graph_properties_t const live = IR_GRAPH_PROPERTY_CONSISTENT_LIVENESS;
+	ir_pass_manager_t *mgr = new_ir_pass_manager("test");
+	ir_pass_manager_add_graph_pass(mgr, "dom0", change_nothing, dom, all);
+	ir_pass_manager_add_graph_pass(mgr, "dom1", keep_dominance, dom, all);
+	ir_pass_manager_add_graph_pass(mgr, "clobber", change_nothing, none,
+	                               none);
+	ir_pass_manager_add_graph_pass(mgr, "check", check_invalidated, none,
+	                               all);
+	ir_pass_manager_add_graph_pass(mgr, "dom2", change_nothing, dom, all);
+	ir_pass_manager_add_graph_pass(mgr, "live", recompute_doms, live, all);
+	ir_pass_manager_add_graph_pass(mgr, "nolive", check_no_liveness, none,
+	                               all);
+	ir_pass_manager_run(mgr);
+
+	/* the dominance is computed once, kept for the next pass, and computed
+	 * again after a pass did not preserve it */
+	assert(get_n_analyses(mgr, "dom0") == 1);
+	assert(get_n_analyses(mgr, "dom1") == 0);
+	assert(get_n_analyses(mgr, "clobber") == 0);
+	assert(get_n_analyses(mgr, "dom2") == 1);
+	assert(get_n_analyses(mgr, "live") == 1);
+
+	free_ir_pass_manager(mgr);
+	ir_finish();
+	return 0;
+}
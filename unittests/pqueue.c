@@ -0,0 +1,76 @@
+#include "pqueue.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define N 1000
+
+static int    values[N];
+static double priorities[N];
+
+static void test_order(void)
+{
+	pqueue_t *q = new_pqueue();
+	assert(pqueue_empty(q));
+	for (int i = 0; i < N; ++i) {
+		values[i] = (i * 7919) % N;
+		pqueue_put(q, &values[i], values[i]);
+	}
+	assert(pqueue_length(q) == N);
+	for (int i = N; i-- > 0; ) {
+		assert(*(int*)pqueue_front(q) == i);
+		int *v = (int*)pqueue_pop_front(q);
+		assert(*v == i);
+	}
+	assert(pqueue_empty(q));
+	del_pqueue(q);
+}
+
+static void test_handles(void)
+{
+	pqueue_t        *q = new_pqueue();
+	pqueue_handle_t  handles[N];
+	bool             present[N];
+	srand(42);
+	for (int i = 0; i < N; ++i) {
+		priorities[i] = rand() / (double)RAND_MAX;
+		handles[i]    = pqueue_insert(q, &priorities[i], priorities[i]);
+		present[i]    = true;
+	}
+
+	/* change and remove some elements */
+	for (int i = 0; i < N; i += 3) {
+		priorities[i] = rand() / (double)RAND_MAX * 2 - 0.5;
+		pqueue_set_priority(q, handles[i], priorities[i]);
+		assert(pqueue_get_priority(q, handles[i]) == priorities[i]);
+	}
+	for (int i = 1; i < N; i += 5) {
+		void *data = pqueue_remove(q, handles[i]);
+		assert(data == &priorities[i]);
+		present[i] = false;
+	}
+
+	/* reuse the freed handles */
+	for (int i = 1; i < N; i += 5) {
+		handles[i] = pqueue_insert(q, &priorities[i], priorities[i]);
+		present[i] = true;
+	}
+
+	double last = 2.0;
+	while (!pqueue_empty(q)) {
+		double *p = (double*)pqueue_pop_front(q);
+		assert(*p <= last);
+		last = *p;
+		present[p - priorities] = false;
+	}
+	for (int i = 0; i < N; ++i)
+		assert(!present[i]);
+	del_pqueue(q);
+}
+
+int main(void)
+{
+	test_order();
+	test_handles();
+	return 0;
+}
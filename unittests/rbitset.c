@@ -1,6 +1,25 @@
 #include "raw_bitset.h"
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
+
+/* Compares the count against a bitwise loop for sizes below and above the
+ * threshold for the bulk kernels. */
+static void test_popcounts(void)
+{
+	for (size_t size = 1; size < 40 * BITS_PER_ELEM; size += 7) {
+		unsigned *a   = rbitset_malloc(size);
+		unsigned  n_a = 0;
+		for (size_t i = 0; i < size; ++i) {
+			bool in_a = rand() % 3 != 0;
+			if (in_a)
+				rbitset_set(a, i);
+			n_a += in_a;
+		}
+		assert(rbitset_popcount(a, size) == n_a);
+		free(a);
+	}
+}
 
 int main(void)
 {
@@ -72,5 +91,10 @@ int main(void)
 	assert(rbitset_popcount(null, 0) == 0);
 	assert(rbitset_is_empty(null, 0));
 
+	/* once with the fallback and once with the kernel for this cpu */
+	test_popcounts();
+	init_rbitset();
+	test_popcounts();
+
 	return 0;
 }
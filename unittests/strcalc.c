@@ -100,6 +100,37 @@ static bool is_zero(const sc_word *val)
 	return sc_is_zero(val, precision);
 }
 
+static void check_divmod(const sc_word *dividend, const sc_word *divisor)
+{
+	if (is_zero(divisor))
+		return;
+	sc_word *quot = XMALLOCN(sc_word, buflen);
+	sc_word *rem  = XMALLOCN(sc_word, buflen);
+	sc_word *temp = XMALLOCN(sc_word, buflen);
+	sc_divmod(dividend, divisor, quot, rem);
+	/* dividend == quot * divisor + rem */
+	sc_mul(quot, divisor, temp);
+	sc_add(temp, rem, temp);
+	assert(equal(temp, dividend));
+	/* the remainder is smaller than the divisor */
+	sc_word *abs_rem     = XMALLOCN(sc_word, buflen);
+	sc_word *abs_divisor = XMALLOCN(sc_word, buflen);
+	if (sc_is_negative(rem))
+		sc_neg(rem, abs_rem);
+	else
+		memcpy(abs_rem, rem, buflen);
+	if (sc_is_negative(divisor))
+		sc_neg(divisor, abs_divisor);
+	else
+		memcpy(abs_divisor, divisor, buflen);
+	assert(sc_comp(abs_rem, abs_divisor) == ir_relation_less);
+	free(abs_divisor);
+	free(abs_rem);
+	free(temp);
+	free(rem);
+	free(quot);
+}
+
 int main(void)
 {
 	init_strcalc(precision);
@@ -321,6 +352,7 @@ int main(void)
 			check_commutativity(val0, val1, sc_or);
 			check_commutativity(val0, val1, sc_and);
 			check_commutativity(val0, val1, sc_xor);
+			check_divmod(val0, val1);
 
 			for (unsigned i2 = 0; i2 < ARRAY_SIZE(vals); ++i2) {
 				const sc_word *val2 = vals[i2];
@@ -0,0 +1,93 @@
+#include "firm.h"
+#include "tv_t.h"
+#include "util.h"
+#include <assert.h>
+#include <string.h>
+
+static ir_tarval *vec4(ir_mode *mode, long a, long b, long c, long d)
+{
+	ir_mode   *element_mode = get_mode_vector_element_mode(mode);
+	ir_tarval *lanes[]      = {
+		new_tarval_from_long(a, element_mode),
+		new_tarval_from_long(b, element_mode),
+		new_tarval_from_long(c, element_mode),
+		new_tarval_from_long(d, element_mode),
+	};
+	return new_tarval_from_lanes(mode, lanes);
+}
+
+static void check_int_vector(void)
+{
+	ir_mode *mode = new_vector_mode("V4Is", mode_Is, 4);
+	assert(mode_is_vector(mode));
+	assert(!mode_is_int(mode) && !mode_is_float(mode));
+	assert(get_mode_size_bits(mode) == 128);
+	assert(get_mode_vector_n_lanes(mode) == 4);
+	assert(get_mode_vector_element_mode(mode) == mode_Is);
+
+	ir_tarval *a = vec4(mode, 1, -2, 3, 0x7FFFFFFF);
+	ir_tarval *b = vec4(mode, 5, 7, -3, 1);
+	assert(a == vec4(mode, 1, -2, 3, 0x7FFFFFFF));
+	assert(get_tarval_lane(a, 1) == new_tarval_from_long(-2, mode_Is));
+
+	/* arithmetic works lane-wise and wraps in each lane */
+	assert(tarval_add(a, b) == vec4(mode, 6, 5, 0, -0x7FFFFFFF - 1));
+	assert(tarval_sub(a, b) == vec4(mode, -4, -9, 6, 0x7FFFFFFE));
+	assert(tarval_mul(a, b) == vec4(mode, 5, -14, -9, 0x7FFFFFFF));
+	assert(tarval_neg(a) == vec4(mode, -1, 2, -3, -0x7FFFFFFF));
+	assert(tarval_and(a, b) == vec4(mode, 1, 6, 1, 1));
+	assert(tarval_or(a, b) == vec4(mode, 5, -1, -1, 0x7FFFFFFF));
+	assert(tarval_eor(a, b) == vec4(mode, 4, -7, -2, 0x7FFFFFFE));
+	assert(tarval_not(b) == vec4(mode, ~5, ~7, ~-3, ~1));
+
+	assert(get_mode_null(mode) == vec4(mode, 0, 0, 0, 0));
+	assert(get_mode_one(mode) == vec4(mode, 1, 1, 1, 1));
+	assert(get_mode_all_one(mode) == vec4(mode, -1, -1, -1, -1));
+	assert(tarval_is_null(get_mode_null(mode)));
+	assert(!tarval_is_null(a));
+
+	/* lanes are laid out in memory order */
+	unsigned char buf[16];
+	tarval_to_bytes(buf, a);
+	assert(new_tarval_from_bytes(buf, mode) == a);
+	assert(get_tarval_sub_bits(a, 4) == get_tarval_sub_bits(get_tarval_lane(a, 1), 0));
+
+	char str[64];
+	tarval_snprintf(str, sizeof(str), vec4(mode, 1, 2, 3, 4));
+	assert(strcmp(str, "<0x1, 0x2, 0x3, 0x4>") == 0);
+
+	assert(tarval_cmp(a, a) == ir_relation_equal);
+	assert(tarval_cmp(a, b) == ir_relation_less_greater);
+}
+
+static void check_float_vector(void)
+{
+	ir_mode   *mode  = new_vector_mode("V2D", mode_D, 2);
+	ir_tarval *l0[]  = { new_tarval_from_double(1.5, mode_D),
+	                     new_tarval_from_double(-2.0, mode_D) };
+	ir_tarval *l1[]  = { new_tarval_from_double(0.25, mode_D),
+	                     new_tarval_from_double(4.0, mode_D) };
+	ir_tarval *a     = new_tarval_from_lanes(mode, l0);
+	ir_tarval *b     = new_tarval_from_lanes(mode, l1);
+
+	ir_tarval *sum   = tarval_add(a, b);
+	assert(get_tarval_double(get_tarval_lane(sum, 0)) == 1.75);
+	assert(get_tarval_double(get_tarval_lane(sum, 1)) == 2.0);
+	ir_tarval *prod  = tarval_mul(a, b);
+	assert(get_tarval_double(get_tarval_lane(prod, 0)) == 0.375);
+	assert(get_tarval_double(get_tarval_lane(prod, 1)) == -8.0);
+	ir_tarval *neg   = tarval_neg(a);
+	assert(get_tarval_double(get_tarval_lane(neg, 1)) == 2.0);
+
+	/* no ordering or conversions on vectors */
+	assert(get_mode_max(mode) == tarval_bad);
+	assert(tarval_convert_to(a, mode_Is) == tarval_bad);
+}
+
+int main(void)
+{
+	ir_init();
+
+	check_int_vector();
+	check_float_vector();
+}
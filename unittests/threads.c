@@ -0,0 +1,259 @@
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef FIRM_THREADS
+#include <pthread.h>
+#endif
+
+#define N_THREADS 4
+#define N_GRAPHS  64
+
+static ir_type   *int_type;
+static ir_entity *entities[N_THREADS][N_GRAPHS];
+
+/* f(x) { int s = x; while (s < n) s = s * 3 + n; return s; } */
+static void build_graph(ir_entity *ent, long n)
+{
+	ir_graph *irg = new_ir_graph(ent, 1);
+	set_current_ir_graph(irg);
+
+	ir_node *x = new_Proj(get_irg_args(irg), get_modeIs(), 0);
+	set_value(0, x);
+	ir_node *jmp = new_Jmp();
+
+	ir_node *head = new_immBlock();
+	add_immBlock_pred(head, jmp);
+	set_cur_block(head);
+	ir_node *bound = new_Const_long(get_modeIs(), n);
+	ir_node *cmp   = new_Cmp(get_value(0, get_modeIs()), bound,
+	                         ir_relation_less);
+	ir_node *cond  = new_Cond(cmp);
+
+	ir_node *body = new_immBlock();
+	add_immBlock_pred(body, new_Proj(cond, get_modeX(), pn_Cond_true));
+	mature_immBlock(body);
+	set_cur_block(body);
+	ir_node *three = new_Const_long(get_modeIs(), 3);
+	ir_node *mul   = new_Mul(get_value(0, get_modeIs()), three);
+	set_value(0, new_Add(mul, bound));
+	add_immBlock_pred(head, new_Jmp());
+	mature_immBlock(head);
+
+	ir_node *exit = new_immBlock();
+	add_immBlock_pred(exit, new_Proj(cond, get_modeX(), pn_Cond_false));
+	mature_immBlock(exit);
+	set_cur_block(exit);
+	ir_node *res[] = { get_value(0, get_modeIs()) };
+	ir_node *ret   = new_Return(get_store(), 1, res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+
+	/* tarvals are printed through a buffer, which must not be shared */
+	char expected[32];
+	char printed[32];
+	snprintf(expected, sizeof(expected), "0x%lX", (unsigned long)n);
+	tarval_snprintf(printed, sizeof(printed), get_Const_tarval(bound));
+	assert(strcmp(expected, printed) == 0);
+}
+
+static void *build_graphs(void *data)
+{
+	ir_entity **ents = (ir_entity**)data;
+	for (size_t i = 0; i < N_GRAPHS; ++i)
+		build_graph(ents[i], (long)get_entity_nr(ents[i]) + 0x1000);
+	return NULL;
+}
+
+static int cmp_long(const void *a, const void *b)
+{
+	long const la = *(const long*)a;
+	long const lb = *(const long*)b;
+	return (la > lb) - (la < lb);
+}
+
+static void collect_node_nr(ir_node *node, void *data)
+{
+	long **nrs = (long**)data;
+	*(*nrs)++ = get_irn_node_nr(node);
+}
+
+/* g(x) { return f0(x) + f1(x); } */
+static void build_caller(ir_entity *ent, ir_entity *f0, ir_entity *f1)
+{
+	ir_graph *irg = new_ir_graph(ent, 0);
+	set_current_ir_graph(irg);
+
+	ir_entity *callees[] = { f0, f1 };
+	ir_node   *x         = new_Proj(get_irg_args(irg), get_modeIs(), 0);
+	ir_node   *sum       = NULL;
+	for (size_t i = 0; i < 2; ++i) {
+		ir_node *in[] = { x };
+		ir_node *call = new_Call(get_store(), new_Address(callees[i]), 1, in,
+		                         get_entity_type(callees[i]));
+		set_store(new_Proj(call, get_modeM(), pn_Call_M));
+		ir_node *ress = new_Proj(call, get_modeT(), pn_Call_T_result);
+		ir_node *res  = new_Proj(ress, get_modeIs(), 0);
+		sum = sum == NULL ? res : new_Add(sum, res);
+	}
+	ir_node *res[] = { sum };
+	ir_node *ret   = new_Return(get_store(), 1, res);
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+}
+
+static void count_call(ir_node *node, void *data)
+{
+	if (is_Call(node))
+		++*(unsigned*)data;
+}
+
+static void optimize_inlined(ir_graph *irg)
+{
+	optimize_graph_df(irg);
+	optimize_cf(irg);
+	assert(irg_verify(irg));
+}
+
+static void verify_graph(ir_graph *irg)
+{
+	assert(irg_verify(irg));
+	(void)irg;
+}
+
+/** Returns the number of runs of pass @p name. */
+static unsigned get_n_runs(ir_pass_manager_t const *mgr, char const *name)
+{
+	FILE *out = tmpfile();
+	assert(out != NULL);
+	ir_pass_manager_print_stats(mgr, out);
+	rewind(out);
+
+	char     line[256];
+	unsigned result = ~0u;
+	while (fgets(line, sizeof(line), out) != NULL) {
+		char     pass[64];
+		unsigned runs;
+		if (sscanf(line, "%63s %u", pass, &runs) == 2
+		    && strcmp(pass, name) == 0)
+			result = runs;
+	}
+	fclose(out);
+	return result;
+}
+
+int main(void)
+{
+	ir_init();
+
+	int_type = new_type_primitive(get_modeIs());
+	ir_type *mtp = new_type_method(1, 1, false, cc_cdecl_set, mtp_no_property);
+	set_method_param_type(mtp, 0, int_type);
+	set_method_res_type(mtp, 0, int_type);
+
+	/* types and entities are created in one thread, only the graphs are
+	 * constructed concurrently */
+	for (size_t t = 0; t < N_THREADS; ++t) {
+		for (size_t i = 0; i < N_GRAPHS; ++i) {
+			entities[t][i] = new_global_entity(get_glob_type(),
+			                                   id_unique("f"), mtp,
+			                                   ir_visibility_external,
+			                                   IR_LINKAGE_DEFAULT);
+		}
+	}
+
+	size_t const n_irgs = get_irp_n_irgs();
+#ifdef FIRM_THREADS
+	pthread_t threads[N_THREADS];
+	for (size_t t = 0; t < N_THREADS; ++t) {
+		int res = pthread_create(&threads[t], NULL, build_graphs, entities[t]);
+		assert(res == 0);
+		(void)res;
+	}
+	for (size_t t = 0; t < N_THREADS; ++t)
+		pthread_join(threads[t], NULL);
+#else
+	for (size_t t = 0; t < N_THREADS; ++t)
+		build_graphs(entities[t]);
+#endif
+
+	assert(get_irp_n_irgs() == n_irgs + N_THREADS * N_GRAPHS);
+	for (size_t t = 0; t < N_THREADS; ++t) {
+		for (size_t i = 0; i < N_GRAPHS; ++i) {
+			ir_graph *irg = get_entity_irg(entities[t][i]);
+			assert(irg != NULL);
+			assert(irg_verify(irg));
+		}
+	}
+
+	/* graph indices and node numbers are unique across all threads */
+	bool  *seen    = (bool*)calloc(get_irp_last_idx(), sizeof(*seen));
+	size_t n_nodes = 0;
+	for (size_t i = 0, n = get_irp_n_irgs(); i < n; ++i) {
+		ir_graph    *irg = get_irp_irg(i);
+		size_t const idx = get_irg_idx(irg);
+		assert(idx < get_irp_last_idx() && !seen[idx]);
+		seen[idx] = true;
+		n_nodes += get_irg_last_idx(irg);
+	}
+	free(seen);
+	long *nrs = (long*)malloc(n_nodes * sizeof(*nrs));
+	long *end = nrs;
+	for (size_t i = 0, n = get_irp_n_irgs(); i < n; ++i)
+		irg_walk_anchors(get_irp_irg(i), collect_node_nr, NULL, &end);
+	qsort(nrs, end - nrs, sizeof(*nrs), cmp_long);
+	for (long *nr = nrs + 1; nr < end; ++nr)
+		assert(nr[-1] != nr[0]);
+	free(nrs);
+
+	/* the graphs are optimized concurrently, each one in a single worker */
+	ir_pass_manager_t *mgr = new_ir_pass_manager("threads");
+	ir_pass_manager_set_n_threads(mgr, N_THREADS);
+	ir_graph_properties_t const none = IR_GRAPH_PROPERTIES_NONE;
+	ir_pass_manager_add_graph_pass(mgr, "local", optimize_graph_df, none,
+	                               none);
+	ir_pass_manager_add_graph_pass(mgr, "cf", optimize_cf, none, none);
+	ir_pass_manager_add_graph_pass(mgr, "jumpthreading", opt_jumpthreading,
+	                               none, none);
+	ir_pass_manager_add_graph_pass(mgr, "reassoc", optimize_reassociation,
+	                               none, none);
+	ir_pass_manager_add_graph_pass(mgr, "gcm", place_code, none, none);
+	ir_pass_manager_add_graph_pass(mgr, "dce", dead_node_elimination, none,
+	                               none);
+	ir_pass_manager_add_graph_pass(mgr, "verify", verify_graph, none, none);
+	ir_pass_manager_run(mgr);
+	assert(get_n_runs(mgr, "verify") == get_irp_n_irgs());
+	free_ir_pass_manager(mgr);
+
+	/* two levels of callers, the graphs of a level are optimized
+	 * concurrently after the calls were inlined */
+	ir_entity *callers[N_GRAPHS];
+	for (size_t i = 0; i < N_GRAPHS; ++i) {
+		callers[i] = new_global_entity(get_glob_type(), id_unique("g"), mtp,
+		                               ir_visibility_external,
+		                               IR_LINKAGE_DEFAULT);
+		build_caller(callers[i], entities[0][i],
+		             entities[1][(i + 1) % N_GRAPHS]);
+	}
+	for (size_t i = 0; i < N_GRAPHS; ++i) {
+		ir_entity *ent = new_global_entity(get_glob_type(), id_unique("h"),
+		                                   mtp, ir_visibility_external,
+		                                   IR_LINKAGE_DEFAULT);
+		build_caller(ent, callers[i], callers[(i + 1) % N_GRAPHS]);
+	}
+	inline_functions_parallel(100000, -100000, optimize_inlined, N_THREADS);
+	unsigned n_calls = 0;
+	for (size_t i = 0, n = get_irp_n_irgs(); i < n; ++i) {
+		ir_graph *irg = get_irp_irg(i);
+		assert(irg_verify(irg));
+		irg_walk_graph(irg, count_call, NULL, &n_calls);
+	}
+	assert(n_calls == 0);
+
+	ir_finish();
+	return 0;
+}
@@ -0,0 +1,132 @@
+#include "firm.h"
+#include <assert.h>
+#include <stdbool.h>
+
+static ir_type *int_type;
+static ir_mode *vector_mode;
+static ir_type *vector_type;
+
+static ir_type *new_method_type(size_t n_params, size_t n_ress)
+{
+	ir_type *mtp = new_type_method(n_params, n_ress, false, cc_cdecl_set,
+	                               mtp_no_property);
+	for (size_t i = 0; i < n_params; ++i)
+		set_method_param_type(mtp, i, int_type);
+	for (size_t i = 0; i < n_ress; ++i)
+		set_method_res_type(mtp, i, int_type);
+	return mtp;
+}
+
+static ir_entity *new_method_entity(ir_type *mtp)
+{
+	return new_global_entity(get_glob_type(), id_unique("method"), mtp,
+	                         ir_visibility_external, IR_LINKAGE_DEFAULT);
+}
+
+static ir_graph *new_method(ir_type *mtp)
+{
+	ir_graph *irg = new_ir_graph(new_method_entity(mtp), 0);
+	set_current_ir_graph(irg);
+	return irg;
+}
+
+static ir_node *finish_method(int n_res, ir_node *const *res)
+{
+	ir_graph *irg = get_current_ir_graph();
+	ir_node  *ret = new_Return(get_store(), n_res, res);
+	mature_immBlock(get_cur_block());
+	add_immBlock_pred(get_irg_end_block(irg), ret);
+	mature_immBlock(get_irg_end_block(irg));
+	irg_finalize_cons(irg);
+	return ret;
+}
+
+static void store_value(ir_node *value)
+{
+	ir_entity *global = new_global_entity(get_glob_type(), id_unique("global"),
+	                                      int_type, ir_visibility_external,
+	                                      IR_LINKAGE_DEFAULT);
+	ir_node   *store  = new_Store(get_store(), new_Address(global), value,
+	                              int_type, cons_none);
+	set_store(new_Proj(store, get_modeM(), pn_Store_M));
+}
+
+static ir_node *new_vector_const(ir_graph *irg)
+{
+	ir_tarval *lane    = new_tarval_from_long(1, get_modeIs());
+	ir_tarval *lanes[] = { lane, lane, lane, lane };
+	return new_r_Const(irg, new_tarval_from_lanes(vector_mode, lanes));
+}
+
+/* There is no calling convention for vectors, so they must not cross method
+ * boundaries. The graphs are built with scalars first, as the constructors
+ * verify each node. */
+static void check_result(void)
+{
+	ir_type  *mtp   = new_method_type(0, 1);
+	ir_graph *irg   = new_method(mtp);
+	ir_node  *res[] = { new_Const_long(get_modeIs(), 1) };
+	ir_node  *ret   = finish_method(1, res);
+	assert(irg_verify(irg));
+
+	set_method_res_type(mtp, 0, vector_type);
+	set_Return_res(ret, 0, new_vector_const(irg));
+	assert(!irg_verify(irg));
+}
+
+static void check_param(void)
+{
+	ir_type  *mtp = new_method_type(1, 0);
+	ir_graph *irg = new_method(mtp);
+	ir_node  *arg = new_Proj(get_irg_args(irg), get_modeIs(), 0);
+	store_value(arg);
+	finish_method(0, NULL);
+	assert(irg_verify(irg));
+
+	set_method_param_type(mtp, 0, vector_type);
+	set_irn_mode(arg, vector_mode);
+	assert(!irg_verify(irg));
+}
+
+static void check_call(void)
+{
+	ir_type   *callee_mtp = new_method_type(1, 1);
+	ir_entity *callee     = new_method_entity(callee_mtp);
+	ir_graph  *irg        = new_method(new_method_type(0, 0));
+	ir_node   *in[]       = { new_Const_long(get_modeIs(), 1) };
+	ir_node   *call       = new_Call(get_store(), new_Address(callee), 1, in,
+	                                 callee_mtp);
+	set_store(new_Proj(call, get_modeM(), pn_Call_M));
+	ir_node   *ress       = new_Proj(call, get_modeT(), pn_Call_T_result);
+	ir_node   *res        = new_Proj(ress, get_modeIs(), 0);
+	store_value(res);
+	finish_method(0, NULL);
+	assert(irg_verify(irg));
+
+	set_method_param_type(callee_mtp, 0, vector_type);
+	set_Call_param(call, 0, new_vector_const(irg));
+	assert(!irg_verify(irg));
+
+	set_method_param_type(callee_mtp, 0, int_type);
+	set_Call_param(call, 0, in[0]);
+	assert(irg_verify(irg));
+
+	set_method_res_type(callee_mtp, 0, vector_type);
+	set_irn_mode(res, vector_mode);
+	assert(!irg_verify(irg));
+}
+
+int main(void)
+{
+	ir_init();
+
+	int_type    = new_type_primitive(get_modeIs());
+	vector_mode = new_vector_mode("V4Is", get_modeIs(), 4);
+	vector_type = new_type_primitive(vector_mode);
+
+	check_result();
+	check_param();
+	check_call();
+
+	return 0;
+}